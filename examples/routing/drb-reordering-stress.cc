@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Reordering stress benchmark built on the drb-routing topology.
+//
+//  senders --- B ===(nCores core switches)=== E --- receivers
+//
+// B and E spray every packet over the core switches, the core links have
+// increasing delays, so nearly every segment reaches the receivers out of
+// order. The receive path (TcpRxBuffer and, optionally, the
+// TcpResequenceBuffer) is exercised as hard as possible and the wall clock
+// time of the run is reported.
+
+#include <iostream>
+#include <string>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-drb-helper.h"
+#include "ns3/system-wall-clock-ms.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DrbReorderingStress");
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nCores = 8;
+  uint32_t nFlows = 8;
+  uint32_t flowSize = 10000000;
+  double endTime = 2.0;
+  bool resequenceBuffer = false;
+  std::string coreDelayStep = "5us";
+
+  CommandLine cmd;
+  cmd.AddValue ("nCores", "Number of core switches the packets are sprayed over", nCores);
+  cmd.AddValue ("nFlows", "Number of concurrent bulk flows", nFlows);
+  cmd.AddValue ("flowSize", "Bytes sent by each flow", flowSize);
+  cmd.AddValue ("endTime", "Simulation end time in seconds", endTime);
+  cmd.AddValue ("resequenceBuffer", "Enable the TCP resequence buffer on the receivers", resequenceBuffer);
+  cmd.AddValue ("coreDelayStep", "Delay added per core path, the source of the reordering", coreDelayStep);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1400));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (4000000));
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (4000000));
+  // Keep the flows sending through the reordering instead of collapsing
+  // the window on duplicate ACKs
+  Config::SetDefault ("ns3::TcpSocketBase::ReTxThreshold", UintegerValue (1000));
+  Config::SetDefault ("ns3::TcpSocketBase::ResequenceBuffer", BooleanValue (resequenceBuffer));
+
+  NodeContainer senders;
+  senders.Create (nFlows);
+  NodeContainer receivers;
+  receivers.Create (nFlows);
+  NodeContainer cores;
+  cores.Create (nCores);
+  Ptr<Node> nB = CreateObject<Node> ();
+  Ptr<Node> nE = CreateObject<Node> ();
+
+  InternetStackHelper internet;
+  internet.Install (senders);
+  internet.Install (receivers);
+  internet.Install (cores);
+
+  internet.SetDrb (true);
+  internet.Install (nB);
+  internet.Install (nE);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("5us"));
+  p2p.SetQueue ("ns3::DropTailQueue", "MaxPackets", UintegerValue (1000));
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.0");
+
+  Ipv4InterfaceContainer receiverInterfaces;
+  for (uint32_t i = 0; i < nFlows; ++i)
+    {
+      ipv4.Assign (p2p.Install (senders.Get (i), nB));
+      ipv4.NewNetwork ();
+      receiverInterfaces.Add (ipv4.Assign (p2p.Install (receivers.Get (i), nE)).Get (0));
+      ipv4.NewNetwork ();
+    }
+
+  Ipv4DrbHelper drb;
+  Ptr<Ipv4Drb> ipv4DrbB = drb.GetIpv4Drb (nB->GetObject<Ipv4> ());
+  Ptr<Ipv4Drb> ipv4DrbE = drb.GetIpv4Drb (nE->GetObject<Ipv4> ());
+
+  Time delayStep = Time (coreDelayStep);
+  for (uint32_t i = 0; i < nCores; ++i)
+    {
+      p2p.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (5) + delayStep * i));
+      Ipv4InterfaceContainer iBiCore = ipv4.Assign (p2p.Install (nB, cores.Get (i)));
+      ipv4.NewNetwork ();
+      Ipv4InterfaceContainer iEiCore = ipv4.Assign (p2p.Install (nE, cores.Get (i)));
+      ipv4.NewNetwork ();
+      ipv4DrbB->AddCoreSwitchAddress (iBiCore.GetAddress (1));
+      ipv4DrbE->AddCoreSwitchAddress (iEiCore.GetAddress (1));
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  uint16_t port = 5000;
+  for (uint32_t i = 0; i < nFlows; ++i)
+    {
+      BulkSendHelper source ("ns3::TcpSocketFactory",
+                             InetSocketAddress (receiverInterfaces.GetAddress (i), port));
+      source.SetAttribute ("MaxBytes", UintegerValue (flowSize));
+      source.SetAttribute ("SendSize", UintegerValue (1400));
+      ApplicationContainer sourceApp = source.Install (senders.Get (i));
+      sourceApp.Start (Seconds (0.0));
+      sourceApp.Stop (Seconds (endTime));
+
+      PacketSinkHelper sink ("ns3::TcpSocketFactory",
+                             InetSocketAddress (Ipv4Address::GetAny (), port));
+      ApplicationContainer sinkApp = sink.Install (receivers.Get (i));
+      sinkApp.Start (Seconds (0.0));
+      sinkApp.Stop (Seconds (endTime));
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+
+  Simulator::Stop (Seconds (endTime));
+  Simulator::Run ();
+
+  int64_t elapsed = clock.End ();
+
+  uint64_t totalRx = 0;
+  for (uint32_t i = 0; i < nFlows; ++i)
+    {
+      Ptr<PacketSink> sink = DynamicCast<PacketSink> (receivers.Get (i)->GetApplication (0));
+      totalRx += sink->GetTotalRx ();
+    }
+
+  std::cout << "Cores: " << nCores << ", flows: " << nFlows
+            << ", resequence buffer: " << (resequenceBuffer ? "on" : "off") << std::endl;
+  std::cout << "Received " << totalRx << " bytes in " << elapsed << " ms wall clock" << std::endl;
+
+  Simulator::Destroy ();
+
+  return 0;
+}
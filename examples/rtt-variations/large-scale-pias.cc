@@ -12,12 +12,6 @@
 #include <utility>
 #include <set>
 
-// The CDF in TrafficGenerator
-extern "C"
-{
-#include "cdf.h"
-}
-
 #define LINK_CAPACITY_BASE    1000000000          // 1Gbps
 #define BUFFER_SIZE 250                           // 250 packets
 
@@ -36,71 +30,43 @@ enum AQM {
   ECNSharp
 };
 
-// Acknowledged to https://github.com/HKUST-SING/TrafficGenerator/blob/master/src/common/common.c
-double poission_gen_interval(double avg_rate)
-{
-  if (avg_rate > 0)
-    return -logf(1.0 - (double)rand() / RAND_MAX) / avg_rate;
-  else
-    return 0;
-}
-
-template<typename T>
-T rand_range (T min, T max)
-{
-  return min + ((double)max - min) * rand () / RAND_MAX;
-}
-
-void install_applications (int fromLeafId, NodeContainer servers, double requestRate, struct cdf_table *cdfTable,
-                           long &flowCount, long &totalFlowSize, int SERVER_COUNT, int LEAF_COUNT, double START_TIME, double END_TIME, double FLOW_LAUNCH_END_TIME)
+void install_applications (const std::vector<WorkloadFlow> &flows, NodeContainer servers, long &flowCount, long &totalFlowSize,
+                           double START_TIME, double END_TIME)
 {
   NS_LOG_INFO ("Install applications:");
-  for (int i = 0; i < SERVER_COUNT; i++)
+  for (uint32_t i = 0; i < flows.size (); i++)
     {
-      int fromServerIndex = fromLeafId * SERVER_COUNT + i;
-
-      double startTime = START_TIME + poission_gen_interval (requestRate);
-      while (startTime < FLOW_LAUNCH_END_TIME)
-        {
-          flowCount ++;
-          uint16_t port = PORT++;
-
-          int destServerIndex = fromServerIndex;
-          while (destServerIndex >= fromLeafId * SERVER_COUNT && destServerIndex < fromLeafId * SERVER_COUNT + SERVER_COUNT)
-            {
-              destServerIndex = rand_range (0, SERVER_COUNT * LEAF_COUNT);
-            }
-
-          Ptr<Node> destServer = servers.Get (destServerIndex);
-          Ptr<Ipv4> ipv4 = destServer->GetObject<Ipv4> ();
-          Ipv4InterfaceAddress destInterface = ipv4->GetAddress (1,0);
-          Ipv4Address destAddress = destInterface.GetLocal ();
-
-          BulkSendPiasHelper source ("ns3::TcpSocketFactory", InetSocketAddress (destAddress, port));
-          uint32_t flowSize = gen_random_cdf (cdfTable);
-          uint32_t deplayClass = rand() % 5;
-
-          totalFlowSize += flowSize;
-
-          source.SetAttribute ("PiasThreshold", UintegerValue (PACKET_SIZE * 100));
-          source.SetAttribute ("SendSize", UintegerValue (PACKET_SIZE));
-          source.SetAttribute ("MaxBytes", UintegerValue(flowSize));
-          source.SetAttribute ("DelayClass", UintegerValue (deplayClass));
-
-          // Install apps
-          ApplicationContainer sourceApp = source.Install (servers.Get (fromServerIndex));
-          sourceApp.Start (Seconds (startTime));
-          sourceApp.Stop (Seconds (END_TIME));
-
-          // Install packet sinks
-          PacketSinkHelper sink ("ns3::TcpSocketFactory",
-                                 InetSocketAddress (Ipv4Address::GetAny (), port));
-          ApplicationContainer sinkApp = sink.Install (servers. Get (destServerIndex));
-          sinkApp.Start (Seconds (START_TIME));
-          sinkApp.Stop (Seconds (END_TIME));
-
-          startTime += poission_gen_interval (requestRate);
-        }
+      const WorkloadFlow &flow = flows[i];
+      NS_ABORT_MSG_IF (flow.src >= servers.GetN () || flow.dst >= servers.GetN (),
+                       "Flow " << i << " between unknown servers " << flow.src << " and " << flow.dst);
+      flowCount ++;
+      uint16_t port = PORT++;
+
+      Ptr<Node> destServer = servers.Get (flow.dst);
+      Ptr<Ipv4> ipv4 = destServer->GetObject<Ipv4> ();
+      Ipv4InterfaceAddress destInterface = ipv4->GetAddress (1,0);
+      Ipv4Address destAddress = destInterface.GetLocal ();
+
+      BulkSendPiasHelper source ("ns3::TcpSocketFactory", InetSocketAddress (destAddress, port));
+
+      totalFlowSize += flow.size;
+
+      source.SetAttribute ("PiasThreshold", UintegerValue (PACKET_SIZE * 100));
+      source.SetAttribute ("SendSize", UintegerValue (PACKET_SIZE));
+      source.SetAttribute ("MaxBytes", UintegerValue(flow.size));
+      source.SetAttribute ("DelayClass", UintegerValue (flow.tos));
+
+      // Install apps
+      ApplicationContainer sourceApp = source.Install (servers.Get (flow.src));
+      sourceApp.Start (Seconds (flow.startTime));
+      sourceApp.Stop (Seconds (END_TIME));
+
+      // Install packet sinks
+      PacketSinkHelper sink ("ns3::TcpSocketFactory",
+                             InetSocketAddress (Ipv4Address::GetAny (), port));
+      ApplicationContainer sinkApp = sink.Install (servers. Get (flow.dst));
+      sinkApp.Start (Seconds (START_TIME));
+      sinkApp.Stop (Seconds (END_TIME));
     }
 }
 
@@ -141,6 +107,9 @@ int main (int argc, char *argv[])
   uint32_t ECNSharpTarget = 10;
   uint32_t ECNSharpMarkingThreshold = 80;
 
+  std::string workloadFile = "";
+  uint32_t workloadThreads = 1;
+
   CommandLine cmd;
   cmd.AddValue ("ID", "Running ID", id);
   cmd.AddValue ("StartTime", "Start time of the simulation", START_TIME);
@@ -148,6 +117,8 @@ int main (int argc, char *argv[])
   cmd.AddValue ("FlowLaunchEndTime", "End time of the flow launch period", FLOW_LAUNCH_END_TIME);
   cmd.AddValue ("randomSeed", "Random seed, 0 for random generated", randomSeed);
   cmd.AddValue ("cdfFileName", "File name for flow distribution", cdfFileName);
+  cmd.AddValue ("workloadFile", "Binary file of the flow schedule, read if it exists with the same parameters, written otherwise", workloadFile);
+  cmd.AddValue ("workloadThreads", "Number of threads generating the flow schedule", workloadThreads);
   cmd.AddValue ("load", "Load of the network, 0.0 - 1.0", load);
   cmd.AddValue ("transportProt", "Transport protocol to use: Tcp, DcTcp", transportProt);
   cmd.AddValue ("linkLatency", "Link latency, should be in MicroSeconds", linkLatency);
@@ -394,23 +365,41 @@ int main (int argc, char *argv[])
   double oversubRatio = static_cast<double>(SERVER_COUNT * LEAF_SERVER_CAPACITY) / (SPINE_LEAF_CAPACITY * SPINE_COUNT * LINK_COUNT);
   NS_LOG_INFO ("Over-subscription ratio: " << oversubRatio);
 
-  NS_LOG_INFO ("Initialize CDF table");
-  struct cdf_table* cdfTable = new cdf_table ();
-  init_cdf (cdfTable);
-  load_cdf (cdfTable, cdfFileName.c_str ());
+  NS_LOG_INFO ("Initialize the workload");
+  WorkloadGenerator workload;
+  workload.LoadCdf (cdfFileName);
 
   NS_LOG_INFO ("Calculating request rate");
-  double requestRate = load * LEAF_SERVER_CAPACITY * SERVER_COUNT / oversubRatio / (8 * avg_cdf (cdfTable)) / SERVER_COUNT;
+  double requestRate = load * LEAF_SERVER_CAPACITY * SERVER_COUNT / oversubRatio / (8 * workload.GetAverageFlowSize ()) / SERVER_COUNT;
   NS_LOG_INFO ("Average request rate: " << requestRate << " per second");
 
-  NS_LOG_INFO ("Initialize random seed: " << randomSeed);
   if (randomSeed == 0)
     {
-      srand ((unsigned)time (NULL));
+      randomSeed = (unsigned)time (NULL);
+    }
+  NS_LOG_INFO ("Initialize random seed: " << randomSeed);
+  // Flow i of server s draws from its own substream of (seed, run)
+  workload.SetKey (randomSeed, RngSeedManager::GetRun ());
+  workload.SetHosts (SERVER_COUNT, LEAF_COUNT);
+  workload.SetRequestRate (requestRate);
+  workload.SetLaunchPeriod (START_TIME, FLOW_LAUNCH_END_TIME);
+  workload.SetNClasses (5);
+  workload.SetNThreads (workloadThreads);
+
+  std::vector<WorkloadFlow> flows;
+  // A schedule saved with other parameters is not loaded but regenerated
+  if (workloadFile.empty () || !workload.Load (workloadFile, flows))
+    {
+      flows = workload.Generate ();
+      if (!workloadFile.empty ())
+        {
+          NS_LOG_INFO ("Saving the flow schedule to " << workloadFile);
+          workload.Save (workloadFile, flows);
+        }
     }
   else
     {
-      srand (randomSeed);
+      NS_LOG_INFO ("Replaying the flow schedule of " << workloadFile);
     }
 
   NS_LOG_INFO ("Create applications");
@@ -418,10 +407,7 @@ int main (int argc, char *argv[])
   long flowCount = 0;
   long totalFlowSize = 0;
 
-  for (int fromLeafId = 0; fromLeafId < LEAF_COUNT; fromLeafId ++)
-    {
-      install_applications(fromLeafId, servers, requestRate, cdfTable, flowCount, totalFlowSize, SERVER_COUNT, LEAF_COUNT, START_TIME, END_TIME, FLOW_LAUNCH_END_TIME);
-    }
+  install_applications (flows, servers, flowCount, totalFlowSize, START_TIME, END_TIME);
 
   NS_LOG_INFO ("Total flow: " << flowCount);
 
@@ -448,6 +434,5 @@ int main (int argc, char *argv[])
   flowMonitor->SerializeToXmlFile(flowMonitorFilename.str (), true, true);
 
   Simulator::Destroy ();
-  free_cdf (cdfTable);
   NS_LOG_INFO ("Stop simulation");
 }
@@ -12,12 +12,6 @@
 #include <utility>
 #include <set>
 
-// The CDF in TrafficGenerator
-extern "C"
-{
-#include "cdf.h"
-}
-
 #define LINK_CAPACITY_BASE    1000000000          // 1Gbps
 #define BUFFER_SIZE 250                           // 250 packets
 
@@ -36,22 +30,14 @@ enum AQM {
   ECNSharp
 };
 
-// Acknowledged to https://github.com/HKUST-SING/TrafficGenerator/blob/master/src/common/common.c
-double poission_gen_interval(double avg_rate)
-{
-  if (avg_rate > 0)
-    return -logf(1.0 - (double)rand() / RAND_MAX) / avg_rate;
-  else
-    return 0;
-}
-
-template<typename T>
-T rand_range (T min, T max)
+void set_persistent_marking_target (Time target)
 {
-  return min + ((double)max - min) * rand () / RAND_MAX;
+  NS_LOG_INFO ("Setting the ECNSharp persistent marking target to " << target);
+  Config::Set ("/NodeList/*/$ns3::TrafficControlLayer/RootQueueDiscList/*/$ns3::ECNSharpQueueDisc/PersistentMarkingTarget",
+               TimeValue (target));
 }
 
-void install_incast_applications (NodeContainer servers, long &flowCount, int SERVER_COUNT, int LEAF_COUNT, double START_TIME, double END_TIME, double FLOW_LAUNCH_END_TIME)
+void install_incast_applications (const WorkloadGenerator &workload, NodeContainer servers, long &flowCount, int SERVER_COUNT, int LEAF_COUNT, double START_TIME, double END_TIME, double FLOW_LAUNCH_END_TIME)
 {
   NS_LOG_INFO ("Install incast applications:");
   for (int i = 0; i < SERVER_COUNT; i++)
@@ -61,19 +47,25 @@ void install_incast_applications (NodeContainer servers, long &flowCount, int SE
       Ipv4InterfaceAddress destInterface = ipv4->GetAddress (1,0);
       Ipv4Address destAddress = destInterface.GetLocal ();
 
-      uint32_t fanout = rand () % 50 + 100;
+      // Substreams 1 to 3 of the destination, 0 is used by the workload
+      double u[4];
+      workload.GetUniforms (i, 0, 2, u);
+      uint32_t fanout = static_cast<uint32_t> (u[0] * 50) + 100;
+      uint32_t n = 0;
       for (uint32_t j = 0; j < fanout; j++)
         {
-          double startTime = START_TIME + static_cast<double> (rand () % 100) / 1000000;
+          workload.GetUniforms (i, j, 3, u);
+          double startTime = START_TIME + static_cast<double> (static_cast<uint32_t> (u[0] * 100)) / 1000000;
           while (startTime < FLOW_LAUNCH_END_TIME)
             {
+              workload.GetUniforms (i, n++, 1, u);
               flowCount ++;
-              uint32_t fromServerIndex = rand () % SERVER_COUNT;
+              uint32_t fromServerIndex = static_cast<uint32_t> (u[0] * SERVER_COUNT);
               uint16_t port = PORT++;
 
               BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (destAddress, port));
-              uint32_t flowSize = rand () % 10000;
-              uint32_t tos = rand() % 5;
+              uint32_t flowSize = static_cast<uint32_t> (u[1] * 10000);
+              uint32_t tos = static_cast<uint32_t> (u[2] * 5);
 
               source.SetAttribute ("SendSize", UintegerValue (PACKET_SIZE));
               source.SetAttribute ("MaxBytes", UintegerValue(flowSize));
@@ -91,7 +83,7 @@ void install_incast_applications (NodeContainer servers, long &flowCount, int SE
               sinkApp.Start (Seconds (START_TIME));
               sinkApp.Stop (Seconds (END_TIME));
 
-              startTime += static_cast<double> (rand () % 1000) / 1000000;
+              startTime += static_cast<double> (static_cast<uint32_t> (u[3] * 1000)) / 1000000;
             }
 
         }
@@ -99,55 +91,59 @@ void install_incast_applications (NodeContainer servers, long &flowCount, int SE
     }
 }
 
-void install_applications (int fromLeafId, NodeContainer servers, double requestRate, struct cdf_table *cdfTable,
-                           long &flowCount, long &totalFlowSize, int SERVER_COUNT, int LEAF_COUNT, double START_TIME, double END_TIME, double FLOW_LAUNCH_END_TIME)
+// Completions of the flows simulated as fluid rates
+static long fluidFlowCount = 0;
+static double fluidFctSum = 0.0;
+
+void fluid_flow_completed (uint32_t flowId, Time fct)
+{
+  fluidFlowCount ++;
+  fluidFctSum += fct.GetSeconds ();
+}
+
+void install_applications (const std::vector<WorkloadFlow> &flows, NodeContainer servers, long &flowCount, long &totalFlowSize,
+                           double START_TIME, double END_TIME, Ptr<FluidFlowManager> fluidManager, uint32_t fluidThreshold)
 {
   NS_LOG_INFO ("Install applications:");
-  for (int i = 0; i < SERVER_COUNT; i++)
+  for (uint32_t i = 0; i < flows.size (); i++)
     {
-      int fromServerIndex = fromLeafId * SERVER_COUNT + i;
-
-      double startTime = START_TIME + poission_gen_interval (requestRate);
-      while (startTime < FLOW_LAUNCH_END_TIME)
-        {
-          flowCount ++;
-          uint16_t port = PORT++;
-
-          int destServerIndex = fromServerIndex;
-          while (destServerIndex >= fromLeafId * SERVER_COUNT && destServerIndex < fromLeafId * SERVER_COUNT + SERVER_COUNT)
-            {
-              destServerIndex = rand_range (0, SERVER_COUNT * LEAF_COUNT);
-            }
+      const WorkloadFlow &flow = flows[i];
+      NS_ABORT_MSG_IF (flow.src >= servers.GetN () || flow.dst >= servers.GetN (),
+                       "Flow " << i << " between unknown servers " << flow.src << " and " << flow.dst);
+      flowCount ++;
+      uint16_t port = PORT++;
 
-          Ptr<Node> destServer = servers.Get (destServerIndex);
-          Ptr<Ipv4> ipv4 = destServer->GetObject<Ipv4> ();
-          Ipv4InterfaceAddress destInterface = ipv4->GetAddress (1,0);
-          Ipv4Address destAddress = destInterface.GetLocal ();
+      Ptr<Node> destServer = servers.Get (flow.dst);
+      Ptr<Ipv4> ipv4 = destServer->GetObject<Ipv4> ();
+      Ipv4InterfaceAddress destInterface = ipv4->GetAddress (1,0);
+      Ipv4Address destAddress = destInterface.GetLocal ();
 
-          BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (destAddress, port));
-          uint32_t flowSize = gen_random_cdf (cdfTable);
-          uint32_t tos = rand() % 5;
+      totalFlowSize += flow.size;
 
-          totalFlowSize += flowSize;
+      if (fluidManager != 0 && flow.size > fluidThreshold)
+        {
+          // Background flow simulated as a fluid rate
+          fluidManager->AddFlow (servers.Get (flow.src), destAddress, port, port, flow.size, Seconds (flow.startTime));
+          continue;
+        }
 
-          source.SetAttribute ("SendSize", UintegerValue (PACKET_SIZE));
-          source.SetAttribute ("MaxBytes", UintegerValue(flowSize));
-          source.SetAttribute ("SimpleTOS", UintegerValue (tos));
+      BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (destAddress, port));
 
-          // Install apps
-          ApplicationContainer sourceApp = source.Install (servers.Get (fromServerIndex));
-          sourceApp.Start (Seconds (startTime));
-          sourceApp.Stop (Seconds (END_TIME));
+      source.SetAttribute ("SendSize", UintegerValue (PACKET_SIZE));
+      source.SetAttribute ("MaxBytes", UintegerValue(flow.size));
+      source.SetAttribute ("SimpleTOS", UintegerValue (flow.tos));
 
-          // Install packet sinks
-          PacketSinkHelper sink ("ns3::TcpSocketFactory",
-                                 InetSocketAddress (Ipv4Address::GetAny (), port));
-          ApplicationContainer sinkApp = sink.Install (servers. Get (destServerIndex));
-          sinkApp.Start (Seconds (START_TIME));
-          sinkApp.Stop (Seconds (END_TIME));
+      // Install apps
+      ApplicationContainer sourceApp = source.Install (servers.Get (flow.src));
+      sourceApp.Start (Seconds (flow.startTime));
+      sourceApp.Stop (Seconds (END_TIME));
 
-          startTime += poission_gen_interval (requestRate);
-        }
+      // Install packet sinks
+      PacketSinkHelper sink ("ns3::TcpSocketFactory",
+                             InetSocketAddress (Ipv4Address::GetAny (), port));
+      ApplicationContainer sinkApp = sink.Install (servers. Get (flow.dst));
+      sinkApp.Start (Seconds (START_TIME));
+      sinkApp.Stop (Seconds (END_TIME));
     }
 }
 
@@ -188,6 +184,16 @@ int main (int argc, char *argv[])
   uint32_t ECNSharpTarget = 10;
   uint32_t ECNSharpMarkingThreshold = 80;
 
+  uint32_t sharedBufferSize = 0;
+  uint32_t gsoMaxSize = 0;
+  uint32_t fluidThreshold = 0;
+
+  double checkpointTime = 0.0;
+  std::string branchTargets = "";
+
+  std::string workloadFile = "";
+  uint32_t workloadThreads = 1;
+
   CommandLine cmd;
   cmd.AddValue ("ID", "Running ID", id);
   cmd.AddValue ("StartTime", "Start time of the simulation", START_TIME);
@@ -215,6 +221,13 @@ int main (int argc, char *argv[])
   cmd.AddValue ("ECNSharpTarget", "The persistent target for ECNShapr", ECNSharpTarget);
   cmd.AddValue ("ECNShaprMarkingThreshold", "The instantaneous marking threshold for ECNSharp", ECNSharpMarkingThreshold);
 
+  cmd.AddValue ("sharedBufferSize", "Size in bytes of the buffer shared by the ports of a switch, 0 for per-port buffers", sharedBufferSize);
+  cmd.AddValue ("gsoMaxSize", "Largest TCP super-segment sent by the servers in bytes, 0 to disable segmentation offload", gsoMaxSize);
+  cmd.AddValue ("fluidThreshold", "Flows larger than this size in bytes are simulated as fluid rates, 0 to simulate all the flows with packets", fluidThreshold);
+  cmd.AddValue ("checkpointTime", "Time at which the simulation forks into one process per branch target, 0 to disable", checkpointTime);
+  cmd.AddValue ("workloadFile", "Binary file of the flow schedule, read if it exists with the same parameters, written otherwise", workloadFile);
+  cmd.AddValue ("workloadThreads", "Number of threads generating the flow schedule", workloadThreads);
+  cmd.AddValue ("branchTargets", "Comma separated ECNSharp persistent marking targets in MicroSeconds, one per branch after the checkpoint", branchTargets);
 
   cmd.Parse (argc, argv);
 
@@ -264,6 +277,7 @@ int main (int argc, char *argv[])
   Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue(PACKET_SIZE));
   Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (0));
   Config::SetDefault ("ns3::TcpSocket::ConnTimeout", TimeValue (MilliSeconds (5)));
+  Config::SetDefault ("ns3::TcpSocketBase::GsoMaxSize", UintegerValue (gsoMaxSize));
 
   Config::SetDefault ("ns3::TcpSocket::InitialCwnd", UintegerValue (10));
   Config::SetDefault ("ns3::TcpSocketBase::MinRto", TimeValue (MilliSeconds (5)));
@@ -410,29 +424,59 @@ int main (int argc, char *argv[])
         }
     }
 
+  if (sharedBufferSize > 0)
+    {
+      NS_LOG_INFO ("Share a " << sharedBufferSize << " bytes buffer among the ports of each switch");
+      NodeContainer switches (leaves, spines);
+      for (uint32_t i = 0; i < switches.GetN (); i++)
+        {
+          Ptr<SharedBufferManager> sharedBuffer = CreateObject<SharedBufferManager> ();
+          sharedBuffer->SetAttribute ("BufferSize", UintegerValue (sharedBufferSize));
+          switches.Get (i)->GetObject<TrafficControlLayer> ()->SetSharedBuffer (sharedBuffer);
+        }
+    }
+
   NS_LOG_INFO ("Populate global routing tables");
   Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
 
   double oversubRatio = static_cast<double>(SERVER_COUNT * LEAF_SERVER_CAPACITY) / (SPINE_LEAF_CAPACITY * SPINE_COUNT * LINK_COUNT);
   NS_LOG_INFO ("Over-subscription ratio: " << oversubRatio);
 
-  NS_LOG_INFO ("Initialize CDF table");
-  struct cdf_table* cdfTable = new cdf_table ();
-  init_cdf (cdfTable);
-  load_cdf (cdfTable, cdfFileName.c_str ());
+  NS_LOG_INFO ("Initialize the workload");
+  WorkloadGenerator workload;
+  workload.LoadCdf (cdfFileName);
 
   NS_LOG_INFO ("Calculating request rate");
-  double requestRate = load * LEAF_SERVER_CAPACITY * SERVER_COUNT / oversubRatio / (8 * avg_cdf (cdfTable)) / SERVER_COUNT;
+  double requestRate = load * LEAF_SERVER_CAPACITY * SERVER_COUNT / oversubRatio / (8 * workload.GetAverageFlowSize ()) / SERVER_COUNT;
   NS_LOG_INFO ("Average request rate: " << requestRate << " per second");
 
-  NS_LOG_INFO ("Initialize random seed: " << randomSeed);
   if (randomSeed == 0)
     {
-      srand ((unsigned)time (NULL));
+      randomSeed = (unsigned)time (NULL);
+    }
+  NS_LOG_INFO ("Initialize random seed: " << randomSeed);
+  // Flow i of server s draws from its own substream of (seed, run)
+  workload.SetKey (randomSeed, RngSeedManager::GetRun ());
+  workload.SetHosts (SERVER_COUNT, LEAF_COUNT);
+  workload.SetRequestRate (requestRate);
+  workload.SetLaunchPeriod (START_TIME, FLOW_LAUNCH_END_TIME);
+  workload.SetNClasses (5);
+  workload.SetNThreads (workloadThreads);
+
+  std::vector<WorkloadFlow> flows;
+  // A schedule saved with other parameters is not loaded but regenerated
+  if (workloadFile.empty () || !workload.Load (workloadFile, flows))
+    {
+      flows = workload.Generate ();
+      if (!workloadFile.empty ())
+        {
+          NS_LOG_INFO ("Saving the flow schedule to " << workloadFile);
+          workload.Save (workloadFile, flows);
+        }
     }
   else
     {
-      srand (randomSeed);
+      NS_LOG_INFO ("Replaying the flow schedule of " << workloadFile);
     }
 
   NS_LOG_INFO ("Create applications");
@@ -440,11 +484,21 @@ int main (int argc, char *argv[])
   long flowCount = 0;
   long totalFlowSize = 0;
 
-  for (int fromLeafId = 0; fromLeafId < LEAF_COUNT; fromLeafId ++)
+  Ptr<FluidFlowManager> fluidManager;
+  if (fluidThreshold > 0)
     {
-      install_applications(fromLeafId, servers, requestRate, cdfTable, flowCount, totalFlowSize, SERVER_COUNT, LEAF_COUNT, START_TIME, END_TIME, FLOW_LAUNCH_END_TIME);
+      NS_LOG_INFO ("Simulating the flows larger than " << fluidThreshold << " bytes as fluid rates");
+      fluidManager = CreateObject<FluidFlowManager> ();
+      if (transportProt.compare ("DcTcp") == 0)
+        {
+          fluidManager->SetAttribute ("Mode", EnumValue (FluidFlowManager::DCTCP));
+        }
+      fluidManager->SetAttribute ("PacketSize", UintegerValue (PACKET_SIZE));
+      fluidManager->TraceConnectWithoutContext ("FlowCompleted", MakeCallback (&fluid_flow_completed));
     }
 
+  install_applications (flows, servers, flowCount, totalFlowSize, START_TIME, END_TIME, fluidManager, fluidThreshold);
+
   NS_LOG_INFO ("Total flow: " << flowCount);
 
   NS_LOG_INFO ("Actual average flow size: " << static_cast<double> (totalFlowSize) / flowCount);
@@ -463,13 +517,43 @@ int main (int argc, char *argv[])
   flowMonitorFilename << "Large_Scale_" <<id << "_" << LEAF_COUNT << "X" << SPINE_COUNT << "_" << aqmStr << "_"  << transportProt << "_" << load << ".xml";
 
 
+  SimulationCheckpoint checkpoint;
+  std::vector<uint32_t> targets;
+  if (checkpointTime > 0.0)
+    {
+      std::stringstream targetStream (branchTargets);
+      std::string target;
+      while (std::getline (targetStream, target, ','))
+        {
+          targets.push_back (atoi (target.c_str ()));
+          checkpoint.AddBranch (MakeBoundCallback (&set_persistent_marking_target, MicroSeconds (targets.back ())));
+        }
+      NS_LOG_INFO ("Checkpoint at " << checkpointTime << " s with " << targets.size () << " branches");
+      checkpoint.Schedule (Seconds (checkpointTime));
+    }
+
   NS_LOG_INFO ("Start simulation");
   Simulator::Stop (Seconds (END_TIME));
   Simulator::Run ();
 
+  if (!targets.empty ())
+    {
+      uint32_t branch = SimulationCheckpoint::GetBranch ();
+      NS_LOG_INFO ("Branch " << branch << " with persistent marking target " << targets[branch] << " us");
+      std::string name = flowMonitorFilename.str ();
+      flowMonitorFilename.str ("");
+      flowMonitorFilename << name.substr (0, name.size () - 4) << "_Target" << targets[branch] << ".xml";
+    }
+
   flowMonitor->SerializeToXmlFile(flowMonitorFilename.str (), true, true);
 
+  if (fluidManager != 0)
+    {
+      NS_LOG_INFO ("Fluid flows completed: " << fluidFlowCount << ", average FCT: "
+                   << (fluidFlowCount > 0 ? fluidFctSum / fluidFlowCount : 0) << " s");
+      fluidManager->Dispose ();
+    }
+
   Simulator::Destroy ();
-  free_cdf (cdfTable);
   NS_LOG_INFO ("Stop simulation");
 }
@@ -9,29 +9,16 @@
 #include "ns3/link-monitor-module.h"
 #include "ns3/gnuplot.h"
 
-extern "C"
-{
-#include "cdf.h"
-}
-
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("MQ");
 
 enum AQM {
     TCN,
-    ECNSharp
+    ECNSharp,
+    MQECNSharp
 };
 
-// Port from Traffic Generator // Acknowledged to https://github.com/HKUST-SING/TrafficGenerator/blob/master/src/common/common.c
-double
-poission_gen_interval(double avg_rate) {
-    if (avg_rate > 0)
-        return -logf(1.0 - (double)rand() / RAND_MAX) / avg_rate;
-    else
-        return 0;
-}
-
 uint32_t sendSize[3];
 void CheckThroughput (Ptr<PacketSink> sink, uint32_t senderID) {
     uint32_t totalRecvBytes = sink->GetTotalRx ();
@@ -41,12 +28,6 @@ void CheckThroughput (Ptr<PacketSink> sink, uint32_t senderID) {
     NS_LOG_UNCOND ("Flow: " << senderID << ", throughput (Gbps): " << currentPeriodRecvBytes * 8 / 0.02 / 1000000000);
 }
 
-template<typename T> T
-rand_range (T min, T max)
-{
-    return min + ((double)max - min) * rand () / RAND_MAX;
-}
-
 std::string
 GetFormatedStr (std::string id, std::string str, std::string terminal, AQM aqm)
 {
@@ -59,6 +40,10 @@ GetFormatedStr (std::string id, std::string str, std::string terminal, AQM aqm)
     {
         ss << "MQ_ECNSharp_" << id << "_" << str << "." << terminal;
     }
+    else if (aqm == MQECNSharp)
+    {
+        ss << "MQ_MQECNSharp_" << id << "_" << str << "." << terminal;
+    }
     return ss.str ();
 }
 
@@ -91,7 +76,7 @@ int main (int argc, char *argv[])
     CommandLine cmd;
     cmd.AddValue ("id", "The running ID", id);
     cmd.AddValue ("transportProt", "Transport protocol to use: Tcp, DcTcp", transportProt);
-    cmd.AddValue ("AQM", "AQM to use: TCN and ECNSharp", aqmStr);
+    cmd.AddValue ("AQM", "AQM to use: TCN, ECNSharp and MQECNSharp", aqmStr);
 
     cmd.AddValue ("endTime", "Simulation end time", endTime);
     cmd.AddValue ("randomSeed", "Random seed, 0 for random generated", randomSeed);
@@ -128,6 +113,10 @@ int main (int argc, char *argv[])
     {
         aqm = ECNSharp;
     }
+    else if (aqmStr.compare ("MQECNSharp") == 0)
+    {
+        aqm = MQECNSharp;
+    }
     else
     {
         return 0;
@@ -157,6 +146,13 @@ int main (int argc, char *argv[])
     Config::SetDefault ("ns3::ECNSharpQueueDisc::PersistentMarkingTarget", TimeValue (MicroSeconds (ECNSharpTarget)));
     Config::SetDefault ("ns3::ECNSharpQueueDisc::PersistentMarkingInterval", TimeValue (MicroSeconds (ECNSharpInterval)));
 
+    // Multi-queue ECNSharp Configuration
+    Config::SetDefault ("ns3::MQECNSharpQueueDisc::Mode", StringValue ("QUEUE_MODE_PACKETS"));
+    Config::SetDefault ("ns3::MQECNSharpQueueDisc::MaxPackets", UintegerValue (bufferSize));
+    Config::SetDefault ("ns3::MQECNSharpQueueDisc::InstantaneousMarkingThreshold", TimeValue (MicroSeconds (ECNSharpMarkingThreshold)));
+    Config::SetDefault ("ns3::MQECNSharpQueueDisc::PersistentMarkingTarget", TimeValue (MicroSeconds (ECNSharpTarget)));
+    Config::SetDefault ("ns3::MQECNSharpQueueDisc::PersistentMarkingInterval", TimeValue (MicroSeconds (ECNSharpInterval)));
+
     NS_LOG_INFO ("Setting up nodes.");
     NodeContainer senders;
     senders.Create (numOfSenders);
@@ -208,35 +204,51 @@ int main (int argc, char *argv[])
     NetDeviceContainer switchToRecvNetDeviceContainer = p2p.Install (switchToRecvNodeContainer);
 
 
-    Ptr<DWRRQueueDisc> dwrrQdisc = CreateObject<DWRRQueueDisc> ();
+    Ptr<QueueDisc> rootQdisc;
     Ptr<Ipv4SimplePacketFilter> filter = CreateObject<Ipv4SimplePacketFilter> ();
 
-    dwrrQdisc->AddPacketFilter (filter);
-
-    ObjectFactory innerQueueFactory;
-    if (aqm == TCN)
+    if (aqm == MQECNSharp)
     {
-        innerQueueFactory.SetTypeId ("ns3::TCNQueueDisc");
+        // The DWRR classes and their ECNSharp state in one queue disc
+        Ptr<MQECNSharpQueueDisc> mqQdisc = CreateObject<MQECNSharpQueueDisc> ();
+        mqQdisc->AddPacketFilter (filter);
+        mqQdisc->AddClass (0, 3000);
+        mqQdisc->AddClass (1, 1500);
+        mqQdisc->AddClass (2, 1500);
+        rootQdisc = mqQdisc;
     }
     else
     {
-        innerQueueFactory.SetTypeId ("ns3::ECNSharpQueueDisc");
-    }
+        Ptr<DWRRQueueDisc> dwrrQdisc = CreateObject<DWRRQueueDisc> ();
+
+        dwrrQdisc->AddPacketFilter (filter);
 
+        ObjectFactory innerQueueFactory;
+        if (aqm == TCN)
+        {
+            innerQueueFactory.SetTypeId ("ns3::TCNQueueDisc");
+        }
+        else
+        {
+            innerQueueFactory.SetTypeId ("ns3::ECNSharpQueueDisc");
+        }
 
-    Ptr<QueueDisc> queueDisc1 = innerQueueFactory.Create<QueueDisc> ();
-    Ptr<QueueDisc> queueDisc2 = innerQueueFactory.Create<QueueDisc> ();
-    Ptr<QueueDisc> queueDisc3 = innerQueueFactory.Create<QueueDisc> ();
 
-    dwrrQdisc->AddDWRRClass (queueDisc1, 0, 3000);
-    dwrrQdisc->AddDWRRClass (queueDisc2, 1, 1500);
-    dwrrQdisc->AddDWRRClass (queueDisc3, 2, 1500);
+        Ptr<QueueDisc> queueDisc1 = innerQueueFactory.Create<QueueDisc> ();
+        Ptr<QueueDisc> queueDisc2 = innerQueueFactory.Create<QueueDisc> ();
+        Ptr<QueueDisc> queueDisc3 = innerQueueFactory.Create<QueueDisc> ();
+
+        dwrrQdisc->AddDWRRClass (queueDisc1, 0, 3000);
+        dwrrQdisc->AddDWRRClass (queueDisc2, 1, 1500);
+        dwrrQdisc->AddDWRRClass (queueDisc3, 2, 1500);
+        rootQdisc = dwrrQdisc;
+    }
 
     Ptr<NetDevice> device = switchToRecvNetDeviceContainer.Get (0);
     Ptr<TrafficControlLayer> tcl = device->GetNode ()->GetObject<TrafficControlLayer> ();
 
-    dwrrQdisc->SetNetDevice (device);
-    tcl->SetRootQueueDiscOnDevice (device, dwrrQdisc);
+    rootQdisc->SetNetDevice (device);
+    tcl->SetRootQueueDiscOnDevice (device, rootQdisc);
 
     tc.SetRootQueueDisc ("ns3::PfifoFastQueueDisc", "Limit", UintegerValue (bufferSize));
     Ipv4InterfaceContainer switchToRecvIpv4Container = ipv4.Assign (switchToRecvNetDeviceContainer);
@@ -246,15 +258,14 @@ int main (int argc, char *argv[])
     Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
 
 
-    NS_LOG_INFO ("Initialize random seed: " << randomSeed);
     if (randomSeed == 0)
     {
-        srand ((unsigned)time (NULL));
-    }
-    else
-    {
-        srand (randomSeed);
+        randomSeed = (unsigned)time (NULL);
     }
+    NS_LOG_INFO ("Initialize random seed: " << randomSeed);
+    // Short flow i of sender s draws from its own substream of (seed, run)
+    WorkloadGenerator workload;
+    workload.SetKey (randomSeed, RngSeedManager::GetRun ());
 
     uint16_t basePort = 8080;
 
@@ -281,8 +292,10 @@ int main (int argc, char *argv[])
     NS_LOG_INFO ("Install 100 short TCP flows");
     for (uint32_t i = 0; i < 100; ++i)
     {
-        double startTime = rand_range (0.0, 0.4);
-        uint32_t tos = rand_range (0, 3);
+        double u[4];
+        workload.GetUniforms (2 + i % 2, i / 2, 0, u);
+        double startTime = u[0] * 0.4;
+        uint32_t tos = static_cast<uint32_t> (u[1] * 3);
         BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (switchToRecvIpv4Container.GetAddress (1), basePort));
         source.SetAttribute ("MaxBytes", UintegerValue (28000)); // 14kb
         source.SetAttribute ("SendSize", UintegerValue (1400));
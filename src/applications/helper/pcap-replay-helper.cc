@@ -0,0 +1,51 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pcap-replay-helper.h"
+#include "ns3/pcap-replay-application.h"
+#include "ns3/string.h"
+
+namespace ns3 {
+
+PcapReplayHelper::PcapReplayHelper (std::string fileName)
+{
+  m_factory.SetTypeId ("ns3::PcapReplayApplication");
+  m_factory.Set ("FileName", StringValue (fileName));
+}
+
+void
+PcapReplayHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+ApplicationContainer
+PcapReplayHelper::Install (Ptr<Node> node, NodeContainer hosts) const
+{
+  Ptr<PcapReplayApplication> app = m_factory.Create<PcapReplayApplication> ();
+  app->SetHosts (hosts);
+  node->AddApplication (app);
+
+  return ApplicationContainer (app);
+}
+
+ApplicationContainer
+PcapReplayHelper::Install (NodeContainer hosts) const
+{
+  return Install (hosts.Get (0), hosts);
+}
+
+} // namespace ns3
@@ -0,0 +1,78 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_REPLAY_HELPER_H
+#define PCAP_REPLAY_HELPER_H
+
+#include <string>
+#include "ns3/object-factory.h"
+#include "ns3/attribute.h"
+#include "ns3/node-container.h"
+#include "ns3/application-container.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ * \brief A helper to make it easier to instantiate an
+ * ns3::PcapReplayApplication which replays a pcap file between hosts.
+ */
+class PcapReplayHelper
+{
+public:
+  /**
+   * Create a PcapReplayHelper to make it easier to work with
+   * PcapReplayApplications
+   *
+   * \param fileName the pcap file to replay
+   */
+  PcapReplayHelper (std::string fileName);
+
+  /**
+   * Helper function used to set the underlying application attributes.
+   *
+   * \param name the name of the application attribute to set
+   * \param value the value of the application attribute to set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Install an ns3::PcapReplayApplication on the node, configured with
+   * all the attributes set with SetAttribute, which replays the file
+   * between the hosts.
+   *
+   * \param node The node on which the PcapReplayApplication will be installed.
+   * \param hosts The hosts the addresses of the trace are mapped onto.
+   * \returns Container of Ptr to the application installed.
+   */
+  ApplicationContainer Install (Ptr<Node> node, NodeContainer hosts) const;
+
+  /**
+   * Install an ns3::PcapReplayApplication on the first host, which
+   * replays the file between the hosts.
+   *
+   * \param hosts The hosts the addresses of the trace are mapped onto.
+   * \returns Container of Ptr to the application installed.
+   */
+  ApplicationContainer Install (NodeContainer hosts) const;
+
+private:
+  ObjectFactory m_factory; //!< Object factory.
+};
+
+} // namespace ns3
+
+#endif /* PCAP_REPLAY_HELPER_H */
@@ -0,0 +1,448 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "workload-generator.h"
+#include "ns3/core-config.h"
+#include "ns3/log.h"
+#include "ns3/fatal-error.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/callback.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WorkloadGenerator");
+
+const char WorkloadGenerator::MAGIC[8] = { 'N', 'S', '3', 'W', 'K', 'L', 'D', '\0' };
+
+namespace {
+
+/**
+ * Generate the flows of a range of hosts, in a thread of its own
+ */
+class WorkloadWorker
+{
+public:
+  /**
+   * \param generator the generator
+   * \param flows the flows of each host
+   * \param first the first host
+   * \param step the distance between two hosts of the worker
+   */
+  WorkloadWorker (const WorkloadGenerator *generator, std::vector<std::vector<WorkloadFlow> > *flows,
+                  uint32_t first, uint32_t step)
+    : m_generator (generator),
+      m_flows (flows),
+      m_first (first),
+      m_step (step)
+  {
+  }
+
+  /** Generate the hosts of the worker */
+  void Run (void)
+  {
+    for (uint32_t host = m_first; host < m_flows->size (); host += m_step)
+      {
+        (*m_flows)[host] = m_generator->GenerateHost (host);
+      }
+  }
+
+private:
+  const WorkloadGenerator *m_generator;                 //!< The generator
+  std::vector<std::vector<WorkloadFlow> > *m_flows;     //!< The flows of each host
+  uint32_t m_first;                                     //!< First host
+  uint32_t m_step;                                      //!< Distance between two hosts
+};
+
+} // anonymous namespace
+
+WorkloadGenerator::WorkloadGenerator ()
+  : m_minCdf (0),
+    m_maxCdf (1),
+    m_hostsPerLeaf (1),
+    m_nLeaves (1),
+    m_requestRate (0),
+    m_start (0),
+    m_end (0),
+    m_nClasses (1),
+    m_nThreads (1)
+{
+  NS_LOG_FUNCTION (this);
+  SetKey (RngSeedManager::GetSeed (), RngSeedManager::GetRun ());
+}
+
+void
+WorkloadGenerator::LoadCdf (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ifstream file (filename.c_str ());
+  if (!file.is_open ())
+    {
+      NS_FATAL_ERROR ("WorkloadGenerator::LoadCdf(): Can't open \"" << filename << "\"");
+    }
+  std::string line;
+  while (std::getline (file, line))
+    {
+      std::istringstream iss (line);
+      double value;
+      double cdf;
+      if (iss >> value >> cdf)
+        {
+          AddCdfEntry (value, cdf);
+        }
+    }
+}
+
+void
+WorkloadGenerator::AddCdfEntry (double value, double cdf)
+{
+  NS_LOG_FUNCTION (this << value << cdf);
+  m_cdf.push_back (std::make_pair (value, cdf));
+  m_minCdf = std::min (m_minCdf, cdf);
+  m_maxCdf = std::max (m_maxCdf, cdf);
+}
+
+double
+WorkloadGenerator::GetAverageFlowSize (void) const
+{
+  double avg = 0;
+  for (uint32_t i = 0; i < m_cdf.size (); ++i)
+    {
+      if (i == 0)
+        {
+          avg += m_cdf[i].first / 2 * m_cdf[i].second;
+        }
+      else
+        {
+          avg += (m_cdf[i].first + m_cdf[i - 1].first) / 2 * (m_cdf[i].second - m_cdf[i - 1].second);
+        }
+    }
+  return avg;
+}
+
+void
+WorkloadGenerator::SetHosts (uint32_t hostsPerLeaf, uint32_t nLeaves)
+{
+  NS_LOG_FUNCTION (this << hostsPerLeaf << nLeaves);
+  NS_ASSERT (hostsPerLeaf > 0 && nLeaves > 0);
+  NS_ASSERT_MSG (hostsPerLeaf * nLeaves > 1, "There must be a destination for every host");
+  m_hostsPerLeaf = hostsPerLeaf;
+  m_nLeaves = nLeaves;
+}
+
+void
+WorkloadGenerator::SetRequestRate (double rate)
+{
+  NS_LOG_FUNCTION (this << rate);
+  m_requestRate = rate;
+}
+
+void
+WorkloadGenerator::SetLaunchPeriod (double start, double end)
+{
+  NS_LOG_FUNCTION (this << start << end);
+  m_start = start;
+  m_end = end;
+}
+
+void
+WorkloadGenerator::SetNClasses (uint32_t nClasses)
+{
+  NS_LOG_FUNCTION (this << nClasses);
+  NS_ASSERT (nClasses > 0);
+  m_nClasses = nClasses;
+}
+
+void
+WorkloadGenerator::SetKey (uint32_t seed, uint64_t run)
+{
+  NS_LOG_FUNCTION (this << seed << run);
+  m_key[0] = seed;
+  m_key[1] = static_cast<uint32_t> (run) ^ static_cast<uint32_t> (run >> 32);
+}
+
+void
+WorkloadGenerator::SetNThreads (uint32_t nThreads)
+{
+  NS_LOG_FUNCTION (this << nThreads);
+  m_nThreads = std::max (nThreads, 1U);
+}
+
+void
+WorkloadGenerator::Philox (uint32_t counter[4], const uint32_t key[2])
+{
+  uint32_t k0 = key[0];
+  uint32_t k1 = key[1];
+  for (uint32_t round = 0; round < 10; ++round)
+    {
+      uint64_t p0 = static_cast<uint64_t> (0xD2511F53) * counter[0];
+      uint64_t p1 = static_cast<uint64_t> (0xCD9E8D57) * counter[2];
+      uint32_t c1 = counter[1];
+      uint32_t c3 = counter[3];
+      counter[0] = static_cast<uint32_t> (p1 >> 32) ^ c1 ^ k0;
+      counter[1] = static_cast<uint32_t> (p1);
+      counter[2] = static_cast<uint32_t> (p0 >> 32) ^ c3 ^ k1;
+      counter[3] = static_cast<uint32_t> (p0);
+      k0 += 0x9E3779B9;
+      k1 += 0xBB67AE85;
+    }
+}
+
+void
+WorkloadGenerator::GetUniforms (uint32_t host, uint32_t index, uint32_t stream, double u[4]) const
+{
+  uint32_t block[4] = { host, index, stream, 0 };
+  Philox (block, m_key);
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      // Never 0 nor 1
+      u[i] = (block[i] + 0.5) / 4294967296.0;
+    }
+}
+
+uint64_t
+WorkloadGenerator::GetCdfHash (void) const
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (uint32_t i = 0; i < m_cdf.size (); ++i)
+    {
+      double point[2] = { m_cdf[i].first, m_cdf[i].second };
+      const unsigned char *bytes = reinterpret_cast<const unsigned char *> (point);
+      for (uint32_t j = 0; j < sizeof (point); ++j)
+        {
+          hash = (hash ^ bytes[j]) * 0x100000001b3ULL;
+        }
+    }
+  return hash;
+}
+
+WorkloadGenerator::Parameters
+WorkloadGenerator::GetParameters (void) const
+{
+  Parameters parameters;
+  std::memset (&parameters, 0, sizeof (parameters));
+  parameters.key[0] = m_key[0];
+  parameters.key[1] = m_key[1];
+  parameters.hostsPerLeaf = m_hostsPerLeaf;
+  parameters.nLeaves = m_nLeaves;
+  parameters.nClasses = m_nClasses;
+  parameters.requestRate = m_requestRate;
+  parameters.start = m_start;
+  parameters.end = m_end;
+  parameters.cdfHash = GetCdfHash ();
+  return parameters;
+}
+
+uint32_t
+WorkloadGenerator::GetFlowSize (double u) const
+{
+  NS_ASSERT_MSG (!m_cdf.empty (), "No flow size distribution");
+  double x = m_minCdf + u * (m_maxCdf - m_minCdf);
+  double x1 = 0;
+  double y1 = 0;
+  for (uint32_t i = 0; i < m_cdf.size (); ++i)
+    {
+      double x2 = m_cdf[i].second;
+      double y2 = m_cdf[i].first;
+      if (x <= x2)
+        {
+          if (x1 == x2)
+            {
+              return static_cast<uint32_t> ((y1 + y2) / 2);
+            }
+          return static_cast<uint32_t> (y1 + (x - x1) * (y2 - y1) / (x2 - x1));
+        }
+      x1 = x2;
+      y1 = y2;
+    }
+  return static_cast<uint32_t> (m_cdf.back ().first);
+}
+
+std::vector<WorkloadFlow>
+WorkloadGenerator::GenerateHost (uint32_t host) const
+{
+  std::vector<WorkloadFlow> flows;
+  if (m_requestRate <= 0)
+    {
+      return flows;
+    }
+
+  uint32_t leafStart = host / m_hostsPerLeaf * m_hostsPerLeaf;
+  uint32_t nHosts = m_hostsPerLeaf * m_nLeaves;
+  // The hosts of the other leaves, or the other hosts with a single leaf
+  uint32_t localStart = m_nLeaves > 1 ? leafStart : host;
+  uint32_t nLocal = m_nLeaves > 1 ? m_hostsPerLeaf : 1;
+
+  double startTime = m_start;
+  for (uint32_t index = 0; ; ++index)
+    {
+      double u[4];
+      GetUniforms (host, index, 0, u);
+      startTime += -std::log (1.0 - u[0]) / m_requestRate;
+      if (startTime >= m_end)
+        {
+          break;
+        }
+
+      WorkloadFlow flow;
+      flow.startTime = startTime;
+      flow.src = host;
+      flow.dst = std::min (static_cast<uint32_t> (u[1] * (nHosts - nLocal)), nHosts - nLocal - 1);
+      if (flow.dst >= localStart)
+        {
+          flow.dst += nLocal;
+        }
+      flow.index = index;
+      flow.size = GetFlowSize (u[2]);
+      flow.tos = std::min (static_cast<uint32_t> (u[3] * m_nClasses), m_nClasses - 1);
+      flow.reserved = 0;
+      flows.push_back (flow);
+    }
+  return flows;
+}
+
+std::vector<WorkloadFlow>
+WorkloadGenerator::Generate (void) const
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t nHosts = m_hostsPerLeaf * m_nLeaves;
+  std::vector<std::vector<WorkloadFlow> > hosts (nHosts);
+  uint32_t nThreads = std::min (m_nThreads, nHosts);
+
+  std::vector<WorkloadWorker> workers;
+  for (uint32_t i = 0; i < nThreads; ++i)
+    {
+      workers.push_back (WorkloadWorker (this, &hosts, i, nThreads));
+    }
+#ifdef HAVE_PTHREAD_H
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < nThreads; ++i)
+    {
+      threads.push_back (Create<SystemThread> (MakeCallback (&WorkloadWorker::Run, &workers[i])));
+      threads.back ()->Start ();
+    }
+  workers[0].Run ();
+  for (uint32_t i = 0; i < threads.size (); ++i)
+    {
+      threads[i]->Join ();
+    }
+#else
+  for (uint32_t i = 0; i < nThreads; ++i)
+    {
+      workers[i].Run ();
+    }
+#endif
+
+  std::vector<WorkloadFlow> flows;
+  for (uint32_t host = 0; host < nHosts; ++host)
+    {
+      flows.insert (flows.end (), hosts[host].begin (), hosts[host].end ());
+    }
+  NS_LOG_INFO ("Generated " << flows.size () << " flows with " << nThreads << " threads");
+  return flows;
+}
+
+void
+WorkloadGenerator::Save (std::string filename, const std::vector<WorkloadFlow> &flows) const
+{
+  NS_LOG_FUNCTION (this << filename << flows.size ());
+  std::ofstream file (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file.is_open ())
+    {
+      NS_FATAL_ERROR ("WorkloadGenerator::Save(): Can't open \"" << filename << "\"");
+    }
+  uint32_t version = VERSION;
+  uint32_t recordSize = sizeof (WorkloadFlow);
+  uint64_t nFlows = flows.size ();
+  Parameters parameters = GetParameters ();
+  file.write (MAGIC, sizeof (MAGIC));
+  file.write (reinterpret_cast<const char *> (&version), sizeof (version));
+  file.write (reinterpret_cast<const char *> (&recordSize), sizeof (recordSize));
+  file.write (reinterpret_cast<const char *> (&nFlows), sizeof (nFlows));
+  file.write (reinterpret_cast<const char *> (&parameters), sizeof (parameters));
+  if (nFlows > 0)
+    {
+      file.write (reinterpret_cast<const char *> (&flows[0]), nFlows * sizeof (WorkloadFlow));
+    }
+  if (!file)
+    {
+      NS_FATAL_ERROR ("WorkloadGenerator::Save(): Can't write \"" << filename << "\"");
+    }
+}
+
+bool
+WorkloadGenerator::Load (std::string filename, std::vector<WorkloadFlow> &flows) const
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ifstream file (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!file.is_open ())
+    {
+      return false;
+    }
+  char magic[8];
+  uint32_t version;
+  uint32_t recordSize;
+  uint64_t nFlows;
+  Parameters parameters;
+  file.read (magic, sizeof (magic));
+  file.read (reinterpret_cast<char *> (&version), sizeof (version));
+  file.read (reinterpret_cast<char *> (&recordSize), sizeof (recordSize));
+  file.read (reinterpret_cast<char *> (&nFlows), sizeof (nFlows));
+  if (!file || std::memcmp (magic, MAGIC, sizeof (MAGIC)) != 0)
+    {
+      NS_FATAL_ERROR ("WorkloadGenerator::Load(): \"" << filename << "\" is not a workload file");
+    }
+  if (version != VERSION || recordSize != sizeof (WorkloadFlow))
+    {
+      NS_LOG_WARN ("\"" << filename << "\" has version " << version << ", expected " << VERSION);
+      return false;
+    }
+  file.read (reinterpret_cast<char *> (&parameters), sizeof (parameters));
+  Parameters expected = GetParameters ();
+  if (!file || std::memcmp (&parameters, &expected, sizeof (parameters)) != 0)
+    {
+      NS_LOG_WARN ("\"" << filename << "\" was generated with other parameters");
+      return false;
+    }
+  flows.resize (nFlows);
+  if (nFlows > 0)
+    {
+      file.read (reinterpret_cast<char *> (&flows[0]), nFlows * sizeof (WorkloadFlow));
+    }
+  if (!file)
+    {
+      NS_FATAL_ERROR ("WorkloadGenerator::Load(): \"" << filename << "\" is truncated");
+    }
+  uint32_t nHosts = m_hostsPerLeaf * m_nLeaves;
+  for (uint64_t i = 0; i < nFlows; ++i)
+    {
+      if (flows[i].src >= nHosts || flows[i].dst >= nHosts || flows[i].tos >= m_nClasses)
+        {
+          NS_FATAL_ERROR ("WorkloadGenerator::Load(): flow " << i << " of \"" << filename << "\" is out of range");
+        }
+    }
+  return true;
+}
+
+} // namespace ns3
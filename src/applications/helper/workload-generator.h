@@ -0,0 +1,226 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WORKLOAD_GENERATOR_H
+#define WORKLOAD_GENERATOR_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ * One flow of a workload, stored verbatim in host byte order in the
+ * workload files.
+ */
+struct WorkloadFlow
+{
+  double startTime;     //!< Start time in seconds
+  uint32_t src;         //!< Index of the source host
+  uint32_t dst;         //!< Index of the destination host
+  uint32_t index;       //!< Index of the flow among the flows of its source
+  uint32_t size;        //!< Size in bytes
+  uint32_t tos;         //!< Class of the flow, from 0 to the number of classes - 1
+  uint32_t reserved;    //!< Padding, always 0
+};
+
+/**
+ * \ingroup applications
+ *
+ * \brief Generate a reproducible schedule of flows between hosts.
+ *
+ * Each host starts flows as a Poisson process of the request rate between
+ * the start and the end of the launch period. The size of a flow is drawn
+ * from an empirical CDF (the "value cdf" line format of the traffic
+ * generator CDF files), its class uniformly among the classes and its
+ * destination uniformly among the hosts of the other leaves (or among the
+ * other hosts when there is a single leaf).
+ *
+ * The draws of flow \c i of host \c h only depend on the key and on the
+ * pair (h, i): they come from the Philox4x32-10 counter-based generator,
+ * whose counter is (h, i, stream, 0) and whose key is the ns-3 seed and
+ * run number by default. The schedule of a host does not depend on the
+ * other hosts nor on the order in which the applications are installed,
+ * so the hosts can be generated by several threads and the schedule is
+ * the same for any number of threads.
+ *
+ * The schedule can be saved to a binary file and loaded to replay the
+ * same workload across runs. The file starts with a 80 bytes header:
+ * the magic "NS3WKLD", a null byte, the version, the size of a record,
+ * both as 32 bits integers, the number of flows as a 64 bits integer,
+ * then the parameters the schedule was generated with: the key, the hosts
+ * per leaf, the number of leaves and of classes, 4 bytes of padding, the
+ * request rate and the launch period as doubles and the FNV-1a hash of
+ * the flow size distribution. A file generated with other parameters is
+ * not loaded, so a stale schedule is regenerated instead of replayed.
+ */
+class WorkloadGenerator
+{
+public:
+  WorkloadGenerator ();
+
+  /**
+   * Load the flow size distribution
+   * \param filename a file of "value cdf" lines with increasing values
+   */
+  void LoadCdf (std::string filename);
+
+  /**
+   * Add a point of the flow size distribution
+   * \param value the flow size in bytes
+   * \param cdf the probability of a flow of this size or smaller
+   */
+  void AddCdfEntry (double value, double cdf);
+
+  /**
+   * \return the average flow size of the distribution in bytes
+   */
+  double GetAverageFlowSize (void) const;
+
+  /**
+   * \param hostsPerLeaf the number of hosts under each leaf
+   * \param nLeaves the number of leaves; host h is under leaf h / hostsPerLeaf
+   */
+  void SetHosts (uint32_t hostsPerLeaf, uint32_t nLeaves);
+
+  /**
+   * \param rate the average number of flows started by each host per second
+   */
+  void SetRequestRate (double rate);
+
+  /**
+   * \param start the start of the launch period in seconds
+   * \param end no flow starts at or after this time in seconds
+   */
+  void SetLaunchPeriod (double start, double end);
+
+  /**
+   * \param nClasses the number of classes of the flows
+   */
+  void SetNClasses (uint32_t nClasses);
+
+  /**
+   * Set the key of the generator, RngSeedManager::GetSeed () and
+   * RngSeedManager::GetRun () by default
+   * \param seed the seed
+   * \param run the run number
+   */
+  void SetKey (uint32_t seed, uint64_t run);
+
+  /**
+   * \param nThreads the number of threads generating the hosts
+   */
+  void SetNThreads (uint32_t nThreads);
+
+  /**
+   * \return the flows of all the hosts, by source host then start time
+   */
+  std::vector<WorkloadFlow> Generate (void) const;
+
+  /**
+   * \param host a host
+   * \return the flows of the host, by start time
+   */
+  std::vector<WorkloadFlow> GenerateHost (uint32_t host) const;
+
+  /**
+   * Draw four uniform values in (0, 1) for a counter
+   * \param host the first word of the counter
+   * \param index the second word of the counter
+   * \param stream the third word of the counter, 0 is used by the flows
+   * \param u the four values
+   */
+  void GetUniforms (uint32_t host, uint32_t index, uint32_t stream, double u[4]) const;
+
+  /**
+   * Write a workload file with the parameters of the generator
+   * \param filename the file name
+   * \param flows the flows
+   */
+  void Save (std::string filename, const std::vector<WorkloadFlow> &flows) const;
+
+  /**
+   * Read a workload file generated with the parameters of the generator
+   * \param filename the file name
+   * \param flows the flows read
+   * \return false if the file cannot be opened or was generated with other
+   * parameters
+   */
+  bool Load (std::string filename, std::vector<WorkloadFlow> &flows) const;
+
+  /**
+   * The Philox4x32-10 block function
+   * \param counter the counter, replaced by the random block
+   * \param key the key
+   */
+  static void Philox (uint32_t counter[4], const uint32_t key[2]);
+
+private:
+  /**
+   * \param u a uniform value in (0, 1)
+   * \return the flow size for this value
+   */
+  uint32_t GetFlowSize (double u) const;
+
+  /**
+   * \return the FNV-1a hash of the (value, cdf) points
+   */
+  uint64_t GetCdfHash (void) const;
+
+  /**
+   * The parameters of the generator, as stored after the header of the
+   * workload files
+   */
+  struct Parameters
+  {
+    uint32_t key[2];            //!< Philox key
+    uint32_t hostsPerLeaf;      //!< Hosts under each leaf
+    uint32_t nLeaves;           //!< Number of leaves
+    uint32_t nClasses;          //!< Number of classes
+    uint32_t reserved;          //!< Padding, always 0
+    double requestRate;         //!< Flows per second per host
+    double start;               //!< Start of the launch period
+    double end;                 //!< End of the launch period
+    uint64_t cdfHash;           //!< Hash of the flow size distribution
+  };
+
+  /**
+   * \return the parameters of the generator
+   */
+  Parameters GetParameters (void) const;
+
+  static const char MAGIC[8];           //!< Magic of the workload files
+  static const uint32_t VERSION = 2;    //!< Version of the workload files
+
+  std::vector<std::pair<double, double> > m_cdf;  //!< (value, cdf) points
+  double m_minCdf;                      //!< Smallest cdf
+  double m_maxCdf;                      //!< Largest cdf
+  uint32_t m_hostsPerLeaf;              //!< Hosts under each leaf
+  uint32_t m_nLeaves;                   //!< Number of leaves
+  double m_requestRate;                 //!< Flows per second per host
+  double m_start;                       //!< Start of the launch period
+  double m_end;                         //!< End of the launch period
+  uint32_t m_nClasses;                  //!< Number of classes
+  uint32_t m_key[2];                    //!< Philox key
+  uint32_t m_nThreads;                  //!< Generating threads
+};
+
+} // namespace ns3
+
+#endif /* WORKLOAD_GENERATOR_H */
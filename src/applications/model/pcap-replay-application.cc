@@ -0,0 +1,609 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/node.h"
+#include "ns3/socket.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/string.h"
+#include "ns3/enum.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/hash.h"
+#include "ns3/nstime.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/ipv4.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/ipv4-raw-socket-factory.h"
+#include "pcap-replay-application.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapReplayApplication");
+
+NS_OBJECT_ENSURE_REGISTERED (PcapReplayApplication);
+
+namespace {
+
+const uint8_t TCP_PROTOCOL = 6;         //!< TCP protocol number
+const uint8_t UDP_PROTOCOL = 17;        //!< UDP protocol number
+const uint8_t TCP_FIN = 0x01;           //!< TCP FIN flag
+const uint8_t TCP_RST = 0x04;           //!< TCP RST flag
+
+/**
+ * \param p two bytes in network order
+ * \return their value
+ */
+inline uint16_t
+Read16 (const uint8_t *p)
+{
+  return (p[0] << 8) | p[1];
+}
+
+/**
+ * \param p four bytes in network order
+ * \return their value
+ */
+inline uint32_t
+Read32 (const uint8_t *p)
+{
+  return (uint32_t (p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+} // anonymous namespace
+
+TypeId
+PcapReplayApplication::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PcapReplayApplication")
+    .SetParent<Application> ()
+    .SetGroupName("Applications")
+    .AddConstructor<PcapReplayApplication> ()
+    .AddAttribute ("FileName", "The pcap file to replay.",
+                   StringValue (""),
+                   MakeStringAccessor (&PcapReplayApplication::m_fileName),
+                   MakeStringChecker ())
+    .AddAttribute ("Mode", "Whether the packets are injected or their payloads sent through sockets.",
+                   EnumValue (PACKET),
+                   MakeEnumAccessor (&PcapReplayApplication::m_mode),
+                   MakeEnumChecker (PACKET, "Packet",
+                                    FLOW, "Flow"))
+    .AddAttribute ("TimeScale",
+                   "The factor applied to the times of the trace, "
+                   "0.5 replays the trace twice as fast.",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&PcapReplayApplication::m_timeScale),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("BatchSize", "The number of records read at a time.",
+                   UintegerValue (256),
+                   MakeUintegerAccessor (&PcapReplayApplication::m_batchSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("RemotePort", "The destination port of the flows in the Flow mode.",
+                   UintegerValue (9),
+                   MakeUintegerAccessor (&PcapReplayApplication::m_remotePort),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("Protocol", "The IP protocol of the packets injected in the Packet mode.",
+                   UintegerValue (253),
+                   MakeUintegerAccessor (&PcapReplayApplication::m_protocol),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("MaxPackets",
+                   "The number of records of the file to replay. "
+                   "The value zero means that there is no limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapReplayApplication::m_maxPackets),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("FlowTimeout",
+                   "The time without packets after which a flow of the Flow mode is closed. "
+                   "The value zero means that the flows are only closed by a FIN or a RST.",
+                   TimeValue (Seconds (60)),
+                   MakeTimeAccessor (&PcapReplayApplication::m_flowTimeout),
+                   MakeTimeChecker ())
+    .AddTraceSource ("Tx", "A packet is sent",
+                     MakeTraceSourceAccessor (&PcapReplayApplication::m_txTrace),
+                     "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+PcapReplayApplication::PcapReplayApplication ()
+  : m_next (0),
+    m_firstTimestamp (0),
+    m_records (0),
+    m_replayed (0),
+    m_skipped (0),
+    m_nFlows (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapReplayApplication::~PcapReplayApplication ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PcapReplayApplication::SetHosts (NodeContainer hosts)
+{
+  NS_LOG_FUNCTION (this);
+  m_hosts = hosts;
+}
+
+void
+PcapReplayApplication::MapAddress (Ipv4Address address, uint32_t host)
+{
+  NS_LOG_FUNCTION (this << address << host);
+  NS_ASSERT (host < m_hosts.GetN ());
+  m_hostOf[address.Get ()] = host;
+}
+
+uint32_t
+PcapReplayApplication::GetHost (Ipv4Address address)
+{
+  NS_ASSERT (m_hosts.GetN () > 0);
+  uint32_t key = address.Get ();
+  std::map<uint32_t, uint32_t>::const_iterator i = m_hostOf.find (key);
+  if (i != m_hostOf.end ())
+    {
+      return i->second;
+    }
+  uint8_t buf[4];
+  address.Serialize (buf);
+  uint32_t host = Hash32 (reinterpret_cast<const char *> (buf), sizeof (buf)) % m_hosts.GetN ();
+  m_hostOf[key] = host;
+  return host;
+}
+
+uint64_t
+PcapReplayApplication::GetReplayedPackets (void) const
+{
+  return m_replayed;
+}
+
+uint64_t
+PcapReplayApplication::GetSkippedPackets (void) const
+{
+  return m_skipped;
+}
+
+uint32_t
+PcapReplayApplication::GetNFlows (void) const
+{
+  return m_nFlows;
+}
+
+void
+PcapReplayApplication::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_replayEvent.Cancel ();
+  m_expireEvent.Cancel ();
+  m_reader.Close ();
+  m_batch.clear ();
+  m_flowOf.clear ();
+  m_flows.clear ();
+  m_rawSockets.clear ();
+  m_hosts = NodeContainer ();
+  // chain up
+  Application::DoDispose ();
+}
+
+void
+PcapReplayApplication::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (m_hosts.GetN () == 0, "PcapReplayApplication has no host");
+  m_addresses.clear ();
+  for (uint32_t i = 0; i < m_hosts.GetN (); ++i)
+    {
+      Ptr<Ipv4> ipv4 = m_hosts.Get (i)->GetObject<Ipv4> ();
+      NS_ABORT_MSG_IF (ipv4 == 0 || ipv4->GetNInterfaces () < 2,
+                       "PcapReplayApplication host " << i << " has no IPv4 interface");
+      m_addresses.push_back (ipv4->GetAddress (1, 0).GetLocal ());
+    }
+  m_rawSockets.resize (m_hosts.GetN ());
+
+  NS_ABORT_MSG_UNLESS (m_reader.Open (m_fileName), "Cannot read the pcap file " << m_fileName);
+  m_records = 0;
+  m_startTime = Simulator::Now ();
+  if (ReadBatch ())
+    {
+      m_firstTimestamp = m_batch[0].timestamp;
+      ScheduleNext ();
+    }
+}
+
+void
+PcapReplayApplication::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_replayEvent.Cancel ();
+  m_expireEvent.Cancel ();
+  m_reader.Close ();
+  m_batch.clear ();
+  m_next = 0;
+  for (std::map<FlowKey, Flow>::iterator i = m_flows.begin (); i != m_flows.end (); ++i)
+    {
+      i->second.socket->Close ();
+    }
+  m_flowOf.clear ();
+  m_flows.clear ();
+}
+
+bool
+PcapReplayApplication::ReadBatch (void)
+{
+  m_batch.clear ();
+  m_next = 0;
+  PcapMmapReader::Record record;
+  TracePacket packet;
+  while (m_batch.size () < m_batchSize
+         && (m_maxPackets == 0 || m_records < m_maxPackets)
+         && m_reader.Next (record))
+    {
+      m_records++;
+      if (Parse (record, packet))
+        {
+          m_batch.push_back (packet);
+        }
+      else
+        {
+          m_skipped++;
+        }
+    }
+  NS_LOG_LOGIC ("read " << m_batch.size () << " packets");
+  return !m_batch.empty ();
+}
+
+bool
+PcapReplayApplication::Parse (const PcapMmapReader::Record &record, TracePacket &packet) const
+{
+  const uint8_t *data = record.data;
+  uint32_t offset;
+  uint16_t type;
+  switch (m_reader.GetDataLinkType ())
+    {
+    case 1: // Ethernet
+      if (record.inclLen < 14)
+        {
+          return false;
+        }
+      offset = 12;
+      type = Read16 (data + offset);
+      while ((type == 0x8100 || type == 0x88a8) && record.inclLen >= offset + 6)
+        {
+          offset += 4;
+          type = Read16 (data + offset);
+        }
+      offset += 2;
+      if (type != 0x0800)
+        {
+          return false;
+        }
+      break;
+    case 9: // PPP, with or without the HDLC address and control
+      offset = record.inclLen >= 2 && data[0] == 0xff && data[1] == 0x03 ? 2 : 0;
+      if (record.inclLen < offset + 2 || Read16 (data + offset) != 0x0021)
+        {
+          return false;
+        }
+      offset += 2;
+      break;
+    case 113: // Linux cooked capture
+      if (record.inclLen < 16 || Read16 (data + 14) != 0x0800)
+        {
+          return false;
+        }
+      offset = 16;
+      break;
+    case 12: // Raw IP on some systems
+    case 101: // Raw IP
+      offset = 0;
+      break;
+    default:
+      return false;
+    }
+
+  if (record.inclLen < offset + 20 || (data[offset] >> 4) != 4)
+    {
+      return false;
+    }
+  const uint8_t *ip = data + offset;
+  uint32_t captured = record.inclLen - offset;
+  uint32_t headerLength = (ip[0] & 0x0f) * 4;
+  if (headerLength < 20)
+    {
+      return false;
+    }
+  uint32_t ipLength = Read16 (ip + 2);
+  if (ipLength == 0)
+    {
+      // segmentation offload captures
+      ipLength = std::min (record.origLen - offset, uint32_t (0xffff));
+    }
+  packet.timestamp = record.timestamp;
+  packet.tos = ip[1];
+  packet.ipLength = ipLength;
+  packet.protocol = ip[9];
+  packet.src = Read32 (ip + 12);
+  packet.dst = Read32 (ip + 16);
+  packet.srcPort = 0;
+  packet.dstPort = 0;
+  packet.tcpFlags = 0;
+  uint32_t transportLength = ipLength > headerLength ? ipLength - headerLength : 0;
+  uint32_t transportHeader = 0;
+  bool firstFragment = (Read16 (ip + 6) & 0x1fff) == 0;
+  if (firstFragment && captured >= headerLength + 4
+      && (packet.protocol == TCP_PROTOCOL || packet.protocol == UDP_PROTOCOL))
+    {
+      packet.srcPort = Read16 (ip + headerLength);
+      packet.dstPort = Read16 (ip + headerLength + 2);
+      transportHeader = 8;
+      if (packet.protocol == TCP_PROTOCOL)
+        {
+          transportHeader = 20;
+          if (captured >= headerLength + 14)
+            {
+              transportHeader = (ip[headerLength + 12] >> 4) * 4;
+              packet.tcpFlags = ip[headerLength + 13];
+            }
+        }
+    }
+  packet.payload = transportLength > transportHeader ? transportLength - transportHeader : 0;
+  return true;
+}
+
+void
+PcapReplayApplication::ScheduleNext (void)
+{
+  const TracePacket &packet = m_batch[m_next];
+  Time at = m_startTime;
+  if (packet.timestamp > m_firstTimestamp)
+    {
+      at += NanoSeconds (static_cast<int64_t> ((packet.timestamp - m_firstTimestamp) * m_timeScale));
+    }
+  m_replayEvent = Simulator::Schedule (std::max (at - Simulator::Now (), Time (0)),
+                                       &PcapReplayApplication::ReplayDue, this);
+}
+
+void
+PcapReplayApplication::ReplayDue (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  for (;;)
+    {
+      if (m_next == m_batch.size () && !ReadBatch ())
+        {
+          NS_LOG_LOGIC ("end of the trace");
+          return;
+        }
+      const TracePacket &packet = m_batch[m_next];
+      if (packet.timestamp > m_firstTimestamp
+          && m_startTime + NanoSeconds (static_cast<int64_t> ((packet.timestamp - m_firstTimestamp) * m_timeScale)) > now)
+        {
+          break;
+        }
+      m_next++;
+      Replay (packet);
+    }
+  ScheduleNext ();
+}
+
+void
+PcapReplayApplication::Replay (const TracePacket &packet)
+{
+  uint32_t src = GetHost (Ipv4Address (packet.src));
+  uint32_t dst = GetHost (Ipv4Address (packet.dst));
+  if (src == dst)
+    {
+      if (m_hosts.GetN () == 1)
+        {
+          m_skipped++;
+          return;
+        }
+      dst = (dst + 1) % m_hosts.GetN ();
+    }
+  if (m_mode == PACKET)
+    {
+      SendPacket (packet, src, dst);
+    }
+  else
+    {
+      SendFlow (packet, src, dst);
+    }
+}
+
+void
+PcapReplayApplication::SendPacket (const TracePacket &packet, uint32_t src, uint32_t dst)
+{
+  Ptr<Socket> socket = m_rawSockets[src];
+  if (socket == 0)
+    {
+      socket = Socket::CreateSocket (m_hosts.Get (src), Ipv4RawSocketFactory::GetTypeId ());
+      socket->SetAttribute ("Protocol", UintegerValue (m_protocol));
+      socket->ShutdownRecv ();
+      m_rawSockets[src] = socket;
+    }
+  Ptr<Packet> p = Create<Packet> (packet.ipLength > 20 ? packet.ipLength - 20 : 0);
+  SocketIpTosTag tosTag;
+  tosTag.SetTos (packet.tos);
+  p->AddPacketTag (tosTag);
+  m_txTrace (p);
+  if (socket->SendTo (p, 0, InetSocketAddress (m_addresses[dst], 0)) >= 0)
+    {
+      m_replayed++;
+    }
+  else
+    {
+      m_skipped++;
+    }
+}
+
+void
+PcapReplayApplication::SendFlow (const TracePacket &packet, uint32_t src, uint32_t dst)
+{
+  if (packet.protocol != TCP_PROTOCOL && packet.protocol != UDP_PROTOCOL)
+    {
+      m_skipped++;
+      return;
+    }
+  FlowKey key (std::make_pair (packet.src, packet.dst),
+               std::make_pair ((uint32_t (packet.srcPort) << 16) | packet.dstPort, uint32_t (packet.protocol)));
+  std::map<FlowKey, Flow>::iterator i = m_flows.find (key);
+  if (i == m_flows.end ())
+    {
+      if (packet.protocol == TCP_PROTOCOL && packet.payload == 0)
+        {
+          // handshake, acknowledgment or end of a flow without data
+          m_skipped++;
+          return;
+        }
+      Flow flow;
+      flow.key = key;
+      flow.pending = 0;
+      flow.closing = false;
+      TypeId tid = packet.protocol == TCP_PROTOCOL ? TcpSocketFactory::GetTypeId () : UdpSocketFactory::GetTypeId ();
+      flow.socket = Socket::CreateSocket (m_hosts.Get (src), tid);
+      if (flow.socket->Bind () == -1
+          || flow.socket->Connect (InetSocketAddress (m_addresses[dst], m_remotePort)) == -1)
+        {
+          // no ephemeral port or no route to the destination host
+          NS_LOG_WARN ("cannot open a flow from host " << src << " to host " << dst
+                       << ": " << flow.socket->GetErrno ());
+          flow.socket->Close ();
+          m_skipped++;
+          return;
+        }
+      flow.socket->ShutdownRecv ();
+      i = m_flows.insert (std::make_pair (key, flow)).first;
+      if (packet.protocol == TCP_PROTOCOL)
+        {
+          flow.socket->SetSendCallback (MakeCallback (&PcapReplayApplication::DataSend, this));
+          m_flowOf[flow.socket] = &i->second;
+        }
+      m_nFlows++;
+      NS_LOG_LOGIC ("flow " << m_nFlows << " from host " << src << " to host " << dst);
+      if (!m_flowTimeout.IsZero () && !m_expireEvent.IsRunning ())
+        {
+          m_expireEvent = Simulator::Schedule (m_flowTimeout, &PcapReplayApplication::ExpireFlows, this);
+        }
+    }
+  Flow &flow = i->second;
+  flow.lastActivity = Simulator::Now ();
+  if (packet.protocol == UDP_PROTOCOL)
+    {
+      Ptr<Packet> p = Create<Packet> (packet.payload);
+      SocketIpTosTag tosTag;
+      tosTag.SetTos (packet.tos);
+      p->AddPacketTag (tosTag);
+      m_txTrace (p);
+      if (flow.socket->Send (p) >= 0)
+        {
+          m_replayed++;
+        }
+      else
+        {
+          m_skipped++;
+        }
+      return;
+    }
+  m_replayed++;
+  flow.pending += packet.payload;
+  if (packet.tcpFlags & (TCP_FIN | TCP_RST))
+    {
+      flow.closing = true;
+    }
+  SendPending (flow);
+}
+
+void
+PcapReplayApplication::SendPending (Flow &flow)
+{
+  while (flow.pending > 0)
+    {
+      uint32_t size = std::min (flow.pending, flow.socket->GetTxAvailable ());
+      if (size == 0)
+        {
+          // wait for DataSend
+          break;
+        }
+      Ptr<Packet> p = Create<Packet> (size);
+      m_txTrace (p);
+      int sent = flow.socket->Send (p);
+      if (sent <= 0)
+        {
+          break;
+        }
+      flow.pending -= sent;
+    }
+  if (flow.pending == 0 && flow.closing)
+    {
+      // the socket sends its buffer before the FIN; a new flow with the
+      // same 5-tuple gets a new socket
+      CloseFlow (flow);
+    }
+}
+
+void
+PcapReplayApplication::CloseFlow (Flow &flow)
+{
+  NS_LOG_FUNCTION (this << flow.socket);
+  Ptr<Socket> socket = flow.socket;
+  socket->Close ();
+  m_flowOf.erase (socket);
+  m_flows.erase (flow.key);
+}
+
+void
+PcapReplayApplication::ExpireFlows (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  std::map<FlowKey, Flow>::iterator i = m_flows.begin ();
+  while (i != m_flows.end ())
+    {
+      Flow &flow = i->second;
+      ++i;
+      // a TCP flow still writing its data is not idle
+      if (flow.pending == 0 && now - flow.lastActivity >= m_flowTimeout)
+        {
+          NS_LOG_LOGIC ("flow idle since " << flow.lastActivity.GetSeconds () << "s");
+          CloseFlow (flow);
+        }
+    }
+  if (!m_flows.empty ())
+    {
+      m_expireEvent = Simulator::Schedule (m_flowTimeout, &PcapReplayApplication::ExpireFlows, this);
+    }
+}
+
+void
+PcapReplayApplication::DataSend (Ptr<Socket> socket, uint32_t available)
+{
+  NS_LOG_FUNCTION (this << socket << available);
+  std::map<Ptr<Socket>, Flow *>::iterator i = m_flowOf.find (socket);
+  if (i != m_flowOf.end ())
+    {
+      SendPending (*i->second);
+    }
+}
+
+} // Namespace ns3
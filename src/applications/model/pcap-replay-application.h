@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_REPLAY_APPLICATION_H
+#define PCAP_REPLAY_APPLICATION_H
+
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/node-container.h"
+#include "ns3/pcap-mmap-reader.h"
+#include "ns3/traced-callback.h"
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+class Socket;
+class Packet;
+
+/**
+ * \ingroup applications
+ *
+ * \brief Replay the IPv4 packets of a pcap file between simulated hosts.
+ *
+ * The file is read with a PcapMmapReader, a batch of records at a
+ * time, so that files of several gigabytes can be replayed. Each
+ * address of the trace is mapped onto one of the hosts, explicitly
+ * with MapAddress or else by hashing the address, and the packets are
+ * sent from the host of their source to the host of their destination
+ * at the time of their capture relative to the first packet,
+ * multiplied by the TimeScale attribute.
+ *
+ * In the Packet mode, each packet is injected through a raw socket of
+ * the source host with the IP length and the TOS of the trace, and the
+ * IP protocol number of the Protocol attribute: the default
+ * experimental number is ignored by the stacks of the destinations.
+ *
+ * In the Flow mode, each TCP or UDP 5-tuple of the trace becomes a
+ * connection from the source host to the RemotePort of the destination
+ * host, where a PacketSink should listen. The payload of each TCP
+ * packet is written to the socket of its flow at its capture time and
+ * TCP paces the transmission; the flow is closed after a FIN or a RST
+ * once its data is written. UDP packets keep their payload size. A flow
+ * without packets for the FlowTimeout attribute is closed, so that the
+ * UDP flows and the TCP flows whose end was not captured release their
+ * ports; a later packet of its 5-tuple opens a new flow. The packets of
+ * other protocols, and those whose socket cannot be bound, connected or
+ * written, are skipped.
+ *
+ * The supported link types are Ethernet (with 802.1Q tags), PPP, Linux
+ * cooked capture and raw IP. Packets which are not IPv4, or whose
+ * source and destination map to the same host when there is a single
+ * host, are skipped.
+ *
+ * The application can be installed on any node, the sockets are
+ * created on the hosts.
+ */
+class PcapReplayApplication : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// How the packets are replayed
+  enum Mode
+  {
+    PACKET,     //!< Inject each packet with a raw socket
+    FLOW        //!< Send the payloads through a socket per 5-tuple
+  };
+
+  PcapReplayApplication ();
+  virtual ~PcapReplayApplication ();
+
+  /**
+   * \param hosts the hosts the addresses of the trace are mapped onto,
+   * each with an IPv4 address on its interface 1
+   */
+  void SetHosts (NodeContainer hosts);
+  /**
+   * Map an address of the trace onto a host, after SetHosts
+   * \param address an address of the trace
+   * \param host the index of the host
+   */
+  void MapAddress (Ipv4Address address, uint32_t host);
+  /**
+   * \param address an address of the trace
+   * \return the index of its host
+   */
+  uint32_t GetHost (Ipv4Address address);
+
+  /**
+   * \return the number of packets replayed
+   */
+  uint64_t GetReplayedPackets (void) const;
+  /**
+   * \return the number of records skipped
+   */
+  uint64_t GetSkippedPackets (void) const;
+  /**
+   * \return the number of flows opened in the Flow mode
+   */
+  uint32_t GetNFlows (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  // inherited from Application base class.
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /// The fields of a packet of the trace used by the replay
+  struct TracePacket
+  {
+    uint64_t timestamp;         //!< Capture time in nanoseconds
+    uint32_t src;               //!< Source address
+    uint32_t dst;               //!< Destination address
+    uint16_t srcPort;           //!< Source port, or 0
+    uint16_t dstPort;           //!< Destination port, or 0
+    uint8_t protocol;           //!< IP protocol
+    uint8_t tos;                //!< IP TOS
+    uint8_t tcpFlags;           //!< TCP flags, or 0
+    uint16_t ipLength;          //!< IP total length
+    uint16_t payload;           //!< Transport payload length
+  };
+
+  /// 5-tuple of a flow: addresses, ports and protocol
+  typedef std::pair<std::pair<uint32_t, uint32_t>, std::pair<uint32_t, uint32_t> > FlowKey;
+
+  /// A flow of the Flow mode
+  struct Flow
+  {
+    FlowKey key;                //!< The 5-tuple of the flow
+    Ptr<Socket> socket;         //!< The socket of the flow
+    uint32_t pending;           //!< TCP bytes not written to the socket yet
+    bool closing;               //!< Whether the trace closed the flow
+    Time lastActivity;          //!< Time of the last packet of the flow
+  };
+
+  /**
+   * Read the next batch of packets
+   * \return false at the end of the file
+   */
+  bool ReadBatch (void);
+  /**
+   * Parse a record
+   * \param record the record
+   * \param packet the fields of the packet
+   * \return false if the record is not an IPv4 packet
+   */
+  bool Parse (const PcapMmapReader::Record &record, TracePacket &packet) const;
+  /**
+   * Replay the packets due now and schedule the next ones
+   */
+  void ReplayDue (void);
+  /**
+   * Schedule the replay of the next packet of the batch
+   */
+  void ScheduleNext (void);
+  /**
+   * Replay a packet
+   * \param packet the packet
+   */
+  void Replay (const TracePacket &packet);
+  /**
+   * Inject a packet with a raw socket
+   * \param packet the packet
+   * \param src the source host
+   * \param dst the destination host
+   */
+  void SendPacket (const TracePacket &packet, uint32_t src, uint32_t dst);
+  /**
+   * Send a packet through the socket of its flow
+   * \param packet the packet
+   * \param src the source host
+   * \param dst the destination host
+   */
+  void SendFlow (const TracePacket &packet, uint32_t src, uint32_t dst);
+  /**
+   * Write the pending bytes of a TCP flow, and close it once they are
+   * written if the trace closed it
+   * \param flow the flow, erased when it is closed
+   */
+  void SendPending (Flow &flow);
+  /**
+   * Close the socket of a flow and forget the flow
+   * \param flow the flow, erased
+   */
+  void CloseFlow (Flow &flow);
+  /**
+   * Close the flows idle for the flow timeout, and check again after the
+   * timeout while flows are open
+   */
+  void ExpireFlows (void);
+  /**
+   * Send more data as soon as the socket buffer has room
+   * \param socket the socket
+   * \param available the room in the buffer
+   */
+  void DataSend (Ptr<Socket> socket, uint32_t available);
+
+  std::string m_fileName;               //!< The pcap file
+  enum Mode m_mode;                     //!< How the packets are replayed
+  double m_timeScale;                   //!< Factor applied to the trace times
+  uint32_t m_batchSize;                 //!< Records read at a time
+  uint16_t m_remotePort;                //!< Destination port of the flows
+  uint8_t m_protocol;                   //!< IP protocol of the injected packets
+  uint64_t m_maxPackets;                //!< Packets to replay, 0 for all
+  Time m_flowTimeout;                   //!< Idle time after which a flow is closed
+
+  NodeContainer m_hosts;                //!< The hosts
+  std::vector<Ipv4Address> m_addresses; //!< Address of each host
+  std::map<uint32_t, uint32_t> m_hostOf; //!< Host of each trace address
+  std::vector<Ptr<Socket> > m_rawSockets; //!< Raw socket of each host
+
+  PcapMmapReader m_reader;              //!< The reader of the file
+  std::vector<TracePacket> m_batch;     //!< The packets read ahead
+  uint32_t m_next;                      //!< Next packet of the batch
+  uint64_t m_firstTimestamp;            //!< Capture time of the first packet
+  Time m_startTime;                     //!< Time the replay started
+  EventId m_replayEvent;                //!< Event of the next replay
+
+  std::map<FlowKey, Flow> m_flows;      //!< The flows of the Flow mode
+  std::map<Ptr<Socket>, Flow *> m_flowOf; //!< The flow of each TCP socket
+  EventId m_expireEvent;                //!< Event of the next check of the idle flows
+
+  uint64_t m_records;                   //!< Records read
+  uint64_t m_replayed;                  //!< Packets replayed
+  uint64_t m_skipped;                   //!< Records skipped
+  uint32_t m_nFlows;                    //!< Flows opened
+
+  /// Traced Callback: replayed packets
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+};
+
+} // namespace ns3
+
+#endif /* PCAP_REPLAY_APPLICATION_H */
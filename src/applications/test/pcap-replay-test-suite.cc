@@ -0,0 +1,350 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+#include "ns3/pcap-file.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/tcp-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/ipv4-raw-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/mac48-address.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/packet-sink.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/pcap-replay-helper.h"
+#include "ns3/pcap-replay-application.h"
+
+using namespace ns3;
+
+/**
+ * Common parts of the pcap replay tests: three hosts on a channel and
+ * a raw IP trace between three addresses mapped onto them.
+ */
+class PcapReplayTestCase : public TestCase
+{
+public:
+  /**
+   * \param name the name of the test
+   */
+  PcapReplayTestCase (std::string name);
+
+protected:
+  /**
+   * Create the hosts
+   */
+  void CreateHosts (void);
+  /**
+   * Add a UDP or TCP packet to the trace
+   * \param time the capture time in microseconds
+   * \param src the index of the source address
+   * \param dst the index of the destination address
+   * \param payload the payload size
+   * \param protocol 6 or 17
+   * \param tcpFlags the TCP flags
+   * \param tos the IP TOS
+   */
+  void AddPacket (uint64_t time, uint32_t src, uint32_t dst, uint32_t payload,
+                  uint8_t protocol, uint8_t tcpFlags = 0, uint8_t tos = 0);
+  /**
+   * Install the replay on the first host, with the trace addresses mapped
+   * onto the hosts
+   * \param helper the helper
+   * \return the application
+   */
+  Ptr<PcapReplayApplication> Install (const PcapReplayHelper &helper);
+  /**
+   * \param i an index of the trace addresses
+   * \return the address
+   */
+  static Ipv4Address TraceAddress (uint32_t i);
+
+  NodeContainer m_hosts;        //!< The hosts
+  Ipv4InterfaceContainer m_interfaces; //!< The interfaces of the hosts
+  PcapFile m_file;              //!< The trace
+  std::string m_fileName;       //!< The name of the trace
+};
+
+PcapReplayTestCase::PcapReplayTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+Ipv4Address
+PcapReplayTestCase::TraceAddress (uint32_t i)
+{
+  return Ipv4Address (0xc0a80001 + i);
+}
+
+void
+PcapReplayTestCase::CreateHosts (void)
+{
+  m_hosts.Create (3);
+  InternetStackHelper internet;
+  internet.Install (m_hosts);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < m_hosts.GetN (); i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      m_hosts.Get (i)->AddDevice (device);
+      devices.Add (device);
+    }
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  m_interfaces = ipv4.Assign (devices);
+
+  m_fileName = CreateTempDirFilename (GetName () + ".pcap");
+  m_file.Open (m_fileName, std::ios::out);
+  m_file.Init (101);
+}
+
+void
+PcapReplayTestCase::AddPacket (uint64_t time, uint32_t src, uint32_t dst, uint32_t payload,
+                               uint8_t protocol, uint8_t tcpFlags, uint8_t tos)
+{
+  Ptr<Packet> p = Create<Packet> (payload);
+  if (protocol == 6)
+    {
+      TcpHeader tcp;
+      tcp.SetSourcePort (1000 + src);
+      tcp.SetDestinationPort (80);
+      tcp.SetFlags (tcpFlags);
+      p->AddHeader (tcp);
+    }
+  else
+    {
+      UdpHeader udp;
+      udp.SetSourcePort (1000 + src);
+      udp.SetDestinationPort (53);
+      p->AddHeader (udp);
+    }
+  Ipv4Header ip;
+  ip.SetSource (TraceAddress (src));
+  ip.SetDestination (TraceAddress (dst));
+  ip.SetProtocol (protocol);
+  ip.SetTos (tos);
+  ip.SetPayloadSize (p->GetSize ());
+  p->AddHeader (ip);
+  std::vector<uint8_t> data (p->GetSize ());
+  p->CopyData (&data[0], data.size ());
+  m_file.Write (time / 1000000, time % 1000000, &data[0], data.size ());
+}
+
+Ptr<PcapReplayApplication>
+PcapReplayTestCase::Install (const PcapReplayHelper &helper)
+{
+  m_file.Close ();
+  ApplicationContainer apps = helper.Install (m_hosts);
+  Ptr<PcapReplayApplication> app = DynamicCast<PcapReplayApplication> (apps.Get (0));
+  for (uint32_t i = 0; i < m_hosts.GetN (); i++)
+    {
+      app->MapAddress (TraceAddress (i), i);
+    }
+  apps.Start (Seconds (1));
+  return app;
+}
+
+/**
+ * Check the times, sizes and TOS of the packets injected in the Packet
+ * mode with a time scale.
+ */
+class PcapReplayPacketTestCase : public PcapReplayTestCase
+{
+public:
+  PcapReplayPacketTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Receive the packets injected to a host
+   * \param socket the raw socket of the host
+   */
+  void Receive (Ptr<Socket> socket);
+  /**
+   * Record the time a packet is replayed
+   * \param p the packet
+   */
+  void Sent (Ptr<const Packet> p);
+
+  std::vector<Time> m_times;            //!< Replay times
+  std::vector<uint32_t> m_sizes;        //!< Arrival IP lengths
+  std::vector<uint8_t> m_tos;           //!< Arrival TOS
+  std::vector<Ipv4Address> m_sources;   //!< Arrival sources
+};
+
+PcapReplayPacketTestCase::PcapReplayPacketTestCase ()
+  : PcapReplayTestCase ("pcap-replay-packet")
+{
+}
+
+void
+PcapReplayPacketTestCase::Sent (Ptr<const Packet> p)
+{
+  m_times.push_back (Simulator::Now ());
+}
+
+void
+PcapReplayPacketTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()))
+    {
+      Ipv4Header ip;
+      p->PeekHeader (ip);
+      m_sizes.push_back (p->GetSize ());
+      m_tos.push_back (ip.GetTos ());
+      m_sources.push_back (ip.GetSource ());
+    }
+}
+
+void
+PcapReplayPacketTestCase::DoRun (void)
+{
+  CreateHosts ();
+  AddPacket (5000000, 0, 1, 100, 17, 0, 0x20);
+  AddPacket (5100000, 1, 2, 1000, 6, 0x10);
+  AddPacket (5100000, 2, 0, 0, 6, 0x02);
+  AddPacket (5400000, 0, 2, 1400, 17, 0, 0xb8);
+  m_file.Write (5500000, 0, reinterpret_cast<const uint8_t *> ("not an IPv4 packet"), 18);
+
+  for (uint32_t i = 0; i < m_hosts.GetN (); i++)
+    {
+      Ptr<Socket> socket = Socket::CreateSocket (m_hosts.Get (i), Ipv4RawSocketFactory::GetTypeId ());
+      socket->SetAttribute ("Protocol", UintegerValue (253));
+      socket->SetRecvCallback (MakeCallback (&PcapReplayPacketTestCase::Receive, this));
+    }
+  PcapReplayHelper helper (m_fileName);
+  helper.SetAttribute ("TimeScale", DoubleValue (2));
+  helper.SetAttribute ("BatchSize", UintegerValue (2));
+  Ptr<PcapReplayApplication> app = Install (helper);
+  app->TraceConnectWithoutContext ("Tx", MakeCallback (&PcapReplayPacketTestCase::Sent, this));
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (app->GetReplayedPackets (), 4, "Bad number of replayed packets");
+  NS_TEST_EXPECT_MSG_EQ (app->GetSkippedPackets (), 1, "Bad number of skipped packets");
+  NS_TEST_ASSERT_MSG_EQ (m_times.size (), 4, "Bad number of sent packets");
+  NS_TEST_ASSERT_MSG_EQ (m_sizes.size (), 4, "Bad number of received packets");
+  const double times[] = { 1, 1.2, 1.2, 1.8 };
+  const uint32_t sizes[] = { 128, 1040, 40, 1428 };
+  const uint8_t tos[] = { 0x20, 0, 0, 0xb8 };
+  const uint32_t sources[] = { 0, 1, 2, 0 };
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ_TOL (m_times[i].GetSeconds (), times[i], 1e-6, "Bad time of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_sizes[i], sizes[i], "Bad size of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (uint32_t (m_tos[i]), uint32_t (tos[i]), "Bad TOS of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_sources[i], m_interfaces.GetAddress (sources[i]), "Bad source of packet " << i);
+    }
+  Simulator::Destroy ();
+  std::remove (m_fileName.c_str ());
+}
+
+/**
+ * Check that the Flow mode delivers the payloads of the TCP and UDP
+ * flows of the trace to packet sinks.
+ */
+class PcapReplayFlowTestCase : public PcapReplayTestCase
+{
+public:
+  PcapReplayFlowTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PcapReplayFlowTestCase::PcapReplayFlowTestCase ()
+  : PcapReplayTestCase ("pcap-replay-flow")
+{
+}
+
+void
+PcapReplayFlowTestCase::DoRun (void)
+{
+  CreateHosts ();
+  // handshake, data in both directions and FIN
+  AddPacket (0, 0, 1, 0, 6, 0x02);
+  AddPacket (100, 1, 0, 0, 6, 0x12);
+  AddPacket (200, 0, 1, 0, 6, 0x10);
+  AddPacket (300, 0, 1, 1000, 6, 0x18);
+  AddPacket (400, 0, 1, 60000, 6, 0x10);
+  AddPacket (500, 1, 0, 300, 6, 0x18);
+  AddPacket (600, 0, 1, 500, 6, 0x11);
+  AddPacket (700, 1, 0, 0, 6, 0x11);
+  // a UDP flow
+  AddPacket (1000, 2, 0, 200, 17);
+  AddPacket (2000, 2, 0, 250, 17);
+  // a TCP flow whose end is not captured, idle for longer than the timeout
+  AddPacket (3000, 1, 2, 400, 6, 0x18);
+  AddPacket (3000000, 1, 2, 100, 6, 0x18);
+  // the UDP flow again, after it expired
+  AddPacket (4000000, 2, 0, 100, 17);
+
+  for (uint32_t i = 0; i < m_hosts.GetN (); i++)
+    {
+      PacketSinkHelper tcpSink ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 9));
+      tcpSink.Install (m_hosts.Get (i));
+      PacketSinkHelper udpSink ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 9));
+      udpSink.Install (m_hosts.Get (i));
+    }
+  PcapReplayHelper helper (m_fileName);
+  helper.SetAttribute ("Mode", EnumValue (PcapReplayApplication::FLOW));
+  helper.SetAttribute ("FlowTimeout", TimeValue (Seconds (1)));
+  Ptr<PcapReplayApplication> app = Install (helper);
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  // the idle flows are opened again
+  NS_TEST_EXPECT_MSG_EQ (app->GetNFlows (), 6, "Bad number of flows");
+  NS_TEST_EXPECT_MSG_EQ (app->GetReplayedPackets (), 10, "Bad number of replayed packets");
+  NS_TEST_EXPECT_MSG_EQ (app->GetSkippedPackets (), 3, "Bad number of skipped packets");
+  const uint32_t expected[3][2] = { { 300, 550 }, { 61500, 0 }, { 500, 0 } };
+  for (uint32_t i = 0; i < m_hosts.GetN (); i++)
+    {
+      Ptr<PacketSink> tcpSink = DynamicCast<PacketSink> (m_hosts.Get (i)->GetApplication (0));
+      Ptr<PacketSink> udpSink = DynamicCast<PacketSink> (m_hosts.Get (i)->GetApplication (1));
+      NS_TEST_EXPECT_MSG_EQ (tcpSink->GetTotalRx (), expected[i][0], "Bad TCP bytes received by host " << i);
+      NS_TEST_EXPECT_MSG_EQ (udpSink->GetTotalRx (), expected[i][1], "Bad UDP bytes received by host " << i);
+    }
+  Simulator::Destroy ();
+  std::remove (m_fileName.c_str ());
+}
+
+static class PcapReplayTestSuite : public TestSuite
+{
+public:
+  PcapReplayTestSuite ()
+    : TestSuite ("pcap-replay", UNIT)
+  {
+    AddTestCase (new PcapReplayPacketTestCase (), TestCase::QUICK);
+    AddTestCase (new PcapReplayFlowTestCase (), TestCase::QUICK);
+  }
+} g_pcapReplayTestSuite;
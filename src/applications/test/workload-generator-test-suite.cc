@@ -0,0 +1,217 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/workload-generator.h"
+#include "ns3/test.h"
+
+#include <cstring>
+
+using namespace ns3;
+
+/**
+ * \ingroup applications
+ * \defgroup applications-test applications module tests
+ */
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief Check the Philox4x32-10 block function against the known answers
+ * of the reference implementation.
+ */
+class WorkloadGeneratorPhiloxTestCase : public TestCase
+{
+public:
+  WorkloadGeneratorPhiloxTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WorkloadGeneratorPhiloxTestCase::WorkloadGeneratorPhiloxTestCase ()
+  : TestCase ("Check the Philox4x32-10 known answers")
+{
+}
+
+void
+WorkloadGeneratorPhiloxTestCase::DoRun (void)
+{
+  uint32_t zeroCounter[4] = { 0, 0, 0, 0 };
+  uint32_t zeroKey[2] = { 0, 0 };
+  uint32_t zeroExpected[4] = { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 };
+  WorkloadGenerator::Philox (zeroCounter, zeroKey);
+
+  uint32_t onesCounter[4] = { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff };
+  uint32_t onesKey[2] = { 0xffffffff, 0xffffffff };
+  uint32_t onesExpected[4] = { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd };
+  WorkloadGenerator::Philox (onesCounter, onesKey);
+
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (zeroCounter[i], zeroExpected[i], "Wrong word " << i << " for the zero counter");
+      NS_TEST_EXPECT_MSG_EQ (onesCounter[i], onesExpected[i], "Wrong word " << i << " for the all ones counter");
+    }
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief Check that the schedule does not depend on the number of threads
+ * nor on the other hosts, follows the configuration, changes with the key
+ * and survives a round trip through a workload file.
+ */
+class WorkloadGeneratorScheduleTestCase : public TestCase
+{
+public:
+  WorkloadGeneratorScheduleTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param generator the generator to configure
+   */
+  void Configure (WorkloadGenerator &generator);
+  /**
+   * \param a a schedule
+   * \param b another schedule
+   * \return true if the schedules are the same
+   */
+  static bool Equal (const std::vector<WorkloadFlow> &a, const std::vector<WorkloadFlow> &b);
+};
+
+WorkloadGeneratorScheduleTestCase::WorkloadGeneratorScheduleTestCase ()
+  : TestCase ("Check the reproducibility of the workload schedule")
+{
+}
+
+void
+WorkloadGeneratorScheduleTestCase::Configure (WorkloadGenerator &generator)
+{
+  generator.AddCdfEntry (0, 0);
+  generator.AddCdfEntry (10000, 0.5);
+  generator.AddCdfEntry (100000, 1);
+  generator.SetHosts (4, 3);
+  generator.SetRequestRate (2000);
+  generator.SetLaunchPeriod (0.1, 0.2);
+  generator.SetNClasses (5);
+  generator.SetKey (7, 3);
+}
+
+bool
+WorkloadGeneratorScheduleTestCase::Equal (const std::vector<WorkloadFlow> &a, const std::vector<WorkloadFlow> &b)
+{
+  return a.size () == b.size ()
+         && (a.empty () || std::memcmp (&a[0], &b[0], a.size () * sizeof (WorkloadFlow)) == 0);
+}
+
+void
+WorkloadGeneratorScheduleTestCase::DoRun (void)
+{
+  WorkloadGenerator generator;
+  Configure (generator);
+  NS_TEST_EXPECT_MSG_EQ_TOL (generator.GetAverageFlowSize (), 0.5 * 5000 + 0.5 * 55000, 1e-9,
+                             "Wrong average flow size");
+
+  std::vector<WorkloadFlow> flows = generator.Generate ();
+  // 12 hosts, 200 flows each on average
+  NS_TEST_ASSERT_MSG_GT (flows.size (), 2000, "Too few flows");
+  NS_TEST_ASSERT_MSG_LT (flows.size (), 2800, "Too many flows");
+
+  uint32_t classes[5] = { 0, 0, 0, 0, 0 };
+  for (uint32_t i = 0; i < flows.size (); ++i)
+    {
+      const WorkloadFlow &flow = flows[i];
+      NS_TEST_ASSERT_MSG_LT (flow.dst, 12, "Unknown destination");
+      NS_TEST_ASSERT_MSG_NE (flow.dst / 4, flow.src / 4, "The destination should be under another leaf");
+      NS_TEST_ASSERT_MSG_LT (flow.tos, 5, "Unknown class");
+      NS_TEST_ASSERT_MSG_LT (flow.size, 100001, "Flow larger than the distribution");
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (flow.startTime, 0.1, "Flow started before the launch period");
+      NS_TEST_ASSERT_MSG_LT (flow.startTime, 0.2, "Flow started after the launch period");
+      if (i > 0 && flows[i - 1].src == flow.src)
+        {
+          NS_TEST_ASSERT_MSG_EQ (flow.index, flows[i - 1].index + 1, "Flows of a host out of order");
+          NS_TEST_ASSERT_MSG_GT (flow.startTime, flows[i - 1].startTime, "Flows of a host out of order");
+        }
+      classes[flow.tos]++;
+    }
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      NS_TEST_EXPECT_MSG_GT (classes[i], flows.size () / 10, "Class " << i << " is rarely drawn");
+    }
+
+  WorkloadGenerator threaded;
+  Configure (threaded);
+  threaded.SetNThreads (5);
+  NS_TEST_EXPECT_MSG_EQ (Equal (threaded.Generate (), flows), true, "The schedule depends on the number of threads");
+
+  // Host 5 alone, the same flows as in the whole schedule
+  std::vector<WorkloadFlow> host;
+  for (uint32_t i = 0; i < flows.size (); ++i)
+    {
+      if (flows[i].src == 5)
+        {
+          host.push_back (flows[i]);
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (Equal (generator.GenerateHost (5), host), true, "The schedule of a host depends on the others");
+
+  WorkloadGenerator otherRun;
+  Configure (otherRun);
+  otherRun.SetKey (7, 4);
+  NS_TEST_EXPECT_MSG_EQ (Equal (otherRun.Generate (), flows), false, "The schedule does not depend on the run");
+
+  std::string filename = CreateTempDirFilename ("workload.bin");
+  generator.Save (filename, flows);
+  std::vector<WorkloadFlow> loaded;
+  NS_TEST_ASSERT_MSG_EQ (threaded.Load (filename, loaded), true, "Cannot open the workload file");
+  NS_TEST_EXPECT_MSG_EQ (Equal (loaded, flows), true, "The workload file does not replay the schedule");
+  NS_TEST_EXPECT_MSG_EQ (generator.Load (CreateTempDirFilename ("missing.bin"), loaded), false,
+                         "Missing workload files should be reported");
+
+  // Any parameter of the schedule invalidates the file
+  NS_TEST_EXPECT_MSG_EQ (otherRun.Load (filename, loaded), false, "Loaded the schedule of another run");
+  WorkloadGenerator otherLoad;
+  Configure (otherLoad);
+  otherLoad.SetRequestRate (1000);
+  NS_TEST_EXPECT_MSG_EQ (otherLoad.Load (filename, loaded), false, "Loaded the schedule of another load");
+  WorkloadGenerator otherHosts;
+  Configure (otherHosts);
+  otherHosts.SetHosts (4, 2);
+  NS_TEST_EXPECT_MSG_EQ (otherHosts.Load (filename, loaded), false, "Loaded the schedule of other hosts");
+  WorkloadGenerator otherCdf;
+  Configure (otherCdf);
+  otherCdf.AddCdfEntry (200000, 1);
+  NS_TEST_EXPECT_MSG_EQ (otherCdf.Load (filename, loaded), false, "Loaded the schedule of another distribution");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief WorkloadGenerator test suite
+ */
+static class WorkloadGeneratorTestSuite : public TestSuite
+{
+public:
+  WorkloadGeneratorTestSuite ()
+    : TestSuite ("workload-generator", UNIT)
+  {
+    AddTestCase (new WorkloadGeneratorPhiloxTestCase (), TestCase::QUICK);
+    AddTestCase (new WorkloadGeneratorScheduleTestCase (), TestCase::QUICK);
+  }
+} g_workloadGeneratorTestSuite;
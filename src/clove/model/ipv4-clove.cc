@@ -16,7 +16,8 @@ Ipv4Clove::Ipv4Clove () :
     m_flowletTimeout (MicroSeconds (200)),
     m_runMode (CLOVE_RUNMODE_EDGE_FLOWLET),
     m_halfRTT (MicroSeconds (40)),
-    m_disToUncongestedPath (false)
+    m_disToUncongestedPath (false),
+    m_utilizationAging (MilliSeconds (1))
 {
     NS_LOG_FUNCTION (this);
 }
@@ -25,7 +26,8 @@ Ipv4Clove::Ipv4Clove (const Ipv4Clove &other) :
     m_flowletTimeout (other.m_flowletTimeout),
     m_runMode (other.m_runMode),
     m_halfRTT (other.m_halfRTT),
-    m_disToUncongestedPath (other.m_disToUncongestedPath)
+    m_disToUncongestedPath (other.m_disToUncongestedPath),
+    m_utilizationAging (other.m_utilizationAging)
 {
     NS_LOG_FUNCTION (this);
 }
@@ -53,6 +55,10 @@ Ipv4Clove::GetTypeId (void)
                        BooleanValue (false),
                        MakeBooleanAccessor (&Ipv4Clove::m_disToUncongestedPath),
                        MakeBooleanChecker ())
+        .AddAttribute ("UtilizationAging", "The utilization of a path not reported for this long is considered to be 0 (INT mode)",
+                       TimeValue (MilliSeconds (1)),
+                       MakeTimeAccessor (&Ipv4Clove::m_utilizationAging),
+                       MakeTimeChecker ())
     ;
 
     return tid;
@@ -168,7 +174,26 @@ Ipv4Clove::CalPath (uint32_t destTor)
     }
     else if (m_runMode == CLOVE_RUNMODE_INT)
     {
-        return 0;
+        // Least utilized path, ties are broken randomly
+        double minUtilization = 2.0;
+        uint32_t nMin = 0;
+        uint32_t bestPath = 0;
+        std::vector<uint32_t>::iterator itr = paths.begin ();
+        for ( ; itr != paths.end (); ++itr)
+        {
+            double utilization = Ipv4Clove::GetPathUtilization (destTor, *itr);
+            if (utilization < minUtilization)
+            {
+                minUtilization = utilization;
+                bestPath = *itr;
+                nMin = 1;
+            }
+            else if (utilization == minUtilization && rand () % (++nMin) == 0)
+            {
+                bestPath = *itr;
+            }
+        }
+        return bestPath;
     }
     return 0;
 }
@@ -261,4 +286,31 @@ Ipv4Clove::FlowRecv (uint32_t path, Ipv4Address daddr, bool withECN)
     }
 }
 
+void
+Ipv4Clove::FlowRecvInt (uint32_t path, Ipv4Address daddr, double utilization)
+{
+    uint32_t destTor = 0;
+    if (!Ipv4Clove::FindTorId (daddr, destTor))
+    {
+        NS_LOG_ERROR ("Cannot find dest tor id based on the given dest address");
+        return;
+    }
+
+    std::pair<uint32_t, uint32_t> key = std::make_pair (destTor, path);
+    m_pathUtilization[key] = std::make_pair (utilization, Simulator::Now ());
+}
+
+double
+Ipv4Clove::GetPathUtilization (uint32_t destTor, uint32_t path) const
+{
+    std::pair<uint32_t, uint32_t> key = std::make_pair (destTor, path);
+    std::map<std::pair<uint32_t, uint32_t>, std::pair<double, Time> >::const_iterator itr = m_pathUtilization.find (key);
+    if (itr == m_pathUtilization.end ()
+            || Simulator::Now () - itr->second.second >= m_utilizationAging)
+    {
+        return 0.0;
+    }
+    return itr->second.first;
+}
+
 }
@@ -36,6 +36,11 @@ public:
 
     void FlowRecv (uint32_t path, Ipv4Address daddr, bool withECN);
 
+    // Clove INT: the receiver reflected the maximum utilization of a path
+    void FlowRecvInt (uint32_t path, Ipv4Address daddr, double utilization);
+
+    double GetPathUtilization (uint32_t destTor, uint32_t path) const;
+
     bool FindTorId (Ipv4Address daddr, uint32_t &torId);
 
 private:
@@ -53,6 +58,10 @@ private:
     bool m_disToUncongestedPath;
     std::map<std::pair<uint32_t, uint32_t>, double> m_pathWeight;
     std::map<std::pair<uint32_t, uint32_t>, Time> m_pathECNSeen;
+
+    // Clove INT
+    Time m_utilizationAging;
+    std::map<std::pair<uint32_t, uint32_t>, std::pair<double, Time> > m_pathUtilization;
 };
 
 }
@@ -1,6 +1,8 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 #include "ns3/tcp-clove-tag.h"
 
+#include <algorithm>
+
 namespace ns3 {
 
 TypeId
@@ -16,6 +18,9 @@ TcpCloveTag::GetTypeId (void)
 }
 
 TcpCloveTag::TcpCloveTag ()
+    : m_path (0),
+      m_hasUtilization (false),
+      m_utilization (0)
 {
 
 }
@@ -32,6 +37,25 @@ TcpCloveTag::SetPath (uint32_t path)
     m_path = path;
 }
 
+bool
+TcpCloveTag::HasUtilization (void) const
+{
+    return m_hasUtilization;
+}
+
+double
+TcpCloveTag::GetUtilization (void) const
+{
+    return m_utilization / 65535.0;
+}
+
+void
+TcpCloveTag::SetUtilization (double utilization)
+{
+    m_hasUtilization = true;
+    m_utilization = static_cast<uint16_t> (std::min (std::max (utilization, 0.0), 1.0) * 65535 + 0.5);
+}
+
 TypeId
 TcpCloveTag::GetInstanceTypeId (void) const
 {
@@ -41,25 +65,33 @@ TcpCloveTag::GetInstanceTypeId (void) const
 uint32_t
 TcpCloveTag::GetSerializedSize (void) const
 {
-    return sizeof (uint32_t);
+    return sizeof (uint32_t) + sizeof (uint8_t) + sizeof (uint16_t);
 }
 
 void
 TcpCloveTag::Serialize (TagBuffer i) const
 {
     i.WriteU32 (m_path);
+    i.WriteU8 (m_hasUtilization ? 1 : 0);
+    i.WriteU16 (m_utilization);
 }
 
 void
 TcpCloveTag::Deserialize (TagBuffer i)
 {
     m_path = i.ReadU32 ();
+    m_hasUtilization = i.ReadU8 () != 0;
+    m_utilization = i.ReadU16 ();
 }
 
 void
 TcpCloveTag::Print (std::ostream &os) const
 {
     os << " path: " << m_path;
+    if (m_hasUtilization)
+    {
+        os << " utilization: " << GetUtilization ();
+    }
 }
 
 }
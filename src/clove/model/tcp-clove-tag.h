@@ -18,6 +18,13 @@ public:
 
     void SetPath (uint32_t path);
 
+    // Clove INT: maximum utilization of the path reflected by the receiver
+    bool HasUtilization (void) const;
+
+    double GetUtilization (void) const;
+
+    void SetUtilization (double utilization);
+
     virtual TypeId GetInstanceTypeId (void) const;
 
     virtual uint32_t GetSerializedSize (void) const;
@@ -32,6 +39,10 @@ private:
 
     uint32_t m_path;
 
+    bool m_hasUtilization;
+
+    uint16_t m_utilization; // 65535 is a fully utilized path
+
 };
 
 }
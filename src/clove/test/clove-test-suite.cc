@@ -3,6 +3,11 @@
 // Include a header file from your module to test.
 #include "ns3/ipv4-clove.h"
 
+#include "ns3/tcp-clove-tag.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
 // An essential include is test.h
 #include "ns3/test.h"
 
@@ -46,6 +51,71 @@ CloveTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// Clove INT picks the least utilized path towards the destination ToR
+class CloveIntTestCase : public TestCase
+{
+public:
+  CloveIntTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void CheckAged (Ptr<Ipv4Clove> clove);
+};
+
+CloveIntTestCase::CloveIntTestCase ()
+  : TestCase ("Clove INT path selection")
+{
+}
+
+void
+CloveIntTestCase::CheckAged (Ptr<Ipv4Clove> clove)
+{
+  NS_TEST_ASSERT_MSG_EQ_TOL (clove->GetPathUtilization (1, 10), 0.0, 1e-9, "The report of the path should have aged");
+  // Path 10 is the only one without a fresh report
+  clove->FlowRecvInt (11, Ipv4Address ("10.1.1.1"), 0.2);
+  clove->FlowRecvInt (12, Ipv4Address ("10.1.1.1"), 0.5);
+  NS_TEST_ASSERT_MSG_EQ (clove->GetPath (2, Ipv4Address ("10.0.0.1"), Ipv4Address ("10.1.1.1")), 10,
+                         "The aged path should be the least utilized");
+}
+
+void
+CloveIntTestCase::DoRun (void)
+{
+  Ptr<Ipv4Clove> clove = CreateObject<Ipv4Clove> ();
+  clove->SetAttribute ("RunMode", UintegerValue (CLOVE_RUNMODE_INT));
+  clove->AddAddressWithTor (Ipv4Address ("10.0.0.1"), 0);
+  clove->AddAddressWithTor (Ipv4Address ("10.1.1.1"), 1);
+  clove->AddAvailPath (1, 10);
+  clove->AddAvailPath (1, 11);
+  clove->AddAvailPath (1, 12);
+
+  clove->FlowRecvInt (10, Ipv4Address ("10.1.1.1"), 0.9);
+  clove->FlowRecvInt (11, Ipv4Address ("10.1.1.1"), 0.2);
+  clove->FlowRecvInt (12, Ipv4Address ("10.1.1.1"), 0.5);
+  NS_TEST_ASSERT_MSG_EQ_TOL (clove->GetPathUtilization (1, 10), 0.9, 1e-9, "Wrong reported utilization");
+  NS_TEST_ASSERT_MSG_EQ (clove->GetPath (1, Ipv4Address ("10.0.0.1"), Ipv4Address ("10.1.1.1")), 11,
+                         "Clove INT should pick the least utilized path");
+
+  Simulator::Schedule (MilliSeconds (2), &CloveIntTestCase::CheckAged, this, clove);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // The utilization is carried back to the sender by the Clove tag
+  Ptr<Packet> p = Create<Packet> (100);
+  TcpCloveTag tag;
+  tag.SetPath (12);
+  p->AddPacketTag (tag);
+  TcpCloveTag copy;
+  p->PeekPacketTag (copy);
+  NS_TEST_ASSERT_MSG_EQ (copy.HasUtilization (), false, "No utilization was set");
+  tag.SetUtilization (0.25);
+  p->ReplacePacketTag (tag);
+  p->PeekPacketTag (copy);
+  NS_TEST_ASSERT_MSG_EQ (copy.GetPath (), 12, "Wrong path");
+  NS_TEST_ASSERT_MSG_EQ (copy.HasUtilization (), true, "The utilization was set");
+  NS_TEST_ASSERT_MSG_EQ_TOL (copy.GetUtilization (), 0.25, 1e-4, "Wrong utilization");
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +131,7 @@ CloveTestSuite::CloveTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new CloveTestCase1, TestCase::QUICK);
+  AddTestCase (new CloveIntTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
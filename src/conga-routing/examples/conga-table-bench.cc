@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+// Micro-benchmark of the CONGA best path selection.
+//
+// A leaf switch with nUplinks uplinks picks the best uplink towards one of
+// nLeaves destination leaves, as it does for every new flowlet. The dense
+// CongaCongestionTable is compared with the nested std::map layout it
+// replaced. Both layouts hold the same metrics and must agree on the number
+// of best ports.
+//
+// ./waf --run "conga-table-bench --nLeaves=64 --nUplinks=32 --nLookups=10000000"
+
+#include "ns3/core-module.h"
+#include "ns3/conga-congestion-table.h"
+
+#include <map>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <iostream>
+
+using namespace ns3;
+
+typedef std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t> > > NestedToLeafTable;
+
+static uint32_t
+SelectNested (NestedToLeafTable &table, uint32_t leaf, const std::vector<uint32_t> &ports,
+              const std::vector<uint32_t> &local, std::vector<uint32_t> &best)
+{
+  NestedToLeafTable::iterator leafItr = table.find (leaf);
+  uint32_t minCe = std::numeric_limits<uint32_t>::max ();
+  best.clear ();
+  for (uint32_t i = 0; i < ports.size (); ++i)
+  {
+    uint32_t remote = 0;
+    if (leafItr != table.end ())
+    {
+      std::map<uint32_t, std::pair<Time, uint32_t> >::iterator portItr = leafItr->second.find (ports[i]);
+      if (portItr != leafItr->second.end ())
+      {
+        remote = portItr->second.second;
+      }
+    }
+    uint32_t ce = std::max (local[i], remote);
+    if (ce < minCe)
+    {
+      minCe = ce;
+      best.clear ();
+    }
+    if (ce == minCe)
+    {
+      best.push_back (ports[i]);
+    }
+  }
+  return best.size ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nLeaves = 64;
+  uint32_t nUplinks = 32;
+  uint32_t nLookups = 10000000;
+
+  CommandLine cmd;
+  cmd.AddValue ("nLeaves", "Number of destination leaves", nLeaves);
+  cmd.AddValue ("nUplinks", "Number of uplinks of the leaf switch", nUplinks);
+  cmd.AddValue ("nLookups", "Number of best path selections", nLookups);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+
+  // Uplinks are the interfaces 1 to nUplinks, 0 is the loopback
+  std::vector<uint32_t> ports (nUplinks);
+  std::vector<uint32_t> local (nUplinks);
+  for (uint32_t i = 0; i < nUplinks; ++i)
+  {
+    ports[i] = i + 1;
+    local[i] = rng->GetInteger (0, 7);
+  }
+
+  NestedToLeafTable nested;
+  CongaCongestionTable dense;
+  for (uint32_t leaf = 0; leaf < nLeaves; ++leaf)
+  {
+    for (uint32_t i = 0; i < nUplinks; ++i)
+    {
+      uint32_t ce = rng->GetInteger (0, 7);
+      nested[leaf][ports[i]] = std::make_pair (Seconds (0), ce);
+      dense.SetToLeaf (leaf, ports[i], ce, Seconds (0));
+    }
+  }
+
+  std::vector<uint32_t> leaves (nLookups);
+  for (uint32_t i = 0; i < nLookups; ++i)
+  {
+    leaves[i] = rng->GetInteger (0, nLeaves - 1);
+  }
+
+  std::vector<uint32_t> best;
+  best.reserve (nUplinks);
+  uint64_t nestedSum = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < nLookups; ++i)
+  {
+    nestedSum += SelectNested (nested, leaves[i], ports, local, best);
+  }
+  int64_t nestedMs = clock.End ();
+
+  std::vector<uint32_t> bestDense (nUplinks);
+  uint64_t denseSum = 0;
+  clock.Start ();
+  for (uint32_t i = 0; i < nLookups; ++i)
+  {
+    denseSum += dense.SelectBestPorts (leaves[i], &ports[0], &local[0], nUplinks, &bestDense[0]);
+  }
+  int64_t denseMs = clock.End ();
+
+  std::cout << nLeaves << " leaves x " << nUplinks << " uplinks, " << nLookups << " lookups" << std::endl;
+  std::cout << "nested map: " << nestedMs << " ms (" << nestedSum << " best ports)" << std::endl;
+  std::cout << "dense table: " << denseMs << " ms (" << denseSum << " best ports)" << std::endl;
+  if (nestedSum != denseSum)
+  {
+    std::cerr << "The two layouts disagree" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,252 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "conga-congestion-table.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CongaCongestionTable");
+
+namespace {
+
+// Copy a row-major nLeaves x nPorts matrix into a larger one
+template <typename T>
+void
+Relayout (std::vector<T> &v, uint32_t nLeaves, uint32_t nPorts, uint32_t newLeaves, uint32_t newPorts)
+{
+  std::vector<T> newV (static_cast<size_t> (newLeaves) * newPorts, T ());
+  for (uint32_t leaf = 0; leaf < nLeaves; ++leaf)
+  {
+    std::copy (v.begin () + static_cast<size_t> (leaf) * nPorts,
+               v.begin () + static_cast<size_t> (leaf + 1) * nPorts,
+               newV.begin () + static_cast<size_t> (leaf) * newPorts);
+  }
+  v.swap (newV);
+}
+
+}
+
+CongaCongestionTable::CongaCongestionTable ()
+  : m_nLeaves (0),
+    m_nPorts (0)
+{
+}
+
+void
+CongaCongestionTable::Reserve (uint32_t nLeaves, uint32_t nPorts)
+{
+  uint32_t newLeaves = std::max (nLeaves, m_nLeaves);
+  uint32_t newPorts = std::max (nPorts, m_nPorts);
+  if (newLeaves == m_nLeaves && newPorts == m_nPorts)
+  {
+    return;
+  }
+  NS_LOG_LOGIC (this << " Resize congestion tables to " << newLeaves << " leaves x " << newPorts << " ports");
+  Relayout (m_toLeafCe, m_nLeaves, m_nPorts, newLeaves, newPorts);
+  Relayout (m_toLeafTime, m_nLeaves, m_nPorts, newLeaves, newPorts);
+  Relayout (m_toLeafValid, m_nLeaves, m_nPorts, newLeaves, newPorts);
+  Relayout (m_fromLeafCe, m_nLeaves, m_nPorts, newLeaves, newPorts);
+  Relayout (m_fromLeafTime, m_nLeaves, m_nPorts, newLeaves, newPorts);
+  Relayout (m_fromLeafValid, m_nLeaves, m_nPorts, newLeaves, newPorts);
+  Relayout (m_fromLeafChange, m_nLeaves, m_nPorts, newLeaves, newPorts);
+  m_fromLeafCount.resize (newLeaves, 0);
+  m_nLeaves = newLeaves;
+  m_nPorts = newPorts;
+}
+
+uint32_t
+CongaCongestionTable::GetNLeaves (void) const
+{
+  return m_nLeaves;
+}
+
+uint32_t
+CongaCongestionTable::GetNPorts (void) const
+{
+  return m_nPorts;
+}
+
+uint32_t
+CongaCongestionTable::Index (uint32_t leaf, uint32_t port) const
+{
+  return leaf * m_nPorts + port;
+}
+
+void
+CongaCongestionTable::SetToLeaf (uint32_t leaf, uint32_t port, uint32_t ce, Time now)
+{
+  Reserve (leaf + 1, port + 1);
+  uint32_t i = Index (leaf, port);
+  m_toLeafCe[i] = ce;
+  m_toLeafTime[i] = now.GetTimeStep ();
+  m_toLeafValid[i] = 1;
+}
+
+uint32_t
+CongaCongestionTable::GetToLeaf (uint32_t leaf, uint32_t port) const
+{
+  if (leaf >= m_nLeaves || port >= m_nPorts)
+  {
+    return 0;
+  }
+  return m_toLeafCe[Index (leaf, port)];
+}
+
+void
+CongaCongestionTable::SetFromLeaf (uint32_t leaf, uint32_t port, uint32_t ce, Time now)
+{
+  Reserve (leaf + 1, port + 1);
+  uint32_t i = Index (leaf, port);
+  if (!m_fromLeafValid[i])
+  {
+    m_fromLeafValid[i] = 1;
+    ++m_fromLeafCount[leaf];
+  }
+  m_fromLeafCe[i] = ce;
+  m_fromLeafChange[i] = 1;
+  m_fromLeafTime[i] = now.GetTimeStep ();
+}
+
+bool
+CongaCongestionTable::HasFromLeaf (uint32_t leaf, uint32_t port) const
+{
+  return leaf < m_nLeaves && port < m_nPorts && m_fromLeafValid[Index (leaf, port)];
+}
+
+uint32_t
+CongaCongestionTable::GetNFromLeaf (uint32_t leaf) const
+{
+  return leaf < m_nLeaves ? m_fromLeafCount[leaf] : 0;
+}
+
+bool
+CongaCongestionTable::PickFeedback (uint32_t leaf, uint64_t index, uint32_t &port, uint32_t &ce)
+{
+  uint32_t count = GetNFromLeaf (leaf);
+  if (count == 0)
+  {
+    return false;
+  }
+  const uint8_t *valid = &m_fromLeafValid[Index (leaf, 0)];
+  const uint8_t *change = &m_fromLeafChange[Index (leaf, 0)];
+
+  // Round robin over the stored entries
+  uint32_t skip = index % count;
+  uint32_t start = 0;
+  for ( ; start < m_nPorts; ++start)
+  {
+    if (valid[start] && skip-- == 0)
+    {
+      break;
+    }
+  }
+
+  // Prefer the changed ones, looking at the entries after the round robin one
+  uint32_t picked = start;
+  if (!change[start])
+  {
+    for (uint32_t step = 1; step < m_nPorts; ++step)
+    {
+      uint32_t p = (start + step) % m_nPorts;
+      if (valid[p] && change[p])
+      {
+        picked = p;
+        break;
+      }
+    }
+  }
+
+  uint32_t i = Index (leaf, picked);
+  m_fromLeafChange[i] = 0;
+  port = picked;
+  ce = m_fromLeafCe[i];
+  return true;
+}
+
+bool
+CongaCongestionTable::Age (Time now, Time agingTime)
+{
+  int64_t oldest = (now - agingTime).GetTimeStep ();
+  bool fresh = false;
+  uint32_t n = m_nLeaves * m_nPorts;
+  for (uint32_t i = 0; i < n; ++i)
+  {
+    if (!m_toLeafValid[i])
+    {
+      continue;
+    }
+    if (m_toLeafTime[i] < oldest)
+    {
+      m_toLeafCe[i] = 0;
+    }
+    else
+    {
+      fresh = true;
+    }
+  }
+  for (uint32_t i = 0; i < n; ++i)
+  {
+    if (!m_fromLeafValid[i])
+    {
+      continue;
+    }
+    if (m_fromLeafTime[i] < oldest)
+    {
+      m_fromLeafValid[i] = 0;
+      m_fromLeafChange[i] = 0;
+      --m_fromLeafCount[i / m_nPorts];
+    }
+    else
+    {
+      fresh = true;
+    }
+  }
+  return fresh;
+}
+
+uint32_t
+CongaCongestionTable::SelectBestPorts (uint32_t leaf, const uint32_t *ports, const uint32_t *localCe,
+                                       uint32_t n, uint32_t *best) const
+{
+  if (m_metrics.size () < n)
+  {
+    m_metrics.resize (n);
+  }
+  uint32_t *metrics = &m_metrics[0];
+
+  // Gather max (local, remote) for every candidate
+  if (leaf < m_nLeaves)
+  {
+    const uint32_t *remote = &m_toLeafCe[Index (leaf, 0)];
+    for (uint32_t i = 0; i < n; ++i)
+    {
+      uint32_t r = ports[i] < m_nPorts ? remote[ports[i]] : 0;
+      metrics[i] = std::max (localCe[i], r);
+    }
+  }
+  else
+  {
+    std::copy (localCe, localCe + n, metrics);
+  }
+
+  // Min-reduction, no data dependent branch
+  uint32_t minCe = std::numeric_limits<uint32_t>::max ();
+  for (uint32_t i = 0; i < n; ++i)
+  {
+    minCe = std::min (minCe, metrics[i]);
+  }
+
+  uint32_t nBest = 0;
+  for (uint32_t i = 0; i < n; ++i)
+  {
+    best[nBest] = ports[i];
+    nBest += (metrics[i] == minCe);
+  }
+  return nBest;
+}
+
+}
@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef CONGA_CONGESTION_TABLE_H
+#define CONGA_CONGESTION_TABLE_H
+
+#include "ns3/nstime.h"
+
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * The Congestion-To-Leaf and Congestion-From-Leaf tables of a CONGA leaf
+ * switch, stored as dense (leaf, port) matrices.
+ *
+ * Each field of the entries lives in its own row-major array (structure of
+ * arrays), so that the metrics of all the uplinks towards one leaf are
+ * contiguous and the best path selection is a branch free min-reduction
+ * the compiler can vectorize. The matrices grow on demand when a leaf id or
+ * a port beyond the current size is written; reading an unknown entry
+ * returns a congestion of 0.
+ */
+class CongaCongestionTable
+{
+public:
+  CongaCongestionTable ();
+
+  /**
+   * Make room for leaf ids below nLeaves and ports below nPorts, keeping
+   * the existing entries.
+   */
+  void Reserve (uint32_t nLeaves, uint32_t nPorts);
+
+  uint32_t GetNLeaves (void) const;
+  uint32_t GetNPorts (void) const;
+
+  // ------ Congestion-To-Leaf Table ------
+
+  // Store the remote metric of the path to leaf through port
+  void SetToLeaf (uint32_t leaf, uint32_t port, uint32_t ce, Time now);
+
+  // Remote metric of the path to leaf through port, 0 if unknown
+  uint32_t GetToLeaf (uint32_t leaf, uint32_t port) const;
+
+  // ------ Congestion-From-Leaf Table ------
+
+  // Store the metric received from leaf for port and mark it as changed
+  void SetFromLeaf (uint32_t leaf, uint32_t port, uint32_t ce, Time now);
+
+  // Whether a metric received from leaf for port is stored
+  bool HasFromLeaf (uint32_t leaf, uint32_t port) const;
+
+  // Number of metrics received from leaf
+  uint32_t GetNFromLeaf (uint32_t leaf) const;
+
+  /**
+   * Pick the feedback to piggyback to leaf: the entry at position
+   * index % GetNFromLeaf (leaf) in port order, or the next changed one after
+   * it if that entry is unchanged. The picked entry is marked unchanged.
+   *
+   * \return false if there is nothing to feed back to leaf
+   */
+  bool PickFeedback (uint32_t leaf, uint64_t index, uint32_t &port, uint32_t &ce);
+
+  /**
+   * Reset the remote metrics and forget the feedback older than agingTime.
+   * \return true if some entry is still fresh
+   */
+  bool Age (Time now, Time agingTime);
+
+  /**
+   * Select the uplinks to leaf which minimize the maximum of the local and
+   * the remote metric.
+   *
+   * \param leaf the destination leaf
+   * \param ports the candidate ports
+   * \param localCe the local metric of each candidate port
+   * \param n the number of candidate ports
+   * \param best filled with the best ports, must have room for n ports
+   * \return the number of best ports
+   */
+  uint32_t SelectBestPorts (uint32_t leaf, const uint32_t *ports, const uint32_t *localCe,
+                            uint32_t n, uint32_t *best) const;
+
+private:
+  uint32_t Index (uint32_t leaf, uint32_t port) const;
+
+  uint32_t m_nLeaves;
+  uint32_t m_nPorts;
+
+  // Congestion-To-Leaf Table
+  std::vector<uint32_t> m_toLeafCe;
+  std::vector<int64_t> m_toLeafTime;
+  std::vector<uint8_t> m_toLeafValid;
+
+  // Congestion-From-Leaf Table
+  std::vector<uint32_t> m_fromLeafCe;
+  std::vector<int64_t> m_fromLeafTime;
+  std::vector<uint8_t> m_fromLeafValid;
+  std::vector<uint8_t> m_fromLeafChange;
+  std::vector<uint32_t> m_fromLeafCount;
+
+  // Scratch buffer of SelectBestPorts
+  mutable std::vector<uint32_t> m_metrics;
+};
+
+}
+
+#endif /* CONGA_CONGESTION_TABLE_H */
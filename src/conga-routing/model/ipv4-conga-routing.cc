@@ -114,18 +114,7 @@ Ipv4CongaRouting::EnableEcmpMode ()
 void
 Ipv4CongaRouting::InitCongestion (uint32_t leafId, uint32_t port, uint32_t congestion)
 {
-  std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t> > >::iterator itr =
-      m_congaToLeafTable.find(leafId);
-  if (itr != m_congaToLeafTable.end ())
-  {
-    (itr->second)[port] = std::make_pair(Simulator::Now (), congestion);
-  }
-  else
-  {
-    std::map<uint32_t, std::pair<Time, uint32_t> > newMap;
-    newMap[port] = std::make_pair(Simulator::Now (), congestion);
-    m_congaToLeafTable[leafId] = newMap;
-  }
+  m_congestionTable.SetToLeaf (leafId, port, congestion, Simulator::Now ());
 }
 
 void
@@ -285,35 +274,13 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       uint32_t destLeafId = itr->second;
 
       // Check piggyback information
-      std::map<uint32_t, std::map<uint32_t, FeedbackInfo> >::iterator fbItr =
-          m_congaFromLeafTable.find (destLeafId);
-
       uint32_t fbLbTag = LOOPBACK_PORT;
       uint32_t fbMetric = 0;
 
       // Piggyback according to round robin and favoring those that has been changed
-      if (fbItr != m_congaFromLeafTable.end ())
+      if (m_congestionTable.PickFeedback (destLeafId, m_feedbackIndex, fbLbTag, fbMetric))
       {
-        std::map<uint32_t, FeedbackInfo>::iterator innerFbItr = (fbItr->second).begin ();
-        std::advance (innerFbItr, m_feedbackIndex++ % (fbItr->second).size ()); // round robin
-
-        if ((innerFbItr->second).change == false)  // prefer the changed ones
-        {
-          for (unsigned loopIndex = 0; loopIndex < (fbItr->second).size (); loopIndex ++) // prevent infinite looping
-          {
-            if (++innerFbItr == (fbItr->second).end ()) {
-              innerFbItr = (fbItr->second).begin (); // start from the beginning
-            }
-            if ((innerFbItr->second).change == true)
-            {
-              break;
-            }
-          }
-        }
-
-        fbLbTag = innerFbItr->first;
-        fbMetric = (innerFbItr->second).ce;
-        (innerFbItr->second).change = false;
+        m_feedbackIndex++;
       }
 
       // Port determination logic:
@@ -361,56 +328,28 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       NS_LOG_LOGIC (this << " Flowlet expires, calculate the new port");
       // Not hit. Determine the port
 
-      // 1. Select port congestion information based on dest leaf switch id
-      std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t> > >::iterator
-          congaToLeafItr = m_congaToLeafTable.find (destLeafId);
-
-      // 2. Prepare the candidate port
-      // For a new flowlet, we pick the uplink port that minimizes the maximum of the local metric (from the local DREs)
-      // and the remote metric (from the Congestion-To-Leaf Table).
-      uint32_t minPortCongestion = (std::numeric_limits<uint32_t>::max)();
-
-      std::vector<uint32_t> portCandidates;
-      std::vector<CongaRouteEntry>::iterator routeEntryItr = routeEntries.begin ();
-
-      for ( ; routeEntryItr != routeEntries.end (); ++routeEntryItr)
+      // 1. Gather the candidate ports with their local metric (from the local DREs)
+      uint32_t nCandidates = routeEntries.size ();
+      m_candidatePorts.resize (nCandidates);
+      m_candidateCongestion.resize (nCandidates);
+      m_bestPorts.resize (nCandidates);
+      for (uint32_t i = 0; i < nCandidates; ++i)
       {
-        uint32_t port = (*routeEntryItr).port;
-        uint32_t localCongestion = 0;
-        uint32_t remoteCongestion = 0;
-
-        std::map<uint32_t, uint32_t>::iterator localCongestionItr = m_XMap.find (port);
-        if (localCongestionItr != m_XMap.end ())
-        {
-          localCongestion = Ipv4CongaRouting::QuantizingX (port, localCongestionItr->second);
-        }
-
-        std::map<uint32_t, std::pair<Time, uint32_t> >::iterator remoteCongestionItr =
-            (congaToLeafItr->second).find (port);
-        if (remoteCongestionItr != (congaToLeafItr->second).end ())
-        {
-          remoteCongestion = (remoteCongestionItr->second).second;
-        }
-
-        uint32_t congestionDegree = std::max (localCongestion, remoteCongestion);
-
-        if (congestionDegree < minPortCongestion)
-        {
-          // Strictly better port
-          minPortCongestion = congestionDegree;
-          portCandidates.clear();
-          portCandidates.push_back(port);
-        }
-        if (congestionDegree == minPortCongestion)
-        {
-          // Equally good port
-          portCandidates.push_back(port);
-        }
+        uint32_t port = routeEntries[i].port;
+        m_candidatePorts[i] = port;
+        m_candidateCongestion[i] = port < m_XMap.size () && m_XMap[port] != 0 ?
+            Ipv4CongaRouting::QuantizingX (port, m_XMap[port]) : 0;
       }
 
+      // 2. For a new flowlet, we pick the uplink port that minimizes the maximum of the local metric
+      // and the remote metric (from the Congestion-To-Leaf Table).
+      uint32_t nBest = m_congestionTable.SelectBestPorts (destLeafId, &m_candidatePorts[0],
+                                                          &m_candidateCongestion[0], nCandidates,
+                                                          &m_bestPorts[0]);
+
       // 3. Select one port from all those candidate ports
       if (flowlet != NULL &&
-            std::find(portCandidates.begin (), portCandidates.end (), flowlet->port) != portCandidates.end ())
+            std::find(m_bestPorts.begin (), m_bestPorts.begin () + nBest, flowlet->port) != m_bestPorts.begin () + nBest)
       {
         // Prefer the port cached in flowlet table
         selectedPort = flowlet->port;
@@ -420,7 +359,7 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       else
       {
         // If there are no cached ports, we randomly choose a good port
-        selectedPort = portCandidates[rand() % portCandidates.size ()];
+        selectedPort = m_bestPorts[rand() % nBest];
         if (flowlet == NULL)
         {
           struct Flowlet *newFlowlet = new Flowlet;
@@ -474,54 +413,12 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       uint32_t sourceLeafId = itr->second;
 
       // 1. Update the CongaFromLeafTable
-      std::map<uint32_t, std::map<uint32_t, FeedbackInfo> >::iterator fromLeafItr = m_congaFromLeafTable.find (sourceLeafId);
-
-      if (fromLeafItr == m_congaFromLeafTable.end ())
-      {
-        std::map<uint32_t, FeedbackInfo> newMap;
-        FeedbackInfo feedbackInfo;
-        feedbackInfo.ce = ipv4CongaTag.GetCe ();
-        feedbackInfo.change = true;
-        feedbackInfo.updateTime = Simulator::Now ();
-        newMap[ipv4CongaTag.GetLbTag ()] = feedbackInfo;
-        m_congaFromLeafTable[sourceLeafId] = newMap;
-      }
-      else
-      {
-        std::map<uint32_t, FeedbackInfo>::iterator innerItr = (fromLeafItr->second).find (ipv4CongaTag.GetLbTag ());
-        if (innerItr == (fromLeafItr->second).end ())
-        {
-          FeedbackInfo feedbackInfo;
-          feedbackInfo.ce = ipv4CongaTag.GetCe ();
-          feedbackInfo.change = true;
-          feedbackInfo.updateTime = Simulator::Now ();
-          (fromLeafItr->second)[ipv4CongaTag.GetLbTag ()] = feedbackInfo;
-        }
-        else
-        {
-          (innerItr->second).ce = ipv4CongaTag.GetCe ();
-          (innerItr->second).change = true;
-          (innerItr->second).updateTime = Simulator::Now ();
-        }
-      }
+      m_congestionTable.SetFromLeaf (sourceLeafId, ipv4CongaTag.GetLbTag (), ipv4CongaTag.GetCe (), Simulator::Now ());
 
       // 2. Update the CongaToLeafTable
       if (ipv4CongaTag.GetFbLbTag () != LOOPBACK_PORT)
       {
-        std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t> > >::iterator toLeafItr =
-            m_congaToLeafTable.find(sourceLeafId);
-        if (toLeafItr != m_congaToLeafTable.end ())
-        {
-          (toLeafItr->second)[ipv4CongaTag.GetFbLbTag ()] =
-              std::make_pair(Simulator::Now (), ipv4CongaTag.GetFbMetric ());
-        }
-        else
-        {
-          std::map<uint32_t, std::pair<Time, uint32_t> > newMap;
-          newMap[ipv4CongaTag.GetFbLbTag ()] =
-              std::make_pair(Simulator::Now (), ipv4CongaTag.GetFbMetric ());
-          m_congaToLeafTable[sourceLeafId] = newMap;
-        }
+        m_congestionTable.SetToLeaf (sourceLeafId, ipv4CongaTag.GetFbLbTag (), ipv4CongaTag.GetFbMetric (), Simulator::Now ());
       }
 
       // Not necessary
@@ -634,13 +531,11 @@ Ipv4CongaRouting::DoDispose (void)
 uint32_t
 Ipv4CongaRouting::UpdateLocalDre (const Ipv4Header &header, Ptr<Packet> packet, uint32_t port)
 {
-  uint32_t X = 0;
-  std::map<uint32_t, uint32_t>::iterator XItr = m_XMap.find(port);
-  if (XItr != m_XMap.end ())
+  if (port >= m_XMap.size ())
   {
-    X = XItr->second;
+    m_XMap.resize (port + 1, 0);
   }
-  uint32_t newX = X + packet->GetSize () + header.GetSerializedSize ();
+  uint32_t newX = m_XMap[port] + packet->GetSize () + header.GetSerializedSize ();
   NS_LOG_LOGIC (this << " Update local dre, new X: " << newX);
   m_XMap[port] = newX;
   return newX;
@@ -651,11 +546,11 @@ Ipv4CongaRouting::DreEvent ()
 {
   bool moveToIdleStatus = true;
 
-  std::map<uint32_t, uint32_t>::iterator itr = m_XMap.begin ();
+  std::vector<uint32_t>::iterator itr = m_XMap.begin ();
   for ( ; itr != m_XMap.end (); ++itr )
   {
-    uint32_t newX = itr->second * (1 - m_alpha);
-    itr->second = newX;
+    uint32_t newX = *itr * (1 - m_alpha);
+    *itr = newX;
     if (newX != 0)
     {
       moveToIdleStatus = false;
@@ -678,48 +573,7 @@ Ipv4CongaRouting::DreEvent ()
 void
 Ipv4CongaRouting::AgingEvent ()
 {
-    bool moveToIdleStatus = true;
-    std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t> > >::iterator itr =
-        m_congaToLeafTable.begin ();
-    for ( ; itr != m_congaToLeafTable.end (); ++itr)
-    {
-      std::map<uint32_t, std::pair<Time, uint32_t> >::iterator innerItr =
-        (itr->second).begin ();
-      for (; innerItr != (itr->second).end (); ++innerItr)
-      {
-        if (Simulator::Now () - (innerItr->second).first > m_agingTime)
-        {
-          (innerItr->second).second = 0;
-        }
-        else
-        {
-          moveToIdleStatus = false;
-        }
-      }
-    }
-    std::map<uint32_t, std::map<uint32_t, FeedbackInfo> >::iterator itr2 =
-        m_congaFromLeafTable.begin ();
-    for ( ; itr2 != m_congaFromLeafTable.end (); ++itr2 )
-    {
-        std::map<uint32_t, FeedbackInfo>::iterator innerItr2 =
-          (itr2->second).begin ();
-        for ( ; innerItr2 != (itr2->second).end (); ++innerItr2)
-        {
-          if (Simulator::Now () - (innerItr2->second).updateTime > m_agingTime)
-          {
-            (itr2->second).erase (innerItr2);
-            if ((itr2->second).empty ())
-            {
-                m_congaFromLeafTable.erase (itr2);
-            }
-          }
-          else
-          {
-            moveToIdleStatus = false;
-          }
-        }
-    }
-
+    bool moveToIdleStatus = !m_congestionTable.Age (Simulator::Now (), m_agingTime);
 
     if (!moveToIdleStatus)
     {
@@ -751,15 +605,13 @@ Ipv4CongaRouting::PrintCongaToLeafTable ()
 /*
   std::ostringstream oss;
   oss << "===== CongaToLeafTable For Leaf: " << m_leafId <<"=====" << std::endl;
-  std::map<uint32_t, std::map<uint32_t, uint32_t> >::iterator itr = m_congaToLeafTable.begin ();
-  for ( ; itr != m_congaToLeafTable.end (); ++itr )
+  for (uint32_t leaf = 0; leaf < m_congestionTable.GetNLeaves (); ++leaf)
   {
-    oss << "Leaf ID: " << itr->first << std::endl<<"\t";
-    std::map<uint32_t, uint32_t>::iterator innerItr = (itr->second).begin ();
-    for ( ; innerItr != (itr->second).end (); ++innerItr)
+    oss << "Leaf ID: " << leaf << std::endl<<"\t";
+    for (uint32_t port = 0; port < m_congestionTable.GetNPorts (); ++port)
     {
       oss << "{ port: "
-          << innerItr->first << ", ce: "  << (innerItr->second)
+          << port << ", ce: "  << m_congestionTable.GetToLeaf (leaf, port)
           << " } ";
     }
     oss << std::endl;
@@ -775,19 +627,9 @@ Ipv4CongaRouting::PrintCongaFromLeafTable ()
 /*
   std::ostringstream oss;
   oss << "===== CongaFromLeafTable For Leaf: " << m_leafId << "=====" <<std::endl;
-  std::map<uint32_t, std::map<uint32_t, FeedbackInfo> >::iterator itr = m_congaFromLeafTable.begin ();
-  for ( ; itr != m_congaFromLeafTable.end (); ++itr )
+  for (uint32_t leaf = 0; leaf < m_congestionTable.GetNLeaves (); ++leaf)
   {
-    oss << "Leaf ID: " << itr->first << std::endl << "\t";
-    std::map<uint32_t, FeedbackInfo>::iterator innerItr = (itr->second).begin ();
-    for ( ; innerItr != (itr->second).end (); ++innerItr)
-    {
-      oss << "{ port: "
-          << innerItr->first << ", ce: "  << (innerItr->second).ce
-          << ", change: " << (innerItr->second).change
-          << " } ";
-    }
-    oss << std::endl;
+    oss << "Leaf ID: " << leaf << ", " << m_congestionTable.GetNFromLeaf (leaf) << " entries" << std::endl;
   }
   oss << "==============================";
   NS_LOG_LOGIC (oss.str ());
@@ -819,12 +661,11 @@ Ipv4CongaRouting::PrintDreTable ()
   std::ostringstream oss;
   std::string switchType = m_isLeaf == true ? "leaf switch" : "spine switch";
   oss << "==== Local Dre for " << switchType << " ====" <<std::endl;
-  std::map<uint32_t, uint32_t>::iterator itr = m_XMap.begin ();
-  for ( ; itr != m_XMap.end (); ++itr)
+  for (uint32_t port = 0; port < m_XMap.size (); ++port)
   {
-    oss << "port: " << itr->first <<
-      ", X: " << itr->second <<
-      ", Quantized X: " << Ipv4CongaRouting::QuantizingX (itr->second) <<std::endl;
+    oss << "port: " << port <<
+      ", X: " << m_XMap[port] <<
+      ", Quantized X: " << Ipv4CongaRouting::QuantizingX (port, m_XMap[port]) <<std::endl;
   }
   oss << "=================================";
   NS_LOG_LOGIC (oss.str ());
@@ -10,6 +10,7 @@
 #include "ns3/data-rate.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
+#include "conga-congestion-table.h"
 
 #include <map>
 #include <vector>
@@ -21,12 +22,6 @@ struct Flowlet {
   Time activeTime;
 };
 
-struct FeedbackInfo {
-  uint32_t ce;
-  bool change;
-  Time updateTime;
-};
-
 struct CongaRouteEntry {
   Ipv4Address network;
   Ipv4Mask networkMask;
@@ -126,18 +121,20 @@ private:
   // used to determine the which leaf switch the packet would go through
   std::map<Ipv4Address, uint32_t> m_ipLeafIdMap;
 
-  // Congestion To Leaf Table
-  std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t> > > m_congaToLeafTable;
-
-  // Congestion From Leaf Table
-  std::map<uint32_t, std::map<uint32_t, FeedbackInfo> > m_congaFromLeafTable;
+  // Congestion To Leaf and Congestion From Leaf Tables
+  CongaCongestionTable m_congestionTable;
 
   // Flowlet Table
   std::map<uint32_t, Flowlet *> m_flowletTable;
 
   // Parameters
-  // DRE
-  std::map<uint32_t, uint32_t> m_XMap;
+  // DRE, indexed by port
+  std::vector<uint32_t> m_XMap;
+
+  // Scratch buffers of the port selection
+  std::vector<uint32_t> m_candidatePorts;
+  std::vector<uint32_t> m_candidateCongestion;
+  std::vector<uint32_t> m_bestPorts;
 
   // ------ Functions ------
   // DRE algorithm
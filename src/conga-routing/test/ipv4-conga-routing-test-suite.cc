@@ -2,6 +2,7 @@
 
 // Include a header file from your module to test.
 #include "ns3/ipv4-conga-routing.h"
+#include "ns3/conga-congestion-table.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -46,6 +47,82 @@ Ipv4CongaRoutingTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// Check the dense congestion tables used by the leaf switches
+class CongaCongestionTableTestCase : public TestCase
+{
+public:
+  CongaCongestionTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CongaCongestionTableTestCase::CongaCongestionTableTestCase ()
+  : TestCase ("Check the Congestion-To-Leaf and Congestion-From-Leaf tables")
+{
+}
+
+void
+CongaCongestionTableTestCase::DoRun (void)
+{
+  CongaCongestionTable table;
+
+  // Unknown entries have no congestion
+  NS_TEST_ASSERT_MSG_EQ (table.GetToLeaf (3, 2), 0, "Unknown path should not be congested");
+
+  table.SetToLeaf (1, 2, 5, Seconds (0));
+  table.SetToLeaf (1, 3, 2, Seconds (0));
+  // Growing the table keeps the entries
+  table.SetToLeaf (7, 9, 4, Seconds (0));
+  NS_TEST_ASSERT_MSG_EQ (table.GetNLeaves (), 8, "Table not grown to the leaf id");
+  NS_TEST_ASSERT_MSG_EQ (table.GetNPorts (), 10, "Table not grown to the port");
+  NS_TEST_ASSERT_MSG_EQ (table.GetToLeaf (1, 2), 5, "Entry lost when growing the table");
+  NS_TEST_ASSERT_MSG_EQ (table.GetToLeaf (1, 3), 2, "Entry lost when growing the table");
+  NS_TEST_ASSERT_MSG_EQ (table.GetToLeaf (7, 9), 4, "Wrong entry");
+
+  // Best ports minimize max (local, remote)
+  uint32_t ports[] = { 1, 2, 3, 4 };
+  uint32_t local[] = { 3, 1, 1, 2 };
+  uint32_t best[4];
+  uint32_t nBest = table.SelectBestPorts (1, ports, local, 4, best);
+  NS_TEST_ASSERT_MSG_EQ (nBest, 2, "Wrong number of best ports");
+  NS_TEST_ASSERT_MSG_EQ (best[0], 3, "Wrong best port");
+  NS_TEST_ASSERT_MSG_EQ (best[1], 4, "Wrong best port");
+  // Towards an unknown leaf only the local metric counts
+  nBest = table.SelectBestPorts (20, ports, local, 4, best);
+  NS_TEST_ASSERT_MSG_EQ (nBest, 2, "Wrong number of best ports to an unknown leaf");
+  NS_TEST_ASSERT_MSG_EQ (best[0], 2, "Wrong best port to an unknown leaf");
+  NS_TEST_ASSERT_MSG_EQ (best[1], 3, "Wrong best port to an unknown leaf");
+
+  // Feedback is round robin, preferring the changed entries
+  uint32_t port;
+  uint32_t ce;
+  NS_TEST_ASSERT_MSG_EQ (table.PickFeedback (2, 0, port, ce), false, "Nothing to feed back");
+  table.SetFromLeaf (2, 1, 10, Seconds (0));
+  table.SetFromLeaf (2, 4, 40, Seconds (0));
+  table.SetFromLeaf (2, 6, 60, MilliSeconds (8));
+  NS_TEST_ASSERT_MSG_EQ (table.GetNFromLeaf (2), 3, "Wrong number of feedback entries");
+  NS_TEST_ASSERT_MSG_EQ (table.PickFeedback (2, 1, port, ce), true, "Feedback expected");
+  NS_TEST_ASSERT_MSG_EQ (port, 4, "Wrong round robin feedback");
+  NS_TEST_ASSERT_MSG_EQ (ce, 40, "Wrong feedback metric");
+  // Port 4 is unchanged now, the next changed entry is port 6
+  table.PickFeedback (2, 1, port, ce);
+  NS_TEST_ASSERT_MSG_EQ (port, 6, "Changed entry not preferred");
+  table.PickFeedback (2, 1, port, ce);
+  NS_TEST_ASSERT_MSG_EQ (port, 1, "Changed entry not preferred after wrapping");
+  // Nothing changed: plain round robin
+  table.PickFeedback (2, 2, port, ce);
+  NS_TEST_ASSERT_MSG_EQ (port, 6, "Wrong round robin feedback");
+
+  // Aging resets the remote metrics and forgets the old feedback
+  NS_TEST_ASSERT_MSG_EQ (table.Age (MilliSeconds (15), MilliSeconds (10)), true, "Fresh entry expected");
+  NS_TEST_ASSERT_MSG_EQ (table.GetToLeaf (1, 2), 0, "Remote metric not aged");
+  NS_TEST_ASSERT_MSG_EQ (table.GetNFromLeaf (2), 1, "Feedback not aged");
+  NS_TEST_ASSERT_MSG_EQ (table.HasFromLeaf (2, 6), true, "Fresh feedback aged");
+  NS_TEST_ASSERT_MSG_EQ (table.Age (MilliSeconds (30), MilliSeconds (10)), false, "No fresh entry expected");
+  NS_TEST_ASSERT_MSG_EQ (table.GetNFromLeaf (2), 0, "Feedback not aged");
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +138,7 @@ CongaRoutingTestSuite::CongaRoutingTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new Ipv4CongaRoutingTestCase1, TestCase::QUICK);
+  AddTestCase (new CongaCongestionTableTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -25,7 +25,7 @@
  * \file
  * \ingroup debugging
  * Definition of build profile macros NS_BUILD_DEBUG, NS_BUILD_RELEASE,
- * and NS_BUILD_OPTIMIZED.
+ * NS_BUILD_OPTIMIZED and NS_BUILD_FAST.
  */
 
 /**
@@ -87,6 +87,17 @@
 #define NS_BUILD_OPTIMIZED(code) NS_BUILD_PROFILE_NOOP (code)
 #endif
 
+#ifdef NS3_BUILD_PROFILE_FAST
+/**
+ * \ingroup debugging
+ * Execute a code snippet in fast builds.
+ * \param [in] code The code to execute.
+ */
+#define NS_BUILD_FAST(code)      NS_BUILD_PROFILE_OP (code)
+#else
+#define NS_BUILD_FAST(code)      NS_BUILD_PROFILE_NOOP (code)
+#endif
+
 
 
 
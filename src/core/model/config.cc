@@ -24,9 +24,15 @@
 #include "object-ptr-container.h"
 #include "names.h"
 #include "pointer.h"
+#include "simulator.h"
+#include "simple-ref-count.h"
+#include "trace-source-accessor.h"
 #include "log.h"
 
 #include <sstream>
+#include <map>
+#include <set>
+#include <limits>
 
 /**
  * \file
@@ -166,6 +172,13 @@ public:
    * \returns \c true if the index matches the Config Path.
    */
   bool Matches (uint32_t i) const;
+  /**
+   * Get the indexes matching the Config Path.
+   *
+   * \param [in,out] ranges The intervals of the matching indexes,
+   *        bounds included, appended in the order Matches() tests them.
+   */
+  void GetRanges (std::vector<std::pair<uint32_t, uint32_t> > *ranges) const;
 private:
   /**
    * Convert a string to an \c uint32_t.
@@ -249,6 +262,50 @@ ArrayMatcher::Matches (uint32_t i) const
   return false;
 }
 
+void
+ArrayMatcher::GetRanges (std::vector<std::pair<uint32_t, uint32_t> > *ranges) const
+{
+  NS_LOG_FUNCTION (this << ranges);
+  if (m_element == "*")
+    {
+      ranges->push_back (std::make_pair (0, std::numeric_limits<uint32_t>::max ()));
+      return;
+    }
+  std::string::size_type tmp;
+  tmp = m_element.find ("|");
+  if (tmp != std::string::npos)
+    {
+      std::string left = m_element.substr (0, tmp-0);
+      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
+      ArrayMatcher (left).GetRanges (ranges);
+      ArrayMatcher (right).GetRanges (ranges);
+      return;
+    }
+  std::string::size_type leftBracket = m_element.find ("[");
+  std::string::size_type rightBracket = m_element.find ("]");
+  std::string::size_type dash = m_element.find ("-");
+  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+      dash > leftBracket && dash < rightBracket)
+    {
+      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      uint32_t min;
+      uint32_t max;
+      if (StringToUint32 (lowerBound, &min) && 
+          StringToUint32 (upperBound, &max) &&
+          min <= max)
+        {
+          ranges->push_back (std::make_pair (min, max));
+        }
+      return;
+    }
+  uint32_t value;
+  if (StringToUint32 (m_element, &value))
+    {
+      ranges->push_back (std::make_pair (value, value));
+    }
+}
+
 bool
 ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
 {
@@ -572,10 +629,435 @@ Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &conta
     }
 }
 
+/**
+ * The parsed path of a Config::CompiledPath and its caches.
+ *
+ * The resolution follows Resolver::DoResolve, with the path already
+ * split, the array indexes parsed and the TypeId names looked up, and
+ * with the pointer and vector attributes matching each element cached
+ * per TypeId.
+ */
+class CompiledPathImpl : public SimpleRefCount<CompiledPathImpl>
+{
+public:
+  /**
+   * Parse a path.
+   *
+   * \param [in] path The Config path.
+   */
+  CompiledPathImpl (std::string path);
+
+  /**
+   * \returns The Config path, with a leading slash.
+   */
+  std::string GetPath (void) const;
+  /**
+   * Find the objects matching the path below the Config roots.
+   *
+   * \param [in] root A Config root.
+   * \param [in,out] objects The objects found.
+   * \param [in,out] contexts The matched paths of the objects found.
+   */
+  void Resolve (Ptr<Object> root, std::vector<Ptr<Object> > &objects,
+                std::vector<std::string> &contexts);
+  /**
+   * Check whether the matched path of an object matches the start of
+   * the path.
+   *
+   * \param [in] context The matched path of the object.
+   * \param [out] n The number of elements of the path matched.
+   * \returns \c true if \p context matches the start of the path.
+   */
+  bool MatchContext (std::string context, uint32_t *n) const;
+  /**
+   * Find the objects matching the end of the path below an object.
+   *
+   * \param [in] i The first element of the path to match.
+   * \param [in] object The object.
+   * \param [in] context The matched path of the object, ending with a slash.
+   * \param [in,out] objects The objects found.
+   * \param [in,out] contexts The matched paths of the objects found.
+   */
+  void Resolve (uint32_t i, Ptr<Object> object, std::string context,
+                std::vector<Ptr<Object> > &objects, std::vector<std::string> &contexts);
+  /**
+   * Look up a trace source.
+   *
+   * \param [in] tid The TypeId of an object.
+   * \param [in] name The name of the trace source.
+   * \returns The accessor of the trace source, 0 if there is none.
+   */
+  Ptr<const TraceSourceAccessor> LookupTraceSource (TypeId tid, std::string name);
+
+private:
+  /** A pointer or vector attribute matching an element of the path. */
+  struct Attribute
+  {
+    std::string name;                           //!< The name of the attribute
+    uint32_t flags;                             //!< The flags of the attribute
+    Ptr<const AttributeAccessor> accessor;      //!< The accessor of the attribute
+    bool isVector;                              //!< Whether it is a vector of objects
+  };
+  /** The attributes of a TypeId matching an element, derived first. */
+  typedef std::vector<Attribute> Attributes;
+
+  /** An element of the path. */
+  struct Element
+  {
+    std::string item;                           //!< The element as written
+    bool isGetObject;                           //!< Whether the element is a $TypeId
+    bool isValidTid;                            //!< Whether the TypeId exists
+    TypeId tid;                                 //!< The TypeId of a $TypeId element
+    /** The intervals of the array indexes matched by the element. */
+    std::vector<std::pair<uint32_t, uint32_t> > ranges;
+    /** The attributes matching the element, by TypeId uid. */
+    std::map<uint16_t, Attributes> attributes;
+  };
+
+  /**
+   * \param [in] element An element of the path.
+   * \param [in] index An array index.
+   * \returns \c true if the element matches the index.
+   */
+  static bool MatchIndex (const Element &element, uint32_t index);
+  /**
+   * Get the pointer and vector attributes of a TypeId matching an element.
+   *
+   * \param [in] element The element.
+   * \param [in] tid The TypeId.
+   * \returns The attributes.
+   */
+  const Attributes &GetAttributes (Element &element, TypeId tid);
+  /**
+   * Drop the cached attributes when attributes have been added.
+   */
+  void CheckGeneration (void);
+  /**
+   * Match the elements of the path from an object.
+   *
+   * \param [in] i The first element to match.
+   * \param [in] root The object.
+   * \param [in,out] context The matched path of the object.
+   * \param [in,out] objects The objects found.
+   * \param [in,out] contexts The matched paths of the objects found.
+   */
+  void DoResolve (uint32_t i, Ptr<Object> root, std::string &context,
+                  std::vector<Ptr<Object> > &objects, std::vector<std::string> &contexts);
+  /**
+   * Match the elements of the path from the objects of a vector.
+   *
+   * \param [in] i The element matching the array index.
+   * \param [in] container The vector.
+   * \param [in,out] context The matched path of the vector.
+   * \param [in,out] objects The objects found.
+   * \param [in,out] contexts The matched paths of the objects found.
+   */
+  void DoArrayResolve (uint32_t i, const ObjectPtrContainerValue &container, std::string &context,
+                       std::vector<Ptr<Object> > &objects, std::vector<std::string> &contexts);
+
+  std::string m_path;                           //!< The Config path
+  std::vector<Element> m_elements;              //!< The elements of the path
+  uint32_t m_generation;                        //!< The attribute generation of the caches
+  /** The trace sources connected, by TypeId uid and name. */
+  std::map<std::pair<uint16_t, std::string>, Ptr<const TraceSourceAccessor> > m_traceSources;
+};
+
+CompiledPathImpl::CompiledPathImpl (std::string path)
+  : m_path (path),
+    m_generation (TypeId::GetAttributeGeneration ())
+{
+  NS_LOG_FUNCTION (this << path);
+  if (m_path.find ("/") != 0)
+    {
+      m_path = "/" + m_path;
+    }
+  std::string::size_type start = 1;
+  while (start <= m_path.size ())
+    {
+      std::string::size_type next = m_path.find ("/", start);
+      if (next == std::string::npos)
+        {
+          next = m_path.size ();
+        }
+      if (next == m_path.size () && next == start)
+        {
+          // trailing slash
+          break;
+        }
+      Element element;
+      element.item = m_path.substr (start, next - start);
+      element.isGetObject = element.item.find ("$") == 0;
+      element.isValidTid = element.isGetObject
+        && TypeId::LookupByNameFailSafe (element.item.substr (1), &element.tid);
+      ArrayMatcher (element.item).GetRanges (&element.ranges);
+      m_elements.push_back (element);
+      start = next + 1;
+    }
+}
+
+std::string
+CompiledPathImpl::GetPath (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_path;
+}
+
+void
+CompiledPathImpl::CheckGeneration (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t generation = TypeId::GetAttributeGeneration ();
+  if (generation != m_generation)
+    {
+      for (std::vector<Element>::iterator i = m_elements.begin (); i != m_elements.end (); ++i)
+        {
+          i->attributes.clear ();
+        }
+      m_traceSources.clear ();
+      m_generation = generation;
+    }
+}
+
+bool
+CompiledPathImpl::MatchIndex (const Element &element, uint32_t index)
+{
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator i = element.ranges.begin ();
+       i != element.ranges.end (); ++i)
+    {
+      if (index >= i->first && index <= i->second)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+const CompiledPathImpl::Attributes &
+CompiledPathImpl::GetAttributes (Element &element, TypeId tid)
+{
+  NS_LOG_FUNCTION (this << element.item << tid);
+  std::map<uint16_t, Attributes>::iterator found = element.attributes.find (tid.GetUid ());
+  if (found != element.attributes.end ())
+    {
+      return found->second;
+    }
+  Attributes &attributes = element.attributes[tid.GetUid ()];
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          if (info.name != element.item && element.item != "*")
+            {
+              continue;
+            }
+          Attribute attribute;
+          attribute.name = info.name;
+          attribute.flags = info.flags;
+          attribute.accessor = info.accessor;
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.isVector = false;
+              attributes.push_back (attribute);
+            }
+          else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.isVector = true;
+              attributes.push_back (attribute);
+            }
+        }
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+  return attributes;
+}
+
+void
+CompiledPathImpl::Resolve (Ptr<Object> root, std::vector<Ptr<Object> > &objects,
+                           std::vector<std::string> &contexts)
+{
+  NS_LOG_FUNCTION (this << root);
+  Resolve (0, root, "/", objects, contexts);
+}
+
+void
+CompiledPathImpl::Resolve (uint32_t i, Ptr<Object> object, std::string context,
+                           std::vector<Ptr<Object> > &objects, std::vector<std::string> &contexts)
+{
+  NS_LOG_FUNCTION (this << i << object << context);
+  CheckGeneration ();
+  DoResolve (i, object, context, objects, contexts);
+}
+
+void
+CompiledPathImpl::DoResolve (uint32_t i, Ptr<Object> root, std::string &context,
+                             std::vector<Ptr<Object> > &objects, std::vector<std::string> &contexts)
+{
+  NS_LOG_FUNCTION (this << i << root << context);
+  if (i == m_elements.size ())
+    {
+      objects.push_back (root);
+      contexts.push_back (context);
+      return;
+    }
+  Element &element = m_elements[i];
+  std::string::size_type length = context.size ();
+
+  // named objects come first, as in Resolver::DoResolve
+  Ptr<Object> namedObject = Names::Find<Object> (root, element.item);
+  if (namedObject)
+    {
+      NS_LOG_DEBUG ("Name system resolved item = " << element.item << " to " << namedObject);
+      context += element.item + "/";
+      DoResolve (i + 1, namedObject, context, objects, contexts);
+      context.resize (length);
+      return;
+    }
+
+  if (element.isGetObject)
+    {
+      if (!element.isValidTid)
+        {
+          // fails like Resolver::DoResolve
+          element.tid = TypeId::LookupByName (element.item.substr (1));
+        }
+      Ptr<Object> object = root->GetObject<Object> (element.tid);
+      if (object == 0)
+        {
+          NS_LOG_DEBUG ("GetObject (" << element.tid.GetName () << ") failed on path=" << context);
+          return;
+        }
+      context += element.item + "/";
+      DoResolve (i + 1, object, context, objects, contexts);
+      context.resize (length);
+      return;
+    }
+
+  const Attributes &attributes = GetAttributes (element, root->GetInstanceTypeId ());
+  for (Attributes::const_iterator j = attributes.begin (); j != attributes.end (); ++j)
+    {
+      if (!(j->flags & TypeId::ATTR_GET) || !j->accessor->HasGetter ())
+        {
+          NS_FATAL_ERROR ("Attribute name=" << j->name << " is not gettable for this object: tid=" <<
+                          root->GetInstanceTypeId ().GetName ());
+        }
+      if (!j->isVector)
+        {
+          PointerValue ptr;
+          if (!j->accessor->Get (PeekPointer (root), ptr))
+            {
+              root->GetAttribute (j->name, ptr);
+            }
+          Ptr<Object> object = ptr.Get<Object> ();
+          if (object == 0)
+            {
+              NS_LOG_ERROR ("Requested object name=\"" << element.item <<
+                            "\" exists on path=\"" << context << "\""
+                            " but is null.");
+              continue;
+            }
+          context += j->name + "/";
+          DoResolve (i + 1, object, context, objects, contexts);
+          context.resize (length);
+        }
+      else
+        {
+          ObjectPtrContainerValue vector;
+          if (!j->accessor->Get (PeekPointer (root), vector))
+            {
+              root->GetAttribute (j->name, vector);
+            }
+          context += j->name + "/";
+          DoArrayResolve (i + 1, vector, context, objects, contexts);
+          context.resize (length);
+        }
+    }
+}
+
+void
+CompiledPathImpl::DoArrayResolve (uint32_t i, const ObjectPtrContainerValue &container, std::string &context,
+                                  std::vector<Ptr<Object> > &objects, std::vector<std::string> &contexts)
+{
+  NS_LOG_FUNCTION (this << i << &container << context);
+  if (i == m_elements.size ())
+    {
+      return;
+    }
+  const Element &element = m_elements[i];
+  std::string::size_type length = context.size ();
+  for (ObjectPtrContainerValue::Iterator it = container.Begin (); it != container.End (); ++it)
+    {
+      if (MatchIndex (element, it->first))
+        {
+          std::ostringstream oss;
+          oss << it->first << "/";
+          context += oss.str ();
+          DoResolve (i + 1, it->second, context, objects, contexts);
+          context.resize (length);
+        }
+    }
+}
+
+bool
+CompiledPathImpl::MatchContext (std::string context, uint32_t *n) const
+{
+  NS_LOG_FUNCTION (this << context);
+  uint32_t i = 0;
+  std::string::size_type start = 1;
+  while (start < context.size ())
+    {
+      std::string::size_type next = context.find ("/", start);
+      if (next == std::string::npos)
+        {
+          next = context.size ();
+        }
+      if (i == m_elements.size ())
+        {
+          return false;
+        }
+      std::string segment = context.substr (start, next - start);
+      const Element &element = m_elements[i];
+      if (element.item != segment && element.item != "*")
+        {
+          std::istringstream iss (segment);
+          uint32_t index;
+          iss >> index;
+          if (element.isGetObject || iss.fail () || !MatchIndex (element, index))
+            {
+              return false;
+            }
+        }
+      i++;
+      start = next + 1;
+    }
+  *n = i;
+  return true;
+}
+
+Ptr<const TraceSourceAccessor>
+CompiledPathImpl::LookupTraceSource (TypeId tid, std::string name)
+{
+  NS_LOG_FUNCTION (this << tid << name);
+  CheckGeneration ();
+  std::pair<uint16_t, std::string> key = std::make_pair (tid.GetUid (), name);
+  std::map<std::pair<uint16_t, std::string>, Ptr<const TraceSourceAccessor> >::iterator found =
+    m_traceSources.find (key);
+  if (found != m_traceSources.end ())
+    {
+      return found->second;
+    }
+  Ptr<const TraceSourceAccessor> accessor = tid.LookupTraceSourceByName (name);
+  m_traceSources[key] = accessor;
+  return accessor;
+}
+
 /** Config system implementation class. */
 class ConfigImpl : public Singleton<ConfigImpl>
 {
 public:
+  ConfigImpl ();
+
   /** \copydoc Config::Set() */
   void Set (std::string path, const AttributeValue &value);
   /** \copydoc Config::ConnectWithoutContext() */
@@ -599,7 +1081,58 @@ public:
   /** \copydoc Config::GetRootNamespaceObject() */
   Ptr<Object> GetRootNamespaceObject (uint32_t i) const;
 
+  /**
+   * Keep a sink to connect to the objects added later.
+   *
+   * \param [in] path The path of the objects.
+   * \param [in] name The name of the trace source to connect to.
+   * \param [in] cb The sink to connect to the trace source.
+   * \param [in] withContext Whether the sink takes the context.
+   */
+  void Subscribe (Config::CompiledPath path, std::string name,
+                  const CallbackBase &cb, bool withContext);
+  /** \copydoc Config::HasSubscriptions() */
+  bool HasSubscriptions (void) const;
+  /** \copydoc Config::NotifyObjectAdded() */
+  void NotifyObjectAdded (std::string context, Ptr<Object> object);
+
 private:
+  /** A sink connected to the objects added later. */
+  struct Subscription
+  {
+    Config::CompiledPath path;          //!< The path of the objects
+    std::string name;                   //!< The name of the trace source
+    CallbackBase cb;                    //!< The sink
+    bool withContext;                   //!< Whether the sink takes the context
+  };
+  /** A new object to connect to a subscription. */
+  struct PendingObject
+  {
+    uint32_t subscription;              //!< The index of the subscription
+    std::string context;                //!< The matched path of the object
+    Ptr<Object> object;                 //!< The object
+  };
+
+  /**
+   * Connect the subscriptions to the objects added since the last call.
+   *
+   * An object whose matched path is below the matched path of another
+   * new object of the same subscription is skipped, since it is found
+   * again below that object.
+   */
+  void ConnectPendingObjects (void);
+  /** Drop the subscriptions, when the simulation is destroyed. */
+  void ClearSubscriptions (void);
+
+  /** The subscriptions. */
+  std::vector<Subscription> m_subscriptions;
+  /** The new objects to connect. */
+  std::vector<PendingObject> m_pending;
+  /** Whether ConnectPendingObjects is scheduled. */
+  bool m_pendingScheduled;
+  /** Whether ClearSubscriptions is scheduled for Simulator::Destroy. */
+  bool m_clearScheduled;
+
   /**
    * Break a Config path into the leading path and the last leaf token.
    * \param [in] path The Config path.
@@ -616,6 +1149,13 @@ private:
   Roots m_roots;
 };
 
+ConfigImpl::ConfigImpl ()
+  : m_pendingScheduled (false),
+    m_clearScheduled (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
 void 
 ConfigImpl::ParsePath (std::string path, std::string *root, std::string *leaf) const
 {
@@ -744,6 +1284,101 @@ ConfigImpl::GetRootNamespaceObject (uint32_t i) const
   return m_roots[i];
 }
 
+void
+ConfigImpl::Subscribe (Config::CompiledPath path, std::string name,
+                       const CallbackBase &cb, bool withContext)
+{
+  NS_LOG_FUNCTION (this << path.GetPath () << name << &cb << withContext);
+  Subscription subscription;
+  subscription.path = path;
+  subscription.name = name;
+  subscription.cb = cb;
+  subscription.withContext = withContext;
+  m_subscriptions.push_back (subscription);
+  if (!m_clearScheduled)
+    {
+      Simulator::ScheduleDestroy (&ConfigImpl::ClearSubscriptions, this);
+      m_clearScheduled = true;
+    }
+}
+
+bool
+ConfigImpl::HasSubscriptions (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return !m_subscriptions.empty ();
+}
+
+void
+ConfigImpl::NotifyObjectAdded (std::string context, Ptr<Object> object)
+{
+  NS_LOG_FUNCTION (this << context << object);
+  for (uint32_t i = 0; i < m_subscriptions.size (); i++)
+    {
+      uint32_t n;
+      if (m_subscriptions[i].path.m_impl->MatchContext (context, &n))
+        {
+          PendingObject pending;
+          pending.subscription = i;
+          pending.context = context;
+          pending.object = object;
+          m_pending.push_back (pending);
+        }
+    }
+  if (!m_pending.empty () && !m_pendingScheduled)
+    {
+      Simulator::ScheduleNow (&ConfigImpl::ConnectPendingObjects, this);
+      m_pendingScheduled = true;
+    }
+}
+
+void
+ConfigImpl::ConnectPendingObjects (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<PendingObject> pending;
+  pending.swap (m_pending);
+  m_pendingScheduled = false;
+
+  std::set<std::pair<uint32_t, std::string> > contexts;
+  for (std::vector<PendingObject>::const_iterator i = pending.begin (); i != pending.end (); ++i)
+    {
+      contexts.insert (std::make_pair (i->subscription, i->context));
+    }
+  std::set<std::pair<uint32_t, std::string> > done;
+  for (std::vector<PendingObject>::const_iterator i = pending.begin (); i != pending.end (); ++i)
+    {
+      if (!done.insert (std::make_pair (i->subscription, i->context)).second)
+        {
+          continue;
+        }
+      bool below = false;
+      for (std::string::size_type slash = i->context.find ("/", 1);
+           slash != std::string::npos && !below;
+           slash = i->context.find ("/", slash + 1))
+        {
+          below = contexts.count (std::make_pair (i->subscription, i->context.substr (0, slash))) != 0;
+        }
+      if (below)
+        {
+          continue;
+        }
+      const Subscription &subscription = m_subscriptions[i->subscription];
+      Config::MatchContainer matches = subscription.path.LookupMatches (i->object, i->context);
+      subscription.path.Connect (matches, subscription.name, subscription.cb, subscription.withContext);
+    }
+}
+
+void
+ConfigImpl::ClearSubscriptions (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_subscriptions.clear ();
+  m_pending.clear ();
+  m_pendingScheduled = false;
+  m_clearScheduled = false;
+}
+
 namespace Config {
 
 void Reset (void)
@@ -873,6 +1508,171 @@ Ptr<Object> GetRootNamespaceObject (uint32_t i)
   return ConfigImpl::Get ()->GetRootNamespaceObject (i);
 }
 
+bool HasSubscriptions (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return ConfigImpl::Get ()->HasSubscriptions ();
+}
+
+void NotifyObjectAdded (std::string context, Ptr<Object> object)
+{
+  NS_LOG_FUNCTION (context << object);
+  ConfigImpl::Get ()->NotifyObjectAdded (context, object);
+}
+
+CompiledPath::CompiledPath ()
+  : m_impl (Create<CompiledPathImpl> ("/"))
+{
+  NS_LOG_FUNCTION (this);
+}
+
+CompiledPath::CompiledPath (std::string path)
+  : m_impl (Create<CompiledPathImpl> (path))
+{
+  NS_LOG_FUNCTION (this << path);
+}
+
+CompiledPath::CompiledPath (const CompiledPath &o)
+  : m_impl (o.m_impl)
+{
+  NS_LOG_FUNCTION (this << &o);
+}
+
+CompiledPath &
+CompiledPath::operator = (const CompiledPath &o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  m_impl = o.m_impl;
+  return *this;
+}
+
+CompiledPath::~CompiledPath ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+CompiledPath::GetPath (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_impl->GetPath ();
+}
+
+MatchContainer
+CompiledPath::LookupMatches (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Ptr<Object> > objects;
+  std::vector<std::string> contexts;
+  for (uint32_t i = 0; i < GetRootNamespaceObjectN (); i++)
+    {
+      m_impl->Resolve (GetRootNamespaceObject (i), objects, contexts);
+    }
+
+  //
+  // The object name service is consulted last, as by Config::LookupMatches
+  //
+  class NamesResolver : public Resolver
+  {
+  public:
+    NamesResolver (std::string path, std::vector<Ptr<Object> > &objects,
+                   std::vector<std::string> &contexts)
+      : Resolver (path),
+        m_objects (objects),
+        m_contexts (contexts)
+    {}
+    virtual void DoOne (Ptr<Object> object, std::string path) {
+      m_objects.push_back (object);
+      m_contexts.push_back (path);
+    }
+    std::vector<Ptr<Object> > &m_objects;
+    std::vector<std::string> &m_contexts;
+  } resolver (m_impl->GetPath (), objects, contexts);
+  resolver.Resolve (0);
+
+  return MatchContainer (objects, contexts, m_impl->GetPath ());
+}
+
+MatchContainer
+CompiledPath::LookupMatches (Ptr<Object> object, std::string context) const
+{
+  NS_LOG_FUNCTION (this << object << context);
+  std::vector<Ptr<Object> > objects;
+  std::vector<std::string> contexts;
+  uint32_t n;
+  if (m_impl->MatchContext (context, &n))
+    {
+      if (context.empty () || context[context.size () - 1] != '/')
+        {
+          context += "/";
+        }
+      m_impl->Resolve (n, object, context, objects, contexts);
+    }
+  return MatchContainer (objects, contexts, m_impl->GetPath ());
+}
+
+void
+CompiledPath::Set (std::string name, const AttributeValue &value) const
+{
+  NS_LOG_FUNCTION (this << name << &value);
+  LookupMatches ().Set (name, value);
+}
+
+void
+CompiledPath::Connect (std::string name, const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << name << &cb);
+  Connect (LookupMatches (), name, cb, true);
+}
+
+void
+CompiledPath::ConnectWithoutContext (std::string name, const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << name << &cb);
+  Connect (LookupMatches (), name, cb, false);
+}
+
+void
+CompiledPath::Subscribe (std::string name, const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << name << &cb);
+  Connect (name, cb);
+  ConfigImpl::Get ()->Subscribe (*this, name, cb, true);
+}
+
+void
+CompiledPath::SubscribeWithoutContext (std::string name, const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << name << &cb);
+  ConnectWithoutContext (name, cb);
+  ConfigImpl::Get ()->Subscribe (*this, name, cb, false);
+}
+
+void
+CompiledPath::Connect (const MatchContainer &matches, std::string name,
+                       const CallbackBase &cb, bool withContext) const
+{
+  NS_LOG_FUNCTION (this << &matches << name << &cb << withContext);
+  for (uint32_t i = 0; i < matches.GetN (); i++)
+    {
+      Ptr<Object> object = matches.Get (i);
+      Ptr<const TraceSourceAccessor> accessor =
+        m_impl->LookupTraceSource (object->GetInstanceTypeId (), name);
+      if (accessor == 0)
+        {
+          continue;
+        }
+      if (withContext)
+        {
+          accessor->Connect (PeekPointer (object), matches.GetMatchedPath (i) + name, cb);
+        }
+      else
+        {
+          accessor->ConnectWithoutContext (PeekPointer (object), cb);
+        }
+    }
+}
+
 } // namespace Config
 
 } // namespace ns3
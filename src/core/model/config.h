@@ -35,6 +35,8 @@ namespace ns3 {
 class AttributeValue;
 class Object;
 class CallbackBase;
+class CompiledPathImpl;
+class ConfigImpl;
 
 /**
  * \ingroup core
@@ -258,6 +260,145 @@ private:
  */
 MatchContainer LookupMatches (std::string path);
 
+/**
+ * \ingroup config
+ * \brief A path of objects parsed once and resolved in one traversal.
+ *
+ * The path is split and its indexes and TypeId names are parsed when the
+ * CompiledPath is created; the attributes of each TypeId crossed by the
+ * path and the trace sources connected are looked up once and cached.
+ * A CompiledPath matches the same objects as Config::LookupMatches on the
+ * same path. The path of a trace source or attribute given to
+ * Config::Connect or Config::Set is the path of a CompiledPath followed
+ * by the name given to Connect or Set: the path
+ * "/NodeList/[0-3]/DeviceList/0/$ns3::PointToPointNetDevice/TxQueue/Dequeue"
+ * is compiled as "/NodeList/[0-3]/DeviceList/0/$ns3::PointToPointNetDevice/TxQueue"
+ * and connected to "Dequeue".
+ *
+ * Copies of a CompiledPath share the parsed path and the caches.
+ *
+ * Subscribe connects the objects matched now and the objects matched
+ * later below an object reported by Config::NotifyObjectAdded, which
+ * the NodeList and the nodes call for each new node and device. The
+ * new objects are connected at the time they are reported, once the
+ * current event (or the installation before Simulator::Run) is over, so
+ * that the helpers have completed them. The subscriptions end with
+ * Simulator::Destroy.
+ */
+class CompiledPath
+{
+public:
+  CompiledPath ();
+  /**
+   * \param [in] path The path of the objects.
+   */
+  CompiledPath (std::string path);
+  /**
+   * \param [in] o The path to copy.
+   */
+  CompiledPath (const CompiledPath &o);
+  /**
+   * \param [in] o The path to copy.
+   * \returns This path.
+   */
+  CompiledPath &operator = (const CompiledPath &o);
+  ~CompiledPath ();
+
+  /**
+   * \returns The path of the objects.
+   */
+  std::string GetPath (void) const;
+  /**
+   * \returns A container of the objects matching the path.
+   */
+  MatchContainer LookupMatches (void) const;
+  /**
+   * Match the path below an object.
+   *
+   * \param [in] object An object.
+   * \param [in] context The matched path of \p object, made of attribute
+   *        names and indexes, e.g. "/NodeList/3/DeviceList/1".
+   * \returns A container of the objects matching the path found below
+   *          \p object, empty if \p context does not match the start of
+   *          the path.
+   */
+  MatchContainer LookupMatches (Ptr<Object> object, std::string context) const;
+
+  /**
+   * \param [in] name The name of the attribute to set.
+   * \param [in] value The value of the attribute.
+   *
+   * Set the attribute of all the objects matching the path.
+   */
+  void Set (std::string name, const AttributeValue &value) const;
+  /**
+   * \param [in] name The name of the trace source to connect to.
+   * \param [in] cb The sink to connect to the trace source.
+   *
+   * Connect the sink to the trace source of all the objects matching
+   * the path, with their matched path as context.
+   */
+  void Connect (std::string name, const CallbackBase &cb) const;
+  /**
+   * \param [in] name The name of the trace source to connect to.
+   * \param [in] cb The sink to connect to the trace source.
+   *
+   * Connect the sink to the trace source of all the objects matching
+   * the path.
+   */
+  void ConnectWithoutContext (std::string name, const CallbackBase &cb) const;
+  /**
+   * \param [in] name The name of the trace source to connect to.
+   * \param [in] cb The sink to connect to the trace source.
+   *
+   * Connect the sink like Connect and connect it to the objects matching
+   * the path added afterwards.
+   */
+  void Subscribe (std::string name, const CallbackBase &cb) const;
+  /**
+   * \param [in] name The name of the trace source to connect to.
+   * \param [in] cb The sink to connect to the trace source.
+   *
+   * Connect the sink like ConnectWithoutContext and connect it to the
+   * objects matching the path added afterwards.
+   */
+  void SubscribeWithoutContext (std::string name, const CallbackBase &cb) const;
+
+private:
+  friend class ns3::ConfigImpl;
+
+  /**
+   * Connect the sink to the trace source of some objects.
+   *
+   * \param [in] matches The objects and their matched paths.
+   * \param [in] name The name of the trace source to connect to.
+   * \param [in] cb The sink to connect to the trace source.
+   * \param [in] withContext Whether the sink takes the context.
+   */
+  void Connect (const MatchContainer &matches, std::string name,
+                const CallbackBase &cb, bool withContext) const;
+
+  /** The parsed path and its caches. */
+  Ptr<CompiledPathImpl> m_impl;
+};
+
+/**
+ * \ingroup config
+ * \returns \c true if a CompiledPath subscription is waiting for new
+ *          objects, to skip Config::NotifyObjectAdded otherwise.
+ */
+bool HasSubscriptions (void);
+
+/**
+ * \ingroup config
+ * Report a new object to the CompiledPath subscriptions.
+ *
+ * \param [in] context The matched path of the object, made of attribute
+ *        names and indexes, e.g. "/NodeList/3/DeviceList/1".
+ * \param [in] object The new object.
+ */
+void NotifyObjectAdded (std::string context, Ptr<Object> object);
+
 /**
  * \ingroup config
  * \param [in] obj A new root object
@@ -25,11 +25,12 @@
 #include "scheduler.h"
 #include "event-impl.h"
 #include "system-thread.h"
-#include "ns3/system-mutex.h"
+#include "mpsc-event-ring.h"
 
 #include "ptr.h"
 
 #include <list>
+#include <vector>
 
 /**
  * \file
@@ -86,26 +87,13 @@ private:
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
  
-  /** Wrap an event with its execution context. */
-  struct EventWithContext {
-    /** The event context. */
-    uint32_t context;
-    /** Event timestamp. */
-    uint64_t timestamp;
-    /** The event implementation. */
-    EventImpl *event;
-  };
-  /** Container type for the events from a different context. */
-  typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
-  EventsWithContext m_eventsWithContext;
   /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
+   * The events from a different context, with their delay as
+   * timestamp. Pushing them takes no lock.
    */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
-  SystemMutex m_eventsWithContextMutex;
+  MpscEventRing m_eventsWithContext;
+  /** The last batch of events drained from #m_eventsWithContext. */
+  std::vector<MpscEventRing::Event> m_eventsWithContextBatch;
 
   /** Container type for the events to run at Simulator::Destroy() */
   typedef std::list<EventId> DestroyEvents;
@@ -0,0 +1,273 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-log.h"
+#include "simulator.h"
+#include "ns3/core-config.h"
+#include "fatal-error.h"
+
+#include <fstream>
+#include <cstdlib>
+
+/**
+ * \file
+ * \ingroup eventlog
+ * ns3::EventLog and ns3::EventLogComponent implementations.
+ */
+
+namespace ns3 {
+
+namespace {
+
+/**
+ * \ingroup eventlog
+ * The ring buffer shared by all the components.
+ */
+struct EventLogRing
+{
+  std::vector<EventLogRecord> records; //!< Storage, allocated on first use
+  uint32_t capacity;                   //!< Number of records, a power of two
+  uint64_t count;                      //!< Records appended since the last clear
+};
+
+/** The ring buffer, 1M records (32 MiB) unless told otherwise. */
+EventLogRing g_eventLogRing = { std::vector<EventLogRecord> (), 1 << 20, 0 };
+
+} // unnamed namespace
+
+
+EventLogComponent::EventLogComponent (const std::string & name)
+  : m_enabled (false),
+    m_name (name)
+{
+  EventLog::ComponentList *components = EventLog::GetComponentList ();
+  if (components->find (name) != components->end ())
+    {
+      NS_FATAL_ERROR ("Event log component \"" << name << "\" has already been registered once.");
+    }
+  m_id = static_cast<uint16_t> (components->size ());
+  components->insert (std::make_pair (name, this));
+  EnvVarCheck ();
+}
+
+std::string
+EventLogComponent::Name (void) const
+{
+  return m_name;
+}
+
+void
+EventLogComponent::Enable (void)
+{
+  m_enabled = true;
+}
+
+void
+EventLogComponent::Disable (void)
+{
+  m_enabled = false;
+}
+
+void
+EventLogComponent::EnvVarCheck (void)
+{
+#ifdef HAVE_GETENV
+  char *envVar = getenv ("NS_EVENT_LOG");
+  if (envVar == 0)
+    {
+      return;
+    }
+  std::string env = envVar;
+  std::string::size_type cur = 0;
+  std::string::size_type next = 0;
+  while (next != std::string::npos)
+    {
+      next = env.find_first_of (":", cur);
+      std::string component = std::string (env, cur, next - cur);
+      if (component == m_name || component == "*")
+        {
+          Enable ();
+          return;
+        }
+      cur = next + 1;
+    }
+#endif
+}
+
+
+/* static */
+EventLog::ComponentList *
+EventLog::GetComponentList (void)
+{
+  static EventLog::ComponentList components;
+  return &components;
+}
+
+void
+EventLog::Enable (const std::string & name)
+{
+  ComponentList *components = GetComponentList ();
+  ComponentList::iterator i = components->find (name);
+  if (i == components->end ())
+    {
+      NS_FATAL_ERROR ("Event log component \"" << name << "\" not found.");
+    }
+  i->second->Enable ();
+}
+
+void
+EventLog::EnableAll (void)
+{
+  ComponentList *components = GetComponentList ();
+  for (ComponentList::iterator i = components->begin (); i != components->end (); ++i)
+    {
+      i->second->Enable ();
+    }
+}
+
+void
+EventLog::Disable (const std::string & name)
+{
+  ComponentList *components = GetComponentList ();
+  ComponentList::iterator i = components->find (name);
+  if (i != components->end ())
+    {
+      i->second->Disable ();
+    }
+}
+
+void
+EventLog::DisableAll (void)
+{
+  ComponentList *components = GetComponentList ();
+  for (ComponentList::iterator i = components->begin (); i != components->end (); ++i)
+    {
+      i->second->Disable ();
+    }
+}
+
+void
+EventLog::SetCapacity (uint32_t records)
+{
+  if (records == 0)
+    {
+      NS_FATAL_ERROR ("The event log needs room for at least one record");
+    }
+  uint32_t capacity = 1;
+  while (capacity < records)
+    {
+      capacity <<= 1;
+    }
+  g_eventLogRing.capacity = capacity;
+  g_eventLogRing.records.clear ();
+  g_eventLogRing.count = 0;
+}
+
+uint32_t
+EventLog::GetCapacity (void)
+{
+  return g_eventLogRing.capacity;
+}
+
+void
+EventLog::Clear (void)
+{
+  g_eventLogRing.count = 0;
+}
+
+uint64_t
+EventLog::GetTotalRecords (void)
+{
+  return g_eventLogRing.count;
+}
+
+std::vector<EventLogRecord>
+EventLog::GetRecords (void)
+{
+  std::vector<EventLogRecord> records;
+  uint64_t count = g_eventLogRing.count;
+  uint64_t first = count > g_eventLogRing.capacity ? count - g_eventLogRing.capacity : 0;
+  records.reserve (count - first);
+  for (uint64_t i = first; i < count; ++i)
+    {
+      records.push_back (g_eventLogRing.records[i & (g_eventLogRing.capacity - 1)]);
+    }
+  return records;
+}
+
+std::string
+EventLog::GetComponentName (uint16_t id)
+{
+  ComponentList *components = GetComponentList ();
+  for (ComponentList::const_iterator i = components->begin (); i != components->end (); ++i)
+    {
+      if (i->second->GetId () == id)
+        {
+          return i->first;
+        }
+    }
+  return "";
+}
+
+void
+EventLog::Write (const std::string & filename)
+{
+  std::ofstream os (filename.c_str (), std::ios::out | std::ios::binary);
+  if (!os.is_open ())
+    {
+      NS_FATAL_ERROR ("Can't open event log file \"" << filename << "\"");
+    }
+  os.write ("NS3EVLOG", 8);
+
+  ComponentList *components = GetComponentList ();
+  uint32_t nComponents = components->size ();
+  os.write (reinterpret_cast<const char *> (&nComponents), sizeof (nComponents));
+  for (ComponentList::const_iterator i = components->begin (); i != components->end (); ++i)
+    {
+      uint16_t id = i->second->GetId ();
+      uint16_t length = i->first.size ();
+      os.write (reinterpret_cast<const char *> (&id), sizeof (id));
+      os.write (reinterpret_cast<const char *> (&length), sizeof (length));
+      os.write (i->first.data (), length);
+    }
+
+  std::vector<EventLogRecord> records = GetRecords ();
+  uint64_t nRecords = records.size ();
+  os.write (reinterpret_cast<const char *> (&nRecords), sizeof (nRecords));
+  if (nRecords > 0)
+    {
+      os.write (reinterpret_cast<const char *> (&records[0]), nRecords * sizeof (EventLogRecord));
+    }
+}
+
+void
+EventLog::Append (uint16_t component, uint16_t type, uint64_t a, uint64_t b)
+{
+  if (g_eventLogRing.records.empty ())
+    {
+      g_eventLogRing.records.resize (g_eventLogRing.capacity);
+    }
+  EventLogRecord &record = g_eventLogRing.records[g_eventLogRing.count & (g_eventLogRing.capacity - 1)];
+  ++g_eventLogRing.count;
+  record.time = Simulator::Now ().GetTimeStep ();
+  record.context = Simulator::GetContext ();
+  record.component = component;
+  record.type = type;
+  record.a = a;
+  record.b = b;
+}
+
+} // namespace ns3
@@ -0,0 +1,238 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_EVENT_LOG_H
+#define NS3_EVENT_LOG_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup logging
+ * Structured binary event log.
+ */
+
+/**
+ * \ingroup logging
+ * \defgroup eventlog Event log
+ *
+ * \brief Structured event log stored as fixed size binary records
+ *
+ * Unlike the NS_LOG macros, the event log is compiled in every build
+ * profile, including \c fast. Each call site costs a single test of a
+ * per-component flag when the component is disabled, and the copy of one
+ * 32 byte record into a preallocated ring buffer when it is enabled:
+ * nothing is formatted and no stream is touched.
+ *
+ * Components are enabled at runtime with ns3::EventLog::Enable or
+ * with the NS_EVENT_LOG environment variable, a ':'-separated list of
+ * component names (\c '*' enables all of them):
+ * \code
+ *   $ NS_EVENT_LOG="ECNSharpQueueDisc:PointToPointNetDevice" ./waf --run ...
+ * \endcode
+ *
+ * When the ring is full the oldest records are overwritten. The content
+ * of the ring can be inspected with ns3::EventLog::GetRecords or dumped
+ * with ns3::EventLog::Write, which writes the records verbatim in host
+ * byte order after a small header naming the components.
+ */
+
+/**
+ * \ingroup eventlog
+ * Define an event log component with a specific name.
+ *
+ * This macro should be used at the top of every file in which you want
+ * to use the NS_EVENT_LOG macro. It defines a new event log component
+ * which can be later selectively enabled or disabled with
+ * ns3::EventLog::Enable and ns3::EventLog::Disable or with the
+ * NS_EVENT_LOG environment variable.
+ *
+ * \param [in] name The event log component name.
+ */
+#define NS_EVENT_LOG_COMPONENT_DEFINE(name)                     \
+  static ns3::EventLogComponent g_eventLog = ns3::EventLogComponent (name)
+
+/**
+ * \ingroup eventlog
+ * Append one record to the event log if the component of this file
+ * is enabled.
+ *
+ * \param [in] type Component specific event type.
+ * \param [in] a First event argument, e.g. a packet uid.
+ * \param [in] b Second event argument, e.g. a packet size or a queue length.
+ */
+#define NS_EVENT_LOG(type, a, b)                                \
+  do                                                            \
+    {                                                           \
+      if (g_eventLog.IsEnabled ())                              \
+        {                                                       \
+          ns3::EventLog::Append (g_eventLog.GetId (), type, a, b); \
+        }                                                       \
+    }                                                           \
+  while (false)
+
+namespace ns3 {
+
+/**
+ * \ingroup eventlog
+ * One entry of the event log.
+ */
+struct EventLogRecord
+{
+  int64_t time;       //!< Simulation time in time steps
+  uint32_t context;   //!< Simulation context, usually the node id
+  uint16_t component; //!< Id of the component that wrote the record
+  uint16_t type;      //!< Component specific event type
+  uint64_t a;         //!< First event argument
+  uint64_t b;         //!< Second event argument
+};
+
+/**
+ * \ingroup eventlog
+ * A single event log component, see NS_EVENT_LOG_COMPONENT_DEFINE.
+ */
+class EventLogComponent
+{
+public:
+  /**
+   * Constructor
+   * \param [in] name The component name.
+   */
+  EventLogComponent (const std::string & name);
+  /**
+   * Check if this component is enabled.
+   * \returns \c true if records are appended for this component.
+   */
+  inline bool IsEnabled (void) const
+  {
+    return m_enabled;
+  }
+  /**
+   * Get the id stored in the records of this component.
+   * \returns The component id.
+   */
+  inline uint16_t GetId (void) const
+  {
+    return m_id;
+  }
+  /**
+   * Get the name of this component.
+   * \returns The component name.
+   */
+  std::string Name (void) const;
+  /** Enable this component. */
+  void Enable (void);
+  /** Disable this component. */
+  void Disable (void);
+
+private:
+  /** Enable this component if it appears in NS_EVENT_LOG. */
+  void EnvVarCheck (void);
+
+  bool m_enabled;      //!< Whether records are appended
+  uint16_t m_id;       //!< Component id
+  std::string m_name;  //!< Component name
+};
+
+/**
+ * \ingroup eventlog
+ * Static interface to the event log ring buffer.
+ */
+class EventLog
+{
+public:
+  /**
+   * Enable a component.
+   * \param [in] name The component name.
+   */
+  static void Enable (const std::string & name);
+  /** Enable all the components. */
+  static void EnableAll (void);
+  /**
+   * Disable a component.
+   * \param [in] name The component name.
+   */
+  static void Disable (const std::string & name);
+  /** Disable all the components. */
+  static void DisableAll (void);
+  /**
+   * Set the number of records the ring can hold, the content of the
+   * ring is discarded. The capacity is rounded up to a power of two.
+   * \param [in] records The number of records.
+   */
+  static void SetCapacity (uint32_t records);
+  /**
+   * Get the number of records the ring can hold.
+   * \returns The capacity of the ring.
+   */
+  static uint32_t GetCapacity (void);
+  /** Discard all the records. */
+  static void Clear (void);
+  /**
+   * Get the number of records appended since the last Clear, including
+   * those already overwritten.
+   * \returns The number of records appended.
+   */
+  static uint64_t GetTotalRecords (void);
+  /**
+   * Get the records held by the ring, oldest first.
+   * \returns The records.
+   */
+  static std::vector<EventLogRecord> GetRecords (void);
+  /**
+   * Get the name of a component from its id.
+   * \param [in] id The component id.
+   * \returns The component name.
+   */
+  static std::string GetComponentName (uint16_t id);
+  /**
+   * Write the records held by the ring to a binary file.
+   *
+   * The file starts with the magic "NS3EVLOG", the number of components
+   * as a uint32_t followed by, for each component, its id as a uint16_t,
+   * the length of its name as a uint16_t and the name. The number of
+   * records follows as a uint64_t and then the raw EventLogRecord array,
+   * oldest first.
+   *
+   * \param [in] filename The output file name.
+   */
+  static void Write (const std::string & filename);
+  /**
+   * Append one record, use the NS_EVENT_LOG macro instead.
+   * \param [in] component The component id.
+   * \param [in] type Component specific event type.
+   * \param [in] a First event argument.
+   * \param [in] b Second event argument.
+   */
+  static void Append (uint16_t component, uint16_t type, uint64_t a, uint64_t b);
+
+private:
+  friend class EventLogComponent;
+  /** Map from component name to component. */
+  typedef std::map<std::string, EventLogComponent *> ComponentList;
+  /**
+   * Get the list of components.
+   * \returns The list of components.
+   */
+  static ComponentList * GetComponentList (void);
+};
+
+} // namespace ns3
+
+#endif /* NS3_EVENT_LOG_H */
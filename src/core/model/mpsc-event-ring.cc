@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mpsc-event-ring.h"
+#include "assert.h"
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup simulator
+ * Implementation of class ns3::MpscEventRing.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MpscEventRing");
+
+MpscEventRing::MpscEventRing (uint32_t capacity)
+  : m_tail (0),
+    m_head (0),
+    m_overflowing (0)
+{
+  NS_LOG_FUNCTION (this << capacity);
+  NS_ASSERT (capacity > 0);
+  uint64_t size = 1;
+  while (size < capacity)
+    {
+      size <<= 1;
+    }
+  m_cells.resize (size);
+  for (uint64_t i = 0; i < size; ++i)
+    {
+      m_cells[i].sequence = i;
+    }
+  m_mask = size - 1;
+}
+
+MpscEventRing::~MpscEventRing ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+MpscEventRing::TryPush (const Event &event)
+{
+  uint64_t position = __atomic_load_n (&m_tail, __ATOMIC_RELAXED);
+  Cell *cell;
+  for (;;)
+    {
+      cell = &m_cells[position & m_mask];
+      uint64_t sequence = __atomic_load_n (&cell->sequence, __ATOMIC_ACQUIRE);
+      int64_t diff = static_cast<int64_t> (sequence - position);
+      if (diff == 0)
+        {
+          // the cell is free, claim it; on failure position is reloaded
+          if (__atomic_compare_exchange_n (&m_tail, &position, position + 1, true,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+              break;
+            }
+        }
+      else if (diff < 0)
+        {
+          // the consumer has not read the cell yet: full
+          return false;
+        }
+      else
+        {
+          // another producer claimed the cell
+          position = __atomic_load_n (&m_tail, __ATOMIC_RELAXED);
+        }
+    }
+  cell->event = event;
+  __atomic_store_n (&cell->sequence, position + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+bool
+MpscEventRing::TryPop (Event &event)
+{
+  Cell *cell = &m_cells[m_head & m_mask];
+  if (__atomic_load_n (&cell->sequence, __ATOMIC_ACQUIRE) != m_head + 1)
+    {
+      return false;
+    }
+  event = cell->event;
+  // free the cell for the producers of the next lap
+  __atomic_store_n (&cell->sequence, m_head + m_mask + 1, __ATOMIC_RELEASE);
+  __atomic_store_n (&m_head, m_head + 1, __ATOMIC_RELAXED);
+  return true;
+}
+
+void
+MpscEventRing::Push (const Event &event)
+{
+  if (__atomic_load_n (&m_overflowing, __ATOMIC_ACQUIRE) == 0
+      && TryPush (event))
+    {
+      return;
+    }
+  CriticalSection cs (m_overflowMutex);
+  NS_LOG_LOGIC ("ring full, overflow");
+  m_overflow.push_back (event);
+  __atomic_store_n (&m_overflowing, 1, __ATOMIC_RELEASE);
+}
+
+void
+MpscEventRing::Drain (std::vector<Event> &events)
+{
+  Event event;
+  while (TryPop (event))
+    {
+      events.push_back (event);
+    }
+  if (__atomic_load_n (&m_overflowing, __ATOMIC_ACQUIRE) == 0)
+    {
+      return;
+    }
+  CriticalSection cs (m_overflowMutex);
+  // The events of the overflow list were pushed after all the cells
+  // claimed so far: wait for the producers to publish them.
+  while (m_head != __atomic_load_n (&m_tail, __ATOMIC_ACQUIRE))
+    {
+      if (TryPop (event))
+        {
+          events.push_back (event);
+        }
+    }
+  events.insert (events.end (), m_overflow.begin (), m_overflow.end ());
+  m_overflow.clear ();
+  __atomic_store_n (&m_overflowing, 0, __ATOMIC_RELEASE);
+}
+
+bool
+MpscEventRing::IsEmpty (void) const
+{
+  const Cell *cell = &m_cells[m_head & m_mask];
+  return __atomic_load_n (&cell->sequence, __ATOMIC_ACQUIRE) != m_head + 1
+         && __atomic_load_n (&m_overflowing, __ATOMIC_ACQUIRE) == 0;
+}
+
+} // namespace ns3
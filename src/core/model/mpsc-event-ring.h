@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MPSC_EVENT_RING_H
+#define MPSC_EVENT_RING_H
+
+#include "system-mutex.h"
+#include <stdint.h>
+#include <vector>
+#include <list>
+
+/**
+ * \file
+ * \ingroup simulator
+ * Declaration of class ns3::MpscEventRing.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Queue of the events scheduled from other threads than the
+ * simulation thread.
+ *
+ * Any number of threads push events, the simulation thread drains
+ * them in batches. The events go through a bounded ring of cells
+ * tagged with sequence numbers: a producer claims a cell with a
+ * compare-and-swap on the tail and publishes it by bumping the
+ * sequence number, so pushing takes no lock. When the ring is full
+ * the events go to a list protected by a mutex, and keep doing so
+ * until the consumer has emptied it, so that the events pushed by a
+ * thread are always drained in the order of the pushes.
+ */
+class MpscEventRing
+{
+public:
+  /** An event and its scheduling information. */
+  struct Event
+  {
+    uint32_t context;   //!< The event context
+    uint64_t timestamp; //!< The timestamp, interpreted by the simulator
+    EventImpl *event;   //!< The event implementation
+  };
+
+  /**
+   * \param capacity the number of cells of the ring, rounded up to a
+   * power of two
+   */
+  MpscEventRing (uint32_t capacity = 1024);
+  ~MpscEventRing ();
+
+  /**
+   * Push an event, from any thread
+   * \param event the event
+   */
+  void Push (const Event &event);
+  /**
+   * Move all the published events at the end of a vector, from the
+   * consumer thread only
+   * \param events the vector to append the events to
+   */
+  void Drain (std::vector<Event> &events);
+  /**
+   * \return true if no event is waiting to be drained. Only meaningful
+   * in the consumer thread, producers may push concurrently.
+   */
+  bool IsEmpty (void) const;
+
+private:
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   */
+  MpscEventRing (const MpscEventRing &);
+  /**
+   * \brief Copy assignment
+   *
+   * Defined and unimplemented to avoid misuse
+   * \returns
+   */
+  MpscEventRing &operator = (const MpscEventRing &);
+
+  /** A cell of the ring */
+  struct Cell
+  {
+    /**
+     * Position of the cell when it is free for a producer, position
+     * plus one when it holds an event for the consumer
+     */
+    uint64_t sequence;
+    Event event;        //!< The event
+  };
+
+  /**
+   * Push an event in the ring
+   * \param event the event
+   * \return false if the ring is full
+   */
+  bool TryPush (const Event &event);
+  /**
+   * Pop the next published event of the ring
+   * \param event the event popped
+   * \return false if the next cell is not published
+   */
+  bool TryPop (Event &event);
+
+  std::vector<Cell> m_cells;            //!< The ring
+  uint64_t m_mask;                      //!< Number of cells minus one
+  // the producers and the consumer write different cache lines
+  char m_pad0[64];                      //!< Padding
+  uint64_t m_tail;                      //!< Next position claimed by a producer
+  char m_pad1[64 - sizeof (uint64_t)];  //!< Padding
+  uint64_t m_head;                      //!< Next position read by the consumer
+  char m_pad2[64 - sizeof (uint64_t)];  //!< Padding
+  uint32_t m_overflowing;               //!< Whether events are in the overflow list
+  std::list<Event> m_overflow;          //!< Events pushed while the ring was full
+  SystemMutex m_overflowMutex;          //!< Mutex of the overflow list
+};
+
+} // namespace ns3
+
+#endif /* MPSC_EVENT_RING_H */
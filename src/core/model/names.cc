@@ -16,13 +16,14 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#include <map>
+#include <vector>
 #include "object.h"
 #include "log.h"
 #include "assert.h"
 #include "abort.h"
 #include "names.h"
 #include "singleton.h"
+#include "hash.h"
 
 /**
  * \file
@@ -38,6 +39,9 @@ NS_LOG_COMPONENT_DEFINE ("Names");
 /**
  * \ingroup config
  *  Node in the naming tree.
+ *
+ *  The NameNodes are chained in two hash tables of NamesPriv, by parent
+ *  and name and by object, rather than keeping a map of their children.
  */
 class NameNode
 {
@@ -76,12 +80,22 @@ public:
   /** The object corresponding to this NameNode. */
   Ptr<Object> m_object;
 
-  /** Children of this NameNode. */
-  std::map<std::string, NameNode *> m_nameMap;
+  /** The hash of the name. */
+  uint32_t m_hash;
+  /** The next NameNode in the bucket of the name table. */
+  NameNode *m_nextByName;
+  /** The next NameNode in the bucket of the object table. */
+  NameNode *m_nextByObject;
+  /** The cached path of this NameNode. */
+  std::string m_path;
+  /** The generation of the names when the path was cached. */
+  uint32_t m_pathGeneration;
 };
 
 NameNode::NameNode ()
-  : m_parent (0), m_name (""), m_object (0)
+  : m_parent (0), m_name (""), m_object (0),
+    m_hash (0), m_nextByName (0), m_nextByObject (0),
+    m_path (""), m_pathGeneration (0)
 {
 }
 
@@ -90,7 +104,11 @@ NameNode::NameNode (const NameNode &nameNode)
   m_parent = nameNode.m_parent;
   m_name = nameNode.m_name;
   m_object = nameNode.m_object;
-  m_nameMap = nameNode.m_nameMap;
+  m_hash = nameNode.m_hash;
+  m_nextByName = 0;
+  m_nextByObject = 0;
+  m_path = nameNode.m_path;
+  m_pathGeneration = nameNode.m_pathGeneration;
 }
 
 NameNode &
@@ -99,12 +117,19 @@ NameNode::operator = (const NameNode &rhs)
   m_parent = rhs.m_parent;
   m_name = rhs.m_name;
   m_object = rhs.m_object;
-  m_nameMap = rhs.m_nameMap;
+  m_hash = rhs.m_hash;
+  m_nextByName = 0;
+  m_nextByObject = 0;
+  m_path = rhs.m_path;
+  m_pathGeneration = rhs.m_pathGeneration;
   return *this;
 }
 
 NameNode::NameNode (NameNode *parent, std::string name, Ptr<Object> object)
-  : m_parent (parent), m_name (name), m_object (object)
+  : m_parent (parent), m_name (name), m_object (object),
+    m_hash (Hash32 (name.data (), name.size ())),
+    m_nextByName (0), m_nextByObject (0),
+    m_path (""), m_pathGeneration (0)
 {
   NS_LOG_FUNCTION (this << parent << name << object);
 }
@@ -142,6 +167,19 @@ public:
    */
   bool Add (Ptr<Object> context, std::string name, Ptr<Object> object);
 
+  /**
+   * \copydoc Names::AddRangeInternal(Ptr<Object>,std::string,uint32_t,const std::vector<Ptr<Object> >&)
+   * \return \c true if the objects were named successfully.
+   */
+  bool AddRange (Ptr<Object> context, std::string prefix, uint32_t first,
+                 const std::vector<Ptr<Object> > &objects);
+  /**
+   * \copydoc Names::AddRangeInternal(std::string,std::string,uint32_t,const std::vector<Ptr<Object> >&)
+   * \return \c true if the objects were named successfully.
+   */
+  bool AddRange (std::string path, std::string prefix, uint32_t first,
+                 const std::vector<Ptr<Object> > &objects);
+
   /**
    * \copydoc Names::Rename(std::string,std::string)
    * \return \c true if the object was renamed successfully.
@@ -192,14 +230,91 @@ private:
    */
   bool IsDuplicateName (NameNode *node, std::string name);
 
+  /**
+   * Find a child of a NameNode.
+   *
+   * \param [in] node The parent NameNode.
+   * \param [in] name The start of the name to search for.
+   * \param [in] size The length of the name.
+   * \returns The child NameNode, or 0 if there is none of this name.
+   */
+  NameNode *FindChild (NameNode *node, const char *name, std::size_t size) const;
+  /**
+   * Get the context NameNode of an object.
+   *
+   * \param [in] context The context object, 0 for the root.
+   * \returns The NameNode of the context, or 0 if it is not named.
+   */
+  NameNode *GetContextNode (Ptr<Object> context);
+  /**
+   * Get the fully qualified path of a NameNode, from its cache if no
+   * name changed since it was computed.
+   *
+   * \param [in] node The NameNode.
+   * \returns The path of the NameNode.
+   */
+  const std::string &GetPath (NameNode *node);
+  /**
+   * Link a new NameNode in both hash tables.
+   *
+   * \param [in] node The NameNode.
+   */
+  void Insert (NameNode *node);
+  /**
+   * Unlink a NameNode from the name table.
+   *
+   * \param [in] node The NameNode.
+   */
+  void RemoveName (NameNode *node);
+  /**
+   * \param [in] parent The parent NameNode.
+   * \param [in] hash The hash of the name.
+   * \returns The bucket of the name table for a name under a parent.
+   */
+  uint32_t GetNameBucket (const NameNode *parent, uint32_t hash) const;
+  /**
+   * \param [in] object The object.
+   * \returns The bucket of the object table for an object.
+   */
+  uint32_t GetObjectBucket (const Object *object) const;
+
   /** The root NameNode. */
   NameNode m_root;
 
-  /** Map from object pointers to their NameNodes. */
-  std::map<Ptr<Object>, NameNode *> m_objectMap;
+  /** NameNodes by parent and name, chained by m_nextByName. */
+  std::vector<NameNode *> m_nameTable;
+  /** NameNodes by object, chained by m_nextByObject. */
+  std::vector<NameNode *> m_objectTable;
+  /** The number of NameNodes in the tables. */
+  uint32_t m_nNodes;
+  /** Incremented when a name changes, to invalidate the cached paths. */
+  uint32_t m_generation;
 };
 
+/** The initial number of buckets of the hash tables, a power of 2. */
+static const uint32_t NAMES_INITIAL_BUCKETS = 64;
+
+/**
+ * Mix the bits of a pointer into a hash.
+ *
+ * \param [in] p The pointer.
+ * \returns The hash of the pointer.
+ */
+static uint32_t
+HashPointer (const void *p)
+{
+  uint64_t v = reinterpret_cast<uintptr_t> (p);
+  v ^= v >> 33;
+  v *= 0xff51afd7ed558ccdULL;
+  v ^= v >> 33;
+  return static_cast<uint32_t> (v);
+}
+
 NamesPriv::NamesPriv ()
+  : m_nameTable (NAMES_INITIAL_BUCKETS, 0),
+    m_objectTable (NAMES_INITIAL_BUCKETS, 0),
+    m_nNodes (0),
+    m_generation (1)
 {
   NS_LOG_FUNCTION (this);
 
@@ -220,21 +335,28 @@ NamesPriv::Clear (void)
 {
   NS_LOG_FUNCTION (this);
   //
-  // Every name is associated with an object in the object map, so freeing the
-  // NameNodes in this map will free all of the memory allocated for the NameNodes
+  // Every name is associated with an object in the object table, so freeing the
+  // NameNodes in this table will free all of the memory allocated for the NameNodes
   //
-  for (std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.begin (); i != m_objectMap.end (); ++i)
+  for (std::vector<NameNode *>::iterator i = m_objectTable.begin (); i != m_objectTable.end (); ++i)
     {
-      delete i->second;
-      i->second = 0;
+      NameNode *node = *i;
+      while (node != 0)
+        {
+          NameNode *next = node->m_nextByObject;
+          delete node;
+          node = next;
+        }
     }
 
-  m_objectMap.clear ();
+  m_nameTable.assign (NAMES_INITIAL_BUCKETS, 0);
+  m_objectTable.assign (NAMES_INITIAL_BUCKETS, 0);
+  m_nNodes = 0;
+  m_generation++;
 
   m_root.m_parent = 0;
   m_root.m_name = "Names";
   m_root.m_object = 0;
-  m_root.m_nameMap.clear ();
 }
 
 bool
@@ -338,13 +460,75 @@ NamesPriv::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
       return false;
     }
 
-  NameNode *newNode = new NameNode (node, name, object);
-  node->m_nameMap[name] = newNode;
-  m_objectMap[object] = newNode;
+  Insert (new NameNode (node, name, object));
+
+  return true;
+}
+
+bool
+NamesPriv::AddRange (Ptr<Object> context, std::string prefix, uint32_t first,
+                     const std::vector<Ptr<Object> > &objects)
+{
+  NS_LOG_FUNCTION (this << context << prefix << first << objects.size ());
+
+  NameNode *node = GetContextNode (context);
+  NS_ASSERT_MSG (node, "NamesPriv::AddRange(): context must point to a previously named node");
+
+  //
+  // The names only differ by their index, so they are built in place at
+  // the end of the prefix.
+  //
+  std::string name = prefix;
+  for (uint32_t i = 0; i < objects.size (); ++i)
+    {
+      name.resize (prefix.size ());
+      char digits[10];
+      uint32_t nDigits = 0;
+      uint32_t index = first + i;
+      do
+        {
+          digits[nDigits++] = '0' + index % 10;
+          index /= 10;
+        }
+      while (index != 0);
+      while (nDigits > 0)
+        {
+          name += digits[--nDigits];
+        }
 
+      if (IsNamed (objects[i]))
+        {
+          NS_LOG_LOGIC ("Object " << name << " is already named");
+          return false;
+        }
+      if (FindChild (node, name.data (), name.size ()))
+        {
+          NS_LOG_LOGIC ("Name " << name << " is already taken");
+          return false;
+        }
+      Insert (new NameNode (node, name, objects[i]));
+    }
   return true;
 }
 
+bool
+NamesPriv::AddRange (std::string path, std::string prefix, uint32_t first,
+                     const std::vector<Ptr<Object> > &objects)
+{
+  NS_LOG_FUNCTION (this << path << prefix << first << objects.size ());
+  if (path == "/Names")
+    {
+      return AddRange (Ptr<Object> (0, false), prefix, first, objects);
+    }
+  Ptr<Object> context = Find (path);
+  if (context == 0)
+    {
+      NS_LOG_LOGIC ("Path " << path << " is not named");
+      return false;
+    }
+  return AddRange (context, prefix, first, objects);
+}
+
 bool
 NamesPriv::Rename (std::string oldpath, std::string newname)
 {
@@ -442,8 +626,8 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       return false;
     }
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (oldname);
-  if (i == node->m_nameMap.end ())
+  NameNode *changeNode = FindChild (node, oldname.data (), oldname.size ());
+  if (changeNode == 0)
     {
       NS_LOG_LOGIC ("Old name does not exist in name map");
       return false;
@@ -454,15 +638,18 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
 
       //
       // The rename process consists of:
-      // 1.  Geting the pointer to the name node from the map and remembering it;
-      // 2.  Removing the map entry corresponding to oldname from the map;
-      // 3.  Changing the name string in the name node;
-      // 4.  Adding the name node back in the map under the newname.
+      // 1.  Removing the name node from the name table;
+      // 2.  Changing the name string and its hash in the name node;
+      // 3.  Adding the name node back in the name table under the newname;
+      // 4.  Invalidating the cached paths, those of the descendants change too.
       //
-      NameNode *changeNode = i->second;
-      node->m_nameMap.erase (i);
+      RemoveName (changeNode);
       changeNode->m_name = newname;
-      node->m_nameMap[newname] = changeNode;
+      changeNode->m_hash = Hash32 (newname.data (), newname.size ());
+      uint32_t bucket = GetNameBucket (node, changeNode->m_hash);
+      changeNode->m_nextByName = m_nameTable[bucket];
+      m_nameTable[bucket] = changeNode;
+      m_generation++;
       return true;
     }
 }
@@ -472,8 +659,8 @@ NamesPriv::FindName (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
-  if (i == m_objectMap.end ())
+  NameNode *p = IsNamed (object);
+  if (p == 0)
     {
       NS_LOG_LOGIC ("Object does not exist in object map");
       return "";
@@ -481,7 +668,7 @@ NamesPriv::FindName (Ptr<Object> object)
   else
     {
       NS_LOG_LOGIC ("Object exists in object map");
-      return i->second->m_name;
+      return p->m_name;
     }
 }
 
@@ -490,26 +677,33 @@ NamesPriv::FindPath (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
-  if (i == m_objectMap.end ())
+  NameNode *p = IsNamed (object);
+  if (p == 0)
     {
       NS_LOG_LOGIC ("Object does not exist in object map");
       return "";
     }
 
-  NameNode *p = i->second;
-  NS_ASSERT_MSG (p, "NamesPriv::FindFullName(): Internal error: Invalid NameNode pointer from map");
-
-  std::string path;
+  return GetPath (p);
+}
 
-  do
+const std::string &
+NamesPriv::GetPath (NameNode *node)
+{
+  if (node->m_pathGeneration != m_generation)
     {
-      path = "/" + p->m_name + path;
-      NS_LOG_LOGIC ("path is " << path);
+      if (node->m_parent == 0)
+        {
+          node->m_path = "/" + node->m_name;
+        }
+      else
+        {
+          node->m_path = GetPath (node->m_parent) + "/" + node->m_name;
+        }
+      node->m_pathGeneration = m_generation;
+      NS_LOG_LOGIC ("path is " << node->m_path);
     }
-  while ((p = p->m_parent) != 0);
-
-  return path;
+  return node->m_path;
 }
 
 
@@ -555,56 +749,37 @@ NamesPriv::Find (std::string path)
   // remaining = "ClientNode/eth0"
   //
   // The start of the search is always at the root of the name space.
+  // The segments are looked up in place, without copying them.
   //
+  std::string::size_type start = 0;
   for (;;)
     {
-      NS_LOG_LOGIC ("Looking for the object of name " << remaining);
-      offset = remaining.find ("/");
+      NS_LOG_LOGIC ("Looking for the object of name " << remaining.substr (start));
+      offset = remaining.find ('/', start);
+      std::string::size_type size = (offset == std::string::npos ? remaining.size () : offset) - start;
+      NameNode *child = FindChild (node, remaining.data () + start, size);
+      if (child == 0)
+        {
+          NS_LOG_LOGIC ("Name does not exist in name map");
+          return 0;
+        }
       if (offset == std::string::npos)
         {
           //
           // There are no remaining slashes so this is the last segment of the 
           // specified name.  We're done when we find it
           //
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (remaining);
-          if (i == node->m_nameMap.end ())
-            {
-              NS_LOG_LOGIC ("Name does not exist in name map");
-              return 0;
-            }
-          else
-            {
-              NS_LOG_LOGIC ("Name parsed, found object");
-              return i->second->m_object;
-            }
-        }
-      else
-        {
-          //
-          // There are more slashes so this is an intermediate segment of the 
-          // specified name.  We need to "recurse" when we find this segment.
-          //
-          offset = remaining.find ("/");
-          std::string segment = remaining.substr (0, offset);
-
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (segment);
-          if (i == node->m_nameMap.end ())
-            {
-              NS_LOG_LOGIC ("Name does not exist in name map");
-              return 0;
-            }
-          else
-            {
-              node = i->second;
-              remaining = remaining.substr (offset + 1);
-              NS_LOG_LOGIC ("Intermediate segment parsed");
-              continue;
-            }
+          NS_LOG_LOGIC ("Name parsed, found object");
+          return child->m_object;
         }
+      //
+      // There are more slashes so this is an intermediate segment of the 
+      // specified name.  We need to "recurse" when we find this segment.
+      //
+      node = child;
+      start = offset + 1;
+      NS_LOG_LOGIC ("Intermediate segment parsed");
     }
-
-  NS_ASSERT_MSG (node, "NamesPriv::Find(): Internal error:  this can't happen");
-  return 0;
 }
 
 Ptr<Object>
@@ -641,8 +816,8 @@ NamesPriv::Find (Ptr<Object> context, std::string name)
         }
     }
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
-  if (i == node->m_nameMap.end ())
+  NameNode *child = FindChild (node, name.data (), name.size ());
+  if (child == 0)
     {
       NS_LOG_LOGIC ("Name does not exist in name map");
       return 0;
@@ -650,7 +825,7 @@ NamesPriv::Find (Ptr<Object> context, std::string name)
   else
     {
       NS_LOG_LOGIC ("Name exists in name map");
-      return i->second->m_object;
+      return child->m_object;
     }
 }
 
@@ -659,17 +834,16 @@ NamesPriv::IsNamed (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
-  if (i == m_objectMap.end ())
-    {
-      NS_LOG_LOGIC ("Object does not exist in object map, returning NameNode 0");
-      return 0;
-    }
-  else
+  for (NameNode *node = m_objectTable[GetObjectBucket (PeekPointer (object))]; node != 0; node = node->m_nextByObject)
     {
-      NS_LOG_LOGIC ("Object exists in object map, returning NameNode " << &i->second);
-      return i->second;
+      if (node->m_object == object)
+        {
+          NS_LOG_LOGIC ("Object exists in object map, returning NameNode " << node);
+          return node;
+        }
     }
+  NS_LOG_LOGIC ("Object does not exist in object map, returning NameNode 0");
+  return 0;
 }
 
 bool
@@ -677,8 +851,7 @@ NamesPriv::IsDuplicateName (NameNode *node, std::string name)
 {
   NS_LOG_FUNCTION (this << node << name);
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
-  if (i == node->m_nameMap.end ())
+  if (FindChild (node, name.data (), name.size ()) == 0)
     {
       NS_LOG_LOGIC ("Name does not exist in name map");
       return false;
@@ -690,6 +863,96 @@ NamesPriv::IsDuplicateName (NameNode *node, std::string name)
     }
 }
 
+NameNode *
+NamesPriv::FindChild (NameNode *node, const char *name, std::size_t size) const
+{
+  uint32_t hash = Hash32 (name, size);
+  for (NameNode *child = m_nameTable[GetNameBucket (node, hash)]; child != 0; child = child->m_nextByName)
+    {
+      if (child->m_hash == hash && child->m_parent == node
+          && child->m_name.size () == size && child->m_name.compare (0, size, name, size) == 0)
+        {
+          return child;
+        }
+    }
+  return 0;
+}
+
+NameNode *
+NamesPriv::GetContextNode (Ptr<Object> context)
+{
+  if (context == 0)
+    {
+      return &m_root;
+    }
+  return IsNamed (context);
+}
+
+void
+NamesPriv::Insert (NameNode *node)
+{
+  NS_LOG_FUNCTION (this << node);
+
+  if (m_nNodes >= m_objectTable.size ())
+    {
+      //
+      // Double the tables and move every NameNode, all of them are in the
+      // object table.
+      //
+      std::vector<NameNode *> nodes;
+      nodes.reserve (m_nNodes);
+      for (std::vector<NameNode *>::const_iterator i = m_objectTable.begin (); i != m_objectTable.end (); ++i)
+        {
+          for (NameNode *p = *i; p != 0; p = p->m_nextByObject)
+            {
+              nodes.push_back (p);
+            }
+        }
+      m_nameTable.assign (m_nameTable.size () * 2, 0);
+      m_objectTable.assign (m_objectTable.size () * 2, 0);
+      m_nNodes = 0;
+      for (std::vector<NameNode *>::const_iterator i = nodes.begin (); i != nodes.end (); ++i)
+        {
+          Insert (*i);
+        }
+    }
+
+  uint32_t bucket = GetNameBucket (node->m_parent, node->m_hash);
+  node->m_nextByName = m_nameTable[bucket];
+  m_nameTable[bucket] = node;
+  bucket = GetObjectBucket (PeekPointer (node->m_object));
+  node->m_nextByObject = m_objectTable[bucket];
+  m_objectTable[bucket] = node;
+  m_nNodes++;
+}
+
+void
+NamesPriv::RemoveName (NameNode *node)
+{
+  NS_LOG_FUNCTION (this << node);
+
+  NameNode **p = &m_nameTable[GetNameBucket (node->m_parent, node->m_hash)];
+  while (*p != node)
+    {
+      NS_ASSERT_MSG (*p, "NamesPriv::RemoveName(): Internal error: NameNode not in the name table");
+      p = &(*p)->m_nextByName;
+    }
+  *p = node->m_nextByName;
+  node->m_nextByName = 0;
+}
+
+uint32_t
+NamesPriv::GetNameBucket (const NameNode *parent, uint32_t hash) const
+{
+  return (hash ^ HashPointer (parent)) & (m_nameTable.size () - 1);
+}
+
+uint32_t
+NamesPriv::GetObjectBucket (const Object *object) const
+{
+  return HashPointer (object) & (m_objectTable.size () - 1);
+}
+
 void
 Names::Add (std::string name, Ptr<Object> object)
 {
@@ -698,6 +961,26 @@ Names::Add (std::string name, Ptr<Object> object)
   NS_ABORT_MSG_UNLESS (result, "Names::Add(): Error adding name " << name);
 }
 
+void
+Names::AddRangeInternal (Ptr<Object> context, std::string prefix, uint32_t first,
+                         const std::vector<Ptr<Object> > &objects)
+{
+  NS_LOG_FUNCTION (context << prefix << first << objects.size ());
+  bool result = NamesPriv::Get ()->AddRange (context, prefix, first, objects);
+  NS_ABORT_MSG_UNLESS (result, "Names::AddRange(): Error adding names " << prefix << first << " to " <<
+                       prefix << first + objects.size () - 1 << " under context " << &context);
+}
+
+void
+Names::AddRangeInternal (std::string path, std::string prefix, uint32_t first,
+                         const std::vector<Ptr<Object> > &objects)
+{
+  NS_LOG_FUNCTION (path << prefix << first << objects.size ());
+  bool result = NamesPriv::Get ()->AddRange (path, prefix, first, objects);
+  NS_ABORT_MSG_UNLESS (result, "Names::AddRange(): Error adding names " << prefix << first << " to " <<
+                       prefix << first + objects.size () - 1 << " under " << path);
+}
+
 void
 Names::Rename (std::string oldpath, std::string newname)
 {
@@ -19,6 +19,7 @@
 #ifndef OBJECT_NAMES_H
 #define OBJECT_NAMES_H
 
+#include <vector>
 #include "ptr.h"
 #include "object.h"
 
@@ -34,6 +35,11 @@ namespace ns3 {
  * \ingroup config
  * \brief A directory of name and Ptr<Object> associations that allows
  * us to give any ns3 Object a name.
+ *
+ * The names are kept in hash tables, by parent and name and by object,
+ * so adding and finding a name costs the same with tens of thousands of
+ * named objects. The fully qualified paths returned by FindPath are
+ * cached until a name is renamed.
  */
 class Names
 {
@@ -171,6 +177,46 @@ public:
    */
   static void Add (Ptr<Object> context, std::string name, Ptr<Object> object);
 
+  /**
+   * \brief Name a range of objects under a previously named object, with
+   * a common prefix followed by their index.
+   *
+   * This is meant for arrays of objects such as the ports of a switch:
+   * Names::AddRange (leaf, "port", devices.Begin (), devices.End ())
+   * names the devices "port0", "port1", ... under the object leaf,
+   * without building each name string in the caller.  The same rules as
+   * Names::Add apply to each name.
+   *
+   * \tparam ITERATOR An iterator over smart pointers to Objects.
+   * \param [in] context A smart pointer to an object that is used
+   *             in place of the path under which you want the new
+   *             names to be defined, 0 for the root of the name space.
+   * \param [in] prefix The prefix of the names.
+   * \param [in] begin The first object to name.
+   * \param [in] end Past the last object to name.
+   * \param [in] first The index of the first object.
+   */
+  template <typename ITERATOR>
+  static void AddRange (Ptr<Object> context, std::string prefix,
+                        ITERATOR begin, ITERATOR end, uint32_t first = 0);
+
+  /**
+   * \brief An intermediate form of Names::AddRange allowing you to
+   * provide a path to the parent object in the form of a name path
+   * string, e.g. Names::AddRange ("/Names/leaf3", "port", begin, end).
+   *
+   * \tparam ITERATOR An iterator over smart pointers to Objects.
+   * \param [in] path A path name describing a previously named object
+   *             under which you want the new names to be defined.
+   * \param [in] prefix The prefix of the names.
+   * \param [in] begin The first object to name.
+   * \param [in] end Past the last object to name.
+   * \param [in] first The index of the first object.
+   */
+  template <typename ITERATOR>
+  static void AddRange (std::string path, std::string prefix,
+                        ITERATOR begin, ITERATOR end, uint32_t first = 0);
+
   /**
    * \brief Rename a previously associated name.
    *
@@ -415,6 +461,30 @@ public:
   static Ptr<T> Find (Ptr<Object> context, std::string name);
 
 private:
+  /**
+   * \brief Non-templated internal version of Names::AddRange
+   *
+   * \param [in] context A smart pointer to the object under which
+   *             the names are defined, 0 for the root.
+   * \param [in] prefix The prefix of the names.
+   * \param [in] first The index of the first object.
+   * \param [in] objects The objects to name.
+   */
+  static void AddRangeInternal (Ptr<Object> context, std::string prefix, uint32_t first,
+                                const std::vector<Ptr<Object> > &objects);
+
+  /**
+   * \brief Non-templated internal version of Names::AddRange
+   *
+   * \param [in] path A path name describing the object under which
+   *             the names are defined.
+   * \param [in] prefix The prefix of the names.
+   * \param [in] first The index of the first object.
+   * \param [in] objects The objects to name.
+   */
+  static void AddRangeInternal (std::string path, std::string prefix, uint32_t first,
+                                const std::vector<Ptr<Object> > &objects);
+
   /**
    * \brief Non-templated internal version of Names::Find
    *
@@ -450,6 +520,34 @@ private:
 };
 
   
+template <typename ITERATOR>
+/* static */
+void
+Names::AddRange (Ptr<Object> context, std::string prefix,
+                 ITERATOR begin, ITERATOR end, uint32_t first)
+{
+  std::vector<Ptr<Object> > objects;
+  for (ITERATOR i = begin; i != end; ++i)
+    {
+      objects.push_back (*i);
+    }
+  AddRangeInternal (context, prefix, first, objects);
+}
+
+template <typename ITERATOR>
+/* static */
+void
+Names::AddRange (std::string path, std::string prefix,
+                 ITERATOR begin, ITERATOR end, uint32_t first)
+{
+  std::vector<Ptr<Object> > objects;
+  for (ITERATOR i = begin; i != end; ++i)
+    {
+      objects.push_back (*i);
+    }
+  AddRangeInternal (path, prefix, first, objects);
+}
+
 template <typename T>
 /* static */
 Ptr<T> 
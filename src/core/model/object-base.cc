@@ -26,6 +26,8 @@
 #ifdef HAVE_STDLIB_H
 #include <cstdlib>
 #endif
+#include "simple-ref-count.h"
+#include <vector>
 
 /**
  * \file
@@ -76,99 +78,169 @@ ObjectBase::NotifyConstructionCompleted (void)
   NS_LOG_FUNCTION (this);
 }
 
-void
-ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
+namespace {
+
+/**
+ * \ingroup object
+ * How ObjectBase::ConstructSelf sets one attribute.
+ */
+struct ConstructionStep
 {
-  // loop over the inheritance tree back to the Object base class.
-  NS_LOG_FUNCTION (this << &attributes);
-  TypeId tid = GetInstanceTypeId ();
+  Ptr<const AttributeAccessor> accessor;        //!< The attribute accessor
+  Ptr<const AttributeChecker> checker;          //!< The attribute checker
+  Ptr<const AttributeValue> value;              //!< The default value
+  bool checked;                                 //!< The default value passed the checker
+  bool construct;                               //!< The attribute has the ATTR_CONSTRUCT flag
+  std::string tidName;                          //!< The TypeId name, for the messages
+  std::string name;                             //!< The attribute name, for the messages
+};
+
+/**
+ * \ingroup object
+ * The attributes of a TypeId and of its parents, with their default
+ * values resolved, in the order ObjectBase::ConstructSelf sets them.
+ */
+struct ConstructionPlan : public SimpleRefCount<ConstructionPlan>
+{
+  uint32_t generation;                          //!< TypeId::GetAttributeGeneration when built
+  std::vector<struct ConstructionStep> steps;   //!< The attributes
+};
+
+/**
+ * \ingroup object
+ * Get the construction plan of a TypeId, built on first use and rebuilt
+ * when an attribute changed.
+ *
+ * The default value of an attribute is the value set in the
+ * NS_ATTRIBUTE_DEFAULT environment variable, if any, else its initial
+ * value. A default value which already passes the checker is set as is
+ * at every construction, without the copy made by the checker. Others,
+ * like strings parsed into objects, go through the checker at every
+ * construction, so that every object gets its own copy.
+ *
+ * A stale plan is replaced, not modified, since the constructions
+ * nested in the construction of an object may rebuild its plan.
+ *
+ * \param [in] tid The TypeId.
+ * \returns The plan.
+ */
+Ptr<const ConstructionPlan>
+GetConstructionPlan (TypeId tid)
+{
+  static std::vector<Ptr<ConstructionPlan> > plans;
+  uint32_t generation = TypeId::GetAttributeGeneration ();
+  uint16_t uid = tid.GetUid ();
+  if (plans.size () <= uid)
+    {
+      plans.resize (uid + 1);
+    }
+  if (plans[uid] != 0 && plans[uid]->generation == generation)
+    {
+      return plans[uid];
+    }
+
+  NS_LOG_DEBUG ("build construction plan of tid=" << tid.GetName ());
+  std::string env;
+#ifdef HAVE_GETENV
+  char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
+  if (envVar != 0)
+    {
+      env = std::string (envVar);
+    }
+#endif /* HAVE_GETENV */
+
+  Ptr<ConstructionPlan> plan = Create<ConstructionPlan> ();
   do {
-      // loop over all attributes in object type
-      NS_LOG_DEBUG ("construct tid="<<tid.GetName ()<<", params="<<tid.GetAttributeN ());
       for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
         {
-          struct TypeId::AttributeInformation info = tid.GetAttribute(i);
-          NS_LOG_DEBUG ("try to construct \""<< tid.GetName ()<<"::"<<
-                        info.name <<"\"");
-          // is this attribute stored in this AttributeConstructionList instance ?
-          Ptr<AttributeValue> value = attributes.Find(info.checker);
-          // See if this attribute should not be set here in the
-          // constructor.
-          if (!(info.flags & TypeId::ATTR_CONSTRUCT))
-            {
-              // Handle this attribute if it should not be 
-              // set here.
-              if (value == 0)
-                {
-                  // Skip this attribute if it's not in the
-                  // AttributeConstructionList.
-                  continue;
-                }              
-              else
-                {
-                  // This is an error because this attribute is not
-                  // settable in its constructor but is present in
-                  // the AttributeConstructionList.
-                  NS_FATAL_ERROR ("Attribute name="<<info.name<<" tid="<<tid.GetName () << ": initial value cannot be set using attributes");
-                }
-            }
-          bool found = false;
-          if (value != 0)
-            {
-              // We have a matching attribute value.
-              if (DoSet (info.accessor, info.checker, *value))
-                {
-                  NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                                info.name<<"\"");
-                  found = true;
-                  continue;
-                }
-            }              
-          if (!found)
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          struct ConstructionStep step;
+          step.accessor = info.accessor;
+          step.checker = info.checker;
+          step.value = info.initialValue;
+          step.construct = (info.flags & TypeId::ATTR_CONSTRUCT) != 0;
+          step.tidName = tid.GetName ();
+          step.name = info.name;
+
+          std::string::size_type cur = 0;
+          std::string::size_type next = 0;
+          while (!env.empty () && next != std::string::npos)
             {
-              // No matching attribute value so we try to look at the env var.
-#ifdef HAVE_GETENV
-              char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
-              if (envVar != 0)
+              next = env.find (";", cur);
+              std::string tmp = std::string (env, cur, next-cur);
+              std::string::size_type equal = tmp.find ("=");
+              if (equal != std::string::npos)
                 {
-                  std::string env = std::string (envVar);
-                  std::string::size_type cur = 0;
-                  std::string::size_type next = 0;
-                  while (next != std::string::npos)
+                  std::string name = tmp.substr (0, equal);
+                  std::string value = tmp.substr (equal+1, tmp.size () - equal - 1);
+                  if (name == tid.GetAttributeFullName (i)
+                      && info.checker->CreateValidValue (StringValue (value)) != 0)
                     {
-                      next = env.find (";", cur);
-                      std::string tmp = std::string (env, cur, next-cur);
-                      std::string::size_type equal = tmp.find ("=");
-                      if (equal != std::string::npos)
-                        {
-                          std::string name = tmp.substr (0, equal);
-                          std::string value = tmp.substr (equal+1, tmp.size () - equal - 1);
-                          if (name == tid.GetAttributeFullName (i))
-                            {
-                              if (DoSet (info.accessor, info.checker, StringValue (value)))
-                                {
-                                  NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                                                info.name <<"\" from env var");
-                                  found = true;
-                                  break;
-                                }
-                            }
-                        }
-                      cur = next + 1;
+                      step.value = Create<StringValue> (value);
+                      break;
                     }
                 }
-#endif /* HAVE_GETENV */
-            }
-          if (!found)
-            {
-              // No matching attribute value so we try to set the default value.
-              DoSet (info.accessor, info.checker, *info.initialValue);
-              NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                            info.name <<"\" from initial value.");
+              cur = next + 1;
             }
+          step.checked = info.checker->Check (*step.value);
+          plan->steps.push_back (step);
         }
       tid = tid.GetParent ();
     } while (tid != ObjectBase::GetTypeId ());
+  plan->generation = generation;
+  plans[uid] = plan;
+  return plan;
+}
+
+} // anonymous namespace
+
+void
+ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
+{
+  // loop over the inheritance tree back to the Object base class.
+  NS_LOG_FUNCTION (this << &attributes);
+  Ptr<const ConstructionPlan> plan = GetConstructionPlan (GetInstanceTypeId ());
+  bool hasAttributes = attributes.Begin () != attributes.End ();
+  for (std::vector<struct ConstructionStep>::const_iterator step = plan->steps.begin ();
+       step != plan->steps.end (); ++step)
+    {
+      // is this attribute stored in this AttributeConstructionList instance ?
+      Ptr<AttributeValue> value;
+      if (hasAttributes)
+        {
+          value = attributes.Find (step->checker);
+        }
+      // See if this attribute should not be set here in the
+      // constructor.
+      if (!step->construct)
+        {
+          if (value != 0)
+            {
+              // This is an error because this attribute is not
+              // settable in its constructor but is present in
+              // the AttributeConstructionList.
+              NS_FATAL_ERROR ("Attribute name="<<step->name<<" tid="<<step->tidName << ": initial value cannot be set using attributes");
+            }
+          continue;
+        }
+      if (value != 0 && DoSet (step->accessor, step->checker, *value))
+        {
+          NS_LOG_DEBUG ("construct \""<< step->tidName<<"::"<<
+                        step->name<<"\"");
+          continue;
+        }
+      // No matching attribute value so we set the default value.
+      if (step->checked)
+        {
+          step->accessor->Set (this, *step->value);
+        }
+      else
+        {
+          DoSet (step->accessor, step->checker, *step->value);
+        }
+      NS_LOG_DEBUG ("construct \""<< step->tidName<<"::"<<
+                    step->name <<"\" from default value.");
+    }
   NotifyConstructionCompleted ();
 }
 
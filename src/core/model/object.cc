@@ -27,6 +27,7 @@
 #include "string.h"
 #include <vector>
 #include <sstream>
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 
@@ -46,6 +47,83 @@ NS_LOG_COMPONENT_DEFINE ("Object");
 
 NS_OBJECT_ENSURE_REGISTERED (Object);
 
+/**
+ * Direct-mapped cache of the lookups of the aggregates by TypeId uid.
+ * An entry whose uid is 0 is empty, an entry whose object is 0 records
+ * that no aggregate has the TypeId.
+ */
+struct Object::AggregateCache
+{
+  /** The number of entries, a power of two. */
+  static const uint32_t SIZE = 16;
+  /** A cached lookup. */
+  struct Entry
+  {
+    uint16_t uid;                       //!< The uid of the TypeId looked up
+    Object *object;                     //!< The Object found
+  };
+  Entry entries[SIZE];                  //!< The entries, indexed by uid modulo SIZE
+};
+
+namespace {
+
+/** The counters of the lookups of a TypeId by GetObject. */
+struct GetObjectStats
+{
+  uint64_t lookups;                     //!< Number of lookups
+  uint64_t misses;                      //!< Lookups which scanned the aggregates
+};
+
+/** Whether the lookups are counted. */
+bool g_getObjectStatsEnabled = false;
+
+/**
+ * Get the counters of the lookups, indexed by TypeId uid.
+ * \returns The counters.
+ */
+std::vector<GetObjectStats> &
+GetObjectStatsTable (void)
+{
+  static std::vector<GetObjectStats> table;
+  return table;
+}
+
+/**
+ * Count a lookup.
+ * \param [in] uid The uid of the TypeId looked up.
+ * \param [in] miss Whether the lookup scanned the aggregates.
+ */
+void
+RecordGetObject (uint16_t uid, bool miss)
+{
+  std::vector<GetObjectStats> &table = GetObjectStatsTable ();
+  if (uid >= table.size ())
+    {
+      GetObjectStats zero = { 0, 0 };
+      table.resize (uid + 1, zero);
+    }
+  table[uid].lookups++;
+  if (miss)
+    {
+      table[uid].misses++;
+    }
+}
+
+/**
+ * Order the TypeId uids by decreasing number of lookups.
+ * \param [in] a The first uid.
+ * \param [in] b The second uid.
+ * \returns \c true if \p a was looked up more often than \p b.
+ */
+bool
+CompareGetObjectStats (uint16_t a, uint16_t b)
+{
+  const std::vector<GetObjectStats> &table = GetObjectStatsTable ();
+  return table[a].lookups > table[b].lookups;
+}
+
+} // unnamed namespace
+
 Object::AggregateIterator::AggregateIterator ()
   : m_object (0),
     m_current (0)
@@ -102,6 +180,7 @@ Object::Object ()
 {
   NS_LOG_FUNCTION (this);
   m_aggregates->n = 1;
+  m_aggregates->cache = 0;
   m_aggregates->buffer[0] = this;
 }
 Object::~Object () 
@@ -120,10 +199,16 @@ Object::~Object ()
           m_aggregates->n--;
         }
     }
+  // the cache may point to this object
+  if (m_aggregates->cache != 0)
+    {
+      std::memset (m_aggregates->cache, 0, sizeof (struct AggregateCache));
+    }
   // finally, if all objects have been removed from the list,
   // delete the aggregate list
   if (m_aggregates->n == 0)
     {
+      std::free (m_aggregates->cache);
       std::free (m_aggregates);
     }
   m_aggregates = 0;
@@ -136,6 +221,7 @@ Object::Object (const Object &o)
     m_getObjectCount (0)
 {
   m_aggregates->n = 1;
+  m_aggregates->cache = 0;
   m_aggregates->buffer[0] = this;
 }
 void
@@ -151,6 +237,25 @@ Object::DoGetObject (TypeId tid) const
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (CheckLoose ());
 
+  uint16_t uid = tid.GetUid ();
+  struct AggregateCache::Entry *entry = 0;
+  if (m_aggregates->cache != 0)
+    {
+      entry = &m_aggregates->cache->entries[uid & (AggregateCache::SIZE - 1)];
+      if (entry->uid == uid)
+        {
+          if (g_getObjectStatsEnabled)
+            {
+              RecordGetObject (uid, false);
+            }
+          return entry->object;
+        }
+    }
+  if (g_getObjectStatsEnabled)
+    {
+      RecordGetObject (uid, true);
+    }
+
   uint32_t n = m_aggregates->n;
   TypeId objectTid = Object::GetTypeId ();
   for (uint32_t i = 0; i < n; i++)
@@ -173,12 +278,65 @@ Object::DoGetObject (TypeId tid) const
           current->m_getObjectCount++;
           // then, update the sort
           UpdateSortedArray (m_aggregates, i);
-          // finally, return the match
+          // finally, remember and return the match
+          if (entry != 0)
+            {
+              entry->uid = uid;
+              entry->object = current;
+            }
           return const_cast<Object *> (current);
         }
     }
+  if (entry != 0)
+    {
+      entry->uid = uid;
+      entry->object = 0;
+    }
   return 0;
 }
+
+void
+Object::EnableGetObjectStats (bool enable)
+{
+  NS_LOG_FUNCTION (enable);
+  if (enable)
+    {
+      GetObjectStatsTable ().clear ();
+    }
+  g_getObjectStatsEnabled = enable;
+}
+
+void
+Object::GetGetObjectStats (TypeId tid, uint64_t &lookups, uint64_t &misses)
+{
+  NS_LOG_FUNCTION (tid);
+  const std::vector<GetObjectStats> &table = GetObjectStatsTable ();
+  uint16_t uid = tid.GetUid ();
+  lookups = uid < table.size () ? table[uid].lookups : 0;
+  misses = uid < table.size () ? table[uid].misses : 0;
+}
+
+void
+Object::PrintGetObjectStats (std::ostream &os)
+{
+  NS_LOG_FUNCTION (&os);
+  const std::vector<GetObjectStats> &table = GetObjectStatsTable ();
+  std::vector<uint16_t> uids;
+  for (uint32_t uid = 1; uid < table.size (); uid++)
+    {
+      if (table[uid].lookups > 0)
+        {
+          uids.push_back (uid);
+        }
+    }
+  std::stable_sort (uids.begin (), uids.end (), CompareGetObjectStats);
+  for (std::vector<uint16_t>::const_iterator i = uids.begin (); i != uids.end (); ++i)
+    {
+      os << TypeId::GetRegistered (*i - 1).GetName ()
+         << " lookups=" << table[*i].lookups
+         << " misses=" << table[*i].misses << std::endl;
+    }
+}
 void
 Object::Initialize (void)
 {
@@ -264,6 +422,8 @@ Object::AggregateObject (Ptr<Object> o)
   struct Aggregates *aggregates = 
     (struct Aggregates *)std::malloc (sizeof(struct Aggregates)+(total-1)*sizeof(Object*));
   aggregates->n = total;
+  // calloc leaves all the entries of the cache empty
+  aggregates->cache = (struct AggregateCache *)std::calloc (1, sizeof (struct AggregateCache));
 
   // copy our buffer to the new buffer
   std::memcpy (&aggregates->buffer[0], 
@@ -307,7 +467,9 @@ Object::AggregateObject (Ptr<Object> o)
     }
 
   // Now that we are done with them, we can free our old aggregate buffers
+  std::free (a->cache);
   std::free (a);
+  std::free (b->cache);
   std::free (b);
 }
 /**
@@ -163,6 +163,32 @@ private:
    */
   template <typename T>
   Ptr<T> GetObject (TypeId tid) const;
+
+  /**
+   * Start or stop counting the lookups of each TypeId by GetObject.
+   *
+   * The lookups resolved by the first aggregate are not counted.
+   * Enabling the counters resets them.
+   *
+   * \param [in] enable Whether to count the lookups.
+   */
+  static void EnableGetObjectStats (bool enable);
+  /**
+   * Get the counters of the lookups of a TypeId by GetObject.
+   *
+   * \param [in] tid The TypeId looked up.
+   * \param [out] lookups The number of lookups of \p tid.
+   * \param [out] misses The number of lookups of \p tid which missed the
+   *        cache and scanned the aggregates.
+   */
+  static void GetGetObjectStats (TypeId tid, uint64_t &lookups, uint64_t &misses);
+  /**
+   * Print the counters of the TypeIds looked up by GetObject, the most
+   * looked up first, to find the callers worth keeping a pointer.
+   *
+   * \param [in,out] os The output stream.
+   */
+  static void PrintGetObjectStats (std::ostream &os);
   /**
    * Dispose of this Object.
    *
@@ -316,6 +342,9 @@ private:
   friend class AggregateIterator;
   friend struct ObjectDeleter;
 
+  /** The cache of the lookups of Objects by TypeId, see DoGetObject(). */
+  struct AggregateCache;
+
   /**
    * The list of Objects aggregated to this one.
    *
@@ -331,6 +360,11 @@ private:
   struct Aggregates {
     /** The number of entries in \c buffer. */
     uint32_t n;
+    /**
+     * The results of the last lookups by TypeId, allocated once several
+     * Objects are aggregated.
+     */
+    struct AggregateCache *cache;
     /** The array of Objects. */
     Object *buffer[1];
   };
@@ -338,6 +372,12 @@ private:
   /**
    * Find an Object of TypeId tid in the aggregates of this Object.
    *
+   * The result, found or not, is kept in a small cache indexed by the
+   * uid of \p tid and shared by the aggregates, so that a repeated
+   * lookup does not scan the aggregates and walk their TypeId parents.
+   * The cache is replaced with the aggregate list by AggregateObject()
+   * and cleared when an aggregated Object is deleted.
+   *
    * \param [in] tid The TypeId we're looking for
    * \return The matching Object, if it is found
    */
@@ -426,6 +466,7 @@ private:
    *
    * This integer is used to implement a heuristic to sort
    * the array of aggregates in most-frequently accessed order.
+   * The lookups answered by the cache are not counted.
    */
   uint32_t m_getObjectCount;
 };
@@ -34,6 +34,7 @@
 
 
 #include <cmath>
+#include <algorithm>
 
 
 /**
@@ -107,6 +108,14 @@ void
 RealtimeSimulatorImpl::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_eventsWithContextBatch.clear ();
+  m_eventsWithContext.Drain (m_eventsWithContextBatch);
+  for (std::vector<MpscEventRing::Event>::const_iterator i = m_eventsWithContextBatch.begin ();
+       i != m_eventsWithContextBatch.end (); ++i)
+    {
+      i->event->Unref ();
+    }
+  m_eventsWithContextBatch.clear ();
   while (!m_events->IsEmpty ())
     {
       Scheduler::Event next = m_events->RemoveNext ();
@@ -220,6 +229,7 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
         //
         NS_ASSERT_MSG (m_synchronizer->Realtime (), 
                        "RealtimeSimulatorImpl::ProcessOneEvent (): Synchronizer reports not Realtime ()");
+        ProcessEventsWithContext ();
 
         //
         // tsNow is set to the normalized current real time.  When the simulation was
@@ -259,6 +269,16 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
         m_synchronizer->SetCondition (false);
       }
 
+      //
+      // The threads which push events in m_eventsWithContext do not take the
+      // critical section: if one of them signalled before we reset the
+      // condition, its event is already visible here.
+      //
+      if (!m_eventsWithContext.IsEmpty ())
+        {
+          continue;
+        }
+
       //
       // We have a time to delay.  This time may actually not be valid anymore
       // since we released the critical section immediately above, and a real-time
@@ -319,6 +339,7 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
 
   { 
     CriticalSection cs (m_mutex);
+    ProcessEventsWithContext ();
 
     // 
     // We do know we're waiting for an event, so there had better be an event on the 
@@ -405,6 +426,34 @@ RealtimeSimulatorImpl::IsFinished (void) const
   return rc;
 }
 
+void
+RealtimeSimulatorImpl::ProcessEventsWithContext (void)
+{
+  if (m_eventsWithContext.IsEmpty ())
+    {
+      return;
+    }
+
+  m_eventsWithContextBatch.clear ();
+  m_eventsWithContext.Drain (m_eventsWithContextBatch);
+  for (std::vector<MpscEventRing::Event>::const_iterator i = m_eventsWithContextBatch.begin ();
+       i != m_eventsWithContextBatch.end (); ++i)
+    {
+      Scheduler::Event ev;
+      ev.impl = i->event;
+      //
+      // The timestamp was computed by the other thread before it pushed the
+      // event, we may have executed later events since.
+      //
+      ev.key.m_ts = std::max (i->timestamp, m_currentTs);
+      ev.key.m_context = i->context;
+      ev.key.m_uid = m_uid;
+      m_uid++;
+      m_unscheduledEvents++;
+      m_events->Insert (ev);
+    }
+}
+
 //
 // Peeks into event list.  Should be called with critical section locked.
 //
@@ -441,6 +490,7 @@ RealtimeSimulatorImpl::Run (void)
       bool process = false;
       {
         CriticalSection cs (m_mutex);
+        ProcessEventsWithContext ();
 
         if (!m_events->IsEmpty ())
           {
@@ -543,23 +593,35 @@ RealtimeSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
 {
   NS_LOG_FUNCTION (this << context << delay << impl);
 
+  if (!SystemThread::Equals (m_main))
+    {
+      //
+      // If the simulator is running, we're pacing and have a meaningful 
+      // realtime clock.  If we're not, then m_currentTs is where we stopped.
+      // The event goes through m_eventsWithContext without taking the
+      // critical section, so that threads feeding events at a high rate do
+      // not contend with the simulation thread.
+      //
+      MpscEventRing::Event ev;
+      ev.context = context;
+      if (m_running)
+        {
+          ev.timestamp = m_synchronizer->GetCurrentRealtime ();
+        }
+      else
+        {
+          ev.timestamp = __atomic_load_n (&m_currentTs, __ATOMIC_RELAXED);
+        }
+      ev.timestamp += delay.GetTimeStep ();
+      ev.event = impl;
+      m_eventsWithContext.Push (ev);
+      m_synchronizer->Signal ();
+      return;
+    }
+
   {
     CriticalSection cs (m_mutex);
-    uint64_t ts;
-
-    if (SystemThread::Equals (m_main))
-      {
-        ts = m_currentTs + delay.GetTimeStep ();
-      }
-    else
-      {
-        //
-        // If the simulator is running, we're pacing and have a meaningful 
-        // realtime clock.  If we're not, then m_currentTs is where we stopped.
-        // 
-        ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
-        ts += delay.GetTimeStep ();
-      }
+    uint64_t ts = m_currentTs + delay.GetTimeStep ();
 
     NS_ASSERT_MSG (ts >= m_currentTs, "RealtimeSimulatorImpl::ScheduleRealtime(): schedule for time < m_currentTs");
     Scheduler::Event ev;
@@ -30,8 +30,10 @@
 #include "assert.h"
 #include "log.h"
 #include "system-mutex.h"
+#include "mpsc-event-ring.h"
 
 #include <list>
+#include <vector>
 
 /**
  * \file
@@ -172,6 +174,11 @@ private:
   uint64_t NextTs (void) const;
   /** Process the next event. */
   void ProcessOneEvent (void);
+  /**
+   * Move the events scheduled from other threads into the event list.
+   * Should be called with #m_mutex locked.
+   */
+  void ProcessEventsWithContext (void);
   /** Destructor implementation. */
   virtual void DoDispose (void);
 
@@ -207,6 +214,14 @@ private:
   /** Mutex to control access to key state. */  
   mutable SystemMutex m_mutex;  
 
+  /**
+   * The events scheduled from other threads, with their absolute
+   * timestamp. Pushing them takes no lock.
+   */
+  MpscEventRing m_eventsWithContext;
+  /** The last batch of events drained from #m_eventsWithContext. */
+  std::vector<MpscEventRing::Event> m_eventsWithContextBatch;
+
   /** The synchronizer in use to track real time. */
   Ptr<Synchronizer> m_synchronizer;
 
@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "simulation-checkpoint.h"
+#include "simulator.h"
+#include "log.h"
+#include "fatal-error.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "system-thread.h"
+#endif
+
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::SimulationCheckpoint implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SimulationCheckpoint");
+
+namespace {
+
+/** Branch run by this process */
+uint32_t g_branch = 0;
+
+/** Whether this process was forked at a checkpoint */
+bool g_child = false;
+
+} // anonymous namespace
+
+SimulationCheckpoint::SimulationCheckpoint ()
+  : m_maxParallel (1),
+    m_nFailed (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SimulationCheckpoint::~SimulationCheckpoint ()
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+}
+
+uint32_t
+SimulationCheckpoint::AddBranch (Callback<void> configure)
+{
+  NS_LOG_FUNCTION (this);
+  m_branches.push_back (configure);
+  return m_branches.size () - 1;
+}
+
+void
+SimulationCheckpoint::SetMaxParallel (uint32_t maxParallel)
+{
+  NS_LOG_FUNCTION (this << maxParallel);
+  NS_ASSERT_MSG (maxParallel > 0, "At least one branch must run at a time");
+  m_maxParallel = maxParallel;
+}
+
+void
+SimulationCheckpoint::Schedule (Time delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  m_event.Cancel ();
+  m_event = Simulator::Schedule (delay, &SimulationCheckpoint::Fork, this);
+}
+
+uint32_t
+SimulationCheckpoint::GetNFailed (void) const
+{
+  return m_nFailed;
+}
+
+uint32_t
+SimulationCheckpoint::GetBranch (void)
+{
+  return g_branch;
+}
+
+bool
+SimulationCheckpoint::IsChild (void)
+{
+  return g_child;
+}
+
+void
+SimulationCheckpoint::WaitBranch (void)
+{
+  NS_LOG_FUNCTION (this);
+  int status;
+  pid_t pid = wait (&status);
+  if (pid < 0)
+    {
+      NS_FATAL_ERROR ("Waiting for a branch failed: " << std::strerror (errno));
+    }
+  if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+    {
+      NS_LOG_WARN ("Branch process " << pid << " did not exit successfully");
+      ++m_nFailed;
+    }
+}
+
+void
+SimulationCheckpoint::Fork (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_branches.empty ())
+    {
+      return;
+    }
+
+#ifdef HAVE_PTHREAD_H
+  // The children would have no copy of the threads, e.g., the writer of a
+  // BinaryTraceFile, and would block on the state they serve
+  if (SystemThread::GetNJoinable () > 0)
+    {
+      NS_FATAL_ERROR ("Cannot fork the branches while " << SystemThread::GetNJoinable ()
+                      << " helper thread(s) are running; close the binary trace files"
+                      " before the checkpoint or open them in the branch callbacks");
+    }
+#endif
+
+  uint32_t running = 0;
+  for (uint32_t branch = 1; branch < m_branches.size (); ++branch)
+    {
+      // Reap a child before starting a new one if enough are running
+      while (running >= m_maxParallel)
+        {
+          WaitBranch ();
+          --running;
+        }
+
+      // The buffered output would be written once by each process
+      std::cout.flush ();
+      std::cerr.flush ();
+      std::clog.flush ();
+      std::fflush (0);
+
+      pid_t pid = fork ();
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("Forking branch " << branch << " failed: " << std::strerror (errno));
+        }
+      if (pid == 0)
+        {
+          g_branch = branch;
+          g_child = true;
+          NS_LOG_LOGIC ("Running branch " << branch << " in process " << getpid ());
+          m_branches[branch] ();
+          return;
+        }
+      NS_LOG_LOGIC ("Forked branch " << branch << " as process " << pid);
+      ++running;
+    }
+
+  while (running > 0)
+    {
+      WaitBranch ();
+      --running;
+    }
+
+  m_branches[0] ();
+}
+
+} // namespace ns3
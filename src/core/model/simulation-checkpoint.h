@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SIMULATION_CHECKPOINT_H
+#define SIMULATION_CHECKPOINT_H
+
+#include "nstime.h"
+#include "callback.h"
+#include "event-id.h"
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::SimulationCheckpoint declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \brief Run several variants of a simulation from a common warm-up.
+ *
+ * The events of a simulation hold callbacks bound to arbitrary objects, so
+ * the state of a running simulation cannot be written to a file and read
+ * back. It can be copied by the operating system instead: when the
+ * checkpoint time is reached, the process is forked once per branch, and
+ * each copy continues from the same state (event queue, nodes, devices,
+ * queue discs, sockets, applications and random number stream positions)
+ * after the configuration callback of its branch has run. A branch
+ * callback typically changes attributes with Config::Set, for instance
+ * an AQM threshold:
+ *
+ * \code
+ *   SimulationCheckpoint checkpoint;
+ *   checkpoint.AddBranch (MakeBoundCallback (&SetTarget, MicroSeconds (10)));
+ *   checkpoint.AddBranch (MakeBoundCallback (&SetTarget, MicroSeconds (40)));
+ *   checkpoint.Schedule (Seconds (0.05));
+ *   Simulator::Run ();
+ *   // Write the results of branch SimulationCheckpoint::GetBranch ()
+ * \endcode
+ *
+ * Branch 0 runs in the original process, the others in child processes.
+ * The original process waits for its children to exit before running
+ * branch 0, with at most MaxParallel children running at the same time.
+ * All the processes return from Simulator::Run, so each one must write its
+ * results to files of its own, named after GetBranch (). Output streams
+ * are flushed before forking; files opened before the checkpoint (pcap or
+ * ascii traces) are shared by the branches and should be avoided.
+ *
+ * A forked process has no copy of the threads of its parent, so the
+ * checkpoint aborts if threads started with SystemThread have not been
+ * joined, e.g., the writer thread of an open BinaryTraceFile. Close such
+ * files before the checkpoint, or open them in the branch callbacks.
+ *
+ * The checkpoint is only available on POSIX systems.
+ */
+class SimulationCheckpoint
+{
+public:
+  SimulationCheckpoint ();
+  ~SimulationCheckpoint ();
+
+  /**
+   * Add a branch.
+   *
+   * \param [in] configure the callback run by the branch at the checkpoint
+   * \return the index of the branch
+   */
+  uint32_t AddBranch (Callback<void> configure);
+
+  /**
+   * Set the maximum number of branches running at the same time.
+   *
+   * \param [in] maxParallel the number of processes, at least 1
+   */
+  void SetMaxParallel (uint32_t maxParallel);
+
+  /**
+   * Schedule the checkpoint.
+   *
+   * \param [in] delay the delay from now
+   */
+  void Schedule (Time delay);
+
+  /**
+   * \return the number of branches which did not exit successfully, known
+   *         by the original process once the checkpoint has been reached
+   */
+  uint32_t GetNFailed (void) const;
+
+  /**
+   * \return the index of the branch run by this process, 0 in the original
+   *         process or if no checkpoint was reached
+   */
+  static uint32_t GetBranch (void);
+
+  /**
+   * \return true if this process is a child forked at a checkpoint
+   */
+  static bool IsChild (void);
+
+private:
+  /** Fork the branches */
+  void Fork (void);
+
+  /** Wait for a child process to exit and count its failure, if any */
+  void WaitBranch (void);
+
+  std::vector<Callback<void> > m_branches; //!< Configuration of the branches
+  uint32_t m_maxParallel;                  //!< Branches run at the same time
+  uint32_t m_nFailed;                      //!< Branches which failed
+  EventId m_event;                         //!< The checkpoint event
+};
+
+} // namespace ns3
+
+#endif /* SIMULATION_CHECKPOINT_H */
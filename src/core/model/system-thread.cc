@@ -35,6 +35,13 @@ NS_LOG_COMPONENT_DEFINE ("SystemThread");
 
 #ifdef HAVE_PTHREAD_H
 
+namespace {
+
+/** Threads started and not joined */
+uint32_t g_nJoinable = 0;
+
+} // anonymous namespace
+
 SystemThread::SystemThread (Callback<void> callback)
   : m_callback (callback)
 {
@@ -59,6 +66,7 @@ SystemThread::Start (void)
       NS_FATAL_ERROR ("pthread_create failed: " << rc << "=\"" << 
                       strerror (rc) << "\".");
     }
+  __atomic_add_fetch (&g_nJoinable, 1, __ATOMIC_RELAXED);
 }
 
 void
@@ -73,6 +81,7 @@ SystemThread::Join (void)
       NS_FATAL_ERROR ("pthread_join failed: " << rc << "=\"" << 
                       strerror (rc) << "\".");
     }
+  __atomic_sub_fetch (&g_nJoinable, 1, __ATOMIC_RELAXED);
 }
 
 void *
@@ -99,6 +108,12 @@ SystemThread::Equals (SystemThread::ThreadId id)
   return (pthread_equal (pthread_self (), id) != 0);
 }
 
+uint32_t
+SystemThread::GetNJoinable (void)
+{
+  return __atomic_load_n (&g_nJoinable, __ATOMIC_RELAXED);
+}
+
 #endif /* HAVE_PTHREAD_H */
 
 } // namespace ns3
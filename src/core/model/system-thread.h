@@ -156,6 +156,19 @@ public:
    */
   static bool Equals(ThreadId id);
 
+#ifdef HAVE_PTHREAD_H
+  /**
+   * @brief Get the number of threads started and not joined yet.
+   *
+   * A process forked while such threads exist has no copy of them, so
+   * the state they own (e.g., the buffers of a background writer) is
+   * left without a thread to serve it in the child.
+   *
+   * @returns The number of threads started and not joined.
+   */
+  static uint32_t GetNJoinable (void);
+#endif /* HAVE_PTHREAD_H */
+
 private:
 #ifdef HAVE_PTHREAD_H
   /**
@@ -78,6 +78,8 @@ NS_LOG_COMPONENT_DEFINE ("TypeId");
 class IidManager : public Singleton<IidManager>
 {
 public:
+  /** Constructor. */
+  IidManager ();
   /**
    * Create a new unique type id.
    * \param [in] name The name of this type id.
@@ -182,6 +184,11 @@ public:
    * \returns The type id.
    */
   uint16_t GetRegistered (uint32_t i) const;
+  /**
+   * Get the generation of the attributes of all the type ids.
+   * \returns The generation.
+   */
+  uint32_t GetAttributeGeneration (void) const;
   /**
    * Record a new attribute in a type id.
    * \param [in] uid The id.
@@ -331,6 +338,9 @@ private:
   /** The by-hash index. */
   hashmap_t m_hashmap;
 
+  /** Incremented when an attribute is added or its initial value set. */
+  uint32_t m_attributeGeneration;
+
 
   enum {
     /**
@@ -344,6 +354,11 @@ private:
 };
 
 
+IidManager::IidManager ()
+  : m_attributeGeneration (0)
+{
+}
+
 //static
 TypeId::hash_t
 IidManager::Hasher (const std::string name)
@@ -557,6 +572,12 @@ IidManager::HasConstructor (uint16_t uid) const
   return information->hasConstructor;
 }
 
+uint32_t
+IidManager::GetAttributeGeneration (void) const
+{
+  return m_attributeGeneration;
+}
+
 uint32_t 
 IidManager::GetRegisteredN (void) const
 {
@@ -623,6 +644,7 @@ IidManager::AddAttribute (uint16_t uid,
   info.accessor = accessor;
   info.checker = checker;
   information->attributes.push_back (info);
+  m_attributeGeneration++;
 }
 void 
 IidManager::SetAttributeInitialValue(uint16_t uid,
@@ -633,6 +655,7 @@ IidManager::SetAttributeInitialValue(uint16_t uid,
   struct IidInformation *information = LookupInformation (uid);
   NS_ASSERT (i < information->attributes.size ());
   information->attributes[i].initialValue = initialValue;
+  m_attributeGeneration++;
 }
 
 
@@ -787,6 +810,12 @@ TypeId::LookupByHashFailSafe (hash_t hash, TypeId *tid)
   return true;
 }
 
+uint32_t
+TypeId::GetAttributeGeneration (void)
+{
+  return IidManager::Get ()->GetAttributeGeneration ();
+}
+
 uint32_t 
 TypeId::GetRegisteredN (void)
 {
@@ -149,6 +149,16 @@ public:
    * \returns The TypeId instance whose index is \c i.
    */
   static TypeId GetRegistered (uint32_t i);
+  /**
+   * Get the generation of the attributes of all the TypeIds.
+   *
+   * The generation changes whenever an Attribute is added or its
+   * initial value is set, so anything cached from the attributes
+   * is stale once the generation changed.
+   *
+   * \returns The current generation.
+   */
+  static uint32_t GetAttributeGeneration (void);
 
   /**
    * Constructor.
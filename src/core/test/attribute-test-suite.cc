@@ -1399,6 +1399,67 @@ CallbackValueTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_gotCbValue, 2, "Callback Attribute set to null callback unexpectedly fired");
 }
 
+// ===========================================================================
+// Test the default values set at construction, which are cached per TypeId
+// and must follow the changes of the defaults.
+// ===========================================================================
+class ConstructionDefaultsTestCase : public TestCase
+{
+public:
+  ConstructionDefaultsTestCase (std::string description);
+  virtual ~ConstructionDefaultsTestCase () {}
+
+private:
+  virtual void DoRun (void);
+};
+
+ConstructionDefaultsTestCase::ConstructionDefaultsTestCase (std::string description)
+  : TestCase (description)
+{
+}
+
+void
+ConstructionDefaultsTestCase::DoRun (void)
+{
+  IntegerValue i;
+  PointerValue a;
+  PointerValue b;
+
+  Ptr<AttributeObjectTest> p = CreateObject<AttributeObjectTest> ();
+  p->GetAttribute ("TestInt16", i);
+  NS_TEST_ASSERT_MSG_EQ (i.Get (), -2, "Wrong initial value of TestInt16");
+
+  //
+  // A new default applies to the objects created after it.
+  //
+  Config::SetDefault ("ns3::AttributeObjectTest::TestInt16", IntegerValue (7));
+  Ptr<AttributeObjectTest> q = CreateObject<AttributeObjectTest> ();
+  q->GetAttribute ("TestInt16", i);
+  NS_TEST_ASSERT_MSG_EQ (i.Get (), 7, "The new default of TestInt16 was not used");
+  p->GetAttribute ("TestInt16", i);
+  NS_TEST_ASSERT_MSG_EQ (i.Get (), -2, "The new default changed an existing object");
+
+  //
+  // Attributes given at construction still override the defaults.
+  //
+  Ptr<AttributeObjectTest> r = CreateObjectWithAttributes<AttributeObjectTest> ("TestInt16", IntegerValue (3));
+  r->GetAttribute ("TestInt16", i);
+  NS_TEST_ASSERT_MSG_EQ (i.Get (), 3, "The value given at construction was not used");
+
+  Config::SetDefault ("ns3::AttributeObjectTest::TestInt16", IntegerValue (-2));
+  q = CreateObject<AttributeObjectTest> ();
+  q->GetAttribute ("TestInt16", i);
+  NS_TEST_ASSERT_MSG_EQ (i.Get (), -2, "The restored default of TestInt16 was not used");
+
+  //
+  // Pointers created from a string default are not shared between objects.
+  //
+  p->GetAttribute ("PointerInitialized", a);
+  q->GetAttribute ("PointerInitialized", b);
+  NS_TEST_ASSERT_MSG_NE (a.GetObject (), 0, "PointerInitialized was not created");
+  NS_TEST_ASSERT_MSG_NE (a.GetObject (), b.GetObject (), "PointerInitialized is shared between objects");
+}
+
 // ===========================================================================
 // The Test Suite that glues all of the Test Cases together.
 // ===========================================================================
@@ -1425,6 +1486,7 @@ AttributesTestSuite::AttributesTestSuite ()
   AddTestCase (new IntegerTraceSourceAttributeTestCase ("Ensure TracedValue<uint8_t> can be set like IntegerValue"), TestCase::QUICK);
   AddTestCase (new IntegerTraceSourceTestCase ("Ensure TracedValue<uint8_t> also works as trace source"), TestCase::QUICK);
   AddTestCase (new TracedCallbackTestCase ("Ensure TracedCallback<double, int, float> works as trace source"), TestCase::QUICK);
+  AddTestCase (new ConstructionDefaultsTestCase ("Check the defaults set at construction"), TestCase::QUICK);
 }
 
 static AttributesTestSuite attributesTestSuite;
@@ -29,6 +29,7 @@
 #include "ns3/object-vector.h"
 #include "ns3/names.h"
 #include "ns3/pointer.h"
+#include "ns3/simulator.h"
 #include "ns3/log.h"
 
 
@@ -721,6 +722,141 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+// ===========================================================================
+// Test for the paths compiled once and resolved in one traversal.
+// ===========================================================================
+class CompiledPathConfigTestCase : public TestCase
+{
+public:
+  CompiledPathConfigTestCase ();
+  virtual ~CompiledPathConfigTestCase () {}
+
+  void TraceWithPath (std::string path, int16_t old, int16_t newValue) { m_count++; m_path = path; }
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check that a compiled path matches the objects of Config::LookupMatches
+   * \param path the path
+   * \param n the number of objects expected
+   */
+  void CheckMatches (std::string path, uint32_t n);
+
+  uint32_t m_count;
+  std::string m_path;
+};
+
+CompiledPathConfigTestCase::CompiledPathConfigTestCase ()
+  : TestCase ("Check that compiled paths match, set and connect like the Config paths")
+{
+}
+
+void
+CompiledPathConfigTestCase::CheckMatches (std::string path, uint32_t n)
+{
+  Config::MatchContainer expected = Config::LookupMatches (path);
+  Config::MatchContainer matches = Config::CompiledPath (path).LookupMatches ();
+  NS_TEST_ASSERT_MSG_EQ (expected.GetN (), n, "Wrong number of objects matching " << path);
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), expected.GetN (), "The compiled path " << path << " matches other objects");
+  for (uint32_t i = 0; i < matches.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (matches.Get (i), expected.Get (i), "The compiled path " << path << " matches other objects");
+      NS_TEST_EXPECT_MSG_EQ (matches.GetMatchedPath (i), expected.GetMatchedPath (i), "The compiled path " << path << " matches other paths");
+    }
+}
+
+void
+CompiledPathConfigTestCase::DoRun (void)
+{
+  IntegerValue iv;
+
+  //
+  // Build /NodeA/NodeB/NodesB/[0-3] under a new root, alone, and a name
+  // for the first object of the vector
+  //
+  std::vector<Ptr<Object> > roots;
+  while (Config::GetRootNamespaceObjectN () > 0)
+    {
+      roots.push_back (Config::GetRootNamespaceObject (0));
+      Config::UnregisterRootNamespaceObject (roots.back ());
+    }
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+  root->SetNodeA (a);
+  Ptr<ConfigTestObject> b = CreateObject<ConfigTestObject> ();
+  a->SetNodeB (b);
+  std::vector<Ptr<ConfigTestObject> > objects;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      objects.push_back (CreateObject<ConfigTestObject> ());
+      b->AddNodeB (objects[i]);
+    }
+  Names::Add ("CompiledPathFirst", objects[0]);
+
+  CheckMatches ("/NodeA/NodeB/NodesB/[0-1]|3", 3);
+  CheckMatches ("/NodeA/NodeB/NodesB/*/", 4);
+  CheckMatches ("/*/NodeB/NodesB/|0|2|", 2);
+  CheckMatches ("/NodeA/$ConfigTestObject/NodeB", 1);
+  CheckMatches ("/NodeA/NodeB/NodesB", 0);
+  CheckMatches ("/Names/CompiledPathFirst", 1);
+
+  //
+  // Set and connect through the compiled paths
+  //
+  Config::CompiledPath path ("/NodeA/NodeB/NodesB/[1-2]");
+  path.Set ("A", IntegerValue (-11));
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      int64_t expected = (i == 1 || i == 2) ? -11 : 10;
+      objects[i]->GetAttribute ("A", iv);
+      NS_TEST_ASSERT_MSG_EQ (iv.Get (), expected, "Object Attribute \"A\" not set as expected");
+    }
+
+  m_count = 0;
+  path.Connect ("Source", MakeCallback (&CompiledPathConfigTestCase::TraceWithPath, this));
+  objects[2]->SetAttribute ("Source", IntegerValue (-2));
+  NS_TEST_ASSERT_MSG_EQ (m_count, 1, "Trace 2 did not fire as expected");
+  NS_TEST_ASSERT_MSG_EQ (m_path, "/NodeA/NodeB/NodesB/2/Source", "Trace 2 did not provide expected context");
+  objects[3]->SetAttribute ("Source", IntegerValue (-3));
+  NS_TEST_ASSERT_MSG_EQ (m_count, 1, "Trace 3 fired unexpectedly");
+
+  //
+  // Subscribe, then add objects; an object reported with its parent is
+  // connected once
+  //
+  Config::CompiledPath all ("/NodeA/NodeB/NodesB/*");
+  all.Subscribe ("Source", MakeCallback (&CompiledPathConfigTestCase::TraceWithPath, this));
+  NS_TEST_ASSERT_MSG_EQ (Config::HasSubscriptions (), true, "The subscription is not kept");
+  Ptr<ConfigTestObject> obj4 = CreateObject<ConfigTestObject> ();
+  b->AddNodeB (obj4);
+  Config::NotifyObjectAdded ("/NodeA/NodeB/NodesB/4", obj4);
+  Ptr<ConfigTestObject> obj5 = CreateObject<ConfigTestObject> ();
+  b->AddNodeB (obj5);
+  Config::NotifyObjectAdded ("/NodeA/NodeB", b);
+  Config::NotifyObjectAdded ("/NodeA/NodeB/NodesB/5", obj5);
+  Config::NotifyObjectAdded ("/NodeA/NodeA", obj5);
+  Simulator::Run ();
+
+  m_count = 0;
+  obj4->SetAttribute ("Source", IntegerValue (-4));
+  NS_TEST_ASSERT_MSG_EQ (m_count, 1, "Trace 4 did not fire as expected");
+  NS_TEST_ASSERT_MSG_EQ (m_path, "/NodeA/NodeB/NodesB/4/Source", "Trace 4 did not provide expected context");
+  m_count = 0;
+  obj5->SetAttribute ("Source", IntegerValue (-5));
+  NS_TEST_ASSERT_MSG_EQ (m_count, 1, "Trace 5 should fire once");
+  NS_TEST_ASSERT_MSG_EQ (m_path, "/NodeA/NodeB/NodesB/5/Source", "Trace 5 did not provide expected context");
+
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (Config::HasSubscriptions (), false, "The subscription should end with the simulation");
+  Names::Clear ();
+  Config::UnregisterRootNamespaceObject (root);
+  for (uint32_t i = 0; i < roots.size (); i++)
+    {
+      Config::RegisterRootNamespaceObject (roots[i]);
+    }
+}
+
 // ===========================================================================
 // The Test Suite that glues all of the Test Cases together.
 // ===========================================================================
@@ -737,6 +873,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase, TestCase::QUICK);
   AddTestCase (new ObjectVectorConfigTestCase, TestCase::QUICK);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase, TestCase::QUICK);
+  AddTestCase (new CompiledPathConfigTestCase, TestCase::QUICK);
 }
 
 static ConfigTestSuite configTestSuite;
@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/event-log.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+NS_EVENT_LOG_COMPONENT_DEFINE ("EventLogTestSuite");
+
+class EventLogTestCase : public TestCase
+{
+public:
+  EventLogTestCase ();
+  virtual ~EventLogTestCase () {}
+
+private:
+  virtual void DoRun (void);
+  void Write (uint16_t type, uint64_t a, uint64_t b);
+};
+
+EventLogTestCase::EventLogTestCase ()
+  : TestCase ("Check the event log ring buffer")
+{
+}
+
+void
+EventLogTestCase::Write (uint16_t type, uint64_t a, uint64_t b)
+{
+  NS_EVENT_LOG (type, a, b);
+}
+
+void
+EventLogTestCase::DoRun (void)
+{
+  EventLog::SetCapacity (3);
+  NS_TEST_ASSERT_MSG_EQ (EventLog::GetCapacity (), 4, "Capacity is rounded up to a power of two");
+
+  // Nothing is recorded while the component is disabled
+  EventLog::Disable ("EventLogTestSuite");
+  Write (1, 2, 3);
+  NS_TEST_ASSERT_MSG_EQ (EventLog::GetTotalRecords (), 0, "Disabled component recorded an event");
+
+  EventLog::Enable ("EventLogTestSuite");
+  for (uint64_t i = 0; i < 6; ++i)
+    {
+      Simulator::Schedule (MicroSeconds (i), &EventLogTestCase::Write, this, 7, i, 2 * i);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  EventLog::Disable ("EventLogTestSuite");
+
+  NS_TEST_ASSERT_MSG_EQ (EventLog::GetTotalRecords (), 6, "Wrong number of appended records");
+  std::vector<EventLogRecord> records = EventLog::GetRecords ();
+  NS_TEST_ASSERT_MSG_EQ (records.size (), 4, "The ring should hold its capacity");
+  for (uint32_t i = 0; i < records.size (); ++i)
+    {
+      // The two oldest records have been overwritten
+      NS_TEST_ASSERT_MSG_EQ (records[i].a, i + 2, "Records are not returned oldest first");
+      NS_TEST_ASSERT_MSG_EQ (records[i].b, 2 * (i + 2), "Wrong second argument");
+      NS_TEST_ASSERT_MSG_EQ (records[i].type, 7, "Wrong event type");
+      NS_TEST_ASSERT_MSG_EQ (records[i].time, MicroSeconds (i + 2).GetTimeStep (), "Wrong record time");
+      NS_TEST_ASSERT_MSG_EQ (EventLog::GetComponentName (records[i].component), "EventLogTestSuite",
+                             "Wrong component");
+    }
+
+  EventLog::Clear ();
+  NS_TEST_ASSERT_MSG_EQ (EventLog::GetRecords ().size (), 0, "The ring should be empty after a clear");
+
+  EventLog::SetCapacity (1 << 20);
+}
+
+class EventLogTestSuite : public TestSuite
+{
+public:
+  EventLogTestSuite ();
+};
+
+EventLogTestSuite::EventLogTestSuite ()
+  : TestSuite ("event-log", UNIT)
+{
+  AddTestCase (new EventLogTestCase, TestCase::QUICK);
+}
+
+static EventLogTestSuite g_eventLogTestSuite;
@@ -16,6 +16,7 @@
 
 #include "ns3/test.h"
 #include "ns3/names.h"
+#include <sstream>
 
 using namespace ns3;
 
@@ -929,6 +930,131 @@ AlternateFindTestCase::DoRun (void)
                          "Unexpectedly able to GetObject<TestObject> on an AlternateTestObject");
 }
 
+// ===========================================================================
+// Test case to make sure that the Object Name Service can name arrays of
+// objects in bulk, using:
+//
+//   AddRange (Ptr<Object> context, std::string prefix, ITERATOR begin, ITERATOR end, uint32_t first);
+//   AddRange (std::string path, std::string prefix, ITERATOR begin, ITERATOR end, uint32_t first);
+// ===========================================================================
+class AddRangeTestCase : public TestCase
+{
+public:
+  AddRangeTestCase ();
+  virtual ~AddRangeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+AddRangeTestCase::AddRangeTestCase ()
+  : TestCase ("Check Names::AddRange functionality")
+{
+}
+
+AddRangeTestCase::~AddRangeTestCase ()
+{
+}
+
+void
+AddRangeTestCase::DoTeardown (void)
+{
+  Names::Clear ();
+}
+
+void
+AddRangeTestCase::DoRun (void)
+{
+  std::vector<Ptr<TestObject> > leaves;
+  for (uint32_t i = 0; i < 12; ++i)
+    {
+      leaves.push_back (CreateObject<TestObject> ());
+    }
+  Names::AddRange (Ptr<Object> (0, false), "leaf", leaves.begin (), leaves.end ());
+
+  std::vector<Ptr<TestObject> > ports;
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      ports.push_back (CreateObject<TestObject> ());
+    }
+  Names::AddRange (leaves[10], "port", ports.begin (), ports.begin () + 2);
+  Names::AddRange ("/Names/leaf10", "port", ports.begin () + 2, ports.end (), 2);
+
+  NS_TEST_ASSERT_MSG_EQ (Names::FindName (leaves[0]), "leaf0", "Could not Names::AddRange the first Object");
+  NS_TEST_ASSERT_MSG_EQ (Names::FindName (leaves[11]), "leaf11", "Could not Names::AddRange the last Object");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("leaf7"), leaves[7], "Could not Names::Find an Object of a range");
+
+  NS_TEST_ASSERT_MSG_EQ (Names::FindPath (ports[0]), "/Names/leaf10/port0", "Could not Names::AddRange under a context");
+  NS_TEST_ASSERT_MSG_EQ (Names::FindPath (ports[2]), "/Names/leaf10/port2", "Could not Names::AddRange under a path");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("leaf10/port1"), ports[1], "Could not Names::Find a child of a range");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("leaf1/port1"), 0, "Unexpectedly found a port under the wrong leaf");
+}
+
+// ===========================================================================
+// Test case to make sure that the Object Name Service keeps finding the
+// objects and their paths when many names are added and renamed.
+// ===========================================================================
+class ManyNamesTestCase : public TestCase
+{
+public:
+  ManyNamesTestCase ();
+  virtual ~ManyNamesTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+ManyNamesTestCase::ManyNamesTestCase ()
+  : TestCase ("Check Names with many objects and renames")
+{
+}
+
+ManyNamesTestCase::~ManyNamesTestCase ()
+{
+}
+
+void
+ManyNamesTestCase::DoTeardown (void)
+{
+  Names::Clear ();
+}
+
+void
+ManyNamesTestCase::DoRun (void)
+{
+  Ptr<TestObject> root = CreateObject<TestObject> ();
+  Names::Add ("Root", root);
+
+  std::vector<Ptr<TestObject> > children;
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      children.push_back (CreateObject<TestObject> ());
+    }
+  Names::AddRange (root, "child", children.begin (), children.end ());
+
+  Ptr<TestObject> grandChild = CreateObject<TestObject> ();
+  Names::Add ("Root/child999/Grand Child", grandChild);
+
+  NS_TEST_ASSERT_MSG_EQ (Names::FindPath (grandChild), "/Names/Root/child999/Grand Child", "Could not Names::FindPath a deep Object");
+  for (uint32_t i = 0; i < children.size (); i += 111)
+    {
+      std::ostringstream oss;
+      oss << "child" << i;
+      NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> (root, oss.str ()), children[i], "Could not Names::Find one of many Objects");
+      NS_TEST_ASSERT_MSG_EQ (Names::FindName (children[i]), oss.str (), "Could not Names::FindName one of many Objects");
+    }
+
+  Names::Rename ("Root", "New Root");
+  Names::Rename ("New Root/child999", "Last Child");
+  NS_TEST_ASSERT_MSG_EQ (Names::FindPath (grandChild), "/Names/New Root/Last Child/Grand Child",
+                         "The path of a descendant did not follow a rename");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("Root/child999"), 0, "Unexpectedly found a renamed Object");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("New Root/Last Child/Grand Child"), grandChild,
+                         "Could not Names::Find an Object under renamed parents");
+}
+
 class NamesTestSuite : public TestSuite
 {
 public:
@@ -952,6 +1078,8 @@ NamesTestSuite::NamesTestSuite ()
   AddTestCase (new FullyQualifiedFindTestCase, TestCase::QUICK);
   AddTestCase (new RelativeFindTestCase, TestCase::QUICK);
   AddTestCase (new AlternateFindTestCase, TestCase::QUICK);
+  AddTestCase (new AddRangeTestCase, TestCase::QUICK);
+  AddTestCase (new ManyNamesTestCase, TestCase::QUICK);
 }
 
 static NamesTestSuite namesTestSuite;
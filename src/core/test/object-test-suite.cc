@@ -22,6 +22,7 @@
 #include "ns3/object.h"
 #include "ns3/object-factory.h"
 #include "ns3/assert.h"
+#include <sstream>
 
 namespace {
 
@@ -359,6 +360,86 @@ AggregateObjectTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_NE (baseA, 0, "Unable to GetObject on released object");
 }
 
+// ===========================================================================
+// Test case to make sure that the lookups of aggregated Objects are cached
+// and that the cache follows the aggregation.
+// ===========================================================================
+class AggregateCacheTestCase : public TestCase
+{
+public:
+  AggregateCacheTestCase ();
+  virtual ~AggregateCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AggregateCacheTestCase::AggregateCacheTestCase ()
+  : TestCase ("Check the cache of the GetObject lookups")
+{
+}
+
+AggregateCacheTestCase::~AggregateCacheTestCase ()
+{
+}
+
+void
+AggregateCacheTestCase::DoRun (void)
+{
+  Ptr<BaseA> baseA = CreateObject<BaseA> ();
+  Ptr<BaseB> baseB = CreateObject<BaseB> ();
+  baseA->AggregateObject (baseB);
+
+  Object::EnableGetObjectStats (true);
+
+  //
+  // The first lookup scans the aggregates, the next ones hit the cache
+  // and find the same Object.
+  //
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (BaseB::GetTypeId ()), baseB, "Cannot GetObject (through baseA) for BaseB Object");
+    }
+  uint64_t lookups;
+  uint64_t misses;
+  Object::GetGetObjectStats (BaseB::GetTypeId (), lookups, misses);
+  NS_TEST_ASSERT_MSG_EQ (lookups, 3, "Wrong number of lookups of BaseB");
+  NS_TEST_ASSERT_MSG_EQ (misses, 1, "Only the first lookup of BaseB should scan the aggregates");
+
+  //
+  // The cache is shared by the aggregates and remembers the Objects which
+  // are missing too.
+  //
+  NS_TEST_ASSERT_MSG_EQ (baseB->GetObject<BaseB> (BaseB::GetTypeId ()), baseB, "Cannot GetObject (through baseB) for BaseB Object");
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (baseB->GetObject<DerivedA> (DerivedA::GetTypeId ()), 0, "Unexpectedly found a DerivedA through baseB");
+    }
+  Object::GetGetObjectStats (BaseB::GetTypeId (), lookups, misses);
+  NS_TEST_ASSERT_MSG_EQ (misses, 1, "The lookup of BaseB through baseB should hit the cache");
+  Object::GetGetObjectStats (DerivedA::GetTypeId (), lookups, misses);
+  NS_TEST_ASSERT_MSG_EQ (lookups, 2, "Wrong number of lookups of DerivedA");
+  NS_TEST_ASSERT_MSG_EQ (misses, 1, "The missing DerivedA should be cached");
+
+  //
+  // A new aggregate is found after its absence was cached.
+  //
+  Ptr<DerivedA> derivedA = CreateObject<DerivedA> ();
+  baseB->AggregateObject (derivedA);
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<DerivedA> (DerivedA::GetTypeId ()), derivedA, "Cannot GetObject (through baseA) for the new DerivedA Object");
+  NS_TEST_ASSERT_MSG_EQ (derivedA->GetObject<BaseB> (BaseB::GetTypeId ()), baseB, "Cannot GetObject (through derivedA) for BaseB Object");
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<DerivedB> (DerivedB::GetTypeId ()), 0, "Unexpectedly found a DerivedB through baseA");
+
+  std::ostringstream oss;
+  Object::PrintGetObjectStats (oss);
+  NS_TEST_ASSERT_MSG_EQ (oss.str ().find ("ObjectTest:BaseB lookups=5 misses=2"), 0, "BaseB should be the most looked up TypeId");
+
+  Object::EnableGetObjectStats (false);
+  baseA->GetObject<BaseB> (BaseB::GetTypeId ());
+  Object::GetGetObjectStats (BaseB::GetTypeId (), lookups, misses);
+  NS_TEST_ASSERT_MSG_EQ (lookups, 5, "The lookups should not be counted once the counters are disabled");
+}
+
 // ===========================================================================
 // Test case to make sure that an Object factory can create Objects
 // ===========================================================================
@@ -445,6 +526,7 @@ ObjectTestSuite::ObjectTestSuite ()
 {
   AddTestCase (new CreateObjectTestCase, TestCase::QUICK);
   AddTestCase (new AggregateObjectTestCase, TestCase::QUICK);
+  AddTestCase (new AggregateCacheTestCase, TestCase::QUICK);
   AddTestCase (new ObjectFactoryTestCase, TestCase::QUICK);
 }
 
@@ -0,0 +1,227 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/simulation-checkpoint.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/system-thread.h"
+#include "ns3/core-config.h"
+#include "ns3/test.h"
+
+#include <unistd.h>
+
+using namespace ns3;
+
+/**
+ * \ingroup core-tests
+ *
+ * Check that the branches of a checkpoint continue from the state reached
+ * at the checkpoint, each with its own configuration.
+ */
+class SimulationCheckpointTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param maxParallel the number of branches run at the same time
+   */
+  SimulationCheckpointTestCase (uint32_t maxParallel);
+  virtual void DoRun (void);
+
+private:
+  /// What a branch reports at the end of the simulation
+  struct Result
+  {
+    uint32_t branch;      //!< Branch index
+    double counter;       //!< Sum of the increments
+    double draws;         //!< Sum of the random draws after the checkpoint
+    double end;           //!< End time in seconds
+  };
+
+  /** Add the increment to the counter and draw a random value */
+  void Tick (void);
+  /**
+   * Configure a branch
+   * \param self the test case
+   * \param increment the increment of the branch
+   */
+  static void Configure (SimulationCheckpointTestCase *self, double increment);
+
+  uint32_t m_maxParallel;                 //!< Branches run at the same time
+  double m_increment;                     //!< Current increment
+  double m_counter;                       //!< Sum of the increments
+  double m_draws;                         //!< Sum of the draws after the checkpoint
+  bool m_checkpointed;                    //!< Whether the checkpoint was reached
+  Ptr<UniformRandomVariable> m_random;    //!< Random stream
+};
+
+SimulationCheckpointTestCase::SimulationCheckpointTestCase (uint32_t maxParallel)
+  : TestCase ("Check the branches of a checkpoint"),
+    m_maxParallel (maxParallel)
+{
+}
+
+void
+SimulationCheckpointTestCase::Tick (void)
+{
+  m_counter += m_increment;
+  double draw = m_random->GetValue ();
+  if (m_checkpointed)
+    {
+      m_draws += draw;
+    }
+}
+
+void
+SimulationCheckpointTestCase::Configure (SimulationCheckpointTestCase *self, double increment)
+{
+  self->m_increment = increment;
+  self->m_checkpointed = true;
+}
+
+void
+SimulationCheckpointTestCase::DoRun (void)
+{
+  m_increment = 1;
+  m_counter = 0;
+  m_draws = 0;
+  m_checkpointed = false;
+  m_random = CreateObject<UniformRandomVariable> ();
+
+  int fds[2];
+  NS_TEST_ASSERT_MSG_EQ (pipe (fds), 0, "Cannot create the pipe");
+
+  for (uint32_t i = 1; i <= 10; ++i)
+    {
+      Simulator::Schedule (Seconds (i), &SimulationCheckpointTestCase::Tick, this);
+    }
+
+  SimulationCheckpoint checkpoint;
+  checkpoint.SetMaxParallel (m_maxParallel);
+  double increments[] = { 1, 10, 100 };
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      checkpoint.AddBranch (MakeBoundCallback (&SimulationCheckpointTestCase::Configure,
+                                               this, increments[i]));
+    }
+  checkpoint.Schedule (Seconds (5.5));
+  Simulator::Run ();
+
+  Result result;
+  result.branch = SimulationCheckpoint::GetBranch ();
+  result.counter = m_counter;
+  result.draws = m_draws;
+  result.end = Simulator::Now ().GetSeconds ();
+  if (SimulationCheckpoint::IsChild ())
+    {
+      // Report to the original process and leave the test framework to it
+      ssize_t written = write (fds[1], &result, sizeof (result));
+      _exit (written == sizeof (result) ? 0 : 1);
+    }
+  Simulator::Destroy ();
+  close (fds[1]);
+
+  NS_TEST_ASSERT_MSG_EQ (checkpoint.GetNFailed (), 0, "A branch failed");
+
+  Result results[3];
+  results[0] = result;
+  for (uint32_t i = 1; i < 3; ++i)
+    {
+      Result child;
+      NS_TEST_ASSERT_MSG_EQ (read (fds[0], &child, sizeof (child)), sizeof (child), "Missing branch");
+      NS_TEST_ASSERT_MSG_LT (child.branch, 3, "Unknown branch");
+      NS_TEST_ASSERT_MSG_GT (child.branch, 0, "Branch 0 runs in the original process");
+      results[child.branch] = child;
+    }
+  close (fds[0]);
+
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (results[i].branch, i, "Branch " << i << " did not run");
+      NS_TEST_ASSERT_MSG_EQ_TOL (results[i].counter, 5 + 5 * increments[i], 1e-9,
+                                 "Branch " << i << " did not keep the state or its configuration");
+      NS_TEST_ASSERT_MSG_EQ_TOL (results[i].end, 10, 1e-9, "Branch " << i << " did not run to the end");
+      // The random stream continues from the same position in every branch
+      NS_TEST_ASSERT_MSG_EQ_TOL (results[i].draws, results[0].draws, 1e-12,
+                                 "Branch " << i << " did not keep the random stream position");
+    }
+  NS_TEST_ASSERT_MSG_GT (results[0].draws, 0, "No draw after the checkpoint");
+}
+
+#ifdef HAVE_PTHREAD_H
+/**
+ * \ingroup core-tests
+ *
+ * Check the count of the threads which keep SimulationCheckpoint::Fork
+ * from forking the branches.
+ */
+class SimulationCheckpointThreadsTestCase : public TestCase
+{
+public:
+  SimulationCheckpointThreadsTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /** Main function of the threads, returns at once */
+  static void Nothing (void);
+};
+
+SimulationCheckpointThreadsTestCase::SimulationCheckpointThreadsTestCase ()
+  : TestCase ("Check the count of the threads started and not joined")
+{
+}
+
+void
+SimulationCheckpointThreadsTestCase::Nothing (void)
+{
+}
+
+void
+SimulationCheckpointThreadsTestCase::DoRun (void)
+{
+  uint32_t joinable = SystemThread::GetNJoinable ();
+  Ptr<SystemThread> threads[2];
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      threads[i] = Create<SystemThread> (MakeCallback (&SimulationCheckpointThreadsTestCase::Nothing));
+      threads[i]->Start ();
+    }
+  // Threads which are done still count until they are joined
+  NS_TEST_EXPECT_MSG_EQ (SystemThread::GetNJoinable (), joinable + 2, "Started threads not counted");
+  threads[0]->Join ();
+  NS_TEST_EXPECT_MSG_EQ (SystemThread::GetNJoinable (), joinable + 1, "Joined thread still counted");
+  threads[1]->Join ();
+  NS_TEST_EXPECT_MSG_EQ (SystemThread::GetNJoinable (), joinable, "Joined threads still counted");
+}
+#endif /* HAVE_PTHREAD_H */
+
+/**
+ * \ingroup core-tests
+ *
+ * Simulation checkpoint test suite
+ */
+static class SimulationCheckpointTestSuite : public TestSuite
+{
+public:
+  SimulationCheckpointTestSuite ()
+    : TestSuite ("simulation-checkpoint", UNIT)
+  {
+    AddTestCase (new SimulationCheckpointTestCase (1), TestCase::QUICK);
+    AddTestCase (new SimulationCheckpointTestCase (2), TestCase::QUICK);
+#ifdef HAVE_PTHREAD_H
+    AddTestCase (new SimulationCheckpointThreadsTestCase (), TestCase::QUICK);
+#endif /* HAVE_PTHREAD_H */
+  }
+} g_simulationCheckpointTestSuite;
@@ -26,10 +26,12 @@
 #include "ns3/config.h"
 #include "ns3/string.h"
 #include "ns3/system-thread.h"
+#include "ns3/mpsc-event-ring.h"
 
 #include <ctime>
 #include <list>
 #include <utility>
+#include <vector>
 
 using namespace ns3;
 
@@ -225,6 +227,88 @@ ThreadedSimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_a, m_d, "Bad scheduling");
 }
 
+class MpscEventRingTestCase : public TestCase
+{
+public:
+  MpscEventRingTestCase (uint32_t capacity, unsigned int threads);
+  static void PushingThread (std::pair<MpscEventRingTestCase *, unsigned int> context);
+
+private:
+  virtual void DoRun (void);
+
+  MpscEventRing m_ring;
+  unsigned int m_threads;
+  uint32_t m_count;
+};
+
+MpscEventRingTestCase::MpscEventRingTestCase (uint32_t capacity, unsigned int threads)
+  : TestCase ("Check that MpscEventRing keeps the events of each thread in order"),
+    m_ring (capacity),
+    m_threads (threads),
+    m_count (20000)
+{
+}
+
+void
+MpscEventRingTestCase::PushingThread (std::pair<MpscEventRingTestCase *, unsigned int> context)
+{
+  MpscEventRingTestCase *me = context.first;
+  for (uint32_t i = 0; i < me->m_count; ++i)
+    {
+      MpscEventRing::Event ev;
+      ev.context = context.second;
+      ev.timestamp = i;
+      ev.event = 0;
+      me->m_ring.Push (ev);
+    }
+}
+
+void
+MpscEventRingTestCase::DoRun (void)
+{
+  std::list<Ptr<SystemThread> > threads;
+  for (unsigned int i = 0; i < m_threads; ++i)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (
+                                                 &MpscEventRingTestCase::PushingThread,
+                                                 std::pair<MpscEventRingTestCase *, unsigned int> (this, i))));
+    }
+  for (std::list<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Start ();
+    }
+
+  // drain while the threads push, then once more after they are done
+  std::vector<uint64_t> next (m_threads, 0);
+  std::vector<MpscEventRing::Event> events;
+  uint64_t received = 0;
+  bool ordered = true;
+  bool joined = false;
+  while (!joined || !m_ring.IsEmpty ())
+    {
+      if (received == uint64_t (m_count) * m_threads)
+        {
+          for (std::list<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+            {
+              (*it)->Join ();
+            }
+          joined = true;
+        }
+      events.clear ();
+      m_ring.Drain (events);
+      for (std::vector<MpscEventRing::Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+        {
+          ordered = ordered && i->timestamp == next[i->context];
+          next[i->context] = i->timestamp + 1;
+          received++;
+        }
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (ordered, true, "Events of a thread drained out of order");
+  NS_TEST_EXPECT_MSG_EQ (received, uint64_t (m_count) * m_threads, "Events lost or duplicated");
+  NS_TEST_EXPECT_MSG_EQ (m_ring.IsEmpty (), true, "Ring not empty");
+}
+
 class ThreadedSimulatorTestSuite : public TestSuite
 {
 public:
@@ -262,5 +346,8 @@ public:
               }
           }
       }
+    // a small ring goes through the overflow list most of the time
+    AddTestCase (new MpscEventRingTestCase (4, 4), TestCase::QUICK);
+    AddTestCase (new MpscEventRingTestCase (1024, 4), TestCase::QUICK);
   }
 } g_threadedSimulatorTestSuite;
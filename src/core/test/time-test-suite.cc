@@ -88,6 +88,12 @@ TimeSimpleTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (FemtoSeconds (1).GetFemtoSeconds (), 1, 
                          "is 1fs really 1fs ?");
 #endif
+  NS_TEST_ASSERT_MSG_EQ (NanoSeconds (3).GetSeconds (), 3e-9,
+                         "is 3ns really 3e-9s ?");
+  NS_TEST_ASSERT_MSG_EQ (MicroSeconds (7).ToDouble (Time::MS), 0.007,
+                         "is 7us really 0.007ms ?");
+  NS_TEST_ASSERT_MSG_EQ (Seconds (2.0).ToDouble (Time::PS), 2e12,
+                         "is 2s really 2e12ps ?");
 
   Time ten = NanoSeconds (10);
   int64_t tenValue = ten.GetInteger ();
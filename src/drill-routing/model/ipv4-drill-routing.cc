@@ -1,13 +1,13 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 #include "ipv4-drill-routing.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 #include "ns3/simulator.h"
 #include "ns3/net-device.h"
 #include "ns3/channel.h"
 #include "ns3/node.h"
 #include "ns3/ipv4-l3-protocol.h"
-#include "ns3/traffic-control-layer.h"
-#include "ns3/point-to-point-net-device.h"
+#include "ns3/uinteger.h"
 
 #include <algorithm>
 #include <limits>
@@ -71,43 +71,32 @@ Ipv4DrillRouting::LookupDrillRouteEntries (Ipv4Address dest)
   return drillRouteEntries;
 }
 
-uint32_t
-Ipv4DrillRouting::CalculateQueueLength (uint32_t interface)
+void
+Ipv4DrillRouting::InitPortOccupancy ()
 {
+  // SetIpv4 made sure of the type
   Ptr<Ipv4L3Protocol> ipv4L3Protocol = DynamicCast<Ipv4L3Protocol> (m_ipv4);
-  if (!ipv4L3Protocol)
-  {
-    NS_LOG_ERROR (this << " Drill routing cannot work other than Ipv4L3Protocol");
-    return 0;
-  }
+  NS_ASSERT (ipv4L3Protocol != 0);
 
-  uint32_t totalLength = 0;
+  // The queue discs are installed by now, the occupancy of the queues is
+  // kept up to date by their traces from here on
+  m_portOccupancy = PortOccupancy::Install (ipv4L3Protocol->GetNode ());
 
-  const Ptr<NetDevice> netDevice = this->m_ipv4->GetNetDevice (interface);
-
-  if (netDevice->IsPointToPoint ())
+  m_interfaceDevice.resize (m_ipv4->GetNInterfaces ());
+  for (uint32_t interface = 0; interface < m_ipv4->GetNInterfaces (); ++interface)
   {
-    Ptr<PointToPointNetDevice> p2pNetDevice = DynamicCast<PointToPointNetDevice> (netDevice);
-    if (p2pNetDevice)
-    {
-      totalLength += p2pNetDevice->GetQueue ()->GetNBytes ();
-    }
-  }
-
-  Ptr<TrafficControlLayer> tc = ipv4L3Protocol->GetNode ()->GetObject<TrafficControlLayer> ();
-
-  if (!tc)
-  {
-    return totalLength;
+    m_interfaceDevice[interface] = m_ipv4->GetNetDevice (interface)->GetIfIndex ();
   }
+}
 
-  Ptr<QueueDisc> queueDisc = tc->GetRootQueueDiscOnDevice (netDevice);
-  if (queueDisc)
+uint32_t
+Ipv4DrillRouting::CalculateQueueLength (uint32_t interface)
+{
+  if (m_portOccupancy == 0 || interface >= m_interfaceDevice.size ())
   {
-    totalLength += queueDisc->GetNBytes ();
+    return 0;
   }
-
-  return totalLength;
+  return m_portOccupancy->GetNBytes (m_interfaceDevice[interface]);
 }
 
 Ptr<Ipv4Route>
@@ -173,11 +162,14 @@ Ipv4DrillRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
     return false;
   }
 
+  if (m_portOccupancy == 0)
+  {
+    InitPortOccupancy ();
+  }
+
   uint32_t leastLoadInterface = 0;
   uint32_t leastLoad = std::numeric_limits<uint32_t>::max ();
 
-  std::random_shuffle (allPorts.begin (), allPorts.end ());
-
   std::map<Ipv4Address, uint32_t>::iterator itr = m_previousBestQueueMap.find (destAddress);
 
   if (itr != m_previousBestQueueMap.end ())
@@ -190,6 +182,8 @@ Ipv4DrillRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
 
   for (uint32_t samplePort = 0; samplePort < sampleNum; samplePort ++)
   {
+    // Partial Fisher-Yates shuffle, only the sampled ports are drawn
+    std::swap (allPorts[samplePort], allPorts[samplePort + rand () % (allPorts.size () - samplePort)]);
     uint32_t sampleLoad = Ipv4DrillRouting::CalculateQueueLength (allPorts[samplePort].port);
     if (sampleLoad < leastLoad)
     {
@@ -233,6 +227,8 @@ Ipv4DrillRouting::SetIpv4 (Ptr<Ipv4> ipv4)
 {
   NS_LOG_LOGIC (this << "Setting up Ipv4: " << ipv4);
   NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
+  NS_ABORT_MSG_IF (DynamicCast<Ipv4L3Protocol> (ipv4) == 0,
+                   "Drill routing cannot work other than Ipv4L3Protocol");
   m_ipv4 = ipv4;
 }
 
@@ -244,6 +240,9 @@ Ipv4DrillRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
 void
 Ipv4DrillRouting::DoDispose (void)
 {
+  m_portOccupancy = 0;
+  m_ipv4 = 0;
+  Ipv4RoutingProtocol::DoDispose ();
 }
 }
 
@@ -8,6 +8,7 @@
 #include "ns3/packet.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/port-occupancy.h"
 
 #include <vector>
 #include <map>
@@ -51,9 +52,17 @@ public:
   virtual void DoDispose (void);
 
 private:
+  // Start reading the port occupancy of the node
+  void InitPortOccupancy ();
+
   uint32_t m_d;
   std::map<Ipv4Address, uint32_t> m_previousBestQueueMap;
 
+  // Bytes queued on each device of the node
+  Ptr<PortOccupancy> m_portOccupancy;
+  // Device index of each interface
+  std::vector<uint32_t> m_interfaceDevice;
+
   Ptr<Ipv4> m_ipv4;
   std::vector<DrillRouteEntry> m_routeEntryList;
 };
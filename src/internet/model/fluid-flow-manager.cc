@@ -0,0 +1,594 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "fluid-flow-manager.h"
+#include "ipv4.h"
+#include "ipv4-route.h"
+#include "ipv4-routing-protocol.h"
+#include "ipv4-queue-disc-item.h"
+#include "tcp-header.h"
+#include "tcp-l4-protocol.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include "ns3/packet.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/hash.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/queue-disc.h"
+#include "ns3/traffic-control-layer.h"
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FluidFlowManager");
+
+NS_OBJECT_ENSURE_REGISTERED (FluidFlowManager);
+
+/// Longest path of a fluid flow, to stop on routing loops
+static const uint32_t MAX_HOPS = 64;
+
+TypeId
+FluidFlowManager::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FluidFlowManager")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<FluidFlowManager> ()
+    .AddAttribute ("Mode",
+                   "Rate and backlog model of the fluid flows",
+                   EnumValue (MAX_MIN),
+                   MakeEnumAccessor (&FluidFlowManager::m_mode),
+                   MakeEnumChecker (MAX_MIN, "MaxMin",
+                                    DCTCP, "Dctcp"))
+    .AddAttribute ("MarkingThreshold",
+                   "DCTCP marking threshold in packets, the fluid backlog of a bottleneck in Dctcp mode",
+                   UintegerValue (65),
+                   MakeUintegerAccessor (&FluidFlowManager::m_markingThreshold),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PacketSize",
+                   "Size in bytes of the packets of the fluid backlog",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&FluidFlowManager::m_packetSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("UpdateInterval",
+                   "Interval over which the packet-level flows crossing a device are counted",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&FluidFlowManager::m_updateInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("MinPacketShare",
+                   "Share of the rate of a device always left to the packets",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&FluidFlowManager::m_minPacketShare),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddTraceSource ("FlowCompleted",
+                     "A fluid flow completed",
+                     MakeTraceSourceAccessor (&FluidFlowManager::m_flowCompleted),
+                     "ns3::FluidFlowManager::FlowCompletedTracedCallback")
+  ;
+  return tid;
+}
+
+FluidFlowManager::FluidFlowManager ()
+  : m_nActive (0),
+    m_lastAdvance (Seconds (0))
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FluidFlowManager::~FluidFlowManager ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FluidFlowManager::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_completionEvent.Cancel ();
+  m_updateEvent.Cancel ();
+  m_intervalEvent.Cancel ();
+  for (std::vector<Link>::iterator it = m_links.begin (); it != m_links.end (); ++it)
+    {
+      it->device->SetAttribute ("DataRate", DataRateValue (DataRate (static_cast<uint64_t> (it->capacity))));
+      if (it->queueDisc != 0)
+        {
+          it->queueDisc->SetFluidBacklog (0, Seconds (0));
+          it->queueDisc->TraceDisconnectWithoutContext ("Enqueue", it->enqueueCallback);
+        }
+    }
+  m_links.clear ();
+  m_linkIndex.clear ();
+  m_flows.clear ();
+  Object::DoDispose ();
+}
+
+uint32_t
+FluidFlowManager::AddFlow (Ptr<Node> source, Ipv4Address destination,
+                           uint16_t sourcePort, uint16_t destinationPort,
+                           uint64_t size, Time start)
+{
+  NS_LOG_FUNCTION (this << source << destination << sourcePort << destinationPort << size << start);
+
+  Flow flow;
+  flow.source = source;
+  flow.destination = destination;
+  flow.sourcePort = sourcePort;
+  flow.destinationPort = destinationPort;
+  flow.size = size;
+  flow.remaining = size;
+  flow.rate = 0;
+  flow.start = std::max (start, Simulator::Now ());
+  flow.completion = Seconds (0);
+  flow.active = false;
+  flow.completed = false;
+
+  uint32_t flowId = m_flows.size ();
+  m_flows.push_back (flow);
+  Simulator::Schedule (flow.start - Simulator::Now (), &FluidFlowManager::StartFlow, this, flowId);
+  return flowId;
+}
+
+uint32_t
+FluidFlowManager::GetNActiveFlows (void) const
+{
+  return m_nActive;
+}
+
+DataRate
+FluidFlowManager::GetFlowRate (uint32_t flowId) const
+{
+  NS_ASSERT (flowId < m_flows.size ());
+  return DataRate (m_flows[flowId].active ? static_cast<uint64_t> (m_flows[flowId].rate) : 0);
+}
+
+bool
+FluidFlowManager::IsCompleted (uint32_t flowId) const
+{
+  NS_ASSERT (flowId < m_flows.size ());
+  return m_flows[flowId].completed;
+}
+
+Time
+FluidFlowManager::GetCompletionTime (uint32_t flowId) const
+{
+  NS_ASSERT (flowId < m_flows.size ());
+  NS_ASSERT_MSG (m_flows[flowId].completed, "Flow " << flowId << " has not completed");
+  return m_flows[flowId].completion;
+}
+
+void
+FluidFlowManager::StartFlow (uint32_t flowId)
+{
+  NS_LOG_FUNCTION (this << flowId);
+
+  // The routing tables are complete by now
+  FindPath (m_flows[flowId]);
+
+  // Account for what the active flows sent before the new one changes the rates
+  Advance ();
+
+  Flow &flow = m_flows[flowId];
+  flow.active = true;
+  m_nActive++;
+  for (std::vector<uint32_t>::const_iterator it = flow.links.begin (); it != flow.links.end (); ++it)
+    {
+      m_links[*it].nFluidFlows++;
+    }
+
+  if (!m_intervalEvent.IsRunning ())
+    {
+      // The counts of a previous busy period are stale
+      for (std::vector<Link>::iterator it = m_links.begin (); it != m_links.end (); ++it)
+        {
+          it->nPacketFlows = 0;
+          it->packetFlows.clear ();
+        }
+      m_intervalEvent = Simulator::Schedule (m_updateInterval, &FluidFlowManager::NewInterval, this);
+    }
+
+  Update ();
+}
+
+void
+FluidFlowManager::FindPath (Flow &flow)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Same flow identifier as the one TcpSocketBase attaches to its packets
+  std::stringstream hashString;
+  hashString << flow.destination.Get ();
+  hashString << flow.destinationPort;
+  uint32_t flowIdHash = Hash32 (hashString.str ());
+
+  Ptr<Node> node = flow.source;
+  Ipv4Address source = Ipv4Address::GetAny ();
+  for (uint32_t hop = 0; hop < MAX_HOPS; ++hop)
+    {
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      NS_ASSERT_MSG (ipv4 != 0, "Node " << node->GetId () << " on the path of a fluid flow has no IPv4 stack");
+      if (ipv4->GetInterfaceForAddress (flow.destination) >= 0)
+        {
+          return;
+        }
+
+      Ipv4Header header;
+      header.SetSource (source);
+      header.SetDestination (flow.destination);
+      header.SetProtocol (TcpL4Protocol::PROT_NUMBER);
+      TcpHeader tcpHeader;
+      tcpHeader.SetSourcePort (flow.sourcePort);
+      tcpHeader.SetDestinationPort (flow.destinationPort);
+      Ptr<Packet> packet = Create<Packet> ();
+      packet->AddHeader (tcpHeader);
+      packet->AddPacketTag (FlowIdTag (flowIdHash));
+
+      Socket::SocketErrno sockerr;
+      Ptr<Ipv4Route> route = ipv4->GetRoutingProtocol ()->RouteOutput (packet, header, 0, sockerr);
+      if (route == 0)
+        {
+          NS_FATAL_ERROR ("Node " << node->GetId () << " has no route to " << flow.destination);
+        }
+      if (hop == 0)
+        {
+          source = route->GetSource ();
+        }
+
+      Ptr<NetDevice> device = route->GetOutputDevice ();
+      flow.links.push_back (GetLink (device));
+
+      Ipv4Address next = route->GetGateway ();
+      if (next == Ipv4Address::GetAny ())
+        {
+          next = flow.destination;
+        }
+      Ptr<Channel> channel = device->GetChannel ();
+      Ptr<Node> nextNode;
+      for (uint32_t i = 0; channel != 0 && i < channel->GetNDevices (); ++i)
+        {
+          Ptr<NetDevice> peer = channel->GetDevice (i);
+          Ptr<Ipv4> peerIpv4 = peer->GetNode ()->GetObject<Ipv4> ();
+          if (peer != device && peerIpv4 != 0 && peerIpv4->GetInterfaceForAddress (next) >= 0)
+            {
+              nextNode = peer->GetNode ();
+              break;
+            }
+        }
+      if (nextNode == 0)
+        {
+          NS_FATAL_ERROR ("No node owns the next hop " << next << " of node " << node->GetId ());
+        }
+      node = nextNode;
+    }
+  NS_FATAL_ERROR ("The path to " << flow.destination << " is longer than " << MAX_HOPS << " hops");
+}
+
+uint32_t
+FluidFlowManager::GetLink (Ptr<NetDevice> device)
+{
+  std::map<Ptr<NetDevice>, uint32_t>::const_iterator it = m_linkIndex.find (device);
+  if (it != m_linkIndex.end ())
+    {
+      return it->second;
+    }
+
+  DataRateValue rate;
+  if (!device->GetAttributeFailSafe ("DataRate", rate))
+    {
+      NS_FATAL_ERROR ("Fluid flows cross device " << device->GetIfIndex () << " of node "
+                      << device->GetNode ()->GetId () << ", which has no DataRate attribute");
+    }
+
+  uint32_t index = m_links.size ();
+  Link link;
+  link.device = device;
+  link.capacity = rate.Get ().GetBitRate ();
+  link.nFluidFlows = 0;
+  link.fluidRate = 0;
+  link.bottleneck = false;
+  link.nPacketFlows = 0;
+
+  Ptr<TrafficControlLayer> tc = device->GetNode ()->GetObject<TrafficControlLayer> ();
+  if (tc != 0)
+    {
+      link.queueDisc = tc->GetRootQueueDiscOnDevice (device);
+    }
+  if (link.queueDisc != 0)
+    {
+      link.enqueueCallback = MakeBoundCallback (&FluidFlowManager::PacketEnqueued, this, index);
+      link.queueDisc->TraceConnectWithoutContext ("Enqueue", link.enqueueCallback);
+    }
+
+  m_links.push_back (link);
+  m_linkIndex[device] = index;
+  return index;
+}
+
+void
+FluidFlowManager::Advance (void)
+{
+  double elapsed = (Simulator::Now () - m_lastAdvance).GetSeconds ();
+  m_lastAdvance = Simulator::Now ();
+  if (elapsed <= 0)
+    {
+      return;
+    }
+  for (std::vector<Flow>::iterator it = m_flows.begin (); it != m_flows.end (); ++it)
+    {
+      if (it->active)
+        {
+          it->remaining -= it->rate * elapsed / 8;
+        }
+    }
+}
+
+void
+FluidFlowManager::Update (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_updateEvent.Cancel ();
+  Advance ();
+
+  std::vector<uint32_t> completed;
+  for (uint32_t i = 0; i < m_flows.size (); ++i)
+    {
+      Flow &flow = m_flows[i];
+      // Less than a byte left is rounding of the completion time
+      if (flow.active && flow.remaining < 1)
+        {
+          flow.active = false;
+          flow.completed = true;
+          flow.rate = 0;
+          flow.completion = Simulator::Now () - flow.start;
+          m_nActive--;
+          for (std::vector<uint32_t>::const_iterator it = flow.links.begin (); it != flow.links.end (); ++it)
+            {
+              m_links[*it].nFluidFlows--;
+            }
+          completed.push_back (i);
+        }
+    }
+
+  Allocate ();
+  Apply ();
+  ScheduleCompletion ();
+
+  for (std::vector<uint32_t>::const_iterator it = completed.begin (); it != completed.end (); ++it)
+    {
+      NS_LOG_LOGIC ("Fluid flow " << *it << " completed in " << m_flows[*it].completion);
+      m_flowCompleted (*it, m_flows[*it].completion);
+    }
+}
+
+void
+FluidFlowManager::Allocate (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Progressive filling: the rate of all the unfrozen flows grows until a
+  // link saturates, then the flows crossing it are frozen. The packet-level
+  // flows of a link are frozen with the fluid flows when it saturates.
+  std::vector<double> capacity (m_links.size ());
+  std::vector<uint32_t> unfrozen (m_links.size ());
+  std::vector<uint32_t> packetFlows (m_links.size ());
+  for (uint32_t l = 0; l < m_links.size (); ++l)
+    {
+      capacity[l] = m_links[l].capacity;
+      unfrozen[l] = m_links[l].nFluidFlows;
+      packetFlows[l] = m_links[l].nPacketFlows;
+      m_links[l].bottleneck = false;
+    }
+
+  std::vector<bool> frozen (m_flows.size (), false);
+  uint32_t nUnfrozen = 0;
+  for (uint32_t f = 0; f < m_flows.size (); ++f)
+    {
+      if (m_flows[f].active)
+        {
+          m_flows[f].rate = 0;
+          if (m_flows[f].links.empty ())
+            {
+              // Sent to the source node: done at once
+              m_flows[f].remaining = 0;
+              frozen[f] = true;
+            }
+          else
+            {
+              nUnfrozen++;
+            }
+        }
+    }
+
+  while (nUnfrozen > 0)
+    {
+      uint32_t best = m_links.size ();
+      double share = std::numeric_limits<double>::max ();
+      for (uint32_t l = 0; l < m_links.size (); ++l)
+        {
+          if (unfrozen[l] > 0)
+            {
+              double s = capacity[l] / (unfrozen[l] + packetFlows[l]);
+              if (s < share)
+                {
+                  share = s;
+                  best = l;
+                }
+            }
+        }
+      NS_ASSERT (best < m_links.size ());
+
+      m_links[best].bottleneck = true;
+      capacity[best] = std::max (0.0, capacity[best] - packetFlows[best] * share);
+      packetFlows[best] = 0;
+      for (uint32_t f = 0; f < m_flows.size (); ++f)
+        {
+          Flow &flow = m_flows[f];
+          if (!flow.active || frozen[f]
+              || std::find (flow.links.begin (), flow.links.end (), best) == flow.links.end ())
+            {
+              continue;
+            }
+          flow.rate = share;
+          frozen[f] = true;
+          nUnfrozen--;
+          for (std::vector<uint32_t>::const_iterator it = flow.links.begin (); it != flow.links.end (); ++it)
+            {
+              capacity[*it] = std::max (0.0, capacity[*it] - share);
+              unfrozen[*it]--;
+            }
+        }
+    }
+}
+
+void
+FluidFlowManager::Apply (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  for (std::vector<Link>::iterator it = m_links.begin (); it != m_links.end (); ++it)
+    {
+      it->fluidRate = 0;
+    }
+  for (std::vector<Flow>::const_iterator it = m_flows.begin (); it != m_flows.end (); ++it)
+    {
+      if (it->active)
+        {
+          for (std::vector<uint32_t>::const_iterator l = it->links.begin (); l != it->links.end (); ++l)
+            {
+              m_links[*l].fluidRate += it->rate;
+            }
+        }
+    }
+
+  for (std::vector<Link>::iterator it = m_links.begin (); it != m_links.end (); ++it)
+    {
+      double packetRate = std::max (it->capacity - it->fluidRate, it->capacity * m_minPacketShare);
+      it->device->SetAttribute ("DataRate", DataRateValue (DataRate (static_cast<uint64_t> (packetRate))));
+
+      if (it->queueDisc == 0)
+        {
+          continue;
+        }
+      if (m_mode == DCTCP && it->bottleneck && it->nFluidFlows > 0)
+        {
+          uint32_t bytes = m_markingThreshold * m_packetSize;
+          it->queueDisc->SetFluidBacklog (bytes, DataRate (static_cast<uint64_t> (it->capacity)).CalculateBytesTxTime (bytes));
+        }
+      else
+        {
+          it->queueDisc->SetFluidBacklog (0, Seconds (0));
+        }
+    }
+}
+
+void
+FluidFlowManager::ScheduleCompletion (void)
+{
+  m_completionEvent.Cancel ();
+
+  double next = std::numeric_limits<double>::max ();
+  for (std::vector<Flow>::const_iterator it = m_flows.begin (); it != m_flows.end (); ++it)
+    {
+      if (it->active && it->rate > 0)
+        {
+          next = std::min (next, it->remaining * 8 / it->rate);
+        }
+      else if (it->active && it->remaining < 1)
+        {
+          next = 0;
+        }
+    }
+  if (next == std::numeric_limits<double>::max ())
+    {
+      return;
+    }
+
+  // Round up, so that the flow has sent all its bytes when the event runs
+  Time delay = Seconds (next);
+  if (delay.GetSeconds () < next)
+    {
+      delay += TimeStep (1);
+    }
+  m_completionEvent = Simulator::Schedule (delay, &FluidFlowManager::Update, this);
+}
+
+void
+FluidFlowManager::ScheduleUpdate (void)
+{
+  if (!m_updateEvent.IsRunning ())
+    {
+      m_updateEvent = Simulator::ScheduleNow (&FluidFlowManager::Update, this);
+    }
+}
+
+void
+FluidFlowManager::NewInterval (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  for (std::vector<Link>::iterator it = m_links.begin (); it != m_links.end (); ++it)
+    {
+      it->nPacketFlows = it->packetFlows.size ();
+      // Packets still queued belong to at least one packet-level flow, even
+      // if none was enqueued during the interval
+      if (it->nPacketFlows == 0 && it->queueDisc != 0 && it->queueDisc->GetNPackets () > 0)
+        {
+          it->nPacketFlows = 1;
+        }
+      it->packetFlows.clear ();
+    }
+  if (m_nActive > 0)
+    {
+      Update ();
+      m_intervalEvent = Simulator::Schedule (m_updateInterval, &FluidFlowManager::NewInterval, this);
+    }
+}
+
+void
+FluidFlowManager::PacketEnqueued (FluidFlowManager *self, uint32_t link, Ptr<const QueueItem> item)
+{
+  Ptr<const Ipv4QueueDiscItem> ipv4Item = DynamicCast<const Ipv4QueueDiscItem> (item);
+  if (ipv4Item == 0 || ipv4Item->GetPacket ()->GetSize () < 4)
+    {
+      return;
+    }
+
+  // The transport header starts with the source and destination ports
+  uint8_t ports[4] = { 0, 0, 0, 0 };
+  ipv4Item->GetPacket ()->CopyData (ports, 4);
+  const Ipv4Header &header = ipv4Item->GetHeader ();
+  uint64_t key = (static_cast<uint64_t> (header.GetSource ().Get ()) << 32) | header.GetDestination ().Get ();
+  key ^= (static_cast<uint64_t> (ports[0]) << 24 | ports[1] << 16 | ports[2] << 8 | ports[3]) * 0x9e3779b97f4a7c15ULL;
+
+  Link &l = self->m_links[link];
+  if (l.packetFlows.insert (key).second && l.packetFlows.size () > l.nPacketFlows)
+    {
+      l.nPacketFlows = l.packetFlows.size ();
+      if (l.nFluidFlows > 0)
+        {
+          self->ScheduleUpdate ();
+        }
+    }
+}
+
+} // namespace ns3
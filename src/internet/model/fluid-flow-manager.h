@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef FLUID_FLOW_MANAGER_H
+#define FLUID_FLOW_MANAGER_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/callback.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/traced-callback.h"
+#include <map>
+#include <set>
+#include <vector>
+
+namespace ns3 {
+
+class Node;
+class NetDevice;
+class QueueDisc;
+class QueueItem;
+
+/**
+ * \ingroup internet
+ *
+ * \brief Simulate background flows as fluid rates.
+ *
+ * Elephant flows carry most of the bytes of a data center workload, but
+ * simulating them packet by packet costs most of the events while the
+ * interesting figures are the completion times of the small flows. The
+ * flows added to this object send no packets: they are given a rate, which
+ * is recomputed every time a fluid flow starts or completes, and they
+ * complete when they have sent their size at that rate.
+ *
+ * The path of a fluid flow is the sequence of output devices chosen by the
+ * IPv4 routing protocols of the nodes, asked with RouteOutput for a TCP
+ * packet of the flow (with the FlowIdTag a TCP socket would attach, so
+ * per-flow ECMP picks the path it would pick for the packets of the flow).
+ * The rates are the max-min fair allocation of the device rates, in which
+ * the packet-level flows crossing a device count as competing flows: a
+ * packet-level flow is a (source, destination, ports) tuple which enqueued
+ * a packet in the root queue disc of the device during the last
+ * UpdateInterval. Pure acknowledgements count too: a port throttled to its
+ * MinPacketShare would delay the ACK clock of the small flows. A
+ * packet-level flow appearing on a device used by fluid flows triggers a
+ * new allocation at once.
+ *
+ * The fluid flows act on the packet-level flows in two ways:
+ *
+ * - the DataRate attribute of every device is lowered by the rate of the
+ *   fluid flows crossing it, down to MinPacketShare of the device rate;
+ * - in DCTCP mode, the root queue disc of a bottleneck device is given a
+ *   fluid backlog of MarkingThreshold packets, where DCTCP keeps the queue
+ *   of a bottleneck. Packets wait for the fluid backlog in the traffic
+ *   control layer before being enqueued, and the AQMs add it to the queue
+ *   length or sojourn time they mark on (see QueueDisc::SetFluidBacklog).
+ *   In MAX_MIN mode the fluid flows hold no backlog.
+ *
+ * DCTCP flows sharing a bottleneck converge to their fair share, so both
+ * modes use the same rates. The fluid flows do not react to the losses and
+ * marks of the packets, and the allocation does not model slow start: a
+ * fluid flow gets its share as soon as it starts.
+ */
+class FluidFlowManager : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// Rate and backlog models of the fluid flows
+  enum Mode
+  {
+    MAX_MIN,    //!< Max-min fair rates, no backlog
+    DCTCP       //!< Max-min fair rates, DCTCP equilibrium backlog at the bottlenecks
+  };
+
+  FluidFlowManager ();
+  virtual ~FluidFlowManager ();
+
+  /**
+   * Add a fluid flow.
+   *
+   * \param source the node sending the flow
+   * \param destination the address of the receiver
+   * \param sourcePort the source port, used to choose the path
+   * \param destinationPort the destination port, used to choose the path
+   * \param size the number of bytes to transfer
+   * \param start the time the flow starts
+   * \return the identifier of the flow
+   */
+  uint32_t AddFlow (Ptr<Node> source, Ipv4Address destination,
+                    uint16_t sourcePort, uint16_t destinationPort,
+                    uint64_t size, Time start);
+
+  /**
+   * \return the number of fluid flows which have started and not completed
+   */
+  uint32_t GetNActiveFlows (void) const;
+
+  /**
+   * \param flowId the identifier of a flow
+   * \return the current rate of the flow, zero if it is not active
+   */
+  DataRate GetFlowRate (uint32_t flowId) const;
+
+  /**
+   * \param flowId the identifier of a flow
+   * \return whether the flow has completed
+   */
+  bool IsCompleted (uint32_t flowId) const;
+
+  /**
+   * \param flowId the identifier of a completed flow
+   * \return the flow completion time
+   */
+  Time GetCompletionTime (uint32_t flowId) const;
+
+  /**
+   * TracedCallback signature for fluid flow completions.
+   * \param [in] flowId the identifier of the flow
+   * \param [in] fct the flow completion time
+   */
+  typedef void (* FlowCompletedTracedCallback)(uint32_t flowId, Time fct);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// A fluid flow
+  struct Flow
+  {
+    Ptr<Node> source;              //!< Sending node
+    Ipv4Address destination;       //!< Receiver address
+    uint16_t sourcePort;           //!< Source port
+    uint16_t destinationPort;      //!< Destination port
+    uint64_t size;                 //!< Bytes to transfer
+    double remaining;              //!< Bytes still to transfer
+    double rate;                   //!< Current rate in bit/s
+    Time start;                    //!< Start time
+    Time completion;               //!< Completion time
+    bool active;                   //!< Started and not completed
+    bool completed;                //!< Completed
+    std::vector<uint32_t> links;   //!< Links of the path
+  };
+
+  /// A device crossed by fluid flows
+  struct Link
+  {
+    Ptr<NetDevice> device;              //!< The device
+    Ptr<QueueDisc> queueDisc;           //!< Its root queue disc, may be 0
+    double capacity;                    //!< Rate of the device in bit/s
+    uint32_t nFluidFlows;               //!< Active fluid flows crossing it
+    double fluidRate;                   //!< Aggregate rate of the fluid flows
+    bool bottleneck;                    //!< Saturated by the allocation
+    uint32_t nPacketFlows;              //!< Packet-level flows counted by the allocation
+    std::set<uint64_t> packetFlows;     //!< Packet-level flows seen in this interval
+    Callback<void, Ptr<const QueueItem> > enqueueCallback; //!< Connected to the queue disc
+  };
+
+  /**
+   * Start a flow
+   * \param flowId the identifier of the flow
+   */
+  void StartFlow (uint32_t flowId);
+
+  /**
+   * Find the links of the path of a flow
+   * \param flow the flow
+   */
+  void FindPath (Flow &flow);
+
+  /**
+   * \param device a device
+   * \return the index of the link of the device, created if needed
+   */
+  uint32_t GetLink (Ptr<NetDevice> device);
+
+  /**
+   * Decrease the remaining bytes of the active flows by what they sent
+   * since the last update at their rates
+   */
+  void Advance (void);
+
+  /**
+   * Advance the flows, complete the finished ones, compute the rates and
+   * apply them to the devices
+   */
+  void Update (void);
+
+  /**
+   * Compute the max-min fair rates of the active flows
+   */
+  void Allocate (void);
+
+  /**
+   * Apply the fluid rates and backlogs to the devices and queue discs
+   */
+  void Apply (void);
+
+  /**
+   * Schedule the next completion of a fluid flow
+   */
+  void ScheduleCompletion (void);
+
+  /**
+   * Schedule an update at the current time, unless one is pending
+   */
+  void ScheduleUpdate (void);
+
+  /**
+   * Start a new interval of the packet-level flow counts
+   */
+  void NewInterval (void);
+
+  /**
+   * Trace sink for the packets enqueued in the root queue disc of a link
+   * \param self the FluidFlowManager
+   * \param link the index of the link
+   * \param item the packet
+   */
+  static void PacketEnqueued (FluidFlowManager *self, uint32_t link, Ptr<const QueueItem> item);
+
+  Mode m_mode;                          //!< Rate and backlog model
+  uint32_t m_markingThreshold;          //!< DCTCP marking threshold in packets
+  uint32_t m_packetSize;                //!< Size of the packets of the backlog
+  Time m_updateInterval;                //!< Interval of the packet-level flow counts
+  double m_minPacketShare;              //!< Share of a device rate left to the packets
+
+  std::vector<Flow> m_flows;            //!< All the fluid flows
+  std::vector<Link> m_links;            //!< Devices crossed by fluid flows
+  std::map<Ptr<NetDevice>, uint32_t> m_linkIndex;  //!< Link of each device
+  uint32_t m_nActive;                   //!< Number of active flows
+  Time m_lastAdvance;                   //!< Last time the flows were advanced
+  EventId m_completionEvent;            //!< Next completion
+  EventId m_updateEvent;                //!< Pending update
+  EventId m_intervalEvent;              //!< Next interval of the flow counts
+
+  TracedCallback<uint32_t, Time> m_flowCompleted; //!< Completions
+};
+
+} // namespace ns3
+
+#endif /* FLUID_FLOW_MANAGER_H */
@@ -33,6 +33,11 @@
 #include "ns3/boolean.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/queue-disc.h"
+#include "ns3/queue.h"
+#include "ns3/pointer.h"
+#include "ns3/gso-tag.h"
+#include "ns3/pfc-ingress.h"
 
 #include "loopback-net-device.h"
 #include "arp-l3-protocol.h"
@@ -41,6 +46,8 @@
 #include "ipv4-interface.h"
 #include "ipv4-raw-socket-impl.h"
 #include "ipv4-ecn-tag.h"
+#include "tcp-header.h"
+#include "tcp-l4-protocol.h"
 
 namespace ns3 {
 
@@ -309,6 +316,7 @@ Ipv4L3Protocol::DoDispose (void)
     }
   m_interfaces.clear ();
   m_reverseInterfacesContainer.clear ();
+  m_gsoTxQueues.clear ();
 
   m_sockets.clear ();
   m_node = 0;
@@ -581,6 +589,7 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
       NS_LOG_LOGIC ("Dropping received packet -- interface is down");
       Ipv4Header ipHeader;
       packet->RemoveHeader (ipHeader);
+      PfcIngress::Release (packet, m_node);
       m_dropTrace (ipHeader, packet, DROP_INTERFACE_DOWN, m_node->GetObject<Ipv4> (), interface);
       return;
     }
@@ -601,6 +610,7 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
   if (!ipHeader.IsChecksumOk ())
     {
       NS_LOG_LOGIC ("Dropping received packet -- checksum not ok");
+      PfcIngress::Release (packet, m_node);
       m_dropTrace (ipHeader, packet, DROP_BAD_CHECKSUM, m_node->GetObject<Ipv4> (), interface);
       return;
     }
@@ -621,6 +631,7 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
                                       ))
     {
       NS_LOG_WARN ("No route found for forwarding packet.  Drop.");
+      PfcIngress::Release (packet, m_node);
       m_dropTrace (ipHeader, packet, DROP_NO_ROUTE, m_node->GetObject<Ipv4> (), interface);
     }
 }
@@ -929,7 +940,7 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
           if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
-              DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
+              SplitForInterface (packet, ipHeader, outInterface, listFragments);
               for ( std::list<Ipv4PayloadHeaderPair>::iterator it = listFragments.begin (); it != listFragments.end (); it++ )
                 {
                   CallTxTrace (it->second, it->first, m_node->GetObject<Ipv4> (), interface);
@@ -945,6 +956,7 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
       else
         {
           NS_LOG_LOGIC ("Dropping -- outgoing interface is down: " << route->GetGateway ());
+          PfcIngress::Release (packet, m_node);
           m_dropTrace (ipHeader, packet, DROP_INTERFACE_DOWN, m_node->GetObject<Ipv4> (), interface);
         }
     }
@@ -956,7 +968,7 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
           if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
-              DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
+              SplitForInterface (packet, ipHeader, outInterface, listFragments);
               for ( std::list<Ipv4PayloadHeaderPair>::iterator it = listFragments.begin (); it != listFragments.end (); it++ )
                 {
                   NS_LOG_LOGIC ("Sending fragment " << *(it->first) );
@@ -973,6 +985,7 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
       else
         {
           NS_LOG_LOGIC ("Dropping -- outgoing interface is down: " << ipHeader.GetDestination ());
+          PfcIngress::Release (packet, m_node);
           m_dropTrace (ipHeader, packet, DROP_INTERFACE_DOWN, m_node->GetObject<Ipv4> (), interface);
         }
     }
@@ -1035,10 +1048,27 @@ Ipv4L3Protocol::IpForward (Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, const Ip
           icmp->SendTimeExceededTtl (ipHeader, packet);
         }
       NS_LOG_WARN ("TTL exceeded.  Drop.");
+      PfcIngress::Release (packet, m_node);
       m_dropTrace (header, packet, DROP_TTL_EXPIRED, m_node->GetObject<Ipv4> (), interface);
       return;
     }
   m_unicastForwardTrace (ipHeader, packet, interface);
+
+  // A GSO super-segment stays whole only while the egress port is idle:
+  // where a queue builds up, the queue disc sees every segment
+  GsoTag gsoTag;
+  if (packet->GetSize () + ipHeader.GetSerializedSize () > rtentry->GetOutputDevice ()->GetMtu ()
+      && IsGsoSuperSegment (packet, ipHeader, gsoTag)
+      && !IsEgressIdle (rtentry->GetOutputDevice ()))
+    {
+      std::list<Ipv4PayloadHeaderPair> segments;
+      DoGsoSegmentation (packet, ipHeader, gsoTag.GetSegmentSize (), segments);
+      for (std::list<Ipv4PayloadHeaderPair>::iterator it = segments.begin (); it != segments.end (); it++)
+        {
+          SendRealOut (rtentry, it->first, it->second);
+        }
+      return;
+    }
   SendRealOut (rtentry, packet, ipHeader);
 }
 
@@ -1047,6 +1077,7 @@ Ipv4L3Protocol::LocalDeliver (Ptr<const Packet> packet, Ipv4Header const&ip, uin
 {
   NS_LOG_FUNCTION (this << packet << &ip << iif);
   Ptr<Packet> p = packet->Copy (); // need to pass a non-const packet up
+  PfcIngress::Release (p, m_node);
   Ipv4Header ipHeader = ip;
 
   if ( !ipHeader.IsLastFragment () || ipHeader.GetFragmentOffset () != 0 )
@@ -1385,9 +1416,104 @@ Ipv4L3Protocol::RouteInputError (Ptr<const Packet> p, const Ipv4Header & ipHeade
 {
   NS_LOG_FUNCTION (this << p << ipHeader << sockErrno);
   NS_LOG_LOGIC ("Route input failure-- dropping packet to " << ipHeader << " with errno " << sockErrno);
+  PfcIngress::Release (p->Copy (), m_node);
   m_dropTrace (ipHeader, p, DROP_ROUTE_ERROR, m_node->GetObject<Ipv4> (), 0);
 }
 
+void
+Ipv4L3Protocol::SplitForInterface (Ptr<Packet> packet, const Ipv4Header & ipv4Header, Ptr<Ipv4Interface> outInterface, std::list<Ipv4PayloadHeaderPair>& listFragments)
+{
+  NS_LOG_FUNCTION (this << *packet << ipv4Header << outInterface);
+
+  GsoTag gsoTag;
+  if (IsGsoSuperSegment (packet, ipv4Header, gsoTag))
+    {
+      // The device serializes the super-segment as a back to back burst
+      NS_LOG_LOGIC ("Sending the super-segment " << *packet << " as a burst");
+      listFragments.push_back (Ipv4PayloadHeaderPair (packet, ipv4Header));
+      return;
+    }
+  DoFragmentation (packet, ipv4Header, outInterface->GetDevice ()->GetMtu (), listFragments);
+}
+
+bool
+Ipv4L3Protocol::IsGsoSuperSegment (Ptr<const Packet> packet, const Ipv4Header & ipv4Header, GsoTag &gsoTag) const
+{
+  return ipv4Header.GetProtocol () == TcpL4Protocol::PROT_NUMBER
+         && ipv4Header.IsLastFragment () && ipv4Header.GetFragmentOffset () == 0
+         && packet->PeekPacketTag (gsoTag);
+}
+
+void
+Ipv4L3Protocol::DoGsoSegmentation (Ptr<Packet> packet, const Ipv4Header & ipv4Header, uint32_t segmentSize, std::list<Ipv4PayloadHeaderPair>& listFragments)
+{
+  NS_LOG_FUNCTION (this << *packet << ipv4Header << segmentSize);
+
+  Ptr<Packet> p = packet->Copy ();
+  GsoTag gsoTag;
+  p->RemovePacketTag (gsoTag);
+  TcpHeader tcpHeader;
+  p->RemoveHeader (tcpHeader);
+
+  uint32_t payloadSize = p->GetSize ();
+  uint16_t identification = ipv4Header.GetIdentification ();
+  for (uint32_t offset = 0; offset < payloadSize; offset += segmentSize)
+    {
+      uint32_t size = std::min (segmentSize, payloadSize - offset);
+      Ptr<Packet> segment = p->CreateFragment (offset, size);
+      // the first segment releases the PFC ingress bytes of the super-segment
+      PfcIngress::Move (p, segment);
+
+      // FIN and PSH belong to the last segment, CWR to the first one
+      TcpHeader segmentHeader = tcpHeader;
+      uint8_t flags = tcpHeader.GetFlags ();
+      if (offset > 0)
+        {
+          flags &= ~TcpHeader::CWR;
+        }
+      if (offset + size < payloadSize)
+        {
+          flags &= ~(TcpHeader::FIN | TcpHeader::PSH);
+        }
+      segmentHeader.SetFlags (flags);
+      segmentHeader.SetSequenceNumber (tcpHeader.GetSequenceNumber () + offset);
+      segment->AddHeader (segmentHeader);
+
+      Ipv4Header segmentIpHeader = ipv4Header;
+      segmentIpHeader.SetPayloadSize (segment->GetSize ());
+      segmentIpHeader.SetIdentification (identification++);
+
+      NS_LOG_LOGIC ("GSO segment " << *segment);
+      listFragments.push_back (Ipv4PayloadHeaderPair (segment, segmentIpHeader));
+    }
+}
+
+bool
+Ipv4L3Protocol::IsEgressIdle (Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+
+  Ptr<TrafficControlLayer> tc = m_node->GetObject<TrafficControlLayer> ();
+  if (tc != 0)
+    {
+      Ptr<QueueDisc> qd = tc->GetRootQueueDiscOnDevice (device);
+      if (qd != 0 && qd->GetNPackets () > 0)
+        {
+          return false;
+        }
+    }
+
+  std::map<Ptr<const NetDevice>, Ptr<Queue> >::iterator it = m_gsoTxQueues.find (device);
+  if (it == m_gsoTxQueues.end ())
+    {
+      PointerValue queue;
+      device->GetAttributeFailSafe ("TxQueue", queue);
+      it = m_gsoTxQueues.insert (std::make_pair (device, queue.Get<Queue> ())).first;
+    }
+  // Without a visible transmission queue, assume the port is busy
+  return it->second != 0 && it->second->IsEmpty ();
+}
+
 void
 Ipv4L3Protocol::DoFragmentation (Ptr<Packet> packet, const Ipv4Header & ipv4Header, uint32_t outIfaceMtu, std::list<Ipv4PayloadHeaderPair>& listFragments)
 {
@@ -42,6 +42,8 @@ namespace ns3 {
 class Packet;
 class NetDevice;
 class Ipv4Interface;
+class Queue;
+class GsoTag;
 class Ipv4Address;
 class Ipv4Header;
 class Ipv4RoutingTableEntry;
@@ -404,6 +406,45 @@ private:
    */
   void DoFragmentation (Ptr<Packet> packet, const Ipv4Header & ipv4Header, uint32_t outIfaceMtu, std::list<Ipv4PayloadHeaderPair>& listFragments);
 
+  /**
+   * \brief Split a packet larger than the MTU of its egress interface.
+   *
+   * A GSO super-segment (a TCP packet with a GsoTag) is kept whole: the
+   * device serializes it as its segments sent back to back. Other packets
+   * are fragmented. IpForward cuts the super-segments into their segments
+   * beforehand when the egress port is not idle.
+   *
+   * \param packet the packet
+   * \param ipv4Header the IPv4 header
+   * \param outInterface the egress interface
+   * \param listFragments the list of packets to send
+   */
+  void SplitForInterface (Ptr<Packet> packet, const Ipv4Header & ipv4Header, Ptr<Ipv4Interface> outInterface, std::list<Ipv4PayloadHeaderPair>& listFragments);
+
+  /**
+   * \param packet the packet
+   * \param ipv4Header the IPv4 header
+   * \param gsoTag the GsoTag of the packet, if any
+   * \return true if the packet is a TCP super-segment built by GSO
+   */
+  bool IsGsoSuperSegment (Ptr<const Packet> packet, const Ipv4Header & ipv4Header, GsoTag &gsoTag) const;
+
+  /**
+   * \brief Cut a GSO super-segment into its TCP segments
+   * \param packet the super-segment, starting with its TCP header
+   * \param ipv4Header the IPv4 header
+   * \param segmentSize the payload size of a segment
+   * \param listFragments the list of segments
+   */
+  void DoGsoSegmentation (Ptr<Packet> packet, const Ipv4Header & ipv4Header, uint32_t segmentSize, std::list<Ipv4PayloadHeaderPair>& listFragments);
+
+  /**
+   * \param device the egress device
+   * \return true if nothing is queued in the root queue disc or in the
+   * transmission queue of the device
+   */
+  bool IsEgressIdle (Ptr<NetDevice> device);
+
   /**
    * \brief Process a packet fragment
    * \param packet the packet
@@ -465,6 +506,7 @@ private:
   uint8_t m_defaultTtl;  //!< Default TTL
   std::map<std::pair<uint64_t, uint8_t>, uint16_t> m_identification; //!< Identification (for each {src, dst, proto} tuple)
   Ptr<Node> m_node; //!< Node attached to stack.
+  std::map<Ptr<const NetDevice>, Ptr<Queue> > m_gsoTxQueues; //!< Transmission queues of the devices, looked up for GSO
 
   /// Trace of sent packets
   TracedCallback<const Ipv4Header &, Ptr<const Packet>, uint32_t> m_sendOutgoingTrace;
@@ -83,11 +83,7 @@ TcpResequenceBuffer::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   m_inOrderQueue.clear ();
-  while (!m_outOrderQueue.empty ())
-  {
-    m_outOrderQueue.pop ();
-  }
-  m_outOrderSeqSet.clear ();
+  m_outOrderQueue.clear ();
 }
 
 void
@@ -178,10 +174,10 @@ TcpResequenceBuffer::BufferPacket (Ptr<Packet> packet,
     // Try to fill the in order queue from the out order queue
     while (!m_outOrderQueue.empty ())
     {
-      if (TcpResequenceBuffer::PutInTheInOrderQueue (m_outOrderQueue.top ()))
+      OutOrderQueue::iterator head = m_outOrderQueue.begin ();
+      if (TcpResequenceBuffer::PutInTheInOrderQueue (head->second))
       {
-        m_outOrderSeqSet.erase (m_outOrderQueue.top ().m_seq);
-        m_outOrderQueue.pop ();
+        m_outOrderQueue.erase (head);
       }
       else
       {
@@ -200,11 +196,9 @@ TcpResequenceBuffer::BufferPacket (Ptr<Packet> packet,
   // If the seq > next seq
   else
   {
-    if (m_outOrderSeqSet.find (element.m_seq) == m_outOrderSeqSet.end())
-    {
-      m_outOrderQueue.push (element);
-      m_outOrderSeqSet.insert (element.m_seq);
-    }
+    // Segments mostly arrive in increasing seq order even when they are out
+    // of order, hint the insertion at the tail. Duplicates are ignored.
+    m_outOrderQueue.insert (m_outOrderQueue.end (), std::make_pair (element.m_seq, element));
   }
 }
 
@@ -337,10 +331,11 @@ TcpResequenceBuffer::FlushOutOrderQueue (TcpRBPopReason reason)
     {
       break;
     }
-    TcpResequenceBuffer::FlushOneElement (m_outOrderQueue.top (), reason);
-    m_outOrderQueue.pop ();
+    OutOrderQueue::iterator head = m_outOrderQueue.begin ();
+    TcpResequenceBuffer::FlushOneElement (head->second, reason);
+    m_outOrderQueue.erase (head);
   }
-  m_outOrderSeqSet.clear ();
+  m_outOrderQueue.clear ();
 
   // Reset the timer
   m_outOrderQueueTimer = Simulator::Now ();
@@ -10,8 +10,7 @@
 #include "ns3/traced-value.h"
 
 #include <vector>
-#include <queue>
-#include <set>
+#include <map>
 
 namespace ns3
 {
@@ -106,11 +105,10 @@ private:
 
   std::vector<TcpResequenceBufferElement> m_inOrderQueue;
 
-  std::priority_queue<TcpResequenceBufferElement,
-      std::vector<TcpResequenceBufferElement>,
-      std::greater<TcpResequenceBufferElement> > m_outOrderQueue;
-
-  std::set<SequenceNumber32> m_outOrderSeqSet;
+  // Out of order segments keyed by their seq, the key both orders the
+  // segments and filters duplicates
+  typedef std::map<SequenceNumber32, TcpResequenceBufferElement> OutOrderQueue;
+  OutOrderQueue m_outOrderQueue;
 
   TcpSocketBase *m_tcp;
 
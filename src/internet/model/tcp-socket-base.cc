@@ -56,6 +56,8 @@
 #include "ns3/tcp-tlb-tag.h"
 #include "ns3/ipv4-clove.h"
 #include "ns3/tcp-clove-tag.h"
+#include "ns3/inband-telemetry-tag.h"
+#include "ns3/gso-tag.h"
 #include "ns3/hash.h"
 
 #include <math.h>
@@ -135,6 +137,12 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_limitedTx),
                    MakeBooleanChecker ())
+    .AddAttribute ("GsoMaxSize",
+                   "Largest super-segment handed to the network layer at once "
+                   "(generic segmentation offload, IPv4 only). 0 sends one segment at a time",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&TcpSocketBase::m_gsoMaxSize),
+                   MakeUintegerChecker<uint32_t> (0, 65000))
     .AddAttribute ("ECN", "Enable ECN capable connection",
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_ecn),
@@ -349,6 +357,7 @@ TcpSocketBase::TcpSocketBase (void)
     m_retxThresh (3),
     m_limitedTx (false),
     m_retransOut (0),
+    m_gsoMaxSize (0),
     m_ecn (true),
     m_resequenceBufferEnabled (false),
     m_flowBenderEnabled (false),
@@ -361,6 +370,8 @@ TcpSocketBase::TcpSocketBase (void)
     m_CloveEnabled (false),
     m_CloveSendSide (false),
     m_piggybackCloveInfo (false),
+    m_CloveUtilizationValid (false),
+    m_CloveUtilization (0),
     // Pause
     m_isPauseEnabled (false),
     m_isPause (false),
@@ -455,6 +466,7 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_retxThresh (sock.m_retxThresh),
     m_limitedTx (sock.m_limitedTx),
     m_retransOut (sock.m_retransOut),
+    m_gsoMaxSize (sock.m_gsoMaxSize),
     m_ecn (sock.m_ecn),
     m_resequenceBufferEnabled (sock.m_resequenceBufferEnabled),
     m_flowBenderEnabled (sock.m_flowBenderEnabled),
@@ -467,6 +479,8 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_CloveEnabled (sock.m_CloveEnabled),
     m_CloveSendSide (false),
     m_piggybackCloveInfo (false),
+    m_CloveUtilizationValid (false),
+    m_CloveUtilization (0),
     // Pause
     m_isPauseEnabled (sock.m_isPauseEnabled),
     m_isPause (false),
@@ -1663,6 +1677,10 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
         Ptr<Ipv4Clove> ipv4Clove = m_node->GetObject<Ipv4Clove> ();
         m_pathAcked = tcpCloveTag.GetPath ();
         ipv4Clove->FlowRecv (m_pathAcked, m_endPoint->GetPeerAddress (), withECE);
+        if (tcpCloveTag.HasUtilization ())
+        {
+          ipv4Clove->FlowRecvInt (m_pathAcked, m_endPoint->GetPeerAddress (), tcpCloveTag.GetUtilization ());
+        }
     }
   }
 
@@ -1915,7 +1933,16 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
           NS_LOG_DEBUG ("LOSS -> OPEN");
         }
 
-      if (callCongestionControl)
+      if (callCongestionControl && m_gsoMaxSize > m_tcb->m_segmentSize)
+        {
+          // A super-segment is acknowledged at once: grow the window as if
+          // each of its segments had been acknowledged on its own
+          for (uint32_t i = 0; i < newSegsAcked; i++)
+            {
+              m_congestionControl->IncreaseWindow (m_tcb, 1);
+            }
+        }
+      else if (callCongestionControl)
         {
           m_congestionControl->IncreaseWindow (m_tcb, newSegsAcked);
 
@@ -2621,6 +2648,10 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
     {
       TcpCloveTag tcpCloveTag;
       tcpCloveTag.SetPath (m_ClovePath);
+      if (m_CloveUtilizationValid)
+      {
+        tcpCloveTag.SetUtilization (m_CloveUtilization);
+      }
       p->AddPacketTag (tcpCloveTag);
     }
   }
@@ -2943,6 +2974,15 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   header.SetWindowSize (AdvertisedWindowSize ());
   AddOptions (header);
 
+  if (sz > m_tcb->m_segmentSize)
+    {
+      GsoTag gsoTag;
+      gsoTag.SetSegmentSize (m_tcb->m_segmentSize);
+      gsoTag.SetNSegments ((sz + m_tcb->m_segmentSize - 1) / m_tcb->m_segmentSize);
+      gsoTag.SetHeaderSize (header.GetSerializedSize () + Ipv4Header ().GetSerializedSize ());
+      p->AddPacketTag (gsoTag);
+    }
+
   if (m_retxEvent.IsExpired ())
     {
       // Schedules retransmit timeout. If this is a retransmission, double the timer
@@ -3136,7 +3176,12 @@ TcpSocketBase::SendPendingData (bool withAck)
                     " cWnd: " << m_tcb->m_cWnd <<
                     " unAck: " << UnAckDataCount ());
 
-      uint32_t s = std::min (w, m_tcb->m_segmentSize);  // Send no more than window
+      uint32_t maxSize = m_tcb->m_segmentSize;
+      if (m_gsoMaxSize > maxSize && m_endPoint != 0)
+        {
+          maxSize = m_gsoMaxSize;               // Hand a super-segment to the network layer
+        }
+      uint32_t s = std::min (w, maxSize);  // Send no more than window
       uint32_t sz = SendDataPacket (m_nextTxSequence, s, withAck);
       nPacketsSent++;                             // Count sent this loop
       m_nextTxSequence += sz;                     // Advance next tx sequence
@@ -3299,6 +3344,14 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
       m_ClovePath = tcpCloveTag.GetPath ();
     }
 
+    // Clove INT: reflect the utilization stamped by the switches
+    InbandTelemetryTag telemetryTag;
+    if (p->RemovePacketTag (telemetryTag))
+    {
+      m_CloveUtilizationValid = true;
+      m_CloveUtilization = telemetryTag.GetMaxUtilization ();
+    }
+
   }
 
   // Put into Rx buffer
@@ -3315,7 +3368,9 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
     }
   else
     { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+      // A GSO super-segment counts as the segments it carries
+      m_delAckCount += std::max<uint32_t> (1, (p->GetSize () + m_tcb->m_segmentSize - 1) / m_tcb->m_segmentSize);
+      if (m_delAckCount >= m_delAckMaxCount)
         {
           m_congestionControl->CwndEvent(m_tcb, TcpCongestionOps::CA_EVENT_DELAY_ACK_NO_RESERVED, this);
           m_delAckEvent.Cancel ();
@@ -1008,6 +1008,9 @@ protected:
   bool                   m_limitedTx;    //!< perform limited transmit
   uint32_t               m_retransOut;   //!< Number of retransmission in this window
 
+  // Generic segmentation offload
+  uint32_t               m_gsoMaxSize;   //!< Largest super-segment, 0 if GSO is disabled
+
   // ECN capable connection
   bool m_ecn;   //!< ECN capability
 
@@ -1036,6 +1039,8 @@ protected:
   bool                      m_CloveSendSide;
   bool                      m_piggybackCloveInfo;
   uint32_t                  m_ClovePath;
+  bool                      m_CloveUtilizationValid;
+  double                    m_CloveUtilization;
 
   // Pause Support
   bool                      m_isPauseEnabled;
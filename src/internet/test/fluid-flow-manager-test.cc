@@ -0,0 +1,342 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/fluid-flow-manager.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/queue-disc.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/node-container.h"
+#include "ns3/data-rate.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Base of the fluid flow tests: A sends to B through the router R.
+ * The link from A to R runs at 10 Gbps, the link from R to B at 1 Gbps.
+ */
+class FluidFlowTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param name the name of the test case
+   */
+  FluidFlowTestCase (std::string name);
+
+protected:
+  /**
+   * Build the topology
+   */
+  void Build (void);
+
+  NodeContainer m_nodes;          //!< A, R and B
+  NetDeviceContainer m_dAdR;      //!< Devices of the link from A to R
+  NetDeviceContainer m_dRdB;      //!< Devices of the link from R to B
+  Ipv4Address m_addressB;         //!< Address of B
+};
+
+FluidFlowTestCase::FluidFlowTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+FluidFlowTestCase::Build (void)
+{
+  m_nodes.Create (3);
+  InternetStackHelper internet;
+  internet.Install (m_nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  devHelper.SetChannelAttribute ("Delay", StringValue ("10us"));
+  devHelper.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("10Gbps")));
+  m_dAdR = devHelper.Install (NodeContainer (m_nodes.Get (0), m_nodes.Get (1)));
+  devHelper.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Gbps")));
+  m_dRdB = devHelper.Install (NodeContainer (m_nodes.Get (1), m_nodes.Get (2)));
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (m_dAdR);
+  ipv4.SetBase ("10.1.2.0", "255.255.255.0");
+  Ipv4InterfaceContainer iRiB = ipv4.Assign (m_dRdB);
+  m_addressB = iRiB.GetAddress (1);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Two fluid flows share the bottleneck, then the longer one gets it
+ * all. The devices are left to the packets only for the rate the fluid
+ * flows do not use, and get back their rate when the fluid flows complete.
+ */
+class FluidFlowMaxMinTestCase : public FluidFlowTestCase
+{
+public:
+  FluidFlowMaxMinTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Check the rates while both flows are active
+   * \param manager the fluid flow manager
+   */
+  void CheckRates (Ptr<FluidFlowManager> manager);
+  /**
+   * Record a completion
+   * \param flowId the flow
+   * \param fct the flow completion time
+   */
+  void FlowCompleted (uint32_t flowId, Time fct);
+
+  uint32_t m_nCompleted;          //!< Completions reported by the trace
+};
+
+FluidFlowMaxMinTestCase::FluidFlowMaxMinTestCase ()
+  : FluidFlowTestCase ("Max-min fair rates and completion times of fluid flows"),
+    m_nCompleted (0)
+{
+}
+
+void
+FluidFlowMaxMinTestCase::CheckRates (Ptr<FluidFlowManager> manager)
+{
+  NS_TEST_EXPECT_MSG_EQ (manager->GetNActiveFlows (), 2, "Both flows are active");
+  NS_TEST_EXPECT_MSG_EQ (manager->GetFlowRate (0), DataRate ("500Mbps"), "The flows share the bottleneck");
+  NS_TEST_EXPECT_MSG_EQ (manager->GetFlowRate (1), DataRate ("500Mbps"), "The flows share the bottleneck");
+
+  DataRateValue rate;
+  m_dAdR.Get (0)->GetAttribute ("DataRate", rate);
+  NS_TEST_EXPECT_MSG_EQ (rate.Get (), DataRate ("9Gbps"), "The packets get what the fluid flows leave");
+  m_dRdB.Get (0)->GetAttribute ("DataRate", rate);
+  NS_TEST_EXPECT_MSG_EQ (rate.Get (), DataRate ("10Mbps"), "The packets keep MinPacketShare of a saturated device");
+}
+
+void
+FluidFlowMaxMinTestCase::FlowCompleted (uint32_t flowId, Time fct)
+{
+  m_nCompleted++;
+}
+
+void
+FluidFlowMaxMinTestCase::DoRun (void)
+{
+  Build ();
+
+  Ptr<FluidFlowManager> manager = CreateObject<FluidFlowManager> ();
+  manager->TraceConnectWithoutContext ("FlowCompleted", MakeCallback (&FluidFlowMaxMinTestCase::FlowCompleted, this));
+  manager->AddFlow (m_nodes.Get (0), m_addressB, 10000, 5000, 1000000, MilliSeconds (1));
+  manager->AddFlow (m_nodes.Get (0), m_addressB, 10001, 5000, 2000000, MilliSeconds (1));
+  Simulator::Schedule (MilliSeconds (5), &FluidFlowMaxMinTestCase::CheckRates, this, manager);
+
+  Simulator::Run ();
+
+  // 1 MB at 500 Mbps each, then the last 1 MB of the second flow at 1 Gbps
+  NS_TEST_ASSERT_MSG_EQ (m_nCompleted, 2, "Both flows complete");
+  NS_TEST_ASSERT_MSG_EQ (manager->IsCompleted (0), true, "The first flow completes");
+  NS_TEST_ASSERT_MSG_EQ_TOL (manager->GetCompletionTime (0).GetSeconds (), 0.016, 1e-6, "Completion time at half the bottleneck rate");
+  NS_TEST_ASSERT_MSG_EQ_TOL (manager->GetCompletionTime (1).GetSeconds (), 0.024, 1e-6, "Completion time after getting the whole bottleneck");
+  NS_TEST_ASSERT_MSG_EQ (manager->GetNActiveFlows (), 0, "No active flow left");
+
+  DataRateValue rate;
+  m_dRdB.Get (0)->GetAttribute ("DataRate", rate);
+  NS_TEST_ASSERT_MSG_EQ (rate.Get (), DataRate ("1Gbps"), "The device gets back its rate");
+
+  manager->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief A packet-level TCP transfer counts as a competing flow: the fluid
+ * flow gets half of the bottleneck while the transfer runs. In DCTCP mode,
+ * the bottleneck queue disc holds the equilibrium backlog of the fluid flow.
+ */
+class FluidFlowPacketCompetitionTestCase : public FluidFlowTestCase
+{
+public:
+  /**
+   * Constructor
+   * \param mode the mode of the fluid flow manager
+   */
+  FluidFlowPacketCompetitionTestCase (FluidFlowManager::Mode mode);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Fill the send buffer of the sender
+   * \param socket the sending socket
+   * \param available the space available in the send buffer
+   */
+  void SendData (Ptr<Socket> socket, uint32_t available);
+  /**
+   * Accept a connection
+   * \param socket the new socket
+   * \param from the peer address
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+  /**
+   * Read the received data
+   * \param socket the receiving socket
+   */
+  void Receive (Ptr<Socket> socket);
+  /**
+   * Check the rate of the fluid flow and the fluid backlog
+   * \param manager the fluid flow manager
+   */
+  void CheckBacklog (Ptr<FluidFlowManager> manager);
+
+  FluidFlowManager::Mode m_mode;  //!< Mode of the fluid flow manager
+  uint32_t m_receivedBytes;       //!< Bytes read by the receiver
+};
+
+static const uint32_t FLUID_MARKING_THRESHOLD = 10;
+
+FluidFlowPacketCompetitionTestCase::FluidFlowPacketCompetitionTestCase (FluidFlowManager::Mode mode)
+  : FluidFlowTestCase (mode == FluidFlowManager::DCTCP ? "Fluid flow competing with a TCP transfer, DCTCP backlog"
+                                                       : "Fluid flow competing with a TCP transfer, max-min rates"),
+    m_mode (mode),
+    m_receivedBytes (0)
+{
+}
+
+void
+FluidFlowPacketCompetitionTestCase::SendData (Ptr<Socket> socket, uint32_t available)
+{
+  while (socket->GetTxAvailable () > 0)
+    {
+      if (socket->Send (Create<Packet> (socket->GetTxAvailable ())) <= 0)
+        {
+          break;
+        }
+    }
+}
+
+void
+FluidFlowPacketCompetitionTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&FluidFlowPacketCompetitionTestCase::Receive, this));
+}
+
+void
+FluidFlowPacketCompetitionTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()))
+    {
+      m_receivedBytes += p->GetSize ();
+    }
+}
+
+void
+FluidFlowPacketCompetitionTestCase::CheckBacklog (Ptr<FluidFlowManager> manager)
+{
+  NS_TEST_EXPECT_MSG_EQ (manager->GetFlowRate (0), DataRate ("500Mbps"), "The fluid flow shares the bottleneck with the transfer");
+
+  Ptr<QueueDisc> bottleneck = m_nodes.Get (1)->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (m_dRdB.Get (0));
+  Ptr<QueueDisc> access = m_nodes.Get (0)->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (m_dAdR.Get (0));
+  NS_TEST_EXPECT_MSG_EQ (access->GetFluidBytes (), 0, "No fluid backlog out of the bottleneck");
+  if (m_mode == FluidFlowManager::DCTCP)
+    {
+      NS_TEST_EXPECT_MSG_EQ (bottleneck->GetFluidBytes (), FLUID_MARKING_THRESHOLD * 1500, "DCTCP keeps K packets at the bottleneck");
+      NS_TEST_EXPECT_MSG_EQ_TOL (bottleneck->GetFluidDelay ().GetSeconds (), 120e-6, 1e-8, "K packets drain in 120 us at 1 Gbps");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (bottleneck->GetFluidBytes (), 0, "No fluid backlog in max-min mode");
+      NS_TEST_EXPECT_MSG_EQ (bottleneck->GetFluidDelay (), Seconds (0), "No fluid backlog in max-min mode");
+    }
+}
+
+void
+FluidFlowPacketCompetitionTestCase::DoRun (void)
+{
+  Build ();
+
+  uint16_t port = 5000;
+  Ptr<Socket> server = Socket::CreateSocket (m_nodes.Get (2), TcpSocketFactory::GetTypeId ());
+  server->Bind (InetSocketAddress (Ipv4Address::GetAny (), port));
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&FluidFlowPacketCompetitionTestCase::Accept, this));
+
+  Ptr<Socket> client = Socket::CreateSocket (m_nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  client->SetAttribute ("SegmentSize", UintegerValue (1000));
+  client->Bind ();
+  client->SetSendCallback (MakeCallback (&FluidFlowPacketCompetitionTestCase::SendData, this));
+  client->Connect (InetSocketAddress (m_addressB, port));
+  Simulator::ScheduleNow (&FluidFlowPacketCompetitionTestCase::SendData, this, client, 0);
+
+  // The transfer is running when the fluid flow starts
+  Ptr<FluidFlowManager> manager = CreateObject<FluidFlowManager> ();
+  manager->SetAttribute ("Mode", EnumValue (m_mode));
+  manager->SetAttribute ("MarkingThreshold", UintegerValue (FLUID_MARKING_THRESHOLD));
+  manager->AddFlow (m_nodes.Get (0), m_addressB, 10000, 6000, 1000000, MilliSeconds (20));
+  Simulator::Schedule (MilliSeconds (25), &FluidFlowPacketCompetitionTestCase::CheckBacklog, this, manager);
+
+  Simulator::Stop (MilliSeconds (60));
+  Simulator::Run ();
+
+  // 1 MB at 500 Mbps
+  NS_TEST_ASSERT_MSG_EQ (manager->IsCompleted (0), true, "The fluid flow completes");
+  NS_TEST_ASSERT_MSG_EQ_TOL (manager->GetCompletionTime (0).GetSeconds (), 0.016, 0.0005, "The fluid flow gets half of the bottleneck");
+  NS_TEST_ASSERT_MSG_GT (m_receivedBytes, 0, "The transfer goes on");
+
+  Ptr<QueueDisc> bottleneck = m_nodes.Get (1)->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (m_dRdB.Get (0));
+  NS_TEST_ASSERT_MSG_EQ (bottleneck->GetFluidBytes (), 0, "The backlog leaves with the fluid flow");
+
+  manager->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Fluid flow manager TestSuite
+ */
+static class FluidFlowManagerTestSuite : public TestSuite
+{
+public:
+  FluidFlowManagerTestSuite ()
+    : TestSuite ("fluid-flow-manager", UNIT)
+  {
+    AddTestCase (new FluidFlowMaxMinTestCase (), TestCase::QUICK);
+    AddTestCase (new FluidFlowPacketCompetitionTestCase (FluidFlowManager::MAX_MIN), TestCase::QUICK);
+    AddTestCase (new FluidFlowPacketCompetitionTestCase (FluidFlowManager::DCTCP), TestCase::QUICK);
+  }
+} g_fluidFlowManagerTestSuite; ///< the test suite
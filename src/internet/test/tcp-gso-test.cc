@@ -0,0 +1,256 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/node-container.h"
+#include "ns3/data-rate.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP generic segmentation offload test.
+ *
+ * A sends a bulk transfer to B through the router R. The link from A to R
+ * is ten times faster than the link from R to B, so a queue builds up at
+ * R. A hands super-segments to its idle port, R must cut the super-segments
+ * which find its port busy into MTU sized segments, and B must receive
+ * the whole transfer.
+ */
+class TcpGsoTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param gsoMaxSize the GsoMaxSize of the sender, 0 to disable GSO
+   */
+  TcpGsoTestCase (uint32_t gsoMaxSize);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Fill the send buffer of the sender
+   * \param socket the sending socket
+   * \param available the space available in the send buffer
+   */
+  void SendData (Ptr<Socket> socket, uint32_t available);
+  /**
+   * Accept a connection
+   * \param socket the new socket
+   * \param from the peer address
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+  /**
+   * Read the received data
+   * \param socket the receiving socket
+   */
+  void Receive (Ptr<Socket> socket);
+  /**
+   * Count the packets sent by A
+   * \param p the packet
+   * \param ipv4 the IPv4 stack
+   * \param interface the egress interface
+   */
+  void SenderTx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface);
+  /**
+   * Count the packets forwarded by R towards B
+   * \param p the packet
+   * \param ipv4 the IPv4 stack
+   * \param interface the egress interface
+   */
+  void RouterTx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface);
+
+  uint32_t m_gsoMaxSize;        //!< GsoMaxSize of the sender
+  uint32_t m_totalBytes;        //!< Bytes to transfer
+  uint32_t m_sentBytes;         //!< Bytes written to the sending socket
+  uint32_t m_receivedBytes;     //!< Bytes read by the receiver
+  uint32_t m_routerInterface;   //!< Interface of R towards B
+  uint32_t m_senderLarge;       //!< Packets larger than the MTU sent by A
+  uint32_t m_routerLarge;       //!< Packets larger than the MTU forwarded by R
+  uint32_t m_routerSegments;    //!< Data segments forwarded by R
+};
+
+static const uint32_t MTU = 1500;
+static const uint32_t SEGMENT_SIZE = 1000;
+
+TcpGsoTestCase::TcpGsoTestCase (uint32_t gsoMaxSize)
+  : TestCase (gsoMaxSize > 0 ? "TCP transfer with generic segmentation offload" : "TCP transfer without generic segmentation offload"),
+    m_gsoMaxSize (gsoMaxSize),
+    m_totalBytes (200000),
+    m_sentBytes (0),
+    m_receivedBytes (0),
+    m_routerInterface (0),
+    m_senderLarge (0),
+    m_routerLarge (0),
+    m_routerSegments (0)
+{
+}
+
+void
+TcpGsoTestCase::SendData (Ptr<Socket> socket, uint32_t available)
+{
+  while (m_sentBytes < m_totalBytes && socket->GetTxAvailable () > 0)
+    {
+      uint32_t size = std::min (m_totalBytes - m_sentBytes, socket->GetTxAvailable ());
+      int sent = socket->Send (Create<Packet> (size));
+      if (sent <= 0)
+        {
+          break;
+        }
+      m_sentBytes += sent;
+    }
+  if (m_sentBytes == m_totalBytes)
+    {
+      socket->Close ();
+    }
+}
+
+void
+TcpGsoTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&TcpGsoTestCase::Receive, this));
+}
+
+void
+TcpGsoTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()))
+    {
+      m_receivedBytes += p->GetSize ();
+    }
+}
+
+void
+TcpGsoTestCase::SenderTx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  if (p->GetSize () > MTU)
+    {
+      m_senderLarge++;
+    }
+}
+
+void
+TcpGsoTestCase::RouterTx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  if (interface != m_routerInterface)
+    {
+      return;
+    }
+  if (p->GetSize () > MTU)
+    {
+      m_routerLarge++;
+    }
+  else if (p->GetSize () > SEGMENT_SIZE)
+    {
+      m_routerSegments++;
+    }
+}
+
+void
+TcpGsoTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  devHelper.SetChannelAttribute ("Delay", StringValue ("10us"));
+  devHelper.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("10Gbps")));
+  NetDeviceContainer dAdR = devHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1)));
+  devHelper.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Gbps")));
+  NetDeviceContainer dRdB = devHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2)));
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (dAdR);
+  ipv4.SetBase ("10.1.2.0", "255.255.255.0");
+  Ipv4InterfaceContainer iRiB = ipv4.Assign (dRdB);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  Ptr<Ipv4L3Protocol> senderIpv4 = nodes.Get (0)->GetObject<Ipv4L3Protocol> ();
+  senderIpv4->TraceConnectWithoutContext ("Tx", MakeCallback (&TcpGsoTestCase::SenderTx, this));
+  Ptr<Ipv4L3Protocol> routerIpv4 = nodes.Get (1)->GetObject<Ipv4L3Protocol> ();
+  m_routerInterface = routerIpv4->GetInterfaceForDevice (dRdB.Get (0));
+  routerIpv4->TraceConnectWithoutContext ("Tx", MakeCallback (&TcpGsoTestCase::RouterTx, this));
+
+  uint16_t port = 5000;
+  Ptr<Socket> server = Socket::CreateSocket (nodes.Get (2), TcpSocketFactory::GetTypeId ());
+  server->Bind (InetSocketAddress (Ipv4Address::GetAny (), port));
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&TcpGsoTestCase::Accept, this));
+
+  Ptr<Socket> client = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  client->SetAttribute ("SegmentSize", UintegerValue (SEGMENT_SIZE));
+  client->SetAttribute ("GsoMaxSize", UintegerValue (m_gsoMaxSize));
+  client->Bind ();
+  client->SetSendCallback (MakeCallback (&TcpGsoTestCase::SendData, this));
+  client->Connect (InetSocketAddress (iRiB.GetAddress (1), port));
+  Simulator::ScheduleNow (&TcpGsoTestCase::SendData, this, client, 0);
+
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_receivedBytes, m_totalBytes, "The receiver did not get the whole transfer");
+  if (m_gsoMaxSize > 0)
+    {
+      NS_TEST_ASSERT_MSG_GT (m_senderLarge, 0, "The sender did not send super-segments");
+      NS_TEST_ASSERT_MSG_GT (m_routerLarge, 0, "The router did not forward super-segments on an idle port");
+      NS_TEST_ASSERT_MSG_GT (m_routerSegments, 0, "The router did not split super-segments on a busy port");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_senderLarge, 0, "No super-segment without GSO");
+      NS_TEST_ASSERT_MSG_EQ (m_routerLarge, 0, "No super-segment without GSO");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP generic segmentation offload TestSuite
+ */
+static class TcpGsoTestSuite : public TestSuite
+{
+public:
+  TcpGsoTestSuite ()
+    : TestSuite ("tcp-gso", UNIT)
+  {
+    AddTestCase (new TcpGsoTestCase (0), TestCase::QUICK);
+    AddTestCase (new TcpGsoTestCase (16000), TestCase::QUICK);
+  }
+} g_tcpGsoTestSuite; ///< the test suite
@@ -0,0 +1,239 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-resequence-buffer.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Socket recording the segments its resequence buffer passes up
+ */
+class TcpResequenceSink : public TcpSocketBase
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  std::vector<uint32_t> m_delivered; //!< Seq of the segments passed up
+
+protected:
+  virtual void DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
+                            const Address &toAddress);
+};
+
+TypeId
+TcpResequenceSink::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpResequenceSink")
+    .SetParent<TcpSocketBase> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpResequenceSink> ()
+  ;
+  return tid;
+}
+
+void
+TcpResequenceSink::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
+                                const Address &toAddress)
+{
+  TcpHeader tcph;
+  packet->PeekHeader (tcph);
+  m_delivered.push_back (tcph.GetSequenceNumber ().GetValue ());
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the order and the timing of the segments flushed by
+ * TcpResequenceBuffer
+ */
+class TcpResequenceBufferTestCase : public TestCase
+{
+public:
+  TcpResequenceBufferTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Buffer a segment of 100 bytes
+   * \param seq the seq of the segment
+   */
+  void Buffer (uint32_t seq);
+
+  /**
+   * \brief Record a flushed segment
+   * \param flowId the flow id
+   * \param time the time of the flush
+   * \param seq the seq of the segment
+   * \param inOrderLength the length of the in order queue
+   * \param outOrderLength the length of the out of order queue
+   * \param reason why the segment is flushed
+   */
+  void Flush (uint32_t flowId, Time time, SequenceNumber32 seq,
+              uint32_t inOrderLength, uint32_t outOrderLength, TcpRBPopReason reason);
+
+  /**
+   * \brief Check the segments flushed so far
+   * \param seqs the expected seq of the segments
+   * \param reasons the expected reason of their flush
+   * \param n the number of expected segments
+   * \param msg the message of the failures
+   */
+  void Check (const uint32_t *seqs, const TcpRBPopReason *reasons, uint32_t n, std::string msg);
+
+  Ptr<TcpResequenceSink> m_sink;           //!< Socket owning the buffer
+  Ptr<TcpResequenceBuffer> m_buffer;       //!< Buffer under test
+  std::vector<uint32_t> m_flushed;         //!< Seq of the segments flushed
+  std::vector<TcpRBPopReason> m_reasons;   //!< Reason of each flush
+};
+
+TcpResequenceBufferTestCase::TcpResequenceBufferTestCase ()
+  : TestCase ("Resequencing, duplicates and flushes of TcpResequenceBuffer")
+{
+}
+
+void
+TcpResequenceBufferTestCase::Buffer (uint32_t seq)
+{
+  TcpHeader tcph;
+  tcph.SetSequenceNumber (SequenceNumber32 (seq));
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddHeader (tcph);
+  m_buffer->BufferPacket (p, Address (), Address ());
+}
+
+void
+TcpResequenceBufferTestCase::Flush (uint32_t flowId, Time time, SequenceNumber32 seq,
+                                    uint32_t inOrderLength, uint32_t outOrderLength,
+                                    TcpRBPopReason reason)
+{
+  m_flushed.push_back (seq.GetValue ());
+  m_reasons.push_back (reason);
+}
+
+void
+TcpResequenceBufferTestCase::Check (const uint32_t *seqs, const TcpRBPopReason *reasons,
+                                    uint32_t n, std::string msg)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_flushed.size (), n, msg << ": wrong number of segments flushed");
+  NS_TEST_ASSERT_MSG_EQ (m_sink->m_delivered.size (), n, msg << ": wrong number of segments passed up");
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_flushed[i], seqs[i], msg << ": wrong segment " << i);
+      NS_TEST_ASSERT_MSG_EQ (m_sink->m_delivered[i], seqs[i], msg << ": wrong segment " << i << " passed up");
+      NS_TEST_ASSERT_MSG_EQ (m_reasons[i], reasons[i], msg << ": wrong reason for segment " << i);
+    }
+}
+
+void
+TcpResequenceBufferTestCase::DoRun (void)
+{
+  m_sink = CreateObject<TcpResequenceSink> ();
+  m_buffer = m_sink->GetResequenceBuffer ();
+  m_buffer->TraceConnectWithoutContext ("Flush", MakeCallback (&TcpResequenceBufferTestCase::Flush, this));
+
+  // In order segments wait for the in order timer (20 us, checked every 10 us)
+  Buffer (1000);
+  Buffer (1100);
+  Buffer (1200);
+  // 1400 waits for 1300, then both join the in order queue
+  Buffer (1400);
+  Buffer (1300);
+  // Duplicates and a segment overlapping the in order queue are ignored
+  Buffer (1400);
+  Buffer (1000);
+  Buffer (1450);
+  // 1600 waits for the missing 1500, a duplicate of it is ignored
+  Buffer (1600);
+  Buffer (1600);
+  Check (0, 0, 0, "Nothing flushed before the timers");
+
+  Simulator::Stop (MicroSeconds (35));
+  Simulator::Run ();
+  uint32_t inOrder[] = { 1000, 1100, 1200, 1300, 1400 };
+  TcpRBPopReason inOrderReasons[] = { IN_ORDER_TIMEOUT, IN_ORDER_TIMEOUT, IN_ORDER_TIMEOUT,
+                                      IN_ORDER_TIMEOUT, IN_ORDER_TIMEOUT };
+  Check (inOrder, inOrderReasons, 5, "In order timeout");
+
+  // The out of order timer (50 us) gives up on 1500
+  Simulator::Stop (MicroSeconds (65));
+  Simulator::Run ();
+  uint32_t outOrder[] = { 1000, 1100, 1200, 1300, 1400, 1600 };
+  TcpRBPopReason outOrderReasons[] = { IN_ORDER_TIMEOUT, IN_ORDER_TIMEOUT, IN_ORDER_TIMEOUT,
+                                       IN_ORDER_TIMEOUT, IN_ORDER_TIMEOUT, OUT_ORDER_TIMEOUT };
+  Check (outOrder, outOrderReasons, 6, "Out of order timeout");
+
+  // A segment older than those flushed is a retransmission, passed up at once
+  Buffer (1100);
+  uint32_t retrans[] = { 1000, 1100, 1200, 1300, 1400, 1600, 1100 };
+  TcpRBPopReason retransReasons[] = { IN_ORDER_TIMEOUT, IN_ORDER_TIMEOUT, IN_ORDER_TIMEOUT,
+                                      IN_ORDER_TIMEOUT, IN_ORDER_TIMEOUT, OUT_ORDER_TIMEOUT,
+                                      RE_TRANS };
+  Check (retrans, retransReasons, 7, "Retransmission");
+
+  // The in order queue is flushed at once when it reaches the size limit
+  m_buffer->SetAttribute ("SizeLimit", UintegerValue (300));
+  Buffer (1200);
+  Buffer (1300);
+  Buffer (1400);
+  uint32_t full[] = { 1000, 1100, 1200, 1300, 1400, 1600, 1100, 1200, 1300, 1400 };
+  TcpRBPopReason fullReasons[] = { IN_ORDER_TIMEOUT, IN_ORDER_TIMEOUT, IN_ORDER_TIMEOUT,
+                                   IN_ORDER_TIMEOUT, IN_ORDER_TIMEOUT, OUT_ORDER_TIMEOUT,
+                                   RE_TRANS, IN_ORDER_FULL, IN_ORDER_FULL, IN_ORDER_FULL };
+  Check (full, fullReasons, 10, "Size limit");
+
+  m_buffer->Stop ();
+  Simulator::Destroy ();
+  m_buffer = 0;
+  m_sink = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TcpResequenceBuffer TestSuite
+ */
+class TcpResequenceBufferTestSuite : public TestSuite
+{
+public:
+  TcpResequenceBufferTestSuite ()
+    : TestSuite ("tcp-resequence-buffer", UNIT)
+  {
+    AddTestCase (new TcpResequenceBufferTestCase, TestCase::QUICK);
+  }
+};
+
+static TcpResequenceBufferTestSuite g_tcpResequenceBufferTestSuite; //!< Static variable for test initialization
+
+} // namespace ns3
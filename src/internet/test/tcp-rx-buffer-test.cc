@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-rx-buffer.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check TcpRxBuffer bookkeeping under heavy reordering and overlap
+ */
+class TcpRxBufferReorderTestCase : public TestCase
+{
+public:
+  TcpRxBufferReorderTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Add a segment of the given size at the given seq
+   * \param buf the buffer
+   * \param seq first byte of the segment
+   * \param size segment size
+   * \return the value returned by TcpRxBuffer::Add
+   */
+  bool AddSegment (Ptr<TcpRxBuffer> buf, uint32_t seq, uint32_t size);
+};
+
+TcpRxBufferReorderTestCase::TcpRxBufferReorderTestCase ()
+  : TestCase ("Reordered and overlapping segments in TcpRxBuffer")
+{
+}
+
+bool
+TcpRxBufferReorderTestCase::AddSegment (Ptr<TcpRxBuffer> buf, uint32_t seq, uint32_t size)
+{
+  TcpHeader tcph;
+  tcph.SetSequenceNumber (SequenceNumber32 (seq));
+  return buf->Add (Create<Packet> (size), tcph);
+}
+
+void
+TcpRxBufferReorderTestCase::DoRun (void)
+{
+  Ptr<TcpRxBuffer> buf = CreateObject<TcpRxBuffer> (1);
+  buf->SetMaxBufferSize (100000);
+
+  // Segments 2..9 arrive before segment 1, in reverse order
+  for (uint32_t i = 9; i >= 2; --i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (AddSegment (buf, 1 + i * 100, 100), true, "Segment should be buffered");
+    }
+  NS_TEST_ASSERT_MSG_EQ (buf->Available (), 0, "Nothing contiguous yet");
+  NS_TEST_ASSERT_MSG_EQ (buf->Size (), 800, "Out of order bytes are accounted");
+
+  // A segment fully covered by buffered data is dropped
+  NS_TEST_ASSERT_MSG_EQ (AddSegment (buf, 351, 100), false, "Duplicate data should not be buffered");
+  NS_TEST_ASSERT_MSG_EQ (buf->Size (), 800, "Duplicate data is not accounted");
+
+  // Segment 1 overlaps the head of segment 2
+  NS_TEST_ASSERT_MSG_EQ (AddSegment (buf, 101, 150), true, "Overlapping segment should be buffered");
+  NS_TEST_ASSERT_MSG_EQ (buf->NextRxSequence (), SequenceNumber32 (1), "Head is still missing");
+  NS_TEST_ASSERT_MSG_EQ (buf->Size (), 900, "Only the new bytes are accounted");
+
+  // Segment 0 was delayed the most and fills the head hole
+  NS_TEST_ASSERT_MSG_EQ (AddSegment (buf, 1, 100), true, "Head segment should be buffered");
+  NS_TEST_ASSERT_MSG_EQ (buf->NextRxSequence (), SequenceNumber32 (1001), "Contiguous run merged");
+  NS_TEST_ASSERT_MSG_EQ (buf->Available (), 1000, "Everything available");
+
+  // Appending in order keeps the run contiguous
+  NS_TEST_ASSERT_MSG_EQ (AddSegment (buf, 1001, 100), true, "In order segment should be buffered");
+  NS_TEST_ASSERT_MSG_EQ (buf->NextRxSequence (), SequenceNumber32 (1101), "In order append");
+
+  // A segment spanning already delivered and new data is trimmed
+  NS_TEST_ASSERT_MSG_EQ (AddSegment (buf, 1051, 100), true, "Partially new segment should be buffered");
+  NS_TEST_ASSERT_MSG_EQ (buf->NextRxSequence (), SequenceNumber32 (1151), "Only new bytes appended");
+  NS_TEST_ASSERT_MSG_EQ (buf->Size (), 1150, "Overlap not accounted twice");
+
+  Ptr<Packet> p = buf->Extract (700);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 700, "Coalesced extraction across segments");
+  p = buf->Extract (10000);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 450, "Remaining bytes extracted");
+  NS_TEST_ASSERT_MSG_EQ (buf->Size (), 0, "Buffer drained");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TcpRxBuffer TestSuite
+ */
+class TcpRxBufferTestSuite : public TestSuite
+{
+public:
+  TcpRxBufferTestSuite ()
+    : TestSuite ("tcp-rx-buffer", UNIT)
+  {
+    AddTestCase (new TcpRxBufferReorderTestCase, TestCase::QUICK);
+  }
+};
+
+static TcpRxBufferTestSuite g_tcpRxBufferTestSuite; //!< Static variable for test initialization
+
+} // namespace ns3
@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mobility-grid.h"
+#include "mobility-model.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MobilityGrid");
+
+MobilityGrid::MobilityGrid ()
+  : m_cellSize (100.0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MobilityGrid::~MobilityGrid ()
+{
+  NS_LOG_FUNCTION (this);
+  Clear ();
+}
+
+void
+MobilityGrid::SetCellSize (double size)
+{
+  NS_LOG_FUNCTION (this << size);
+  NS_ASSERT_MSG (m_entries.empty (), "The cell size cannot change once models are added");
+  NS_ASSERT (size > 0);
+  m_cellSize = size;
+}
+
+double
+MobilityGrid::GetCellSize (void) const
+{
+  return m_cellSize;
+}
+
+uint32_t
+MobilityGrid::Add (Ptr<MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  uint32_t index = m_entries.size ();
+  Entry entry;
+  entry.mobility = mobility;
+  entry.moving = false;
+  m_entries.push_back (entry);
+  std::vector<uint32_t> &indexes = m_indexes[PeekPointer (mobility)];
+  if (indexes.empty ())
+    {
+      mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&MobilityGrid::CourseChanged, this));
+    }
+  indexes.push_back (index);
+  Insert (index);
+  return index;
+}
+
+uint32_t
+MobilityGrid::GetN (void) const
+{
+  return m_entries.size ();
+}
+
+void
+MobilityGrid::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::map<const MobilityModel *, std::vector<uint32_t> >::const_iterator i = m_indexes.begin ();
+       i != m_indexes.end (); ++i)
+    {
+      m_entries[i->second.front ()].mobility->TraceDisconnectWithoutContext ("CourseChange",
+                                                                            MakeCallback (&MobilityGrid::CourseChanged, this));
+    }
+  m_indexes.clear ();
+  m_cells.clear ();
+  m_moving.clear ();
+  m_entries.clear ();
+}
+
+void
+MobilityGrid::GetNeighbors (const Vector &position, double distance, std::vector<uint32_t> &indexes) const
+{
+  NS_LOG_FUNCTION (this << position << distance);
+  indexes = m_moving;
+  double lowX = std::floor ((position.x - distance) / m_cellSize);
+  double lowY = std::floor ((position.y - distance) / m_cellSize);
+  double highX = std::floor ((position.x + distance) / m_cellSize);
+  double highY = std::floor ((position.y + distance) / m_cellSize);
+  if ((highX - lowX + 1) * (highY - lowY + 1) > m_cells.size ())
+    {
+      // fewer occupied cells than cells in range
+      for (std::map<Cell, std::vector<uint32_t> >::const_iterator i = m_cells.begin (); i != m_cells.end (); ++i)
+        {
+          if (i->first.first >= lowX && i->first.first <= highX
+              && i->first.second >= lowY && i->first.second <= highY)
+            {
+              indexes.insert (indexes.end (), i->second.begin (), i->second.end ());
+            }
+        }
+    }
+  else
+    {
+      for (int64_t x = lowX; x <= highX; ++x)
+        {
+          for (int64_t y = lowY; y <= highY; ++y)
+            {
+              std::map<Cell, std::vector<uint32_t> >::const_iterator i = m_cells.find (Cell (x, y));
+              if (i != m_cells.end ())
+                {
+                  indexes.insert (indexes.end (), i->second.begin (), i->second.end ());
+                }
+            }
+        }
+    }
+  std::sort (indexes.begin (), indexes.end ());
+}
+
+MobilityGrid::Cell
+MobilityGrid::GetCell (const Vector &position) const
+{
+  return Cell (static_cast<int64_t> (std::floor (position.x / m_cellSize)),
+               static_cast<int64_t> (std::floor (position.y / m_cellSize)));
+}
+
+void
+MobilityGrid::Insert (uint32_t index)
+{
+  Entry &entry = m_entries[index];
+  Vector velocity = entry.mobility->GetVelocity ();
+  entry.moving = velocity.x != 0 || velocity.y != 0 || velocity.z != 0;
+  if (entry.moving)
+    {
+      m_moving.push_back (index);
+    }
+  else
+    {
+      entry.cell = GetCell (entry.mobility->GetPosition ());
+      m_cells[entry.cell].push_back (index);
+    }
+}
+
+void
+MobilityGrid::Remove (uint32_t index)
+{
+  Entry &entry = m_entries[index];
+  if (entry.moving)
+    {
+      m_moving.erase (std::find (m_moving.begin (), m_moving.end (), index));
+    }
+  else
+    {
+      std::map<Cell, std::vector<uint32_t> >::iterator cell = m_cells.find (entry.cell);
+      NS_ASSERT (cell != m_cells.end ());
+      cell->second.erase (std::find (cell->second.begin (), cell->second.end (), index));
+      if (cell->second.empty ())
+        {
+          m_cells.erase (cell);
+        }
+    }
+}
+
+void
+MobilityGrid::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  std::map<const MobilityModel *, std::vector<uint32_t> >::const_iterator i = m_indexes.find (PeekPointer (mobility));
+  NS_ASSERT (i != m_indexes.end ());
+  for (std::vector<uint32_t>::const_iterator j = i->second.begin (); j != i->second.end (); ++j)
+    {
+      Remove (*j);
+      Insert (*j);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MOBILITY_GRID_H
+#define MOBILITY_GRID_H
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/vector.h"
+
+namespace ns3 {
+
+class MobilityModel;
+
+/**
+ * \ingroup mobility
+ *
+ * \brief Uniform grid of mobility models, to find the models close to
+ * a position without looking at all of them.
+ *
+ * The grid splits the (x, y) plane in square cells and keeps the index
+ * of each model in the cell of its position. It listens to the
+ * CourseChange trace of the models to move them between cells. The
+ * models with a non-zero velocity change position without notifying
+ * their course, so they are kept apart and always returned as
+ * candidates until they stop.
+ *
+ * The neighbors are candidates: the caller must check their exact
+ * distance, which also takes z into account.
+ */
+class MobilityGrid
+{
+public:
+  MobilityGrid ();
+  ~MobilityGrid ();
+
+  /**
+   * Set the size of the cells, which should be close to the distances
+   * queried. Only allowed while the grid is empty.
+   * \param size the side of a cell in meters
+   */
+  void SetCellSize (double size);
+  /**
+   * \return the side of a cell in meters
+   */
+  double GetCellSize (void) const;
+
+  /**
+   * Add a model, a model can be added several times
+   * \param mobility the model
+   * \return the index of the model, the number of models added before it
+   */
+  uint32_t Add (Ptr<MobilityModel> mobility);
+  /**
+   * \return the number of models added
+   */
+  uint32_t GetN (void) const;
+  /**
+   * Remove all the models
+   */
+  void Clear (void);
+
+  /**
+   * Find the models which may be within a distance of a position
+   * \param position the position
+   * \param distance the distance in meters
+   * \param indexes the indexes of the candidates, sorted
+   */
+  void GetNeighbors (const Vector &position, double distance, std::vector<uint32_t> &indexes) const;
+
+private:
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   */
+  MobilityGrid (const MobilityGrid &);
+  /**
+   * \brief Copy assignment
+   *
+   * Defined and unimplemented to avoid misuse
+   * \returns
+   */
+  MobilityGrid &operator = (const MobilityGrid &);
+
+  /// Coordinates of a cell
+  typedef std::pair<int64_t, int64_t> Cell;
+
+  /// A model of the grid
+  struct Entry
+  {
+    Ptr<MobilityModel> mobility;        //!< The model
+    bool moving;                        //!< Whether it is in the moving list
+    Cell cell;                          //!< Its cell when it is not moving
+  };
+
+  /**
+   * \param position a position
+   * \return the cell of the position
+   */
+  Cell GetCell (const Vector &position) const;
+  /**
+   * Put a model in its cell or in the moving list
+   * \param index the index of the model
+   */
+  void Insert (uint32_t index);
+  /**
+   * Take a model out of its cell or out of the moving list
+   * \param index the index of the model
+   */
+  void Remove (uint32_t index);
+  /**
+   * Move the entries of a model after a course change
+   * \param mobility the model
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+
+  double m_cellSize;                                    //!< Side of a cell
+  std::vector<Entry> m_entries;                         //!< Models by index
+  std::map<Cell, std::vector<uint32_t> > m_cells;       //!< Indexes of the models by cell
+  std::vector<uint32_t> m_moving;                       //!< Indexes of the moving models
+  std::map<const MobilityModel *, std::vector<uint32_t> > m_indexes; //!< Indexes of each model
+};
+
+} // namespace ns3
+
+#endif /* MOBILITY_GRID_H */
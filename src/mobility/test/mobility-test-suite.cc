@@ -31,6 +31,10 @@
 #include "ns3/mobility-model.h"
 #include "ns3/waypoint-mobility-model.h"
 #include "ns3/mobility-helper.h"
+#include "ns3/mobility-grid.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include <sstream>
 
 using namespace ns3;
 
@@ -354,6 +358,87 @@ WaypointMobilityModelViaHelper::DoRun (void)
   Simulator::Destroy ();
 }
 
+// Test that the grid returns the models close to a position and follows
+// their course changes
+class MobilityGridNeighbors : public TestCase
+{
+public:
+  MobilityGridNeighbors ();
+  virtual ~MobilityGridNeighbors ();
+
+private:
+  /**
+   * \param grid the grid
+   * \param distance the distance from the origin
+   * \return the indexes of the candidates, as a string
+   */
+  std::string GetNeighbors (const MobilityGrid &grid, double distance);
+  virtual void DoRun (void);
+};
+
+MobilityGridNeighbors::MobilityGridNeighbors ()
+  : TestCase ("Test the neighbors of a MobilityGrid")
+{
+}
+
+MobilityGridNeighbors::~MobilityGridNeighbors ()
+{
+}
+
+std::string
+MobilityGridNeighbors::GetNeighbors (const MobilityGrid &grid, double distance)
+{
+  std::vector<uint32_t> indexes;
+  grid.GetNeighbors (Vector (0.0, 0.0, 0.0), distance, indexes);
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < indexes.size (); ++i)
+    {
+      oss << indexes[i] << " ";
+    }
+  return oss.str ();
+}
+
+void
+MobilityGridNeighbors::DoRun (void)
+{
+  MobilityGrid grid;
+  grid.SetCellSize (100.0);
+  Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (10.0, 10.0, 0.0));
+  Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  b->SetPosition (Vector (-150.0, 20.0, 0.0));
+  Ptr<ConstantPositionMobilityModel> c = CreateObject<ConstantPositionMobilityModel> ();
+  c->SetPosition (Vector (1000.0, 1000.0, 0.0));
+  Ptr<ConstantVelocityMobilityModel> d = CreateObject<ConstantVelocityMobilityModel> ();
+  d->SetPosition (Vector (5000.0, 0.0, 0.0));
+  grid.Add (a);
+  grid.Add (c);
+  grid.Add (b);
+  grid.Add (d);
+  grid.Add (a);
+  NS_TEST_EXPECT_MSG_EQ (grid.GetN (), 5, "Five models were added");
+
+  NS_TEST_EXPECT_MSG_EQ (GetNeighbors (grid, 50.0), "0 4 ", "Only a is in range");
+  NS_TEST_EXPECT_MSG_EQ (GetNeighbors (grid, 200.0), "0 2 4 ", "a and b are in range");
+  NS_TEST_EXPECT_MSG_EQ (GetNeighbors (grid, 1e9), "0 1 2 3 4 ", "All the models are in range");
+
+  c->SetPosition (Vector (-30.0, -30.0, 0.0));
+  NS_TEST_EXPECT_MSG_EQ (GetNeighbors (grid, 50.0), "0 1 4 ", "c moved in range");
+  a->SetPosition (Vector (300.0, 10.0, 0.0));
+  NS_TEST_EXPECT_MSG_EQ (GetNeighbors (grid, 50.0), "1 ", "a moved out of range");
+
+  // a moving model is always a candidate
+  d->SetVelocity (Vector (-10.0, 0.0, 0.0));
+  NS_TEST_EXPECT_MSG_EQ (GetNeighbors (grid, 50.0), "1 3 ", "d is moving");
+  d->SetVelocity (Vector (0.0, 0.0, 0.0));
+  NS_TEST_EXPECT_MSG_EQ (GetNeighbors (grid, 50.0), "1 ", "d stopped out of range");
+
+  grid.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (grid.GetN (), 0, "The grid was cleared");
+  a->SetPosition (Vector (0.0, 0.0, 0.0));
+  Simulator::Destroy ();
+}
+
 class MobilityTestSuite : public TestSuite
 {
 public:
@@ -367,6 +452,7 @@ MobilityTestSuite::MobilityTestSuite ()
   AddTestCase (new WaypointLazyNotifyTrue, TestCase::QUICK);
   AddTestCase (new WaypointInitialPositionIsWaypoint, TestCase::QUICK);
   AddTestCase (new WaypointMobilityModelViaHelper, TestCase::QUICK);
+  AddTestCase (new MobilityGridNeighbors, TestCase::QUICK);
 }
 
 static MobilityTestSuite mobilityTestSuite;
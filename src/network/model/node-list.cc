@@ -26,6 +26,7 @@
 #include "ns3/assert.h"
 #include "node-list.h"
 #include "node.h"
+#include <sstream>
 
 namespace ns3 {
 
@@ -179,6 +180,12 @@ NodeListPriv::Add (Ptr<Node> node)
   uint32_t index = m_nodes.size ();
   m_nodes.push_back (node);
   Simulator::ScheduleWithContext (index, TimeStep (0), &Node::Initialize, node);
+  if (Config::HasSubscriptions ())
+    {
+      std::ostringstream oss;
+      oss << "/NodeList/" << index;
+      Config::NotifyObjectAdded (oss.str (), node);
+    }
   return index;
 
 }
@@ -24,6 +24,7 @@
 #include "application.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/config.h"
 #include "ns3/object-vector.h"
 #include "ns3/uinteger.h"
 #include "ns3/log.h"
@@ -31,6 +32,7 @@
 #include "ns3/global-value.h"
 #include "ns3/boolean.h"
 #include "ns3/simulator.h"
+#include <sstream>
 
 namespace ns3 {
 
@@ -136,6 +138,12 @@ Node::AddDevice (Ptr<NetDevice> device)
   Simulator::ScheduleWithContext (GetId (), Seconds (0.0), 
                                   &NetDevice::Initialize, device);
   NotifyDeviceAdded (device);
+  if (Config::HasSubscriptions ())
+    {
+      std::ostringstream oss;
+      oss << "/NodeList/" << GetId () << "/DeviceList/" << index;
+      Config::NotifyObjectAdded (oss.str (), device);
+    }
   return index;
 }
 Ptr<NetDevice>
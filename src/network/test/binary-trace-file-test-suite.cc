@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+#include "ns3/packet.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/binary-trace-file.h"
+#include "ns3/binary-trace-reader.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Write records through several turns of a small ring and check
+ * that the reader maps them back in order.
+ */
+class BinaryTraceWriteReadTestCase : public TestCase
+{
+public:
+  BinaryTraceWriteReadTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BinaryTraceWriteReadTestCase::BinaryTraceWriteReadTestCase ()
+  : TestCase ("Check that records written to a binary trace are read back unchanged")
+{
+}
+
+void
+BinaryTraceWriteReadTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("binary-trace-test.bin");
+  // 1000 records with chunks of 7 records and a 3 chunks ring: the ring
+  // wraps many times and the last chunk is partially filled
+  const uint32_t nRecords = 1000;
+
+  Ptr<BinaryTraceFile> file = CreateObject<BinaryTraceFile> ();
+  file->SetAttribute ("ChunkRecords", UintegerValue (7));
+  file->SetAttribute ("NChunks", UintegerValue (3));
+  file->Open (filename);
+  for (uint32_t i = 0; i < nRecords; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (100 + i);
+      p->AddPacketTag (FlowIdTag (i % 5));
+      file->Write (BinaryTraceFile::MakeRecord (p, i % 6, i / 10, i % 3, i));
+    }
+  NS_TEST_ASSERT_MSG_EQ (file->GetNRecords (), nRecords, "Wrong number of records appended");
+  file->Close ();
+
+  BinaryTraceReader reader;
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (filename), true, "Can't open the binary trace");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetNRecords (), nRecords, "Wrong number of records read");
+  for (uint32_t i = 0; i < nRecords; i++)
+    {
+      const BinaryTraceRecord &record = reader.GetRecord (i);
+      NS_TEST_ASSERT_MSG_EQ (record.size, 100 + i, "Wrong size in record " << i);
+      NS_TEST_ASSERT_MSG_EQ (record.flowId, i % 5, "Wrong flow id in record " << i);
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t) record.event, i % 6, "Wrong event in record " << i);
+      NS_TEST_ASSERT_MSG_EQ (record.node, i / 10, "Wrong node in record " << i);
+      NS_TEST_ASSERT_MSG_EQ (record.device, i % 3, "Wrong device in record " << i);
+      NS_TEST_ASSERT_MSG_EQ (record.queueDepth, i, "Wrong queue depth in record " << i);
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t) record.ecn, 0, "Unexpected ECN bits in record " << i);
+    }
+  reader.Close ();
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that the ECN bits are extracted from an IPv4 packet, with
+ * and without the PPP header in front of it.
+ */
+class BinaryTraceEcnTestCase : public TestCase
+{
+public:
+  BinaryTraceEcnTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BinaryTraceEcnTestCase::BinaryTraceEcnTestCase ()
+  : TestCase ("Check the extraction of the ECN bits")
+{
+}
+
+void
+BinaryTraceEcnTestCase::DoRun (void)
+{
+  // Version 4, IHL 5, DSCP 0, ECN CE
+  uint8_t ipv4[] = { 0x45, 0x03, 0x00, 0x14 };
+  Ptr<Packet> p = Create<Packet> (ipv4, sizeof (ipv4));
+  BinaryTraceRecord record = BinaryTraceFile::MakeRecord (p, BINARY_TRACE_DEVICE_RX, 0, 0, 0);
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t) record.ecn, 3, "ECN bits not extracted from an IPv4 header");
+
+  uint8_t ppp[] = { 0x00, 0x21, 0x45, 0x02 };
+  p = Create<Packet> (ppp, sizeof (ppp));
+  record = BinaryTraceFile::MakeRecord (p, BINARY_TRACE_DEVICE_TX, 0, 0, 0);
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t) record.ecn, 2, "ECN bits not extracted behind a PPP header");
+
+  p = Create<Packet> (4);
+  record = BinaryTraceFile::MakeRecord (p, BINARY_TRACE_DEVICE_TX, 0, 0, 0);
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t) record.ecn, 0, "ECN bits extracted from a non IPv4 packet");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Binary trace file TestSuite
+ */
+class BinaryTraceFileTestSuite : public TestSuite
+{
+public:
+  BinaryTraceFileTestSuite ();
+};
+
+BinaryTraceFileTestSuite::BinaryTraceFileTestSuite ()
+  : TestSuite ("binary-trace-file", UNIT)
+{
+  AddTestCase (new BinaryTraceWriteReadTestCase, TestCase::QUICK);
+  AddTestCase (new BinaryTraceEcnTestCase, TestCase::QUICK);
+}
+
+static BinaryTraceFileTestSuite g_binaryTraceFileTestSuite; //!< Static variable for test initialization
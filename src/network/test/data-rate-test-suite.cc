@@ -0,0 +1,66 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+
+using namespace ns3;
+
+class DataRateTxTimeTestCase : public TestCase
+{
+public:
+  DataRateTxTimeTestCase ();
+  virtual void DoRun (void);
+};
+
+DataRateTxTimeTestCase::DataRateTxTimeTestCase ()
+  : TestCase ("Check the exact transmission times of DataRate")
+{
+}
+
+void
+DataRateTxTimeTestCase::DoRun (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("1Gbps").CalculateBytesTxTime (40), NanoSeconds (320),
+                         "40 bytes take 320ns at 1Gbps");
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("10Gbps").CalculateBytesTxTime (1500), NanoSeconds (1200),
+                         "1500 bytes take 1200ns at 10Gbps");
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("40Gbps").CalculateBytesTxTime (9000), NanoSeconds (1800),
+                         "9000 bytes take 1800ns at 40Gbps");
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("5Mbps").CalculateBitsTxTime (100), NanoSeconds (20000),
+                         "100 bits take 20us at 5Mbps");
+  // 1500 * 8 / 56000 = 0.214285714285...s, rounded down
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("56kbps").CalculateBytesTxTime (1500), NanoSeconds (214285714),
+                         "The transmission time is rounded down");
+  // 3Gbps does not divide 10^12 bits per second
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("3Gbps").CalculateBytesTxTime (1500), NanoSeconds (4000),
+                         "1500 bytes take 4000ns at 3Gbps");
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("3Gbps").CalculateBytesTxTime (1), NanoSeconds (2),
+                         "1 byte takes 2.67ns at 3Gbps, rounded down");
+  NS_TEST_EXPECT_MSG_EQ (DataRate (100).CalculateBytesTxTime (10), Seconds (0.8),
+                         "10 bytes take 800ms at 100bps");
+}
+
+static class DataRateTestSuite : public TestSuite
+{
+public:
+  DataRateTestSuite ()
+    : TestSuite ("data-rate", UNIT)
+  {
+    AddTestCase (new DataRateTxTimeTestCase (), TestCase::QUICK);
+  }
+} g_dataRateTestSuite;
@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <cstdio>
+
+#include "ns3/test.h"
+#include "ns3/pcap-file.h"
+#include "ns3/pcap-mmap-reader.h"
+
+using namespace ns3;
+
+/**
+ * Read back with PcapMmapReader the records written by PcapFile, in
+ * both byte orders and timestamp resolutions.
+ */
+class PcapMmapReaderRecordsTestCase : public TestCase
+{
+public:
+  PcapMmapReaderRecordsTestCase (bool swapMode, bool nanosecMode);
+  virtual void DoRun (void);
+
+private:
+  bool m_swapMode;
+  bool m_nanosecMode;
+};
+
+PcapMmapReaderRecordsTestCase::PcapMmapReaderRecordsTestCase (bool swapMode, bool nanosecMode)
+  : TestCase (std::string ("Check that PcapMmapReader reads the records of a ")
+              + (swapMode ? "swapped " : "") + (nanosecMode ? "nanosecond " : "microsecond ")
+              + "pcap file"),
+    m_swapMode (swapMode),
+    m_nanosecMode (nanosecMode)
+{
+}
+
+void
+PcapMmapReaderRecordsTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("pcap-mmap-reader.pcap");
+  PcapFile file;
+  file.Open (filename, std::ios::out);
+  file.Init (1, 1000, PcapFile::ZONE_DEFAULT, m_swapMode, m_nanosecMode);
+  uint8_t data[1000];
+  for (uint32_t i = 0; i < 50; i++)
+    {
+      for (uint32_t j = 0; j < sizeof (data); j++)
+        {
+          data[j] = i + j;
+        }
+      file.Write (i, i * 1000 + 7, data, i * 20);
+    }
+  file.Close ();
+
+  PcapMmapReader reader;
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (filename), true, "Cannot open the file");
+  NS_TEST_EXPECT_MSG_EQ (reader.GetDataLinkType (), 1, "Bad data link type");
+  NS_TEST_EXPECT_MSG_EQ (reader.GetSnapLen (), 1000, "Bad snap length");
+  NS_TEST_EXPECT_MSG_EQ (reader.GetSwapMode (), m_swapMode, "Bad byte order");
+  NS_TEST_EXPECT_MSG_EQ (reader.IsNanoSecMode (), m_nanosecMode, "Bad resolution");
+
+  for (uint32_t pass = 0; pass < 2; pass++)
+    {
+      PcapMmapReader::Record record;
+      for (uint32_t i = 0; i < 50; i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (reader.Next (record), true, "Missing record " << i);
+          uint64_t frac = i * 1000 + 7;
+          NS_TEST_EXPECT_MSG_EQ (record.timestamp, i * 1000000000ULL + (m_nanosecMode ? frac : frac * 1000),
+                                 "Bad timestamp of record " << i);
+          NS_TEST_EXPECT_MSG_EQ (record.inclLen, i * 20, "Bad captured length of record " << i);
+          NS_TEST_EXPECT_MSG_EQ (record.origLen, i * 20, "Bad original length of record " << i);
+          bool same = true;
+          for (uint32_t j = 0; j < record.inclLen; j++)
+            {
+              same = same && record.data[j] == uint8_t (i + j);
+            }
+          NS_TEST_EXPECT_MSG_EQ (same, true, "Bad data of record " << i);
+        }
+      NS_TEST_EXPECT_MSG_EQ (reader.Next (record), false, "Record after the end");
+      NS_TEST_EXPECT_MSG_EQ (reader.GetOffset (), reader.GetFileSize (), "Not at the end of the file");
+      reader.Rewind ();
+    }
+  reader.Close ();
+  std::remove (filename.c_str ());
+}
+
+/**
+ * Check that PcapMmapReader stops at a truncated record and rejects
+ * files which are not pcap files.
+ */
+class PcapMmapReaderErrorsTestCase : public TestCase
+{
+public:
+  PcapMmapReaderErrorsTestCase ();
+  virtual void DoRun (void);
+};
+
+PcapMmapReaderErrorsTestCase::PcapMmapReaderErrorsTestCase ()
+  : TestCase ("Check that PcapMmapReader handles truncated and invalid files")
+{
+}
+
+void
+PcapMmapReaderErrorsTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("pcap-mmap-reader-errors.pcap");
+  PcapFile file;
+  file.Open (filename, std::ios::out);
+  file.Init (101);
+  uint8_t data[100] = { 0 };
+  file.Write (1, 0, data, sizeof (data));
+  file.Write (2, 0, data, sizeof (data));
+  file.Close ();
+
+  // cut the data of the second record
+  std::ifstream in (filename.c_str (), std::ios::binary);
+  std::string content ((std::istreambuf_iterator<char> (in)), std::istreambuf_iterator<char> ());
+  in.close ();
+  std::ofstream out (filename.c_str (), std::ios::binary | std::ios::trunc);
+  out.write (content.data (), content.size () - 10);
+  out.close ();
+
+  PcapMmapReader reader;
+  PcapMmapReader::Record record;
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (filename), true, "Cannot open the file");
+  NS_TEST_EXPECT_MSG_EQ (reader.Next (record), true, "The first record is complete");
+  NS_TEST_EXPECT_MSG_EQ (reader.Next (record), false, "The second record is truncated");
+  reader.Close ();
+
+  out.open (filename.c_str (), std::ios::binary | std::ios::trunc);
+  out << "this is not a pcap file, only some text";
+  out.close ();
+  NS_TEST_EXPECT_MSG_EQ (reader.Open (filename), false, "Bad magic number accepted");
+  NS_TEST_EXPECT_MSG_EQ (reader.IsOpen (), false, "Bad file left open");
+  NS_TEST_EXPECT_MSG_EQ (reader.Open (filename + ".missing"), false, "Missing file opened");
+  std::remove (filename.c_str ());
+}
+
+static class PcapMmapReaderTestSuite : public TestSuite
+{
+public:
+  PcapMmapReaderTestSuite ()
+    : TestSuite ("pcap-mmap-reader", UNIT)
+  {
+    AddTestCase (new PcapMmapReaderRecordsTestCase (false, false), TestCase::QUICK);
+    AddTestCase (new PcapMmapReaderRecordsTestCase (true, false), TestCase::QUICK);
+    AddTestCase (new PcapMmapReaderRecordsTestCase (false, true), TestCase::QUICK);
+    AddTestCase (new PcapMmapReaderRecordsTestCase (true, true), TestCase::QUICK);
+    AddTestCase (new PcapMmapReaderErrorsTestCase (), TestCase::QUICK);
+  }
+} g_pcapMmapReaderTestSuite;
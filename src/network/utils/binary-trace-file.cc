@@ -0,0 +1,280 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "binary-trace-file.h"
+#include "flow-id-tag.h"
+#include "ns3/log.h"
+#include "ns3/fatal-error.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceFile");
+
+NS_OBJECT_ENSURE_REGISTERED (BinaryTraceFile);
+
+const char BinaryTraceFile::MAGIC[8] = { 'N', 'S', '3', 'B', 'T', 'R', 'C', '\0' };
+
+TypeId
+BinaryTraceFile::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BinaryTraceFile")
+    .SetParent<Object> ()
+    .SetGroupName ("Network")
+    .AddConstructor<BinaryTraceFile> ()
+    .AddAttribute ("ChunkRecords",
+                   "Number of records handed at once to the writer thread.",
+                   UintegerValue (1 << 16),
+                   MakeUintegerAccessor (&BinaryTraceFile::m_chunkRecords),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("NChunks",
+                   "Number of chunks in the in-memory ring.",
+                   UintegerValue (16),
+                   MakeUintegerAccessor (&BinaryTraceFile::m_nChunks),
+                   MakeUintegerChecker<uint32_t> (2))
+  ;
+  return tid;
+}
+
+BinaryTraceFile::BinaryTraceFile ()
+  : m_chunkRecords (1 << 16),
+    m_nChunks (16),
+    m_isOpen (false),
+    m_fillChunk (0),
+    m_fillPos (0),
+    m_nRecords (0)
+#ifdef HAVE_PTHREAD_H
+  ,
+    m_readyChunks (0),
+    m_writtenChunks (0),
+    m_stopWriter (false)
+#endif
+{
+  NS_LOG_FUNCTION (this);
+}
+
+BinaryTraceFile::~BinaryTraceFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+BinaryTraceFile::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  Object::DoDispose ();
+}
+
+void
+BinaryTraceFile::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  NS_ASSERT_MSG (!m_isOpen, "BinaryTraceFile::Open(): File already open");
+
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file.is_open ())
+    {
+      NS_FATAL_ERROR ("BinaryTraceFile::Open(): Can't open \"" << filename << "\"");
+    }
+
+  uint32_t version = VERSION;
+  uint32_t recordSize = sizeof (BinaryTraceRecord);
+  m_file.write (MAGIC, sizeof (MAGIC));
+  m_file.write (reinterpret_cast<const char *> (&version), sizeof (version));
+  m_file.write (reinterpret_cast<const char *> (&recordSize), sizeof (recordSize));
+
+  m_ring.resize (static_cast<size_t> (m_chunkRecords) * m_nChunks);
+  m_fillChunk = 0;
+  m_fillPos = 0;
+  m_nRecords = 0;
+  m_isOpen = true;
+
+#ifdef HAVE_PTHREAD_H
+  m_readyChunks = 0;
+  m_writtenChunks = 0;
+  m_stopWriter = false;
+  m_writer = Create<SystemThread> (MakeCallback (&BinaryTraceFile::WriterLoop, this));
+  m_writer->Start ();
+#endif
+}
+
+void
+BinaryTraceFile::Close (void)
+{
+  if (!m_isOpen)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+
+#ifdef HAVE_PTHREAD_H
+  {
+    CriticalSection cs (m_mutex);
+    m_stopWriter = true;
+  }
+  m_readyCondition.SetCondition (true);
+  m_readyCondition.Signal ();
+  // The writer drains all the full chunks before exiting
+  m_writer->Join ();
+  m_writer = 0;
+#endif
+
+  // The chunk being filled is written by the main thread
+  WriteChunk (m_fillChunk % m_nChunks, m_fillPos);
+  m_file.close ();
+  m_ring.clear ();
+  m_isOpen = false;
+}
+
+void
+BinaryTraceFile::Write (const BinaryTraceRecord &record)
+{
+  NS_ASSERT_MSG (m_isOpen, "BinaryTraceFile::Write(): File not open");
+  m_ring[(m_fillChunk % m_nChunks) * m_chunkRecords + m_fillPos] = record;
+  ++m_nRecords;
+  if (++m_fillPos == m_chunkRecords)
+    {
+      ChunkFull ();
+    }
+}
+
+void
+BinaryTraceFile::ChunkFull (void)
+{
+#ifdef HAVE_PTHREAD_H
+  {
+    CriticalSection cs (m_mutex);
+    m_readyChunks = m_fillChunk + 1;
+  }
+  m_readyCondition.SetCondition (true);
+  m_readyCondition.Signal ();
+
+  ++m_fillChunk;
+  m_fillPos = 0;
+
+  // Wait until the writer is done with the chunk we are going to fill
+  while (true)
+    {
+      m_freeCondition.SetCondition (false);
+      {
+        CriticalSection cs (m_mutex);
+        if (m_fillChunk - m_writtenChunks < m_nChunks)
+          {
+            break;
+          }
+      }
+      NS_LOG_LOGIC ("Waiting for the writer thread");
+      m_freeCondition.TimedWait (1000000);
+    }
+#else
+  WriteChunk (m_fillChunk % m_nChunks, m_chunkRecords);
+  ++m_fillChunk;
+  m_fillPos = 0;
+#endif
+}
+
+void
+BinaryTraceFile::WriteChunk (uint32_t chunk, uint32_t records)
+{
+  if (records == 0)
+    {
+      return;
+    }
+  m_file.write (reinterpret_cast<const char *> (&m_ring[static_cast<size_t> (chunk) * m_chunkRecords]),
+                static_cast<std::streamsize> (records) * sizeof (BinaryTraceRecord));
+}
+
+void
+BinaryTraceFile::WriterLoop (void)
+{
+#ifdef HAVE_PTHREAD_H
+  while (true)
+    {
+      m_readyCondition.SetCondition (false);
+      uint64_t chunk;
+      bool ready;
+      bool stop;
+      {
+        CriticalSection cs (m_mutex);
+        chunk = m_writtenChunks;
+        ready = m_writtenChunks < m_readyChunks;
+        stop = m_stopWriter;
+      }
+      if (ready)
+        {
+          WriteChunk (chunk % m_nChunks, m_chunkRecords);
+          {
+            CriticalSection cs (m_mutex);
+            ++m_writtenChunks;
+          }
+          m_freeCondition.SetCondition (true);
+          m_freeCondition.Signal ();
+        }
+      else if (stop)
+        {
+          break;
+        }
+      else
+        {
+          m_readyCondition.TimedWait (1000000);
+        }
+    }
+#endif
+}
+
+uint64_t
+BinaryTraceFile::GetNRecords (void) const
+{
+  return m_nRecords;
+}
+
+BinaryTraceRecord
+BinaryTraceFile::MakeRecord (Ptr<const Packet> p, uint8_t event,
+                             uint32_t node, uint32_t device, uint32_t queueDepth)
+{
+  BinaryTraceRecord record;
+  record.time = Simulator::Now ().GetTimeStep ();
+  record.uid = p->GetUid ();
+  record.node = node;
+  record.device = device;
+  record.size = p->GetSize ();
+  record.queueDepth = queueDepth;
+  record.event = event;
+  record.reserved = 0;
+
+  FlowIdTag flowIdTag;
+  record.flowId = p->PeekPacketTag (flowIdTag) ? flowIdTag.GetFlowId () : 0;
+
+  // The packet may still carry the 2 bytes PPP header (0x0021 for IPv4)
+  // in front of the IPv4 header, whose second byte holds the ECN bits
+  uint8_t bytes[4];
+  uint32_t copied = p->CopyData (bytes, sizeof (bytes));
+  record.ecn = 0;
+  if (copied >= 2 && (bytes[0] >> 4) == 4)
+    {
+      record.ecn = bytes[1] & 0x3;
+    }
+  else if (copied == 4 && bytes[0] == 0x00 && bytes[1] == 0x21 && (bytes[2] >> 4) == 4)
+    {
+      record.ecn = bytes[3] & 0x3;
+    }
+  return record;
+}
+
+} // namespace ns3
@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_FILE_H
+#define BINARY_TRACE_FILE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+#include "ns3/core-config.h"
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-mutex.h"
+#include "ns3/system-condition.h"
+#include "ns3/system-thread.h"
+#endif
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ * Events stored in a binary trace.
+ */
+enum BinaryTraceEvent
+{
+  BINARY_TRACE_DEVICE_TX = 0,   //!< A device started the transmission of a packet
+  BINARY_TRACE_DEVICE_RX,       //!< A device received a packet
+  BINARY_TRACE_DEVICE_DROP,     //!< A device dropped a packet
+  BINARY_TRACE_QUEUE_ENQUEUE,   //!< A queue disc enqueued a packet
+  BINARY_TRACE_QUEUE_DEQUEUE,   //!< A queue disc dequeued a packet
+  BINARY_TRACE_QUEUE_DROP       //!< A queue disc dropped a packet
+};
+
+/**
+ * \ingroup network
+ * One fixed size record of a binary trace, stored verbatim in host byte
+ * order.
+ */
+struct BinaryTraceRecord
+{
+  int64_t time;         //!< Simulation time in time steps
+  uint64_t uid;         //!< Packet uid
+  uint32_t node;        //!< Node id
+  uint32_t device;      //!< Device index on the node
+  uint32_t size;        //!< Packet size in bytes
+  uint32_t flowId;      //!< Flow id from the FlowIdTag, 0 if none
+  uint32_t queueDepth;  //!< Packets in the queue after the event
+  uint8_t event;        //!< A BinaryTraceEvent
+  uint8_t ecn;          //!< ECN bits of the IPv4 header, 0 if not IPv4
+  uint16_t reserved;    //!< Padding, always 0
+};
+
+/**
+ * \ingroup network
+ *
+ * \brief A compact binary trace file with fixed size records.
+ *
+ * The records are appended to an in-memory ring made of \c NChunks chunks
+ * of \c ChunkRecords records each. When a chunk is full it is handed to a
+ * background writer thread, so the simulation only pays for the copy of
+ * the record. The simulation blocks only if the writer falls behind by the
+ * whole ring. Without thread support the chunks are written synchronously.
+ *
+ * The file starts with a 16 bytes header: the magic "NS3BTRC", a null
+ * byte, the format version and the record size as two uint32_t. The
+ * BinaryTraceRecord array follows. Use BinaryTraceReader to map the file
+ * back into memory.
+ */
+class BinaryTraceFile : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  BinaryTraceFile ();
+  virtual ~BinaryTraceFile ();
+
+  /**
+   * Create the trace file and start the writer.
+   * \param filename the name of the file
+   */
+  void Open (std::string const &filename);
+
+  /**
+   * Write the pending records and close the file. Called on dispose if the
+   * file is still open.
+   */
+  void Close (void);
+
+  /**
+   * Append a record to the trace.
+   * \param record the record
+   */
+  void Write (const BinaryTraceRecord &record);
+
+  /**
+   * Fill a record with the current time and the fields that can be
+   * extracted from a packet: uid, size, flow id and, when the packet starts
+   * with an IPv4 header, the ECN bits.
+   *
+   * \param p the packet
+   * \param event the BinaryTraceEvent
+   * \param node the node id
+   * \param device the device index on the node
+   * \param queueDepth the number of packets in the queue
+   * \return the record
+   */
+  static BinaryTraceRecord MakeRecord (Ptr<const Packet> p, uint8_t event,
+                                       uint32_t node, uint32_t device, uint32_t queueDepth);
+
+  /**
+   * \return the number of records appended so far
+   */
+  uint64_t GetNRecords (void) const;
+
+  /// Magic written at the beginning of every binary trace file
+  static const char MAGIC[8];
+  /// Version of the file format
+  static const uint32_t VERSION = 1;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// Hand the chunk being filled to the writer and wait for a free one
+  void ChunkFull (void);
+  /**
+   * Write the records of a chunk to the file
+   * \param chunk the chunk index
+   * \param records the number of records in the chunk
+   */
+  void WriteChunk (uint32_t chunk, uint32_t records);
+  /// Body of the writer thread
+  void WriterLoop (void);
+
+  uint32_t m_chunkRecords;                    //!< Records per chunk
+  uint32_t m_nChunks;                         //!< Chunks in the ring
+  std::vector<BinaryTraceRecord> m_ring;      //!< The ring buffer
+  std::ofstream m_file;                       //!< The output file
+  bool m_isOpen;                              //!< Whether the file is open
+
+  uint64_t m_fillChunk;                       //!< Number of the chunk being filled
+  uint32_t m_fillPos;                         //!< Next free record in that chunk
+  uint64_t m_nRecords;                        //!< Records appended so far
+
+#ifdef HAVE_PTHREAD_H
+  SystemMutex m_mutex;                        //!< Protects the three fields below
+  uint64_t m_readyChunks;                     //!< Chunks handed to the writer
+  uint64_t m_writtenChunks;                   //!< Chunks written by the writer
+  bool m_stopWriter;                          //!< Ask the writer to exit
+  SystemCondition m_readyCondition;           //!< Signals a chunk to write
+  SystemCondition m_freeCondition;            //!< Signals a written chunk
+  Ptr<SystemThread> m_writer;                 //!< The writer thread
+#endif
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_FILE_H */
@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "binary-trace-reader.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceReader");
+
+/// Size of the file header: magic, version and record size
+static const uint64_t BINARY_TRACE_HEADER_SIZE = sizeof (BinaryTraceFile::MAGIC) + 2 * sizeof (uint32_t);
+
+BinaryTraceReader::BinaryTraceReader ()
+  : m_map (0),
+    m_mapSize (0),
+    m_records (0),
+    m_nRecords (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+BinaryTraceReader::~BinaryTraceReader ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+BinaryTraceReader::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+
+  int fd = open (filename.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      NS_LOG_WARN ("Can't open " << filename);
+      return false;
+    }
+  struct stat st;
+  if (fstat (fd, &st) < 0 || static_cast<uint64_t> (st.st_size) < BINARY_TRACE_HEADER_SIZE)
+    {
+      NS_LOG_WARN (filename << " is too short to be a binary trace");
+      close (fd);
+      return false;
+    }
+
+  void *map = mmap (0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED)
+    {
+      NS_LOG_WARN ("Can't map " << filename);
+      return false;
+    }
+
+  const uint8_t *bytes = static_cast<const uint8_t *> (map);
+  uint32_t version;
+  uint32_t recordSize;
+  std::memcpy (&version, bytes + sizeof (BinaryTraceFile::MAGIC), sizeof (version));
+  std::memcpy (&recordSize, bytes + sizeof (BinaryTraceFile::MAGIC) + sizeof (version), sizeof (recordSize));
+  if (std::memcmp (bytes, BinaryTraceFile::MAGIC, sizeof (BinaryTraceFile::MAGIC)) != 0
+      || version != BinaryTraceFile::VERSION
+      || recordSize != sizeof (BinaryTraceRecord))
+    {
+      NS_LOG_WARN (filename << " is not a binary trace of this version");
+      munmap (map, st.st_size);
+      return false;
+    }
+
+  m_map = map;
+  m_mapSize = st.st_size;
+  m_records = reinterpret_cast<const BinaryTraceRecord *> (bytes + BINARY_TRACE_HEADER_SIZE);
+  m_nRecords = (m_mapSize - BINARY_TRACE_HEADER_SIZE) / sizeof (BinaryTraceRecord);
+  return true;
+}
+
+void
+BinaryTraceReader::Close (void)
+{
+  if (m_map != 0)
+    {
+      munmap (m_map, m_mapSize);
+    }
+  m_map = 0;
+  m_mapSize = 0;
+  m_records = 0;
+  m_nRecords = 0;
+}
+
+uint64_t
+BinaryTraceReader::GetNRecords (void) const
+{
+  return m_nRecords;
+}
+
+const BinaryTraceRecord *
+BinaryTraceReader::GetRecords (void) const
+{
+  return m_records;
+}
+
+const BinaryTraceRecord &
+BinaryTraceReader::GetRecord (uint64_t i) const
+{
+  NS_ASSERT (i < m_nRecords);
+  return m_records[i];
+}
+
+} // namespace ns3
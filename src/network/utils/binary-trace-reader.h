@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_READER_H
+#define BINARY_TRACE_READER_H
+
+#include <string>
+#include <stdint.h>
+#include "binary-trace-file.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Read-only view of a file written by BinaryTraceFile.
+ *
+ * The file is mapped in memory, so the records can be scanned without
+ * copying them and files larger than the memory can be analyzed. This class
+ * does not depend on the simulator and can be used by stand-alone analysis
+ * programs.
+ */
+class BinaryTraceReader
+{
+public:
+  BinaryTraceReader ();
+  ~BinaryTraceReader ();
+
+  /**
+   * Map a binary trace file.
+   * \param filename the name of the file
+   * \return true if the file is a valid binary trace
+   */
+  bool Open (std::string const &filename);
+
+  /**
+   * Unmap the file.
+   */
+  void Close (void);
+
+  /**
+   * \return the number of records in the file
+   */
+  uint64_t GetNRecords (void) const;
+
+  /**
+   * \return a pointer to the first record of the file
+   */
+  const BinaryTraceRecord * GetRecords (void) const;
+
+  /**
+   * \param i the index of the record
+   * \return the record
+   */
+  const BinaryTraceRecord & GetRecord (uint64_t i) const;
+
+private:
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   */
+  BinaryTraceReader (const BinaryTraceReader &);
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   * \returns
+   */
+  BinaryTraceReader &operator = (const BinaryTraceReader &);
+
+  void *m_map;                          //!< The mapped file
+  uint64_t m_mapSize;                   //!< Size of the mapping
+  const BinaryTraceRecord *m_records;   //!< First record
+  uint64_t m_nRecords;                  //!< Number of records
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_READER_H */
@@ -22,6 +22,7 @@
 #include "ns3/nstime.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include <limits>
 
 namespace ns3 {
   
@@ -185,7 +186,9 @@ DataRate::DoParse (const std::string s, uint64_t *v)
 }
 
 DataRate::DataRate ()
-  : m_bps (0)
+  : m_bps (0),
+    m_psPerBit (0),
+    m_psPerBitRemainder (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -194,6 +197,21 @@ DataRate::DataRate(uint64_t bps)
   : m_bps (bps)
 {
   NS_LOG_FUNCTION (this << bps);
+  UpdatePsPerBit ();
+}
+
+void
+DataRate::UpdatePsPerBit (void)
+{
+  static const uint64_t PS_PER_SECOND = 1000000000000ULL;
+  if (m_bps == 0)
+    {
+      m_psPerBit = 0;
+      m_psPerBitRemainder = 0;
+      return;
+    }
+  m_psPerBit = PS_PER_SECOND / m_bps;
+  m_psPerBitRemainder = PS_PER_SECOND % m_bps;
 }
 
 bool DataRate::operator < (const DataRate& rhs) const
@@ -235,15 +253,29 @@ double DataRate::CalculateTxTime (uint32_t bytes) const
 Time DataRate::CalculateBytesTxTime (uint32_t bytes) const
 {
   NS_LOG_FUNCTION (this << bytes);
-  // \todo avoid to use double (if possible).
-  return Seconds (static_cast<double>(bytes)*8/m_bps);
+  return DoCalculateTxTime (static_cast<uint64_t> (bytes) * 8);
 }
 
 Time DataRate::CalculateBitsTxTime (uint32_t bits) const
 {
   NS_LOG_FUNCTION (this << bits);
-  // \todo avoid to use double (if possible).
-  return Seconds (static_cast<double>(bits)/m_bps);
+  return DoCalculateTxTime (bits);
+}
+
+Time DataRate::DoCalculateTxTime (uint64_t bits) const
+{
+  // bits * 10^12 / m_bps picoseconds, split in an integer part and a
+  // remainder to stay in 64 bits.
+  const uint64_t maxValue = std::numeric_limits<uint64_t>::max ();
+  if (m_bps == 0
+      || (m_psPerBit != 0 && bits > maxValue / m_psPerBit)
+      || (m_psPerBitRemainder != 0 && bits > maxValue / m_psPerBitRemainder))
+    {
+      // very low rates or very large sizes
+      return Seconds (static_cast<double>(bits)/m_bps);
+    }
+  uint64_t ps = bits * m_psPerBit + bits * m_psPerBitRemainder / m_bps;
+  return PicoSeconds (ps);
 }
 
 uint64_t DataRate::GetBitRate () const
@@ -260,6 +292,7 @@ DataRate::DataRate (std::string rate)
     {
       NS_FATAL_ERROR ("Could not parse rate: "<<rate);
     }
+  UpdatePsPerBit ();
 }
 
 /* For printing of data rate */
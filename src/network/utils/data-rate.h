@@ -83,6 +83,10 @@ namespace ns3 {
  * * "8Kib/s" = 1 KiB/s = 8192 bits/s
  * * "1kB/s" = 8000 bits/s 
  *
+ * The transmission times are computed with integers, from the number of
+ * picoseconds per bit precomputed when the rate is set, and rounded down
+ * to the time resolution.
+ *
  * \see attribute_DataRate
  */
 class DataRate
@@ -214,10 +218,25 @@ private:
    */
   static bool DoParse (const std::string s, uint64_t *v);
 
+  /**
+   * \brief Compute the picoseconds per bit of the current rate
+   */
+  void UpdatePsPerBit (void);
+
+  /**
+   * \brief Calculate transmission time
+   *
+   * \param bits The number of bits
+   * \return The transmission time, rounded down to the time resolution
+   */
+  Time DoCalculateTxTime (uint64_t bits) const;
+
   // Uses DoParse
   friend std::istream &operator >> (std::istream &is, DataRate &rate);
   
   uint64_t m_bps; //!< data rate [bps]
+  uint64_t m_psPerBit;          //!< Integer part of the picoseconds per bit
+  uint64_t m_psPerBitRemainder; //!< Remainder of the picoseconds per bit, in 1/m_bps
 };
 
 /**
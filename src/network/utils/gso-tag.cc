@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "gso-tag.h"
+#include "ns3/packet.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (GsoTag);
+
+TypeId
+GsoTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::GsoTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Network")
+    .AddConstructor<GsoTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+GsoTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+GsoTag::GetSerializedSize (void) const
+{
+  return 6;
+}
+
+void
+GsoTag::Serialize (TagBuffer buf) const
+{
+  buf.WriteU16 (m_segmentSize);
+  buf.WriteU16 (m_nSegments);
+  buf.WriteU16 (m_headerSize);
+}
+
+void
+GsoTag::Deserialize (TagBuffer buf)
+{
+  m_segmentSize = buf.ReadU16 ();
+  m_nSegments = buf.ReadU16 ();
+  m_headerSize = buf.ReadU16 ();
+}
+
+void
+GsoTag::Print (std::ostream &os) const
+{
+  os << "segments=" << m_nSegments << " segsize=" << m_segmentSize
+     << " hdrsize=" << m_headerSize;
+}
+
+GsoTag::GsoTag ()
+  : m_segmentSize (0),
+    m_nSegments (1),
+    m_headerSize (0)
+{
+}
+
+void
+GsoTag::SetSegmentSize (uint16_t segmentSize)
+{
+  m_segmentSize = segmentSize;
+}
+
+uint16_t
+GsoTag::GetSegmentSize (void) const
+{
+  return m_segmentSize;
+}
+
+void
+GsoTag::SetNSegments (uint16_t nSegments)
+{
+  m_nSegments = nSegments;
+}
+
+uint16_t
+GsoTag::GetNSegments (void) const
+{
+  return m_nSegments;
+}
+
+void
+GsoTag::SetHeaderSize (uint16_t headerSize)
+{
+  m_headerSize = headerSize;
+}
+
+uint16_t
+GsoTag::GetHeaderSize (void) const
+{
+  return m_headerSize;
+}
+
+uint32_t
+GsoTag::GetExtraWireBytes (uint32_t linkHeaderSize) const
+{
+  if (m_nSegments <= 1)
+    {
+      return 0;
+    }
+  return (m_nSegments - 1) * (m_headerSize + linkHeaderSize);
+}
+
+uint32_t
+GsoTag::GetWireSize (Ptr<const Packet> packet, uint32_t linkHeaderSize)
+{
+  GsoTag gsoTag;
+  if (!packet->PeekPacketTag (gsoTag))
+    {
+      return packet->GetSize ();
+    }
+  return packet->GetSize () + gsoTag.GetExtraWireBytes (linkHeaderSize);
+}
+
+} // namespace ns3
@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef GSO_TAG_H
+#define GSO_TAG_H
+
+#include "ns3/tag.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \ingroup network
+ *
+ * \brief Marks a super-segment built by a transport protocol with
+ * generic segmentation offload.
+ *
+ * A super-segment carries the payload of several MTU-sized segments behind
+ * a single copy of the network and transport headers. It travels as one
+ * packet, i.e., one set of events per hop, for as long as the network layer
+ * finds the egress ports idle; it is cut into its segments where a queue
+ * builds up. Net devices use the tag to charge the headers of the
+ * segments which are not materialized, so a super-segment takes as long
+ * to serialize as its segments sent back to back.
+ */
+class GsoTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  GsoTag ();
+
+  /**
+   * \param segmentSize the payload size of a segment
+   */
+  void SetSegmentSize (uint16_t segmentSize);
+  /**
+   * \returns the payload size of a segment
+   */
+  uint16_t GetSegmentSize (void) const;
+  /**
+   * \param nSegments the number of segments in the super-segment
+   */
+  void SetNSegments (uint16_t nSegments);
+  /**
+   * \returns the number of segments in the super-segment
+   */
+  uint16_t GetNSegments (void) const;
+  /**
+   * \param headerSize the size of the headers replicated in every segment
+   */
+  void SetHeaderSize (uint16_t headerSize);
+  /**
+   * \returns the size of the headers replicated in every segment
+   */
+  uint16_t GetHeaderSize (void) const;
+  /**
+   * \param linkHeaderSize the size of the link layer framing of a segment
+   * \returns the bytes the segments would add on the wire to the
+   * super-segment, i.e., the headers of all the segments but the first
+   */
+  uint32_t GetExtraWireBytes (uint32_t linkHeaderSize) const;
+  /**
+   * \param packet a packet, possibly a super-segment
+   * \param linkHeaderSize the size of the link layer framing of a segment
+   * \returns the number of bytes the packet takes on the wire
+   */
+  static uint32_t GetWireSize (Ptr<const Packet> packet, uint32_t linkHeaderSize);
+
+private:
+  uint16_t m_segmentSize; //!< Payload size of a segment
+  uint16_t m_nSegments;   //!< Number of segments
+  uint16_t m_headerSize;  //!< Network and transport header size
+};
+
+} // namespace ns3
+
+#endif /* GSO_TAG_H */
@@ -0,0 +1,226 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pcap-mmap-reader.h"
+#include "ns3/log.h"
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapMmapReader");
+
+namespace {
+
+const uint32_t MAGIC = 0xa1b2c3d4;            //!< Standard pcap file format
+const uint32_t SWAPPED_MAGIC = 0xd4c3b2a1;    //!< Standard format, swapped
+const uint32_t NS_MAGIC = 0xa1b23c4d;         //!< Nanosecond resolution format
+const uint32_t NS_SWAPPED_MAGIC = 0x4d3cb2a1; //!< Nanosecond format, swapped
+const uint32_t FILE_HEADER_SIZE = 24;         //!< Size of the file header
+const uint32_t RECORD_HEADER_SIZE = 16;       //!< Size of a record header
+/// The pages behind the reader are released by chunks of this size
+const uint64_t RELEASE_CHUNK = 64 * 1024 * 1024;
+
+} // anonymous namespace
+
+PcapMmapReader::PcapMmapReader ()
+  : m_base (0),
+    m_size (0),
+    m_offset (0),
+    m_released (0),
+    m_swap (false),
+    m_nanoSec (false),
+    m_snapLen (0),
+    m_dataLinkType (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapMmapReader::~PcapMmapReader ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+PcapMmapReader::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+  int fd = open (filename.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      NS_LOG_WARN ("Cannot open " << filename);
+      return false;
+    }
+  struct stat st;
+  if (fstat (fd, &st) < 0 || st.st_size < FILE_HEADER_SIZE)
+    {
+      NS_LOG_WARN ("Not a pcap file: " << filename);
+      close (fd);
+      return false;
+    }
+  void *base = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping keeps its own reference to the file
+  close (fd);
+  if (base == MAP_FAILED)
+    {
+      NS_LOG_WARN ("Cannot map " << filename);
+      return false;
+    }
+  madvise (base, st.st_size, MADV_SEQUENTIAL);
+  m_base = static_cast<const uint8_t *> (base);
+  m_size = st.st_size;
+
+  uint32_t magic;
+  std::memcpy (&magic, m_base, sizeof (magic));
+  m_swap = magic == SWAPPED_MAGIC || magic == NS_SWAPPED_MAGIC;
+  m_nanoSec = magic == NS_MAGIC || magic == NS_SWAPPED_MAGIC;
+  if (magic != MAGIC && !m_swap && !m_nanoSec)
+    {
+      NS_LOG_WARN ("Bad magic number in " << filename);
+      Close ();
+      return false;
+    }
+  m_snapLen = Read32 (16);
+  m_dataLinkType = Read32 (20);
+  m_offset = FILE_HEADER_SIZE;
+  m_released = 0;
+  return true;
+}
+
+void
+PcapMmapReader::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_base != 0)
+    {
+      munmap (const_cast<uint8_t *> (m_base), m_size);
+    }
+  m_base = 0;
+  m_size = 0;
+  m_offset = 0;
+  m_released = 0;
+}
+
+bool
+PcapMmapReader::IsOpen (void) const
+{
+  return m_base != 0;
+}
+
+uint32_t
+PcapMmapReader::Read32 (uint64_t offset) const
+{
+  uint32_t v;
+  std::memcpy (&v, m_base + offset, sizeof (v));
+  if (m_swap)
+    {
+      v = ((v >> 24) & 0xff) | ((v >> 8) & 0xff00) | ((v << 8) & 0xff0000) | (v << 24);
+    }
+  return v;
+}
+
+bool
+PcapMmapReader::Next (Record &record)
+{
+  if (m_base == 0 || m_offset + RECORD_HEADER_SIZE > m_size)
+    {
+      return false;
+    }
+  uint32_t tsSec = Read32 (m_offset);
+  uint32_t tsFrac = Read32 (m_offset + 4);
+  record.inclLen = Read32 (m_offset + 8);
+  record.origLen = Read32 (m_offset + 12);
+  if (m_offset + RECORD_HEADER_SIZE + record.inclLen > m_size)
+    {
+      NS_LOG_WARN ("Truncated record at offset " << m_offset);
+      return false;
+    }
+  record.timestamp = tsSec * 1000000000ULL + (m_nanoSec ? tsFrac : tsFrac * 1000ULL);
+  record.data = m_base + m_offset + RECORD_HEADER_SIZE;
+  m_offset += RECORD_HEADER_SIZE + record.inclLen;
+  if (m_offset - m_released >= 2 * RELEASE_CHUNK)
+    {
+      Release ();
+    }
+  return true;
+}
+
+void
+PcapMmapReader::Release (void)
+{
+  // keep the last chunk, the caller may still look at the latest records
+  uint64_t end = (m_offset - RELEASE_CHUNK) & ~(RELEASE_CHUNK - 1);
+  if (end > m_released)
+    {
+      NS_LOG_LOGIC ("release " << m_released << " to " << end);
+      madvise (const_cast<uint8_t *> (m_base) + m_released, end - m_released, MADV_DONTNEED);
+      m_released = end;
+    }
+}
+
+void
+PcapMmapReader::Rewind (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_base != 0)
+    {
+      m_offset = FILE_HEADER_SIZE;
+      m_released = 0;
+    }
+}
+
+uint32_t
+PcapMmapReader::GetDataLinkType (void) const
+{
+  return m_dataLinkType;
+}
+
+uint32_t
+PcapMmapReader::GetSnapLen (void) const
+{
+  return m_snapLen;
+}
+
+bool
+PcapMmapReader::IsNanoSecMode (void) const
+{
+  return m_nanoSec;
+}
+
+bool
+PcapMmapReader::GetSwapMode (void) const
+{
+  return m_swap;
+}
+
+uint64_t
+PcapMmapReader::GetFileSize (void) const
+{
+  return m_size;
+}
+
+uint64_t
+PcapMmapReader::GetOffset (void) const
+{
+  return m_offset;
+}
+
+} // namespace ns3
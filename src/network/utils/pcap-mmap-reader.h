@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_MMAP_READER_H
+#define PCAP_MMAP_READER_H
+
+#include <string>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \brief Sequential reader of large pcap files
+ *
+ * The file is mapped in memory and the records are returned as
+ * pointers into the mapping, without copying the packets. The pages
+ * are read by the kernel as the reader walks the file and the pages
+ * behind it are released, so a file of several gigabytes can be read
+ * without ever being resident. Both the microsecond and the nanosecond
+ * formats are supported, in either byte order.
+ */
+class PcapMmapReader
+{
+public:
+  /** A record of the file */
+  struct Record
+  {
+    uint64_t timestamp;         //!< Capture time in nanoseconds
+    uint32_t inclLen;           //!< Number of bytes captured
+    uint32_t origLen;           //!< Number of bytes of the original packet
+    const uint8_t *data;        //!< The captured bytes, valid until Close
+  };
+
+  PcapMmapReader ();
+  ~PcapMmapReader ();
+
+  /**
+   * Map a pcap file
+   * \param filename the file name
+   * \return false if the file cannot be mapped or is not a pcap file
+   */
+  bool Open (std::string const &filename);
+  /**
+   * Unmap the file
+   */
+  void Close (void);
+  /**
+   * \return true if a file is mapped
+   */
+  bool IsOpen (void) const;
+
+  /**
+   * Read the next record
+   * \param record the record read
+   * \return false at the end of the file or on a truncated record
+   */
+  bool Next (Record &record);
+  /**
+   * Go back to the first record
+   */
+  void Rewind (void);
+
+  /**
+   * \return the data link type of the file
+   */
+  uint32_t GetDataLinkType (void) const;
+  /**
+   * \return the maximum number of bytes captured per packet
+   */
+  uint32_t GetSnapLen (void) const;
+  /**
+   * \return true if the timestamps are in nanoseconds
+   */
+  bool IsNanoSecMode (void) const;
+  /**
+   * \return true if the file is in the other byte order than the host
+   */
+  bool GetSwapMode (void) const;
+  /**
+   * \return the size of the file in bytes
+   */
+  uint64_t GetFileSize (void) const;
+  /**
+   * \return the offset of the next record in the file
+   */
+  uint64_t GetOffset (void) const;
+
+private:
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   */
+  PcapMmapReader (const PcapMmapReader &);
+  /**
+   * \brief Copy assignment
+   *
+   * Defined and unimplemented to avoid misuse
+   * \returns
+   */
+  PcapMmapReader &operator = (const PcapMmapReader &);
+
+  /**
+   * \param offset an offset in the file
+   * \return the 32 bits integer at this offset, in host byte order
+   */
+  uint32_t Read32 (uint64_t offset) const;
+  /**
+   * Release the pages before the current offset
+   */
+  void Release (void);
+
+  const uint8_t *m_base;        //!< Start of the mapping
+  uint64_t m_size;              //!< Size of the file
+  uint64_t m_offset;            //!< Offset of the next record
+  uint64_t m_released;          //!< Offset up to which the pages were released
+  bool m_swap;                  //!< Whether the byte order is swapped
+  bool m_nanoSec;               //!< Whether the timestamps are in nanoseconds
+  uint32_t m_snapLen;           //!< Maximum bytes per packet
+  uint32_t m_dataLinkType;      //!< Data link type
+};
+
+} // namespace ns3
+
+#endif /* PCAP_MMAP_READER_H */
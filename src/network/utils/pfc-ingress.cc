@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pfc-ingress.h"
+#include "ns3/log.h"
+#include "ns3/tag.h"
+#include "ns3/packet.h"
+#include "ns3/node-list.h"
+#include "ns3/net-device.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PfcIngress");
+
+NS_OBJECT_ENSURE_REGISTERED (PfcIngress);
+
+/**
+ * \ingroup network
+ *
+ * Records the PFC ingress counter a packet was counted against, so that
+ * the counter is released when the packet leaves the node.
+ */
+class PfcIngressTag : public Tag
+{
+public:
+  PfcIngressTag ()
+    : m_nodeId (0),
+      m_ifIndex (0),
+      m_priority (0),
+      m_size (0)
+  {
+  }
+
+  /**
+   * Constructor
+   * \param nodeId the node of the ingress device
+   * \param ifIndex the index of the ingress device
+   * \param priority the PFC priority
+   * \param size the number of bytes counted
+   */
+  PfcIngressTag (uint32_t nodeId, uint32_t ifIndex, uint8_t priority, uint32_t size)
+    : m_nodeId (nodeId),
+      m_ifIndex (ifIndex),
+      m_priority (priority),
+      m_size (size)
+  {
+  }
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::PfcIngressTag")
+      .SetParent<Tag> ()
+      .SetGroupName ("Network")
+      .AddConstructor<PfcIngressTag> ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const
+  {
+    return 13;
+  }
+  virtual void Serialize (TagBuffer i) const
+  {
+    i.WriteU32 (m_nodeId);
+    i.WriteU32 (m_ifIndex);
+    i.WriteU8 (m_priority);
+    i.WriteU32 (m_size);
+  }
+  virtual void Deserialize (TagBuffer i)
+  {
+    m_nodeId = i.ReadU32 ();
+    m_ifIndex = i.ReadU32 ();
+    m_priority = i.ReadU8 ();
+    m_size = i.ReadU32 ();
+  }
+  virtual void Print (std::ostream &os) const
+  {
+    os << "node=" << m_nodeId << " if=" << m_ifIndex
+       << " prio=" << (uint32_t) m_priority << " size=" << m_size;
+  }
+
+  uint32_t m_nodeId;    //!< Node of the ingress device
+  uint32_t m_ifIndex;   //!< Index of the ingress device
+  uint8_t m_priority;   //!< PFC priority
+  uint32_t m_size;      //!< Bytes counted
+};
+
+NS_OBJECT_ENSURE_REGISTERED (PfcIngressTag);
+
+TypeId
+PfcIngress::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PfcIngress")
+    .SetParent<Object> ()
+    .SetGroupName ("Network")
+  ;
+  return tid;
+}
+
+PfcIngress::PfcIngress ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PfcIngress::~PfcIngress ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PfcIngress::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_release = MakeNullCallback<void, uint8_t, uint32_t> ();
+  Object::DoDispose ();
+}
+
+void
+PfcIngress::SetReleaseCallback (ReleaseCallback release)
+{
+  NS_LOG_FUNCTION (this);
+  m_release = release;
+}
+
+void
+PfcIngress::Count (Ptr<Packet> packet, Ptr<NetDevice> device, uint8_t priority, uint32_t size)
+{
+  NS_LOG_FUNCTION (packet << device << (uint32_t) priority << size);
+  packet->AddPacketTag (PfcIngressTag (device->GetNode ()->GetId (), device->GetIfIndex (),
+                                       priority, size));
+}
+
+void
+PfcIngress::Release (Ptr<Packet> packet, Ptr<Node> node)
+{
+  PfcIngressTag tag;
+  if (!packet->RemovePacketTag (tag))
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (packet << node << tag.m_nodeId << tag.m_ifIndex);
+  if (node == 0 || node->GetId () != tag.m_nodeId)
+    {
+      node = NodeList::GetNode (tag.m_nodeId);
+    }
+  Ptr<PfcIngress> ingress = node->GetDevice (tag.m_ifIndex)->GetObject<PfcIngress> ();
+  if (ingress != 0 && !ingress->m_release.IsNull ())
+    {
+      ingress->m_release (tag.m_priority, tag.m_size);
+    }
+}
+
+void
+PfcIngress::Move (Ptr<Packet> from, Ptr<Packet> to)
+{
+  PfcIngressTag tag;
+  if (from->RemovePacketTag (tag))
+    {
+      PfcIngressTag copy;
+      to->RemovePacketTag (copy);
+      to->AddPacketTag (tag);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PFC_INGRESS_H
+#define PFC_INGRESS_H
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/callback.h"
+#include "ns3/node.h"
+
+namespace ns3 {
+
+class Packet;
+class NetDevice;
+
+/**
+ * \ingroup network
+ *
+ * \brief Release of the PFC ingress counters by the layers a packet
+ * crosses in a node.
+ *
+ * A net device implementing priority-based flow control counts the bytes
+ * it receives against a per-priority ingress counter until they leave the
+ * node. Count tags the packet with the counter, and Release gives the
+ * bytes back to the device when the packet leaves the node, whichever way
+ * it leaves: transmission by a device, drop by a queue disc, the shared
+ * buffer or the IP layer, or local delivery. The device aggregates a
+ * PfcIngress object whose release callback adjusts its counter.
+ *
+ * Release removes the tag, so a packet is released once even when several
+ * layers report its drop.
+ */
+class PfcIngress : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PfcIngress ();
+  virtual ~PfcIngress ();
+
+  /**
+   * Callback to release bytes of the counter of a priority
+   */
+  typedef Callback<void, uint8_t, uint32_t> ReleaseCallback;
+
+  /**
+   * \param release the callback of the device releasing its counter
+   */
+  void SetReleaseCallback (ReleaseCallback release);
+
+  /**
+   * Tag a packet counted against an ingress counter
+   *
+   * \param packet the packet
+   * \param device the device which counted the packet, with a PfcIngress
+   * object aggregated
+   * \param priority the priority
+   * \param size the number of bytes counted
+   */
+  static void Count (Ptr<Packet> packet, Ptr<NetDevice> device, uint8_t priority, uint32_t size);
+
+  /**
+   * Release the ingress counter the packet was counted against, if any,
+   * and remove the tag
+   *
+   * \param packet the packet
+   * \param node the node the packet leaves; a packet counted by another
+   * node, which it left through a device without flow control, is
+   * released at that node
+   */
+  static void Release (Ptr<Packet> packet, Ptr<Node> node);
+
+  /**
+   * Move the count of a packet to another packet, so that the bytes are
+   * released once when a packet is cut into several, e.g., a GSO
+   * super-segment into its segments
+   *
+   * \param from the packet counted
+   * \param to the packet which carries the count from now on
+   */
+  static void Move (Ptr<Packet> from, Ptr<Packet> to);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  ReleaseCallback m_release;    //!< Release of the counter of the device
+};
+
+} // namespace ns3
+
+#endif /* PFC_INGRESS_H */
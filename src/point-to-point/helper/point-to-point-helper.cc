@@ -214,6 +214,46 @@ PointToPointHelper::EnableAsciiInternal (
   Config::Connect (oss.str (), MakeBoundCallback (&AsciiTraceHelper::DefaultDropSinkWithContext, stream));
 }
 
+/**
+ * \brief Binary trace sink for the packet traces of a PointToPointNetDevice
+ * \param file the binary trace file
+ * \param device the traced device, not a Ptr as the device holds the callback
+ * \param event the BinaryTraceEvent recorded
+ * \param p the packet
+ */
+static void
+BinaryTraceDeviceSink (Ptr<BinaryTraceFile> file, PointToPointNetDevice *device,
+                       uint8_t event, Ptr<const Packet> p)
+{
+  file->Write (BinaryTraceFile::MakeRecord (p, event, device->GetNode ()->GetId (),
+                                            device->GetIfIndex (),
+                                            device->GetQueue ()->GetNPackets ()));
+}
+
+void
+PointToPointHelper::EnableBinaryTrace (Ptr<BinaryTraceFile> file, NetDeviceContainer devices)
+{
+  NS_LOG_FUNCTION (this << file);
+  for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); ++i)
+    {
+      Ptr<PointToPointNetDevice> device = (*i)->GetObject<PointToPointNetDevice> ();
+      if (device == 0)
+        {
+          NS_LOG_INFO ("PointToPointHelper::EnableBinaryTrace(): Device " << (*i) <<
+                       " not of type ns3::PointToPointNetDevice");
+          continue;
+        }
+      device->TraceConnectWithoutContext ("PhyTxBegin",
+        MakeBoundCallback (&BinaryTraceDeviceSink, file, PeekPointer (device), (uint8_t) BINARY_TRACE_DEVICE_TX));
+      device->TraceConnectWithoutContext ("MacRx",
+        MakeBoundCallback (&BinaryTraceDeviceSink, file, PeekPointer (device), (uint8_t) BINARY_TRACE_DEVICE_RX));
+      device->TraceConnectWithoutContext ("MacTxDrop",
+        MakeBoundCallback (&BinaryTraceDeviceSink, file, PeekPointer (device), (uint8_t) BINARY_TRACE_DEVICE_DROP));
+      device->TraceConnectWithoutContext ("PhyRxDrop",
+        MakeBoundCallback (&BinaryTraceDeviceSink, file, PeekPointer (device), (uint8_t) BINARY_TRACE_DEVICE_DROP));
+    }
+}
+
 NetDeviceContainer 
 PointToPointHelper::Install (NodeContainer c)
 {
@@ -27,6 +27,7 @@
 #include "ns3/node-container.h"
 
 #include "ns3/trace-helper.h"
+#include "ns3/binary-trace-file.h"
 
 namespace ns3 {
 
@@ -151,6 +152,18 @@ public:
    */
   NetDeviceContainer Install (std::string aNode, std::string bNode);
 
+  /**
+   * \brief Write the transmissions, receptions and drops of the given
+   * devices to a binary trace file.
+   *
+   * Each event becomes one BinaryTraceRecord, whose queue depth is the
+   * number of packets in the device queue.
+   *
+   * \param file an open binary trace file
+   * \param devices the PointToPointNetDevices to trace
+   */
+  void EnableBinaryTrace (Ptr<BinaryTraceFile> file, NetDeviceContainer devices);
+
 private:
   /**
    * \brief Enable pcap output the indicated net device.
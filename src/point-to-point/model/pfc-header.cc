@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "pfc-header.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PfcHeader");
+
+NS_OBJECT_ENSURE_REGISTERED (PfcHeader);
+
+/// MAC control opcode of the priority-based PAUSE frames
+static const uint16_t PFC_OPCODE = 0x0101;
+
+PfcHeader::PfcHeader ()
+  : m_classEnable (0)
+{
+  for (uint8_t i = 0; i < N_PRIORITIES; i++)
+    {
+      m_quanta[i] = 0;
+    }
+}
+
+PfcHeader::~PfcHeader ()
+{
+}
+
+TypeId
+PfcHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PfcHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("PointToPoint")
+    .AddConstructor<PfcHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+PfcHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+PfcHeader::Print (std::ostream &os) const
+{
+  os << "PFC";
+  for (uint8_t i = 0; i < N_PRIORITIES; i++)
+    {
+      if (IsEnabled (i))
+        {
+          os << " prio " << (uint32_t) i << " quanta " << m_quanta[i];
+        }
+    }
+}
+
+uint32_t
+PfcHeader::GetSerializedSize (void) const
+{
+  return 4 + 2 * N_PRIORITIES;
+}
+
+void
+PfcHeader::Serialize (Buffer::Iterator start) const
+{
+  start.WriteHtonU16 (PFC_OPCODE);
+  start.WriteHtonU16 (m_classEnable);
+  for (uint8_t i = 0; i < N_PRIORITIES; i++)
+    {
+      start.WriteHtonU16 (m_quanta[i]);
+    }
+}
+
+uint32_t
+PfcHeader::Deserialize (Buffer::Iterator start)
+{
+  uint16_t opcode = start.ReadNtohU16 ();
+  NS_ASSERT_MSG (opcode == PFC_OPCODE, "Not a PFC frame");
+  m_classEnable = start.ReadNtohU16 ();
+  for (uint8_t i = 0; i < N_PRIORITIES; i++)
+    {
+      m_quanta[i] = start.ReadNtohU16 ();
+    }
+  return GetSerializedSize ();
+}
+
+void
+PfcHeader::SetQuanta (uint8_t priority, uint16_t quanta)
+{
+  NS_ASSERT (priority < N_PRIORITIES);
+  m_classEnable |= (1 << priority);
+  m_quanta[priority] = quanta;
+}
+
+uint16_t
+PfcHeader::GetQuanta (uint8_t priority) const
+{
+  NS_ASSERT (priority < N_PRIORITIES);
+  return m_quanta[priority];
+}
+
+bool
+PfcHeader::IsEnabled (uint8_t priority) const
+{
+  NS_ASSERT (priority < N_PRIORITIES);
+  return m_classEnable & (1 << priority);
+}
+
+} // namespace ns3
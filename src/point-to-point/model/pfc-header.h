@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PFC_HEADER_H
+#define PFC_HEADER_H
+
+#include "ns3/header.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief Priority-based flow control (IEEE 802.1Qbb) PAUSE frame
+ *
+ * The frame carries the MAC control opcode 0x0101, a class-enable vector
+ * and one pause time per priority. A pause time is expressed in quanta of
+ * 512 bit times at the speed of the link; a pause time of 0 on an enabled
+ * priority resumes the transmission of that priority immediately.
+ *
+ * On a point-to-point link the frame is carried after a PPP header whose
+ * protocol is PointToPointNetDevice::PFC_PROTOCOL.
+ */
+class PfcHeader : public Header
+{
+public:
+  /// Number of priorities of a PFC frame
+  static const uint8_t N_PRIORITIES = 8;
+
+  PfcHeader ();
+  virtual ~PfcHeader ();
+
+  /**
+   * \brief Get the TypeId
+   *
+   * \return The TypeId for this class
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  virtual void Print (std::ostream &os) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual uint32_t GetSerializedSize (void) const;
+
+  /**
+   * \brief Enable a priority and set its pause time
+   *
+   * \param priority the priority
+   * \param quanta the pause time in quanta, 0 to resume
+   */
+  void SetQuanta (uint8_t priority, uint16_t quanta);
+
+  /**
+   * \param priority the priority
+   * \return the pause time of the priority in quanta
+   */
+  uint16_t GetQuanta (uint8_t priority) const;
+
+  /**
+   * \param priority the priority
+   * \return true if the frame acts on the priority
+   */
+  bool IsEnabled (uint8_t priority) const;
+
+private:
+  uint16_t m_classEnable;                //!< Class-enable vector
+  uint16_t m_quanta[N_PRIORITIES];       //!< Pause time of each priority
+};
+
+} // namespace ns3
+
+#endif /* PFC_HEADER_H */
@@ -17,6 +17,7 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/event-log.h"
 #include "ns3/queue.h"
 #include "ns3/simulator.h"
 #include "ns3/mac48-address.h"
@@ -25,16 +26,25 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/pfc-ingress.h"
+#include "ns3/gso-tag.h"
+#include <algorithm>
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
+#include "pfc-header.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PointToPointNetDevice");
+NS_EVENT_LOG_COMPONENT_DEFINE ("PointToPointNetDevice");
 
 NS_OBJECT_ENSURE_REGISTERED (PointToPointNetDevice);
 
+/// Padding of the PFC frames to the minimum Ethernet payload
+static const uint32_t PFC_PADDING = 26;
+
 TypeId 
 PointToPointNetDevice::GetTypeId (void)
 {
@@ -67,6 +77,43 @@ PointToPointNetDevice::GetTypeId (void)
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("PfcEnabled",
+                   "Whether to enable priority-based flow control (802.1Qbb PAUSE)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointNetDevice::m_pfcEnabled),
+                   MakeBooleanChecker ())
+    .AddAttribute ("PfcXoff",
+                   "The ingress bytes of a priority above which the peer is paused, 0 to never pause it",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_pfcXoff),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PfcXon",
+                   "The ingress bytes of a priority below which the peer is resumed",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_pfcXon),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PfcHeadroom",
+                   "The ingress bytes of a priority accepted above PfcXoff, 0 for no limit",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_pfcHeadroom),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PfcPauseQuanta",
+                   "The pause time of the PAUSE frames in quanta of 512 bit times",
+                   UintegerValue (0xffff),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_pfcPauseQuanta),
+                   MakeUintegerChecker<uint16_t> (1))
+    .AddAttribute ("PfcDeadlockThreshold",
+                   "The blocking time reported by the PfcDeadlock trace, 0 to disable",
+                   TimeValue (MilliSeconds (10)),
+                   MakeTimeAccessor (&PointToPointNetDevice::m_pfcDeadlockThreshold),
+                   MakeTimeChecker ())
+    .AddAttribute ("PfcMaxPausedPackets",
+                   "The packets of paused priorities the transmitter takes out of "
+                   "the queue to send the other priorities, 0 to always stop at a "
+                   "paused packet",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_pfcMaxPausedPackets),
+                   MakeUintegerChecker<uint32_t> ())
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -167,6 +214,32 @@ PointToPointNetDevice::GetTypeId (void)
                      "attached to the device",
                      MakeTraceSourceAccessor (&PointToPointNetDevice::m_promiscSnifferTrace),
                      "ns3::Packet::TracedCallback")
+
+    //
+    // Priority-based flow control
+    //
+    .AddTraceSource ("PfcTx",
+                     "A PFC frame has been sent to the peer",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_pfcTxTrace),
+                     "ns3::PointToPointNetDevice::PfcTxTracedCallback")
+    .AddTraceSource ("PfcPause",
+                     "The peer has paused a priority",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_pfcPauseTrace),
+                     "ns3::PointToPointNetDevice::PfcPauseTracedCallback")
+    .AddTraceSource ("PfcResume",
+                     "A paused priority has been resumed",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_pfcResumeTrace),
+                     "ns3::PointToPointNetDevice::PfcResumeTracedCallback")
+    .AddTraceSource ("PfcHolBlocking",
+                     "The transmission stopped because the packet at the head "
+                     "of the queue belongs to a paused priority and cannot be "
+                     "set aside",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_pfcHolBlockingTrace),
+                     "ns3::PointToPointNetDevice::PfcHolBlockingTracedCallback")
+    .AddTraceSource ("PfcDeadlock",
+                     "The transmission has been blocked for PfcDeadlockThreshold",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_pfcDeadlockTrace),
+                     "ns3::PointToPointNetDevice::PfcDeadlockTracedCallback")
   ;
   return tid;
 }
@@ -177,9 +250,31 @@ PointToPointNetDevice::PointToPointNetDevice ()
     m_txMachineState (READY),
     m_channel (0),
     m_linkUp (false),
-    m_currentPkt (0)
+    m_currentPkt (0),
+    m_pfcEnabled (false),
+    m_pfcXoff (0),
+    m_pfcXon (0),
+    m_pfcHeadroom (0),
+    m_pfcPauseQuanta (0xffff),
+    m_pfcMaxPausedPackets (100),
+    m_pfcNPausedPackets (0),
+    m_pfcPausedSeq (0),
+    m_pfcHolBlocked (false),
+    m_pfcBlocked (false)
 {
   NS_LOG_FUNCTION (this);
+  for (uint8_t i = 0; i < PFC_PRIORITIES; i++)
+    {
+      m_pfcIngressBytes[i] = 0;
+      m_pfcPauseSent[i] = false;
+      m_pfcPaused[i] = false;
+      m_pfcStats[i].pausesSent = 0;
+      m_pfcStats[i].resumesSent = 0;
+      m_pfcStats[i].pausesReceived = 0;
+      m_pfcStats[i].resumesReceived = 0;
+      m_pfcStats[i].maxHeadroom = 0;
+      m_pfcStats[i].headroomDrops = 0;
+    }
 }
 
 PointToPointNetDevice::~PointToPointNetDevice ()
@@ -226,6 +321,16 @@ PointToPointNetDevice::DoDispose ()
   m_currentPkt = 0;
   m_queue = 0;
   m_queueInterface = 0;
+  for (uint8_t i = 0; i < PFC_PRIORITIES; i++)
+    {
+      m_pfcRefreshEvent[i].Cancel ();
+      m_pfcResumeEvent[i].Cancel ();
+      m_pfcPausedPackets[i].clear ();
+    }
+  m_pfcNPausedPackets = 0;
+  m_pfcDeadlockEvent.Cancel ();
+  m_pfcFrames.clear ();
+  m_pfcIngress = 0;
   NetDevice::DoDispose ();
 }
 
@@ -255,11 +360,14 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   // schedule an event that will be executed when the transmission is complete.
   //
   NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
+  PfcIngress::Release (p, m_node);
   m_txMachineState = BUSY;
   m_currentPkt = p;
   m_phyTxBeginTrace (m_currentPkt);
+  NS_EVENT_LOG (EVENT_TX_START, p->GetUid (), p->GetSize ());
 
-  Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+  // A GSO super-segment is serialized as its segments sent back to back
+  Time txTime = m_bps.CalculateBytesTxTime (GsoTag::GetWireSize (p, PppHeader ().GetSerializedSize ()));
   Time txCompleteTime = txTime + m_tInterframeGap;
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
@@ -292,6 +400,13 @@ PointToPointNetDevice::TransmitComplete (void)
   m_phyTxEndTrace (m_currentPkt);
   m_currentPkt = 0;
 
+  if (m_pfcEnabled)
+    {
+      PfcTransmitNext ();
+      PfcUpdateTxQueue ();
+      return;
+    }
+
   Ptr<NetDeviceQueue> txq;
   if (m_queueInterface)
   {
@@ -370,9 +485,35 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
       // corrupted packet, don't forward this packet up, let it go.
       //
       m_phyRxDropTrace (packet);
+      NS_EVENT_LOG (EVENT_RX_DROP, packet->GetUid (), packet->GetSize ());
     }
   else 
     {
+      NS_EVENT_LOG (EVENT_RX_END, packet->GetUid (), packet->GetSize ());
+
+      if (m_pfcEnabled)
+        {
+          uint8_t buf[2];
+          packet->CopyData (buf, 2);
+          if (((buf[0] << 8) | buf[1]) == PFC_PROTOCOL)
+            {
+              // PFC frames are consumed by the device
+              m_snifferTrace (packet);
+              m_promiscSnifferTrace (packet);
+              m_phyRxEndTrace (packet);
+              PppHeader ppp;
+              packet->RemoveHeader (ppp);
+              PfcReceiveFrame (packet);
+              return;
+            }
+          if (!PfcAdmit (packet))
+            {
+              NS_LOG_LOGIC ("PFC headroom exhausted, packet dropped");
+              m_phyRxDropTrace (packet);
+              return;
+            }
+        }
+
       // 
       // Hit the trace hooks.  All of these hooks are in the same place in this 
       // device because it is so simple, but this is not usually the case in
@@ -573,6 +714,16 @@ PointToPointNetDevice::Send (
   //
   if (m_queue->Enqueue (Create<QueueItem> (packet)))
     {
+      if (m_pfcEnabled)
+        {
+          if (m_txMachineState == READY)
+            {
+              PfcTransmitNext ();
+              PfcUpdateTxQueue ();
+            }
+          return true;
+        }
+
       //
       // If the channel is ready for transition we send the packet right now
       // 
@@ -587,7 +738,9 @@ PointToPointNetDevice::Send (
     }
 
   // Enqueue may fail (overflow). Stop the tx queue, so that the upper layers
-  // do not send packets until there is room in the queue again.
+  // do not send packets until there is room in the queue again. The caller
+  // keeps the packet (a queue disc requeues it), so its PFC ingress count
+  // is released by whoever finally transmits or drops it.
   m_macTxDropTrace (packet);
   if (txq)
   {
@@ -685,6 +838,359 @@ PointToPointNetDevice::GetMtu (void) const
   return m_mtu;
 }
 
+PointToPointNetDevice::PfcStats
+PointToPointNetDevice::GetPfcStats (uint8_t priority) const
+{
+  NS_ASSERT (priority < PFC_PRIORITIES);
+  PfcStats stats = m_pfcStats[priority];
+  if (m_pfcPaused[priority])
+    {
+      stats.pausedTime += Simulator::Now () - m_pfcPausedSince[priority];
+    }
+  return stats;
+}
+
+uint32_t
+PointToPointNetDevice::GetPfcIngressBytes (uint8_t priority) const
+{
+  NS_ASSERT (priority < PFC_PRIORITIES);
+  return m_pfcIngressBytes[priority];
+}
+
+bool
+PointToPointNetDevice::IsPfcPaused (uint8_t priority) const
+{
+  NS_ASSERT (priority < PFC_PRIORITIES);
+  return m_pfcPaused[priority];
+}
+
+uint8_t
+PointToPointNetDevice::GetPfcPriority (Ptr<const Packet> p)
+{
+  uint8_t buf[4];
+  if (p->CopyData (buf, 4) < 4)
+    {
+      return 0;
+    }
+  switch ((buf[0] << 8) | buf[1])
+    {
+    case 0x0021:   // IPv4, class selector of the TOS
+      return buf[3] >> 5;
+    case 0x0057:   // IPv6, class selector of the traffic class
+      return (buf[2] & 0x0f) >> 1;
+    default:
+      return 0;
+    }
+}
+
+void
+PointToPointNetDevice::PfcTransmitNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_txMachineState == READY);
+
+  // PFC frames are not subject to pause and overtake the data packets
+  if (!m_pfcFrames.empty ())
+    {
+      Ptr<Packet> p = m_pfcFrames.front ();
+      m_pfcFrames.pop_front ();
+      m_snifferTrace (p);
+      m_promiscSnifferTrace (p);
+      TransmitStart (p);
+      return;
+    }
+
+  // The packets set aside arrived before those in the queue
+  int32_t oldest = -1;
+  for (uint8_t i = 0; i < PFC_PRIORITIES; i++)
+    {
+      if (!m_pfcPaused[i] && !m_pfcPausedPackets[i].empty ()
+          && (oldest < 0 || m_pfcPausedPackets[i].front ().first < m_pfcPausedPackets[oldest].front ().first))
+        {
+          oldest = i;
+        }
+    }
+
+  Ptr<Packet> p;
+  if (oldest >= 0)
+    {
+      p = m_pfcPausedPackets[oldest].front ().second;
+      m_pfcPausedPackets[oldest].pop_front ();
+      m_pfcNPausedPackets--;
+    }
+
+  // Set the packets of the paused priorities aside until one can be sent
+  bool holBlocked = m_pfcHolBlocked;
+  m_pfcHolBlocked = false;
+  Ptr<const QueueItem> head;
+  while (p == 0 && (head = m_queue->Peek ()) != 0)
+    {
+      uint8_t priority = GetPfcPriority (head->GetPacket ());
+      if (!m_pfcPaused[priority])
+        {
+          p = m_queue->Dequeue ()->GetPacket ();
+        }
+      else if (m_pfcNPausedPackets < m_pfcMaxPausedPackets)
+        {
+          NS_LOG_LOGIC ("Set aside a packet of the paused priority " << (uint32_t) priority);
+          m_pfcPausedPackets[priority].push_back (std::make_pair (m_pfcPausedSeq++, m_queue->Dequeue ()->GetPacket ()));
+          m_pfcNPausedPackets++;
+        }
+      else
+        {
+          NS_LOG_LOGIC ("Head of the queue paused on priority " << (uint32_t) priority);
+          if (!holBlocked)
+            {
+              m_pfcHolBlockingTrace (priority, m_queue->GetNPackets () - 1);
+            }
+          m_pfcHolBlocked = true;
+          break;
+        }
+    }
+
+  if (p == 0)
+    {
+      PfcSetBlocked (m_pfcNPausedPackets > 0 || m_pfcHolBlocked);
+      return;
+    }
+
+  PfcSetBlocked (false);
+  m_snifferTrace (p);
+  m_promiscSnifferTrace (p);
+  TransmitStart (p);
+}
+
+void
+PointToPointNetDevice::PfcSetBlocked (bool blocked)
+{
+  if (blocked == m_pfcBlocked)
+    {
+      return;
+    }
+  m_pfcBlocked = blocked;
+  m_pfcDeadlockEvent.Cancel ();
+  if (blocked)
+    {
+      m_pfcBlockedSince = Simulator::Now ();
+      if (m_pfcDeadlockThreshold.IsStrictlyPositive ())
+        {
+          m_pfcDeadlockEvent = Simulator::Schedule (m_pfcDeadlockThreshold,
+                                                    &PointToPointNetDevice::PfcCheckDeadlock,
+                                                    this, m_pfcBlockedSince);
+        }
+    }
+}
+
+void
+PointToPointNetDevice::PfcUpdateTxQueue (void)
+{
+  if (!m_queueInterface)
+    {
+      return;
+    }
+  Ptr<NetDeviceQueue> txq = m_queueInterface->GetTxQueue (0);
+  if (m_pfcHolBlocked)
+    {
+      // Keep the packets in the queue disc while the head is paused
+      txq->Stop ();
+    }
+  else if (m_txMachineState == READY)
+    {
+      // Nothing left to send, ask the upper layers for more
+      txq->Wake ();
+    }
+  else if (txq->IsStopped ())
+    {
+      txq->Start ();
+    }
+}
+
+Time
+PointToPointNetDevice::PfcQuantaToTime (uint16_t quanta) const
+{
+  // A quantum is 512 bit times
+  return m_bps.CalculateBytesTxTime (quanta * 64);
+}
+
+void
+PointToPointNetDevice::PfcSendFrame (uint8_t priority, uint16_t quanta)
+{
+  NS_LOG_FUNCTION (this << (uint32_t) priority << quanta);
+  if (!IsLinkUp ())
+    {
+      return;
+    }
+
+  Ptr<Packet> p = Create<Packet> (PFC_PADDING);
+  PfcHeader pfc;
+  pfc.SetQuanta (priority, quanta);
+  p->AddHeader (pfc);
+  PppHeader ppp;
+  ppp.SetProtocol (PFC_PROTOCOL);
+  p->AddHeader (ppp);
+
+  m_pfcRefreshEvent[priority].Cancel ();
+  if (quanta > 0)
+    {
+      m_pfcStats[priority].pausesSent++;
+      // Renew the pause before it expires at the peer
+      m_pfcRefreshEvent[priority] = Simulator::Schedule (PfcQuantaToTime (quanta) / 2,
+                                                         &PointToPointNetDevice::PfcRefresh,
+                                                         this, priority);
+    }
+  else
+    {
+      m_pfcStats[priority].resumesSent++;
+    }
+  m_pfcTxTrace (priority, quanta);
+
+  m_pfcFrames.push_back (p);
+  if (m_pfcEnabled && m_txMachineState == READY)
+    {
+      PfcTransmitNext ();
+      PfcUpdateTxQueue ();
+    }
+}
+
+void
+PointToPointNetDevice::PfcReceiveFrame (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+  PfcHeader pfc;
+  p->RemoveHeader (pfc);
+  for (uint8_t i = 0; i < PFC_PRIORITIES; i++)
+    {
+      if (!pfc.IsEnabled (i))
+        {
+          continue;
+        }
+      if (pfc.GetQuanta (i) == 0)
+        {
+          m_pfcStats[i].resumesReceived++;
+          PfcResume (i);
+        }
+      else
+        {
+          m_pfcStats[i].pausesReceived++;
+          PfcPause (i, PfcQuantaToTime (pfc.GetQuanta (i)));
+        }
+    }
+}
+
+void
+PointToPointNetDevice::PfcPause (uint8_t priority, Time duration)
+{
+  NS_LOG_FUNCTION (this << (uint32_t) priority << duration);
+  if (!m_pfcPaused[priority])
+    {
+      m_pfcPaused[priority] = true;
+      m_pfcPausedSince[priority] = Simulator::Now ();
+      m_pfcPauseTrace (priority);
+    }
+  m_pfcResumeEvent[priority].Cancel ();
+  m_pfcResumeEvent[priority] = Simulator::Schedule (duration, &PointToPointNetDevice::PfcResume,
+                                                    this, priority);
+}
+
+void
+PointToPointNetDevice::PfcResume (uint8_t priority)
+{
+  NS_LOG_FUNCTION (this << (uint32_t) priority);
+  m_pfcResumeEvent[priority].Cancel ();
+  if (!m_pfcPaused[priority])
+    {
+      return;
+    }
+  m_pfcPaused[priority] = false;
+  Time duration = Simulator::Now () - m_pfcPausedSince[priority];
+  m_pfcStats[priority].pausedTime += duration;
+  m_pfcResumeTrace (priority, duration);
+
+  if (m_txMachineState == READY)
+    {
+      PfcTransmitNext ();
+      PfcUpdateTxQueue ();
+    }
+}
+
+bool
+PointToPointNetDevice::PfcAdmit (Ptr<Packet> p)
+{
+  if (m_pfcXoff == 0)
+    {
+      return true;
+    }
+
+  // A packet still counted at another node left it through another kind of device
+  PfcIngress::Release (p, m_node);
+
+  uint8_t priority = GetPfcPriority (p);
+  uint32_t size = p->GetSize ();
+  if (m_pfcHeadroom > 0 && m_pfcIngressBytes[priority] + size > m_pfcXoff + m_pfcHeadroom)
+    {
+      m_pfcStats[priority].headroomDrops++;
+      return false;
+    }
+
+  if (m_pfcIngress == 0)
+    {
+      m_pfcIngress = CreateObject<PfcIngress> ();
+      m_pfcIngress->SetReleaseCallback (MakeCallback (&PointToPointNetDevice::PfcRelease, this));
+      AggregateObject (m_pfcIngress);
+    }
+  m_pfcIngressBytes[priority] += size;
+  PfcIngress::Count (p, this, priority, size);
+
+  if (m_pfcIngressBytes[priority] > m_pfcXoff)
+    {
+      m_pfcStats[priority].maxHeadroom = std::max (m_pfcStats[priority].maxHeadroom,
+                                                   m_pfcIngressBytes[priority] - m_pfcXoff);
+    }
+  if (m_pfcIngressBytes[priority] >= m_pfcXoff && !m_pfcPauseSent[priority])
+    {
+      NS_LOG_LOGIC ("XOFF reached on priority " << (uint32_t) priority);
+      m_pfcPauseSent[priority] = true;
+      PfcSendFrame (priority, m_pfcPauseQuanta);
+    }
+  return true;
+}
+
+void
+PointToPointNetDevice::PfcRelease (uint8_t priority, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << (uint32_t) priority << size);
+  NS_ASSERT_MSG (m_pfcIngressBytes[priority] >= size, "Releasing more PFC ingress bytes than counted");
+  m_pfcIngressBytes[priority] -= size;
+  if (m_pfcPauseSent[priority] && m_pfcIngressBytes[priority] <= m_pfcXon)
+    {
+      NS_LOG_LOGIC ("XON reached on priority " << (uint32_t) priority);
+      m_pfcPauseSent[priority] = false;
+      PfcSendFrame (priority, 0);
+    }
+}
+
+void
+PointToPointNetDevice::PfcRefresh (uint8_t priority)
+{
+  NS_LOG_FUNCTION (this << (uint32_t) priority);
+  if (m_pfcPauseSent[priority])
+    {
+      PfcSendFrame (priority, m_pfcPauseQuanta);
+    }
+}
+
+void
+PointToPointNetDevice::PfcCheckDeadlock (Time blockedSince)
+{
+  NS_LOG_FUNCTION (this << blockedSince);
+  if (m_pfcBlocked && m_pfcBlockedSince == blockedSince)
+    {
+      NS_LOG_WARN ("Transmission blocked by PFC since " << blockedSince.GetSeconds ()
+                   << "s, potential deadlock");
+      m_pfcDeadlockTrace (Simulator::Now () - blockedSince);
+    }
+}
+
 uint16_t
 PointToPointNetDevice::PppToEther (uint16_t proto)
 {
@@ -30,12 +30,16 @@
 #include "ns3/data-rate.h"
 #include "ns3/ptr.h"
 #include "ns3/mac48-address.h"
+#include "ns3/event-id.h"
+#include <deque>
+#include <utility>
 
 namespace ns3 {
 
 class Queue;
 class PointToPointChannel;
 class ErrorModel;
+class PfcIngress;
 
 /**
  * \defgroup point-to-point Point-To-Point Network Device
@@ -58,6 +62,39 @@ class ErrorModel;
  * Key parameters or objects that can be specified for this device 
  * include a queue, data rate, and interframe transmission gap (the 
  * propagation delay is set in the PointToPointChannel).
+ *
+ * \section pfc Priority-based flow control
+ *
+ * When PfcEnabled is set, the device implements IEEE 802.1Qbb PAUSE on
+ * eight priorities. The priority of a packet is the class selector of its
+ * IPv4 DSCP or IPv6 traffic class (the three most significant bits).
+ *
+ * On the receive side, the device counts per priority the bytes it has
+ * received and the node has not yet sent out (the ingress counter). When a
+ * counter reaches PfcXoff bytes a PAUSE frame is sent to the peer, and when
+ * it falls to PfcXon bytes a resume (zero quanta) frame is sent. The pause
+ * is refreshed while the counter stays above PfcXon. Packets arriving
+ * while the counter is PfcHeadroom bytes above PfcXoff are dropped. The
+ * counter of a packet is released by PfcIngress when the packet leaves the
+ * node: when it starts transmission on a point-to-point device of the node
+ * or is dropped by its device queue, when a queue disc, the shared buffer
+ * of the traffic control layer or the IP layer drops it, and when it is
+ * delivered locally. A packet which leaves through another kind of device
+ * is released when it reaches the next device with PFC.
+ *
+ * On the transmit side, PAUSE frames travel over the channel like any other
+ * frame and take precedence over the data packets. Only the paused
+ * priorities stop: the transmitter takes the packets of a paused priority
+ * out of the device queue and keeps them aside, per priority, so that the
+ * packets of the other priorities behind them are still sent. When the
+ * priority resumes, its packets set aside are sent first, in their order of
+ * arrival. Up to PfcMaxPausedPackets packets are kept aside; beyond that,
+ * a paused packet at the head of the device queue stops the transmission
+ * and the device transmission queue of the NetDeviceQueueInterface, which
+ * keeps the following packets in the queue disc (head-of-line blocking).
+ * The PfcHolBlocking trace reports these victims and the PfcDeadlock trace
+ * reports transmitters which have had packets waiting without being able
+ * to send any of them for longer than PfcDeadlockThreshold.
  */
 class PointToPointNetDevice : public NetDevice
 {
@@ -69,6 +106,69 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  /**
+   * Types of the records written to the event log by the
+   * "PointToPointNetDevice" component. The arguments of every record are
+   * the packet uid and the packet size.
+   */
+  enum EventLogType
+  {
+    EVENT_TX_START = 0,
+    EVENT_RX_END,
+    EVENT_RX_DROP
+  };
+
+  /// PPP protocol number of the PFC frames (the MAC control EtherType)
+  static const uint16_t PFC_PROTOCOL = 0x8808;
+
+  /// Number of PFC priorities
+  static const uint8_t PFC_PRIORITIES = 8;
+
+  /// Per-priority PFC statistics
+  struct PfcStats
+  {
+    uint32_t pausesSent;       //!< PAUSE frames sent to the peer
+    uint32_t resumesSent;      //!< Resume frames sent to the peer
+    uint32_t pausesReceived;   //!< PAUSE frames received from the peer
+    uint32_t resumesReceived;  //!< Resume frames received from the peer
+    Time pausedTime;           //!< Time the peer kept the priority paused
+    uint32_t maxHeadroom;      //!< Largest ingress occupancy above PfcXoff, in bytes
+    uint32_t headroomDrops;    //!< Packets dropped because the headroom was full
+  };
+
+  /**
+   * TracedCallback signature for PFC frames sent
+   * \param [in] priority the priority
+   * \param [in] quanta the pause time, 0 for a resume frame
+   */
+  typedef void (* PfcTxTracedCallback)(uint8_t priority, uint16_t quanta);
+
+  /**
+   * TracedCallback signature for the start of a pause
+   * \param [in] priority the priority
+   */
+  typedef void (* PfcPauseTracedCallback)(uint8_t priority);
+
+  /**
+   * TracedCallback signature for the end of a pause
+   * \param [in] priority the priority
+   * \param [in] duration how long the priority was paused
+   */
+  typedef void (* PfcResumeTracedCallback)(uint8_t priority, Time duration);
+
+  /**
+   * TracedCallback signature for head-of-line blocking
+   * \param [in] priority the paused priority at the head of the queue
+   * \param [in] victims the packets queued behind it
+   */
+  typedef void (* PfcHolBlockingTracedCallback)(uint8_t priority, uint32_t victims);
+
+  /**
+   * TracedCallback signature for potential deadlocks
+   * \param [in] duration how long the transmission has been blocked
+   */
+  typedef void (* PfcDeadlockTracedCallback)(Time duration);
+
   /**
    * Construct a PointToPointNetDevice
    *
@@ -149,6 +249,24 @@ public:
    */
   void Receive (Ptr<Packet> p);
 
+  /**
+   * \param priority the priority
+   * \return the PFC statistics of the priority
+   */
+  PfcStats GetPfcStats (uint8_t priority) const;
+
+  /**
+   * \param priority the priority
+   * \return the bytes counted against the PFC thresholds of the priority
+   */
+  uint32_t GetPfcIngressBytes (uint8_t priority) const;
+
+  /**
+   * \param priority the priority
+   * \return true if the peer has paused the priority
+   */
+  bool IsPfcPaused (uint8_t priority) const;
+
   // The remaining methods are documented in ns3::NetDevice*
 
   virtual void SetIfIndex (const uint32_t index);
@@ -277,6 +395,90 @@ private:
    */
   void TransmitComplete (void);
 
+  /**
+   * \param p a packet with its PPP header
+   * \return the PFC priority of the packet
+   */
+  static uint8_t GetPfcPriority (Ptr<const Packet> p);
+
+  /**
+   * Start the transmission of the pending PFC frame, or else of the oldest
+   * packet whose priority is not paused. The packets of the paused
+   * priorities met at the head of the queue are set aside on the way.
+   */
+  void PfcTransmitNext (void);
+
+  /**
+   * Stop, start or wake the device transmission queue according to the
+   * transmitter state.
+   */
+  void PfcUpdateTxQueue (void);
+
+  /**
+   * Record whether packets are waiting while none of them can be sent, and
+   * schedule the deadlock detection when the transmitter starts waiting.
+   * \param blocked whether the transmitter is blocked
+   */
+  void PfcSetBlocked (bool blocked);
+
+  /**
+   * Send a PFC frame to the peer
+   * \param priority the priority
+   * \param quanta the pause time, 0 to resume
+   */
+  void PfcSendFrame (uint8_t priority, uint16_t quanta);
+
+  /**
+   * Handle a PFC frame received from the peer
+   * \param p the frame, without its PPP header
+   */
+  void PfcReceiveFrame (Ptr<Packet> p);
+
+  /**
+   * Stop transmitting a priority
+   * \param priority the priority
+   * \param duration the pause time
+   */
+  void PfcPause (uint8_t priority, Time duration);
+
+  /**
+   * Resume transmitting a priority
+   * \param priority the priority
+   */
+  void PfcResume (uint8_t priority);
+
+  /**
+   * Count a received packet against the ingress thresholds
+   * \param p the packet, with its PPP header
+   * \return false if the packet must be dropped
+   */
+  bool PfcAdmit (Ptr<Packet> p);
+
+  /**
+   * Release bytes of the ingress counter of a priority
+   * \param priority the priority
+   * \param size the number of bytes
+   */
+  void PfcRelease (uint8_t priority, uint32_t size);
+
+  /**
+   * Renew the pause of a priority if its ingress counter is still above XON
+   * \param priority the priority
+   */
+  void PfcRefresh (uint8_t priority);
+
+  /**
+   * \param quanta a pause time in quanta
+   * \return the pause time at the rate of the device
+   */
+  Time PfcQuantaToTime (uint16_t quanta) const;
+
+  /**
+   * Report transmissions blocked since blockedSince
+   * \param blockedSince the start of the blocking
+   */
+  void PfcCheckDeadlock (Time blockedSince);
+
   /**
    * \brief Make the link up and running
    *
@@ -460,6 +662,39 @@ private:
 
   Ptr<Packet> m_currentPkt; //!< Current packet processed
 
+  bool m_pfcEnabled;                 //!< Whether PFC is enabled
+  uint32_t m_pfcXoff;                //!< Ingress bytes triggering a PAUSE, 0 to never pause the peer
+  uint32_t m_pfcXon;                 //!< Ingress bytes triggering a resume
+  uint32_t m_pfcHeadroom;            //!< Ingress bytes accepted above XOFF, 0 for no limit
+  uint16_t m_pfcPauseQuanta;         //!< Pause time of the PAUSE frames
+  Time m_pfcDeadlockThreshold;       //!< Blocking time reported as a potential deadlock
+  uint32_t m_pfcMaxPausedPackets;    //!< Packets of paused priorities set aside at most
+
+  uint32_t m_pfcIngressBytes[PFC_PRIORITIES];  //!< Ingress counters
+  bool m_pfcPauseSent[PFC_PRIORITIES];         //!< Whether the peer is paused
+  EventId m_pfcRefreshEvent[PFC_PRIORITIES];   //!< Pause renewal
+  bool m_pfcPaused[PFC_PRIORITIES];            //!< Whether the peer paused us
+  Time m_pfcPausedSince[PFC_PRIORITIES];       //!< Start of the current pause
+  EventId m_pfcResumeEvent[PFC_PRIORITIES];    //!< Pause expiration
+  PfcStats m_pfcStats[PFC_PRIORITIES];         //!< Statistics
+  std::deque<Ptr<Packet> > m_pfcFrames;        //!< PFC frames waiting for the transmitter
+  /// Packets of a priority set aside, with their order of arrival
+  typedef std::deque<std::pair<uint64_t, Ptr<Packet> > > PfcPausedPackets;
+  PfcPausedPackets m_pfcPausedPackets[PFC_PRIORITIES]; //!< Packets set aside per priority
+  uint32_t m_pfcNPausedPackets;                //!< Number of packets set aside
+  uint64_t m_pfcPausedSeq;                     //!< Order of arrival of the next packet set aside
+  bool m_pfcHolBlocked;                        //!< Whether a paused head blocks the queue
+  bool m_pfcBlocked;                           //!< Whether packets wait but none can be sent
+  Time m_pfcBlockedSince;                      //!< Start of the blocking
+  EventId m_pfcDeadlockEvent;                  //!< Deadlock detection
+  Ptr<PfcIngress> m_pfcIngress;                //!< Release of the ingress counters
+
+  TracedCallback<uint8_t, uint16_t> m_pfcTxTrace;          //!< PFC frames sent
+  TracedCallback<uint8_t> m_pfcPauseTrace;                 //!< Priority paused by the peer
+  TracedCallback<uint8_t, Time> m_pfcResumeTrace;          //!< Priority resumed
+  TracedCallback<uint8_t, uint32_t> m_pfcHolBlockingTrace; //!< Transmission blocked by the head
+  TracedCallback<Time> m_pfcDeadlockTrace;                 //!< Blocked for longer than the threshold
+
   /**
    * \brief PPP to Ethernet protocol number mapping
    * \param protocol A PPP protocol number
@@ -23,6 +23,12 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/pfc-ingress.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/data-rate.h"
+#include <cstring>
 
 using namespace ns3;
 
@@ -98,6 +104,289 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test of the priority-based flow control
+ *
+ * A sends 20 packets of 1000 bytes to B, which never forwards them. B
+ * pauses A once XOFF is reached, A stops transmitting until B releases the
+ * packets and resumes it, then A sends the rest. A second run with a long
+ * link and a small headroom checks that B drops the packets in excess. A
+ * third run checks that packets of priority 1 pass those of the paused
+ * priority 0.
+ */
+class PointToPointPfcTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointPfcTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Build the link and send the packets
+   * \param delay the delay of the channel
+   * \param headroom the headroom of B
+   * \param mixed whether the last half of the packets has priority 1
+   */
+  void Setup (Time delay, uint32_t headroom, bool mixed);
+  /**
+   * \brief Store a packet received by B
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol
+   * \param from the sender
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+  /**
+   * \brief Release the packets received by B, and the next ones as they arrive
+   */
+  void Release (void);
+  /**
+   * \brief Count the deadlock reports of A
+   * \param duration the blocking time
+   */
+  void Deadlock (Time duration);
+
+  Ptr<PointToPointNetDevice> m_devA;        //!< The sender
+  Ptr<PointToPointNetDevice> m_devB;        //!< The receiver
+  std::vector<Ptr<Packet> > m_received;     //!< Packets received by B
+  uint32_t m_nReceived;                     //!< Number of packets received by B
+  uint32_t m_nDeadlocks;                    //!< Number of deadlock reports
+  bool m_forward;                           //!< Whether B releases the packets it receives
+};
+
+PointToPointPfcTest::PointToPointPfcTest ()
+  : TestCase ("PointToPoint PFC"),
+    m_nReceived (0),
+    m_nDeadlocks (0),
+    m_forward (false)
+{
+}
+
+bool
+PointToPointPfcTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_received.push_back (p->Copy ());
+  m_nReceived++;
+  if (m_forward)
+    {
+      Release ();
+    }
+  return true;
+}
+
+void
+PointToPointPfcTest::Release (void)
+{
+  for (uint32_t i = 0; i < m_received.size (); i++)
+    {
+      PfcIngress::Release (m_received[i], m_devB->GetNode ());
+    }
+  m_received.clear ();
+  m_forward = true;
+}
+
+void
+PointToPointPfcTest::Deadlock (Time duration)
+{
+  m_nDeadlocks++;
+}
+
+void
+PointToPointPfcTest::Setup (Time delay, uint32_t headroom, bool mixed)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  m_devA = CreateObject<PointToPointNetDevice> ();
+  m_devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (delay));
+
+  Ptr<PointToPointNetDevice> devs[2] = { m_devA, m_devB };
+  Ptr<Node> nodes[2] = { a, b };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      devs[i]->SetAttribute ("DataRate", DataRateValue (DataRate ("8Mbps")));
+      devs[i]->SetAttribute ("PfcEnabled", BooleanValue (true));
+      devs[i]->Attach (channel);
+      devs[i]->SetAddress (Mac48Address::Allocate ());
+      devs[i]->SetQueue (CreateObject<DropTailQueue> ());
+      nodes[i]->AddDevice (devs[i]);
+    }
+  m_devB->SetAttribute ("PfcXoff", UintegerValue (3000));
+  m_devB->SetAttribute ("PfcXon", UintegerValue (1000));
+  m_devB->SetAttribute ("PfcHeadroom", UintegerValue (headroom));
+  m_devB->SetReceiveCallback (MakeCallback (&PointToPointPfcTest::Receive, this));
+  m_devA->SetAttribute ("PfcDeadlockThreshold", TimeValue (MilliSeconds (500)));
+  m_devA->TraceConnectWithoutContext ("PfcDeadlock", MakeCallback (&PointToPointPfcTest::Deadlock, this));
+
+  // The PFC priority is the class selector of the TOS of the IPv4 header
+  uint8_t payload[1000];
+  std::memset (payload, 0, sizeof (payload));
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      payload[1] = (mixed && i >= 10) ? 0x20 : 0;
+      m_devA->Send (Create<Packet> (payload, sizeof (payload)), m_devA->GetBroadcast (), 0x800);
+    }
+}
+
+void
+PointToPointPfcTest::DoRun (void)
+{
+  // Lossless: 1 ms per packet, B pauses A after the third packet
+  Setup (MicroSeconds (10), 0, false);
+  Simulator::Schedule (Seconds (1), &PointToPointPfcTest::Release, this);
+  Simulator::Stop (Seconds (0.5));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_nReceived, 4, "A should stop after the packet in transmission when the PAUSE arrived");
+  NS_TEST_EXPECT_MSG_EQ (m_devA->IsPfcPaused (0), true, "A should be paused");
+  NS_TEST_EXPECT_MSG_EQ (m_devB->GetPfcIngressBytes (0), 4 * 1002, "B should count the received bytes");
+
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_nReceived, 20, "A should resume after B released the packets");
+  NS_TEST_EXPECT_MSG_EQ (m_devA->IsPfcPaused (0), false, "A should not be paused anymore");
+  NS_TEST_EXPECT_MSG_EQ (m_nDeadlocks, 1, "A was blocked for more than the deadlock threshold");
+  PointToPointNetDevice::PfcStats statsA = m_devA->GetPfcStats (0);
+  PointToPointNetDevice::PfcStats statsB = m_devB->GetPfcStats (0);
+  NS_TEST_EXPECT_MSG_EQ (statsB.pausesSent, 1, "B should have sent one PAUSE before the resume");
+  NS_TEST_EXPECT_MSG_EQ (statsB.resumesSent, 1, "B should have resumed A once");
+  NS_TEST_EXPECT_MSG_EQ (statsA.pausesReceived, 1, "A should have received the PAUSE");
+  NS_TEST_EXPECT_MSG_EQ (statsA.resumesReceived, 1, "A should have received the resume");
+  NS_TEST_EXPECT_MSG_EQ ((statsA.pausedTime > Seconds (0.99)), true, "A was paused until B released the packets");
+  NS_TEST_EXPECT_MSG_EQ (statsB.maxHeadroom, 4 * 1002 - 3000, "Wrong headroom usage");
+  Simulator::Destroy ();
+
+  // Lossy: 5 packets are in flight when B pauses A, there is room for 2 of them
+  m_nReceived = 0;
+  m_received.clear ();
+  m_forward = false;
+  Setup (MilliSeconds (2), 2100, false);
+  Simulator::Stop (Seconds (0.5));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_devB->GetPfcStats (0).headroomDrops, 3, "B should drop the packets beyond the headroom");
+  NS_TEST_EXPECT_MSG_EQ (m_nReceived, 5, "B should accept XOFF plus headroom bytes");
+  Simulator::Destroy ();
+
+  // Mixed: the packets of priority 1 pass those of the paused priority 0,
+  // until B pauses priority 1 too
+  m_nReceived = 0;
+  m_nDeadlocks = 0;
+  m_received.clear ();
+  m_forward = false;
+  Setup (MicroSeconds (10), 0, true);
+  Simulator::Schedule (Seconds (1), &PointToPointPfcTest::Release, this);
+  Simulator::Stop (Seconds (0.5));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_nReceived, 8, "A should send priority 1 while priority 0 is paused");
+  NS_TEST_EXPECT_MSG_EQ (m_devB->GetPfcIngressBytes (0), 4 * 1002, "B should count the bytes of priority 0");
+  NS_TEST_EXPECT_MSG_EQ (m_devB->GetPfcIngressBytes (1), 4 * 1002, "B should count the bytes of priority 1");
+  NS_TEST_EXPECT_MSG_EQ (m_devA->IsPfcPaused (0), true, "Priority 0 should be paused");
+  NS_TEST_EXPECT_MSG_EQ (m_devA->IsPfcPaused (1), true, "Priority 1 should be paused");
+
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_nReceived, 20, "A should resume both priorities");
+  NS_TEST_EXPECT_MSG_EQ (m_nDeadlocks, 1, "A was blocked for more than the deadlock threshold");
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Test of the PFC ingress release when the device queue is full
+ *
+ * A packet counted by an ingress device is sent to a full device queue.
+ * The caller keeps the packet, as a queue disc requeues it, so its count
+ * is only released when it is finally transmitted.
+ */
+class PointToPointPfcRequeueTest : public TestCase
+{
+public:
+  PointToPointPfcRequeueTest ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Release callback of the ingress device
+   * \param priority the priority
+   * \param size the bytes released
+   */
+  void Release (uint8_t priority, uint32_t size);
+
+  uint32_t m_released;          //!< Bytes released
+  uint32_t m_nReleases;         //!< Number of releases
+};
+
+PointToPointPfcRequeueTest::PointToPointPfcRequeueTest ()
+  : TestCase ("Check the PFC ingress release of the packets the device queue rejects"),
+    m_released (0),
+    m_nReleases (0)
+{
+}
+
+void
+PointToPointPfcRequeueTest::Release (uint8_t priority, uint32_t size)
+{
+  m_released += size;
+  m_nReleases++;
+}
+
+void
+PointToPointPfcRequeueTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  Ptr<DropTailQueue> queue = CreateObject<DropTailQueue> ();
+  queue->SetAttribute ("MaxPackets", UintegerValue (1));
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (queue);
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue> ());
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+
+  // the device the packet came in through
+  Ptr<SimpleNetDevice> ingressDevice = CreateObject<SimpleNetDevice> ();
+  a->AddDevice (ingressDevice);
+  Ptr<PfcIngress> ingress = CreateObject<PfcIngress> ();
+  ingress->SetReleaseCallback (MakeCallback (&PointToPointPfcRequeueTest::Release, this));
+  ingressDevice->AggregateObject (ingress);
+
+  // one packet in transmission, one in the queue
+  devA->Send (Create<Packet> (1000), devA->GetBroadcast (), 0x800);
+  devA->Send (Create<Packet> (1000), devA->GetBroadcast (), 0x800);
+
+  Ptr<Packet> p = Create<Packet> (1000);
+  PfcIngress::Count (p, ingressDevice, 0, 1000);
+  // a queue disc sends a copy and requeues the packet when the send fails
+  NS_TEST_EXPECT_MSG_EQ (devA->Send (p->Copy (), devA->GetBroadcast (), 0x800), false,
+                         "The device queue should be full");
+  NS_TEST_EXPECT_MSG_EQ (m_released, 0, "The packet kept by the caller should still be counted");
+
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (devA->Send (p->Copy (), devA->GetBroadcast (), 0x800), true,
+                         "The device should be idle");
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_released, 1000, "The packet should be released when it is transmitted");
+  NS_TEST_EXPECT_MSG_EQ (m_nReleases, 1, "The packet should be released once");
+  Simulator::Destroy ();
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -114,6 +403,8 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointPfcTest, TestCase::QUICK);
+  AddTestCase (new PointToPointPfcRequeueTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
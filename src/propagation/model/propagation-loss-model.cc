@@ -93,6 +93,32 @@ PropagationLossModel::AssignStreams (int64_t stream)
   return (currentStream - stream);
 }
 
+double
+PropagationLossModel::GetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  double range = DoGetMaxRange (txPowerDbm, rxPowerDbm);
+  if (range < 0)
+    {
+      return -1;
+    }
+  if (m_next != 0)
+    {
+      double next = m_next->GetMaxRange (txPowerDbm, rxPowerDbm);
+      if (next < 0)
+        {
+          return -1;
+        }
+      range = std::min (range, next);
+    }
+  return range;
+}
+
+double
+PropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  return -1;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (RandomPropagationLossModel);
@@ -275,6 +301,18 @@ FriisPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+FriisPropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  double margin = txPowerDbm - rxPowerDbm;
+  if (m_minLoss > margin)
+    {
+      return 0;
+    }
+  // the loss is 20 log10 (4 * pi * d / lambda) + 10 log10 (L)
+  return m_lambda / (4 * M_PI * std::sqrt (m_systemLoss)) * std::pow (10.0, margin / 20);
+}
+
 // ------------------------------------------------------------------------- //
 // -- Two-Ray Ground Model ported from NS-2 -- tomhewer@mac.com -- Nov09 //
 
@@ -448,6 +486,16 @@ TwoRayGroundPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+TwoRayGroundPropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  // Beyond the crossover distance the two-ray loss is larger than the
+  // Friis loss, so the Friis range holds whatever the antenna heights.
+  double range = m_lambda / (4 * M_PI * std::sqrt (m_systemLoss))
+    * std::pow (10.0, (txPowerDbm - rxPowerDbm) / 20);
+  return std::max (range, m_minDistance);
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (LogDistancePropagationLossModel);
@@ -537,6 +585,18 @@ LogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+LogDistancePropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  if (m_exponent <= 0)
+    {
+      return -1;
+    }
+  double range = m_referenceDistance
+    * std::pow (10.0, (txPowerDbm - rxPowerDbm - m_referenceLoss) / (10 * m_exponent));
+  return std::max (range, m_referenceDistance);
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (ThreeLogDistancePropagationLossModel);
@@ -638,6 +698,32 @@ ThreeLogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+ThreeLogDistancePropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  if (m_exponent0 <= 0 || m_exponent1 <= 0 || m_exponent2 <= 0)
+    {
+      return -1;
+    }
+  double margin = txPowerDbm - rxPowerDbm;
+  double loss0 = m_referenceLoss;
+  double loss1 = loss0 + 10 * m_exponent0 * std::log10 (m_distance1 / m_distance0);
+  double loss2 = loss1 + 10 * m_exponent1 * std::log10 (m_distance2 / m_distance1);
+  if (margin < loss0)
+    {
+      return m_distance0;
+    }
+  else if (margin < loss1)
+    {
+      return m_distance0 * std::pow (10.0, (margin - loss0) / (10 * m_exponent0));
+    }
+  else if (margin < loss2)
+    {
+      return m_distance1 * std::pow (10.0, (margin - loss1) / (10 * m_exponent1));
+    }
+  return m_distance2 * std::pow (10.0, (margin - loss2) / (10 * m_exponent2));
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (NakagamiPropagationLossModel);
@@ -925,6 +1011,12 @@ RangePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+RangePropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  return m_range;
+}
+
 // ------------------------------------------------------------------------- //
 
 } // namespace ns3
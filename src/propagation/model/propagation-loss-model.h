@@ -106,6 +106,23 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * Returns the distance beyond which the chain of PropagationLossModel(s)
+   * starting at the current one always returns a reception power lower
+   * than a threshold. The channels use it to skip the receivers out of
+   * range without computing their reception power.
+   *
+   * The range of a chain is the smallest range of its models, which
+   * assumes that none of them adds a gain to the signal. It is unknown
+   * as soon as one of the models of the chain does not know its range,
+   * like the models with random fading.
+   *
+   * \param txPowerDbm transmission power (in dBm)
+   * \param rxPowerDbm reception power threshold (in dBm)
+   * \returns the range (in meters), or a negative value if it is unknown
+   */
+  double GetMaxRange (double txPowerDbm, double rxPowerDbm) const;
+
 private:
   /**
    * \brief Copy constructor
@@ -140,6 +157,16 @@ private:
    */
   virtual int64_t DoAssignStreams (int64_t stream) = 0;
 
+  /**
+   * Returns the range of this particular PropagationLossModel. The default
+   * implementation returns -1: the range is unknown.
+   *
+   * \param txPowerDbm transmission power (in dBm)
+   * \param rxPowerDbm reception power threshold (in dBm)
+   * \returns the range (in meters), or a negative value if it is unknown
+   */
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
+
   Ptr<PropagationLossModel> m_next; //!< Next propagation loss model in the list
 };
 
@@ -322,6 +349,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -442,6 +470,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -530,6 +559,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 
   /**
    *  Creates a default reference loss model
@@ -613,6 +643,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 
   double m_distance0; //!< Beginning of the first (near) distance field
   double m_distance1; //!< Beginning of the second (middle) distance field.
@@ -852,6 +883,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 private:
   double m_range; //!< Maximum Transmission Range (meters)
 };
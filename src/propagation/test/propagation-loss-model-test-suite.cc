@@ -436,6 +436,77 @@ RangePropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class MaxRangePropagationLossModelTestCase : public TestCase
+{
+public:
+  MaxRangePropagationLossModelTestCase ();
+  virtual ~MaxRangePropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check that the reception power crosses the threshold at the range
+   * \param lossModel the loss model
+   * \param txPowerDbm the transmission power
+   * \param rxPowerDbm the reception power threshold
+   */
+  void CheckRange (Ptr<PropagationLossModel> lossModel, double txPowerDbm, double rxPowerDbm);
+};
+
+MaxRangePropagationLossModelTestCase::MaxRangePropagationLossModelTestCase ()
+  : TestCase ("Test the range of the PropagationLossModels")
+{
+}
+
+MaxRangePropagationLossModelTestCase::~MaxRangePropagationLossModelTestCase ()
+{
+}
+
+void
+MaxRangePropagationLossModelTestCase::CheckRange (Ptr<PropagationLossModel> lossModel, double txPowerDbm, double rxPowerDbm)
+{
+  double range = lossModel->GetMaxRange (txPowerDbm, rxPowerDbm);
+  NS_TEST_ASSERT_MSG_GT (range, 0, "The range of " << lossModel->GetInstanceTypeId ().GetName () << " should be known");
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0,0,0));
+  Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  b->SetPosition (Vector (range * 0.99,0,0));
+  NS_TEST_EXPECT_MSG_GT (lossModel->CalcRxPower (txPowerDbm, a, b), rxPowerDbm,
+                         "The signal should be heard within the range of " << lossModel->GetInstanceTypeId ().GetName ());
+  b->SetPosition (Vector (range * 1.01,0,0));
+  NS_TEST_EXPECT_MSG_LT (lossModel->CalcRxPower (txPowerDbm, a, b), rxPowerDbm,
+                         "The signal should not be heard beyond the range of " << lossModel->GetInstanceTypeId ().GetName ());
+}
+
+void
+MaxRangePropagationLossModelTestCase::DoRun (void)
+{
+  CheckRange (CreateObject<FriisPropagationLossModel> (), 16.0206, -96);
+  // within the crossover distance, where the two-ray ground model is Friis
+  Ptr<TwoRayGroundPropagationLossModel> twoRay = CreateObject<TwoRayGroundPropagationLossModel> ();
+  twoRay->SetHeightAboveZ (1.5);
+  CheckRange (twoRay, 16.0206, -64);
+  CheckRange (CreateObject<LogDistancePropagationLossModel> (), 16.0206, -96);
+  Ptr<ThreeLogDistancePropagationLossModel> threeLog = CreateObject<ThreeLogDistancePropagationLossModel> ();
+  CheckRange (threeLog, 16.0206, -60);
+  CheckRange (threeLog, 16.0206, -96);
+  CheckRange (threeLog, 16.0206, -110);
+  Ptr<RangePropagationLossModel> range = CreateObject<RangePropagationLossModel> ();
+  range->SetAttribute ("MaxRange", DoubleValue (100));
+  CheckRange (range, 16.0206, -96);
+
+  // The range of a chain is the smallest range of its models
+  Ptr<LogDistancePropagationLossModel> logDistance = CreateObject<LogDistancePropagationLossModel> ();
+  logDistance->SetNext (range);
+  NS_TEST_EXPECT_MSG_EQ_TOL (logDistance->GetMaxRange (16.0206, -96), 100, 1e-9, "The range model should bound the chain");
+  CheckRange (logDistance, 16.0206, -60);
+
+  // and is unknown as soon as one of its models does not know its range
+  range->SetNext (CreateObject<NakagamiPropagationLossModel> ());
+  NS_TEST_EXPECT_MSG_LT (logDistance->GetMaxRange (16.0206, -96), 0, "The range of a fading model is unknown");
+  Simulator::Destroy ();
+}
+
 class PropagationLossModelsTestSuite : public TestSuite
 {
 public:
@@ -450,6 +521,7 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new MatrixPropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new RangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new MaxRangePropagationLossModelTestCase, TestCase::QUICK);
 }
 
 static PropagationLossModelsTestSuite propagationLossModelsTestSuite;
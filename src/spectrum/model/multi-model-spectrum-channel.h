@@ -27,6 +27,7 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
+#include <ns3/mobility-grid.h>
 #include <map>
 #include <set>
 
@@ -102,6 +103,15 @@ typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap
  * for this to work is that, after the SpectrumPhy switched its
  * SpectrumModel,  MultiModelSpectrumChannel::AddRx () is
  * called again passing the pointer to that SpectrumPhy.
+ *
+ * With the ReceiverCulling attribute, the channel keeps the receivers
+ * in a ns3::MobilityGrid and only considers those within the range of
+ * the signal: the MaxRange attribute if set, else the distance beyond
+ * which the PropagationLossModel gives a loss above MaxLossDb, assuming
+ * the antennas add no gain. The receivers out of range are skipped as
+ * if their loss was above MaxLossDb, except that no PathLoss trace is
+ * fired for them. The receivers are not culled when the range is
+ * unknown or when some of them have no mobility model.
  */
 class MultiModelSpectrumChannel : public SpectrumChannel
 {
@@ -158,6 +168,25 @@ private:
    */
   virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
 
+  /**
+   * Apply the losses between the transmitter and a receiver and schedule
+   * the reception of the signal after the propagation delay.
+   *
+   * @param txParams The signal parameters of the transmitter.
+   * @param convertedTxPowerSpectrum The transmitted PSD in the RX SpectrumModel.
+   * @param txMobility The mobility model of the transmitter.
+   * @param receiver A pointer to the receiver SpectrumPhy.
+   */
+  void PropagateSignal (Ptr<SpectrumSignalParameters> txParams, Ptr<SpectrumValue> convertedTxPowerSpectrum,
+                        Ptr<MobilityModel> txMobility, Ptr<SpectrumPhy> receiver);
+
+  /**
+   * @param txMobility The mobility model of the transmitter.
+   * @return the distance beyond which no receiver gets the signal, or a
+   * negative value if the receivers are not culled
+   */
+  double GetCullingRange (Ptr<MobilityModel> txMobility);
+
   /**
    * Propagation delay model to be used with this channel.
    */
@@ -207,6 +236,43 @@ private:
    * in a future release.
    */
   TracedCallback<Ptr<SpectrumPhy>, Ptr<SpectrumPhy>, double > m_pathLossTrace;
+
+  /**
+   * Whether only the receivers within range get the signals.
+   */
+  bool m_culling;
+
+  /**
+   * Range of the signals [m] when the receivers are culled, or 0 to
+   * derive it from the PropagationLossModel and m_maxLossDb.
+   */
+  double m_maxRange;
+
+  /**
+   * Positions of the receivers, indexed by RX SpectrumModel then in the
+   * order of their m_rxPhySet.
+   */
+  MobilityGrid m_grid;
+
+  /**
+   * Receivers by grid index.
+   */
+  std::vector<Ptr<SpectrumPhy> > m_gridPhys;
+
+  /**
+   * RX SpectrumModel of the receivers by grid index.
+   */
+  std::vector<SpectrumModelUid_t> m_gridModels;
+
+  /**
+   * Whether receivers were added since the grid was filled.
+   */
+  bool m_gridDirty;
+
+  /**
+   * Whether all the receivers have a mobility model, so that they can be culled.
+   */
+  bool m_gridValid;
 };
 
 
@@ -22,6 +22,7 @@
 #include <ns3/spectrum-value.h>
 #include <ns3/math.h>
 #include <ns3/log.h>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -41,13 +42,15 @@ SpectrumValue::SpectrumValue (Ptr<const SpectrumModel> sof)
 double&
 SpectrumValue::operator[] (size_t index)
 {
-  return m_values.at (index);
+  NS_ASSERT (index < m_values.size ());
+  return m_values[index];
 }
 
 const double&
 SpectrumValue::operator[] (size_t index) const
 {
-  return m_values.at (index);
+  NS_ASSERT (index < m_values.size ());
+  return m_values[index];
 }
 
 
@@ -90,6 +93,18 @@ SpectrumValue::ValuesEnd ()
   return m_values.end ();
 }
 
+double *
+SpectrumValue::GetData ()
+{
+  return m_values.empty () ? 0 : &m_values[0];
+}
+
+const double *
+SpectrumValue::GetData () const
+{
+  return m_values.empty () ? 0 : &m_values[0];
+}
+
 Bands::const_iterator
 SpectrumValue::ConstBandsBegin () const
 {
@@ -106,30 +121,62 @@ SpectrumValue::ConstBandsEnd () const
 void
 SpectrumValue::Add (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
+  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+
+  double *a = GetData ();
+  const double *b = x.GetData ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; ++i)
+    {
+      a[i] += b[i];
+    }
+}
+
 
+void
+SpectrumValue::AddScaled (const SpectrumValue& x, double s)
+{
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  double *a = GetData ();
+  const double *b = x.GetData ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 += *it2;
-      ++it1;
-      ++it2;
+      a[i] += s * b[i];
     }
 }
 
 
 void
-SpectrumValue::Add (double s)
+SpectrumValue::MultiplyAdd (const SpectrumValue& x, const SpectrumValue& y)
 {
-  Values::iterator it1 = m_values.begin ();
+  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_spectrumModel == y.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  NS_ASSERT (m_values.size () == y.m_values.size ());
+
+  double *a = GetData ();
+  const double *b = x.GetData ();
+  const double *c = y.GetData ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; ++i)
+    {
+      a[i] += b[i] * c[i];
+    }
+}
 
-  while (it1 != m_values.end ())
+
+void
+SpectrumValue::Add (double s)
+{
+  double *a = GetData ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; ++i)
     {
-      *it1 += s;
-      ++it1;
+      a[i] += s;
     }
 }
 
@@ -138,17 +185,15 @@ SpectrumValue::Add (double s)
 void
 SpectrumValue::Subtract (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  double *a = GetData ();
+  const double *b = x.GetData ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 -= *it2;
-      ++it1;
-      ++it2;
+      a[i] -= b[i];
     }
 }
 
@@ -164,17 +209,15 @@ SpectrumValue::Subtract (double s)
 void
 SpectrumValue::Multiply (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  double *a = GetData ();
+  const double *b = x.GetData ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 *= *it2;
-      ++it1;
-      ++it2;
+      a[i] *= b[i];
     }
 }
 
@@ -182,12 +225,11 @@ SpectrumValue::Multiply (const SpectrumValue& x)
 void
 SpectrumValue::Multiply (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *a = GetData ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; ++i)
     {
-      *it1 *= s;
-      ++it1;
+      a[i] *= s;
     }
 }
 
@@ -197,17 +239,15 @@ SpectrumValue::Multiply (double s)
 void
 SpectrumValue::Divide (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  double *a = GetData ();
+  const double *b = x.GetData ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 /= *it2;
-      ++it1;
-      ++it2;
+      a[i] /= b[i];
     }
 }
 
@@ -216,12 +256,11 @@ void
 SpectrumValue::Divide (double s)
 {
   NS_LOG_FUNCTION (this << s);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *a = GetData ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; ++i)
     {
-      *it1 /= s;
-      ++it1;
+      a[i] /= s;
     }
 }
 
@@ -231,12 +270,11 @@ SpectrumValue::Divide (double s)
 void
 SpectrumValue::ChangeSign ()
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *a = GetData ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; ++i)
     {
-      *it1 = -(*it1);
-      ++it1;
+      a[i] = -a[i];
     }
 }
 
@@ -347,28 +385,45 @@ SpectrumValue::Log ()
 double
 Norm (const SpectrumValue& x)
 {
-  double s = 0;
-  Values::const_iterator it1 = x.ConstValuesBegin ();
-  while (it1 != x.ConstValuesEnd ())
+  // four partial sums, to overlap the additions
+  double s[4] = { 0, 0, 0, 0 };
+  const double *a = x.GetData ();
+  size_t n = x.m_values.size ();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
     {
-      s += (*it1) * (*it1);
-      ++it1;
+      s[0] += a[i] * a[i];
+      s[1] += a[i + 1] * a[i + 1];
+      s[2] += a[i + 2] * a[i + 2];
+      s[3] += a[i + 3] * a[i + 3];
     }
-  return std::sqrt (s);
+  for (; i < n; ++i)
+    {
+      s[0] += a[i] * a[i];
+    }
+  return std::sqrt ((s[0] + s[1]) + (s[2] + s[3]));
 }
 
 
 double
 Sum (const SpectrumValue& x)
 {
-  double s = 0;
-  Values::const_iterator it1 = x.ConstValuesBegin ();
-  while (it1 != x.ConstValuesEnd ())
+  double s[4] = { 0, 0, 0, 0 };
+  const double *a = x.GetData ();
+  size_t n = x.m_values.size ();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
     {
-      s += (*it1);
-      ++it1;
+      s[0] += a[i];
+      s[1] += a[i + 1];
+      s[2] += a[i + 2];
+      s[3] += a[i + 3];
     }
-  return s;
+  for (; i < n; ++i)
+    {
+      s[0] += a[i];
+    }
+  return (s[0] + s[1]) + (s[2] + s[3]);
 }
 
 
@@ -389,18 +444,24 @@ Prod (const SpectrumValue& x)
 double
 Integral (const SpectrumValue& arg)
 {
-  double i = 0;
-  Values::const_iterator vit = arg.ConstValuesBegin ();
+  NS_ASSERT (arg.m_values.size () == arg.m_spectrumModel->GetNumBands ());
+  double s[4] = { 0, 0, 0, 0 };
+  const double *a = arg.GetData ();
   Bands::const_iterator bit = arg.ConstBandsBegin ();
-  while (vit != arg.ConstValuesEnd ())
+  size_t n = arg.m_values.size ();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4, bit += 4)
+    {
+      s[0] += a[i] * (bit[0].fh - bit[0].fl);
+      s[1] += a[i + 1] * (bit[1].fh - bit[1].fl);
+      s[2] += a[i + 2] * (bit[2].fh - bit[2].fl);
+      s[3] += a[i + 3] * (bit[3].fh - bit[3].fl);
+    }
+  for (; i < n; ++i, ++bit)
     {
-      NS_ASSERT (bit != arg.ConstBandsEnd ());
-      i += (*vit) * (bit->fh - bit->fl);
-      ++vit;
-      ++bit;
+      s[0] += a[i] * (bit->fh - bit->fl);
     }
-  NS_ASSERT (bit == arg.ConstBandsEnd ());
-  return i;
+  return (s[0] + s[1]) + (s[2] + s[3]);
 }
 
 
@@ -467,9 +528,8 @@ operator+ (double lhs, const SpectrumValue& rhs)
 SpectrumValue
 operator- (const SpectrumValue& lhs, const SpectrumValue& rhs)
 {
-  SpectrumValue res = rhs;
-  res.ChangeSign ();
-  res.Add (lhs);
+  SpectrumValue res = lhs;
+  res.Subtract (rhs);
   return res;
 }
 
@@ -664,13 +724,7 @@ SpectrumValue::operator/= (double rhs)
 SpectrumValue&
 SpectrumValue::operator= (double rhs)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
-    {
-      *it1 = rhs;
-      ++it1;
-    }
+  std::fill (m_values.begin (), m_values.end (), rhs);
   return *this;
 }
 
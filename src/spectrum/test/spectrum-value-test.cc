@@ -82,6 +82,49 @@ SpectrumValueTestCase::DoRun (void)
 
 
 
+/**
+ * Check Sum, Norm and Integral against plain loops over the values
+ */
+class SpectrumValueReductionTestCase : public TestCase
+{
+public:
+  SpectrumValueReductionTestCase (SpectrumValue a, std::string name);
+  virtual ~SpectrumValueReductionTestCase ();
+  virtual void DoRun (void);
+
+private:
+  SpectrumValue m_a;
+};
+
+SpectrumValueReductionTestCase::SpectrumValueReductionTestCase (SpectrumValue a, std::string name)
+  : TestCase (name),
+    m_a (a)
+{
+}
+
+SpectrumValueReductionTestCase::~SpectrumValueReductionTestCase ()
+{
+}
+
+void
+SpectrumValueReductionTestCase::DoRun (void)
+{
+  double sum = 0;
+  double squares = 0;
+  double integral = 0;
+  Bands::const_iterator bit = m_a.ConstBandsBegin ();
+  for (Values::const_iterator vit = m_a.ConstValuesBegin (); vit != m_a.ConstValuesEnd (); ++vit, ++bit)
+    {
+      sum += *vit;
+      squares += (*vit) * (*vit);
+      integral += (*vit) * (bit->fh - bit->fl);
+    }
+  NS_TEST_ASSERT_MSG_EQ_TOL (Sum (m_a), sum, TOLERANCE, "Sum differs from the loop");
+  NS_TEST_ASSERT_MSG_EQ_TOL (Norm (m_a), std::sqrt (squares), TOLERANCE, "Norm differs from the loop");
+  NS_TEST_ASSERT_MSG_EQ_TOL (Integral (m_a), integral, TOLERANCE, "Integral differs from the loop");
+}
+
+
 class SpectrumValueTestSuite : public TestSuite
 {
 public:
@@ -242,6 +285,30 @@ SpectrumValueTestSuite::SpectrumValueTestSuite ()
   AddTestCase (new SpectrumValueTestCase (tv1rs3, v1rs3, "tv1rs3 = v1 >> 3"), TestCase::QUICK);
 
 
+  SpectrumValue tv11 (f), tv12 (f);
+  tv11 = v1;
+  tv11.AddScaled (v2, doubleValue);
+  AddTestCase (new SpectrumValueTestCase (tv11, v1 + v2 * doubleValue, "tv11 = v1, tv11.AddScaled (v2, doubleValue)"), TestCase::QUICK);
+  tv12 = v3;
+  tv12.MultiplyAdd (v1, v2);
+  AddTestCase (new SpectrumValueTestCase (tv12, v3 + v5, "tv12 = v3, tv12.MultiplyAdd (v1, v2)"), TestCase::QUICK);
+
+  AddTestCase (new SpectrumValueReductionTestCase (v1, "Sum, Norm and Integral of v1"), TestCase::QUICK);
+
+  // a number of values which is not a multiple of 4
+  std::vector<double> freqs11;
+  for (int i = 1; i <= 11; i++)
+    {
+      freqs11.push_back (i * i);
+    }
+  SpectrumValue v11 (Create<SpectrumModel> (freqs11));
+  for (int i = 0; i < 11; i++)
+    {
+      v11[i] = std::sin (i + 1.0);
+    }
+  AddTestCase (new SpectrumValueReductionTestCase (v11, "Sum, Norm and Integral of 11 values"), TestCase::QUICK);
+
+
 }
 
 
@@ -24,6 +24,8 @@
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/node.h"
 #include "traffic-control-helper.h"
 
 namespace ns3 {
@@ -390,4 +392,47 @@ TrafficControlHelper::Uninstall (NetDeviceContainer c)
 }
 
 
+/**
+ * \brief Binary trace sink for the packet traces of a QueueDisc
+ * \param file the binary trace file
+ * \param qd the traced queue disc, not a Ptr as the queue disc holds the callback
+ * \param event the BinaryTraceEvent recorded
+ * \param item the queue disc item
+ */
+static void
+BinaryTraceQueueDiscSink (Ptr<BinaryTraceFile> file, QueueDisc *qd,
+                          uint8_t event, Ptr<const QueueItem> item)
+{
+  Ptr<NetDevice> device = qd->GetNetDevice ();
+  BinaryTraceRecord record = BinaryTraceFile::MakeRecord (item->GetPacket (), event,
+                                                          device->GetNode ()->GetId (),
+                                                          device->GetIfIndex (),
+                                                          qd->GetNPackets ());
+  // The IPv4 header is not part of the packet yet
+  Ptr<const Ipv4QueueDiscItem> ipv4Item = DynamicCast<const Ipv4QueueDiscItem> (item);
+  if (ipv4Item != 0)
+    {
+      record.size = ipv4Item->GetPacketSize ();
+      record.ecn = ipv4Item->GetHeader ().GetEcn ();
+    }
+  file->Write (record);
+}
+
+void
+TrafficControlHelper::EnableBinaryTrace (Ptr<BinaryTraceFile> file, QueueDiscContainer queueDiscs)
+{
+  NS_LOG_FUNCTION (this << file);
+  for (QueueDiscContainer::ConstIterator i = queueDiscs.Begin (); i != queueDiscs.End (); ++i)
+    {
+      Ptr<QueueDisc> qd = *i;
+      NS_ABORT_MSG_IF (qd->GetNetDevice () == 0, "The queue disc is not attached to a device");
+      qd->TraceConnectWithoutContext ("Enqueue",
+        MakeBoundCallback (&BinaryTraceQueueDiscSink, file, PeekPointer (qd), (uint8_t) BINARY_TRACE_QUEUE_ENQUEUE));
+      qd->TraceConnectWithoutContext ("Dequeue",
+        MakeBoundCallback (&BinaryTraceQueueDiscSink, file, PeekPointer (qd), (uint8_t) BINARY_TRACE_QUEUE_DEQUEUE));
+      qd->TraceConnectWithoutContext ("Drop",
+        MakeBoundCallback (&BinaryTraceQueueDiscSink, file, PeekPointer (qd), (uint8_t) BINARY_TRACE_QUEUE_DROP));
+    }
+}
+
 } // namespace ns3
@@ -26,6 +26,7 @@
 #include "ns3/object-factory.h"
 #include "ns3/net-device-container.h"
 #include "ns3/queue-disc-container.h"
+#include "ns3/binary-trace-file.h"
 
 namespace ns3 {
 
@@ -450,6 +451,19 @@ public:
    */
   void Uninstall (Ptr<NetDevice> d);
 
+  /**
+   * \brief Write the enqueues, dequeues and drops of the given queue discs
+   * to a binary trace file.
+   *
+   * Each event becomes one BinaryTraceRecord, whose queue depth is the
+   * number of packets in the queue disc and whose device is the index of
+   * the device the queue disc is attached to.
+   *
+   * \param file an open binary trace file
+   * \param queueDiscs the root queue discs to trace
+   */
+  void EnableBinaryTrace (Ptr<BinaryTraceFile> file, QueueDiscContainer queueDiscs);
+
 private:
   /// QueueDisc factory, stores the configuration of all the queue discs
   std::vector<QueueDiscFactory> m_queueDiscFactory;
@@ -1,6 +1,8 @@
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include "ns3/string.h"
 #include "ns3/delay-queue-disc.h"
+#include <algorithm>
 
 namespace ns3 {
   
@@ -20,6 +22,9 @@ namespace ns3 {
   }
 
   DelayClass::DelayClass ()
+    : cl (0),
+      delay (0),
+      lastRelease (0)
   {
     NS_LOG_FUNCTION (this);
   }
@@ -32,11 +37,19 @@ namespace ns3 {
       .SetParent<QueueDisc> ()
       .SetGroupName ("TrafficControl")
       .AddConstructor<DelayQueueDisc> ()
+      .AddAttribute ("Granularity", "The duration of a bucket of the timing wheel",
+                     StringValue ("1us"),
+                     MakeTimeAccessor (&DelayQueueDisc::m_granularity),
+                     MakeTimeChecker (TimeStep (1)))
       ;
     return tid;
   }
 
   DelayQueueDisc::DelayQueueDisc ()
+    : m_wheel (64),
+      m_cursor (0),
+      m_lastTick (0),
+      m_nDelayed (0)
   {
     NS_LOG_FUNCTION (this);
   }
@@ -47,6 +60,18 @@ namespace ns3 {
     m_delayClasses.clear ();
   }
 
+  void
+  DelayQueueDisc::DoDispose (void)
+  {
+    NS_LOG_FUNCTION (this);
+    m_event.Cancel ();
+    m_delayClasses.clear ();
+    m_outQueue.clear ();
+    m_wheel.clear ();
+    m_nDelayed = 0;
+    QueueDisc::DoDispose ();
+  }
+
   void
   DelayQueueDisc::AddDelayClass (int32_t cl, Time delay)
   {
@@ -57,27 +82,129 @@ namespace ns3 {
   }
 
   void
-  DelayQueueDisc::FetchToOutQueue (Ptr<DelayClass> fromClass)
+  DelayQueueDisc::AddDelayClass (int32_t cl, Ptr<RandomVariableStream> delay)
+  {
+    Ptr<DelayClass> delayClass = CreateObject<DelayClass> ();
+    delayClass->cl = cl;
+    delayClass->jitter = delay;
+    m_delayClasses[cl] = delayClass;
+  }
+
+  uint32_t
+  DelayQueueDisc::GetNDelayedPackets (void) const
+  {
+    return m_nDelayed;
+  }
+
+  void
+  DelayQueueDisc::Grow (int64_t ticks)
+  {
+    NS_LOG_FUNCTION (this << ticks);
+    size_t size = m_wheel.size ();
+    while (static_cast<int64_t> (size) < ticks)
+      {
+        size *= 2;
+      }
+
+    // Every bucket holds the packets of one tick, move them as a whole
+    std::vector<std::deque<DelayedItem> > wheel (size);
+    for (size_t i = 0; i < m_wheel.size (); ++i)
+      {
+        if (!m_wheel[i].empty ())
+          {
+            int64_t tick = m_wheel[i].front ().release / m_granularity.GetTimeStep ();
+            wheel[tick % size].swap (m_wheel[i]);
+          }
+      }
+    m_wheel.swap (wheel);
+  }
+
+  void
+  DelayQueueDisc::Insert (const DelayedItem &delayed)
+  {
+    int64_t tick = delayed.release / m_granularity.GetTimeStep ();
+    if (m_nDelayed == 0)
+      {
+        m_cursor = tick;
+        m_lastTick = tick;
+      }
+    m_cursor = std::min (m_cursor, tick);
+    m_lastTick = std::max (m_lastTick, tick);
+    if (m_lastTick - m_cursor >= static_cast<int64_t> (m_wheel.size ()))
+      {
+        Grow (m_lastTick - m_cursor + 1);
+      }
+
+    // Keep the bucket sorted by release time, most packets go last
+    std::deque<DelayedItem> &bucket = m_wheel[tick % m_wheel.size ()];
+    std::deque<DelayedItem>::iterator pos = bucket.end ();
+    while (pos != bucket.begin () && (pos - 1)->release > delayed.release)
+      {
+        --pos;
+      }
+    bucket.insert (pos, delayed);
+    m_nDelayed++;
+  }
+
+  std::deque<DelayQueueDisc::DelayedItem> &
+  DelayQueueDisc::FirstBucket (void)
+  {
+    NS_ASSERT (m_nDelayed > 0);
+    while (m_wheel[m_cursor % m_wheel.size ()].empty ())
+      {
+        m_cursor++;
+      }
+    return m_wheel[m_cursor % m_wheel.size ()];
+  }
+
+  void
+  DelayQueueDisc::ScheduleRelease (void)
   {
-    Ptr<const QueueDiscItem> item = 0;
-    item = fromClass->queue.front ();
-    fromClass->queue.pop ();
+    if (m_nDelayed == 0)
+      {
+        m_event.Cancel ();
+        return;
+      }
 
-    if (item == 0)
+    int64_t earliest = FirstBucket ().front ().release;
+    if (m_event.IsRunning () && static_cast<int64_t> (m_event.GetTs ()) == earliest)
       {
-        NS_LOG_ERROR ("Cannot fetch from qdisc, which is impossible to happen!");
         return;
       }
+    m_event.Cancel ();
+    m_event = Simulator::Schedule (TimeStep (earliest) - Simulator::Now (), &DelayQueueDisc::Release, this);
+  }
 
-    m_outQueue.push (item);
-    NS_LOG_INFO ("Fetch from class: " << fromClass->cl << " to out queue");
+  void
+  DelayQueueDisc::Release (void)
+  {
+    NS_LOG_FUNCTION (this);
+    int64_t now = Simulator::Now ().GetTimeStep ();
+    while (m_nDelayed > 0)
+      {
+        std::deque<DelayedItem> &bucket = FirstBucket ();
+        if (bucket.front ().release > now)
+          {
+            break;
+          }
+        m_outQueue.push_back (bucket.front ().item);
+        bucket.pop_front ();
+        m_nDelayed--;
+      }
+    NS_LOG_INFO ("Released packets, " << m_outQueue.size () << " ready to send");
+    ScheduleRelease ();
+
+    // Nothing else would send the released packets if the device is idle
+    if (GetNetDevice () != 0)
+      {
+        Run ();
+      }
   }
 
   bool
   DelayQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   {
     NS_LOG_FUNCTION (this << item);
-    Ptr<DelayClass> delayClass = 0;
 
     int32_t cl = Classify (item);
 
@@ -89,21 +216,32 @@ namespace ns3 {
         return false;
       }
 
-    delayClass = itr->second;
+    Ptr<DelayClass> delayClass = itr->second;
 
-    delayClass->queue.push (ConstCast<const QueueDiscItem> (item));
-    NS_LOG_INFO ("Enqueue to class: " << cl);
+    Time delay = delayClass->delay;
+    if (delayClass->jitter != 0)
+      {
+        delay = MicroSeconds (std::max (delayClass->jitter->GetValue (), 0.0));
+      }
+    // Packets of a class leave in order
+    Time release = std::max (Simulator::Now () + delay, delayClass->lastRelease);
+    delayClass->lastRelease = release;
 
-    m_event = Simulator::Schedule (delayClass->delay, &DelayQueueDisc::FetchToOutQueue, this, delayClass);
+    DelayedItem delayed;
+    delayed.item = item;
+    delayed.release = release.GetTimeStep ();
+    Insert (delayed);
+    NS_LOG_INFO ("Enqueue to class: " << cl << ", released at " << release);
 
-    return true; 
+    ScheduleRelease ();
+
+    return true;
   }
 
   Ptr<QueueDiscItem>
   DelayQueueDisc::DoDequeue (void)
   {
     NS_LOG_FUNCTION (this);
-    Ptr<QueueDiscItem> item = 0;
 
     if (m_outQueue.empty ())
       {
@@ -111,8 +249,8 @@ namespace ns3 {
         return 0;
       }
 
-    item = ConstCast<QueueDiscItem> (m_outQueue.front ());
-    m_outQueue.pop ();
+    Ptr<QueueDiscItem> item = m_outQueue.front ();
+    m_outQueue.pop_front ();
 
     return item;
   }
@@ -120,6 +258,10 @@ namespace ns3 {
   Ptr<const QueueDiscItem>
   DelayQueueDisc::DoPeek (void) const
   {
+    if (m_outQueue.empty ())
+      {
+        return 0;
+      }
     return m_outQueue.front ();
   }
 
@@ -130,7 +272,7 @@ namespace ns3 {
     return true;
   }
 
-  void 
+  void
   DelayQueueDisc::InitializeParams (void)
   {
     NS_LOG_FUNCTION (this);
@@ -4,8 +4,10 @@
 #include "ns3/queue-disc.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
-#include <list>
-#include <queue>
+#include "ns3/random-variable-stream.h"
+#include <deque>
+#include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -15,34 +17,106 @@ namespace ns3 {
     static TypeId GetTypeId (void);
 
     DelayClass ();
-    
+
     int32_t cl;
-    std::queue<Ptr<const QueueDiscItem> > queue;
     Time delay;
+    Ptr<RandomVariableStream> jitter;   //!< Delay in microseconds, replaces delay if set
+    Time lastRelease;                   //!< Release time of the last packet of the class
   };
 
+  /**
+   * \ingroup traffic-control
+   *
+   * \brief Delay the packets of each class before sending them.
+   *
+   * The packets waiting for their release time are kept in a timing wheel:
+   * a ring of buckets of Granularity each, holding the packets released
+   * during that time sorted by release time. The ring grows when a packet
+   * is released further than it spans. The queue disc keeps one event,
+   * for the earliest release; it then moves the released packets to the
+   * queue of packets ready to be sent and runs itself.
+   *
+   * The delay of a class is fixed, or drawn for each packet from a random
+   * variable (in microseconds) to emulate jitter. A packet is never
+   * released before the packets enqueued before it in its class.
+   */
   class DelayQueueDisc: public QueueDisc
   {
   public:
     static TypeId GetTypeId (void);
-    
+
     DelayQueueDisc ();
     virtual ~DelayQueueDisc ();
 
     void AddDelayClass (int32_t cl, Time delay);
 
+    /**
+     * Add a class whose delay is drawn for each packet
+     * \param cl the class returned by the packet filters
+     * \param delay the delay in microseconds, negative values count as 0
+     */
+    void AddDelayClass (int32_t cl, Ptr<RandomVariableStream> delay);
+
+    /**
+     * \return the number of packets waiting for their release time
+     */
+    uint32_t GetNDelayedPackets (void) const;
+
+  protected:
+    virtual void DoDispose (void);
+
   private:
+    /// A packet waiting for its release time
+    struct DelayedItem
+    {
+      Ptr<QueueDiscItem> item;          //!< The packet
+      int64_t release;                  //!< Release time in time steps
+    };
+
     virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
     virtual Ptr<QueueDiscItem> DoDequeue (void);
     virtual Ptr<const QueueDiscItem> DoPeek (void) const;
     virtual bool CheckConfig (void);
     virtual void InitializeParams (void);
 
-    void FetchToOutQueue (Ptr<DelayClass> fromClass);
+    /**
+     * Insert a packet in the timing wheel
+     * \param delayed the packet and its release time
+     */
+    void Insert (const DelayedItem &delayed);
+
+    /**
+     * Double the number of buckets until the wheel spans the given ticks
+     * \param ticks the number of buckets needed
+     */
+    void Grow (int64_t ticks);
+
+    /**
+     * Move the cursor to the first non-empty bucket, there must be one
+     * \return the first non-empty bucket
+     */
+    std::deque<DelayedItem> &FirstBucket (void);
+
+    /**
+     * Schedule the release event for the earliest delayed packet
+     */
+    void ScheduleRelease (void);
+
+    /**
+     * Move the packets whose release time has come to the out queue and
+     * send them
+     */
+    void Release (void);
 
     std::map<int32_t, Ptr<DelayClass> > m_delayClasses;
-    std::queue<Ptr<const QueueDiscItem> > m_outQueue;
+    std::deque<Ptr<QueueDiscItem> > m_outQueue;
     EventId m_event;
+
+    Time m_granularity;                                 //!< Duration of a bucket
+    std::vector<std::deque<DelayedItem> > m_wheel;      //!< Buckets of delayed packets
+    int64_t m_cursor;                                   //!< Tick of the earliest delayed packet
+    int64_t m_lastTick;                                 //!< Tick of the latest delayed packet
+    uint32_t m_nDelayed;                                //!< Packets in the wheel
   };
 
 }
@@ -1,6 +1,9 @@
 #include "ns3/log.h"
 #include "dwrr-queue-disc.h"
 #include "ns3/ipv4-queue-disc-item.h"
+#include <algorithm>
+
+#define MAX_DWRR_PRIORITIES 64
 
 namespace ns3 {
 
@@ -20,6 +23,8 @@ DWRRClass::GetTypeId (void)
 }
 
 DWRRClass::DWRRClass ()
+    : level (0),
+      nextActive (0)
 {
     NS_LOG_FUNCTION (this);
 }
@@ -28,7 +33,7 @@ TypeId
 DWRRQueueDisc::GetTypeId (void)
 {
     static TypeId tid = TypeId ("ns3::DWRRQueueDisc")
-      .SetParent<Object> ()
+      .SetParent<QueueDisc> ()
       .SetGroupName ("TrafficControl")
       .AddConstructor<DWRRQueueDisc> ()
     ;
@@ -36,6 +41,7 @@ DWRRQueueDisc::GetTypeId (void)
 }
 
 DWRRQueueDisc::DWRRQueueDisc ()
+    : m_activeLevels (0)
 {
     NS_LOG_FUNCTION (this);
 }
@@ -61,6 +67,58 @@ DWRRQueueDisc::AddDWRRClass (Ptr<QueueDisc> qdisc, int32_t cl, uint32_t priority
     dwrrClass->quantum = quantum;
     dwrrClass->deficit = 0;
     m_DWRRs[cl] = dwrrClass;
+
+    NS_ASSERT_MSG (m_activeLevels == 0, "Classes must be added before packets are enqueued");
+    if (!std::binary_search (m_priorities.begin (), m_priorities.end (), priority))
+    {
+        NS_ASSERT_MSG (m_priorities.size () < MAX_DWRR_PRIORITIES, "Too many priorities");
+        m_priorities.insert (std::upper_bound (m_priorities.begin (), m_priorities.end (), priority), priority);
+        ActiveList empty = { 0, 0 };
+        m_active.assign (m_priorities.size (), empty);
+    }
+    std::map<int32_t, Ptr<DWRRClass> >::iterator itr = m_DWRRs.begin ();
+    for ( ; itr != m_DWRRs.end (); ++itr)
+    {
+        itr->second->level = std::lower_bound (m_priorities.begin (), m_priorities.end (),
+                                               itr->second->priority) - m_priorities.begin ();
+    }
+}
+
+void
+DWRRQueueDisc::PushBack (DWRRClass *dwrrClass)
+{
+    ActiveList &list = m_active[dwrrClass->level];
+    dwrrClass->nextActive = 0;
+    if (list.tail == 0)
+    {
+        list.head = dwrrClass;
+        m_activeLevels |= static_cast<uint64_t> (1) << dwrrClass->level;
+    }
+    else
+    {
+        list.tail->nextActive = dwrrClass;
+    }
+    list.tail = dwrrClass;
+}
+
+void
+DWRRQueueDisc::PopFront (uint32_t level)
+{
+    ActiveList &list = m_active[level];
+    DWRRClass *dwrrClass = list.head;
+    list.head = dwrrClass->nextActive;
+    dwrrClass->nextActive = 0;
+    if (list.head == 0)
+    {
+        list.tail = 0;
+        m_activeLevels &= ~(static_cast<uint64_t> (1) << level);
+    }
+}
+
+uint32_t
+DWRRQueueDisc::GetHighestLevel (void) const
+{
+    return 63 - __builtin_clzll (m_activeLevels);
 }
 
 bool
@@ -94,7 +152,7 @@ DWRRQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 
     if (dwrrClass->qdisc->GetNPackets () == 1)
     {
-        m_active[dwrrClass->priority].push_back (dwrrClass);
+        PushBack (PeekPointer (dwrrClass));
         dwrrClass->deficit = dwrrClass->quantum;
     }
 
@@ -108,32 +166,18 @@ DWRRQueueDisc::DoDequeue (void)
 
     Ptr<const QueueDiscItem> item = 0;
 
-    if (m_active.empty ())
-    {
-        NS_LOG_LOGIC ("Active map is empty");
-        return 0;
-    }
-
-    int32_t highestPriority = -1;
-    std::map<uint32_t, std::list<Ptr<DWRRClass> > >::const_iterator itr = m_active.begin ();
-    for (; itr != m_active.end (); ++itr)
-    {
-        if (static_cast<int32_t>(itr->first) > highestPriority
-                && !(itr->second).empty ())
-        {
-            highestPriority = static_cast<int32_t> (itr->first);
-        }
-    }
-
-    if (highestPriority == -1)
+    if (m_activeLevels == 0)
     {
         NS_LOG_LOGIC ("Cannot find active queue");
         return 0;
     }
 
+    uint32_t level = GetHighestLevel ();
+    ActiveList &list = m_active[level];
+
     while (true)
     {
-        Ptr<DWRRClass> dwrrClass = m_active[highestPriority].front ();
+        DWRRClass *dwrrClass = list.head;
 
         item = dwrrClass->qdisc->Peek ();
         if (item == 0)
@@ -161,14 +205,17 @@ DWRRQueueDisc::DoDequeue (void)
             }
             if (dwrrClass->qdisc->GetNPackets () == 0)
             {
-                m_active[highestPriority].pop_front ();
+                PopFront (level);
             }
             return retItem;
         }
 
         dwrrClass->deficit += dwrrClass->quantum;
-        m_active[highestPriority].pop_front ();
-        m_active[highestPriority].push_back (dwrrClass);
+        if (list.head != list.tail)
+        {
+            PopFront (level);
+            PushBack (dwrrClass);
+        }
     }
 
     return 0;
@@ -179,32 +226,13 @@ DWRRQueueDisc::DoPeek (void) const
 {
     NS_LOG_FUNCTION (this);
 
-    if (m_active.empty ())
-    {
-        NS_LOG_LOGIC ("Active map is empty");
-        return 0;
-    }
-
-    int32_t highestPriority = -1;
-    std::map<uint32_t, std::list<Ptr<DWRRClass> > >::const_iterator itr = m_active.begin ();
-    for (; itr != m_active.end (); ++itr)
-    {
-        if (static_cast<int32_t>(itr->first) >= highestPriority
-                && !(itr->second).empty ())
-        {
-            highestPriority = static_cast<int32_t>(itr->first);
-        }
-    }
-
-    if (highestPriority == -1)
+    if (m_activeLevels == 0)
     {
         NS_LOG_LOGIC ("Cannot find active queue");
         return 0;
     }
 
-    Ptr<DWRRClass> dwrrClass = m_active.at (highestPriority).front ();
-
-    return dwrrClass->qdisc->Peek ();
+    return m_active[GetHighestLevel ()].head->qdisc->Peek ();
 }
 
 bool
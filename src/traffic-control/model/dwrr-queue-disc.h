@@ -2,7 +2,8 @@
 #define DWRR_QUEUE_DISC_H
 
 #include "ns3/queue-disc.h"
-#include <list>
+#include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -19,6 +20,9 @@ public:
     Ptr<QueueDisc> qdisc;
     uint32_t quantum;
     uint32_t deficit;
+
+    uint32_t level;             //!< Index of the priority in the sorted priorities
+    DWRRClass *nextActive;      //!< Next class in the active list of the priority
 };
 
 class DWRRQueueDisc : public QueueDisc
@@ -42,10 +46,37 @@ private:
     virtual bool CheckConfig (void);
     virtual void InitializeParams (void);
 
-    // The internal DWRR queue discs are first organized in a map
-    // with the priority as key and then in a linked list if they are
-    // with the same priority
-    std::map<uint32_t, std::list<Ptr<DWRRClass> > > m_active;
+    /// Active classes of a priority, linked through DWRRClass::nextActive
+    struct ActiveList
+    {
+        DWRRClass *head;
+        DWRRClass *tail;
+    };
+
+    /**
+     * Append a class to the active list of its priority
+     * @param dwrrClass the class
+     */
+    void PushBack (DWRRClass *dwrrClass);
+
+    /**
+     * Remove the first class of the active list of a priority
+     * @param level the index of the priority
+     */
+    void PopFront (uint32_t level);
+
+    /**
+     * @return the index of the highest priority with active classes, the
+     * bitmap of active priorities must not be empty
+     */
+    uint32_t GetHighestLevel (void) const;
+
+    // The internal DWRR queue discs with packets are linked in a circular
+    // order per priority; a bitmap tells which priorities have any, the
+    // priorities being sorted so that the highest set bit is served first
+    std::vector<uint32_t> m_priorities;
+    std::vector<ActiveList> m_active;
+    uint64_t m_activeLevels;
     std::map<int32_t, Ptr<DWRRClass> > m_DWRRs;
 };
 
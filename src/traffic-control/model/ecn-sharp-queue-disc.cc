@@ -1,4 +1,5 @@
 #include "ns3/log.h"
+#include "ns3/event-log.h"
 #include "ns3/enum.h"
 #include "ns3/object-factory.h"
 #include "ecn-sharp-queue-disc.h"
@@ -11,6 +12,7 @@
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("ECNSharpQueueDisc");
+NS_EVENT_LOG_COMPONENT_DEFINE ("ECNSharpQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED (ECNSharpQueueDisc);
 
@@ -70,7 +72,7 @@ TypeId
 ECNSharpQueueDisc::GetTypeId (void)
 {
     static TypeId tid = TypeId ("ns3::ECNSharpQueueDisc")
-      .SetParent<Object> ()
+      .SetParent<QueueDisc> ()
       .SetGroupName ("TrafficControl")
       .AddConstructor<ECNSharpQueueDisc> ()
       .AddAttribute ("Mode", "Whether to use Bytes (see MaxBytes) or Packets (see MaxPackets) as the maximum queue size metric.",
@@ -124,12 +126,14 @@ ECNSharpQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
     Ptr<Packet> p = item->GetPacket ();
     if (m_mode == Queue::QUEUE_MODE_PACKETS && (GetInternalQueue (0)->GetNPackets () + 1 > m_maxPackets))
     {
+        NS_EVENT_LOG (EVENT_DROP, p->GetUid (), item->GetPacketSize ());
         Drop (item);
         return false;
     }
 
     if (m_mode == Queue::QUEUE_MODE_BYTES && (GetInternalQueue (0)->GetNBytes () + item->GetPacketSize () > m_maxBytes))
     {
+        NS_EVENT_LOG (EVENT_DROP, p->GetUid (), item->GetPacketSize ());
         Drop (item);
         return false;
     }
@@ -138,6 +142,8 @@ ECNSharpQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
     ECNSharpTimestampTag tag;
     p->AddPacketTag (tag);
 
+    NS_EVENT_LOG (EVENT_ENQUEUE, p->GetUid (), item->GetPacketSize ());
+
     GetInternalQueue (0)->Enqueue (item);
 
     return true;
@@ -170,7 +176,10 @@ ECNSharpQueueDisc::DoDequeue (void)
         return NULL;
     }
 
-    Time sojournTime = now - tag.GetTxTime ();
+    // Packets waited for the fluid backlog before being enqueued
+    Time sojournTime = now - tag.GetTxTime () + GetFluidDelay ();
+
+    NS_EVENT_LOG (EVENT_DEQUEUE, p->GetUid (), sojournTime.GetTimeStep ());
 
      // First we check the instantaneous queue length
     if (sojournTime > m_instantMarkingThreshold)
@@ -207,6 +216,7 @@ ECNSharpQueueDisc::DoDequeue (void)
 
     if (instantaneousMarking || persistentMarking)
     {
+        NS_EVENT_LOG (EVENT_MARK, p->GetUid (), sojournTime.GetTimeStep ());
         if (!ECNSharpQueueDisc::MarkingECN (item))
         {
             NS_LOG_ERROR ("Cannot mark ECN");
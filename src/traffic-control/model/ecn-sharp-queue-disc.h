@@ -31,6 +31,20 @@ public:
 
     static TypeId GetTypeId (void);
 
+    /**
+     * Types of the records written to the event log by the
+     * "ECNSharpQueueDisc" component. The first argument of every record is
+     * the packet uid, the second one is the packet size for enqueue and drop,
+     * and the sojourn time in time steps for dequeue and mark
+     */
+    enum EventLogType
+    {
+        EVENT_ENQUEUE = 0,
+        EVENT_DROP,
+        EVENT_DEQUEUE,
+        EVENT_MARK
+    };
+
     ECNSharpQueueDisc ();
 
     virtual ~ECNSharpQueueDisc ();
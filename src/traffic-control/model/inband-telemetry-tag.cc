@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "inband-telemetry-tag.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (InbandTelemetryTag);
+
+TypeId
+InbandTelemetryTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::InbandTelemetryTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<InbandTelemetryTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+InbandTelemetryTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+InbandTelemetryTag::InbandTelemetryTag ()
+  : m_hops (0),
+    m_maxUtilization (0),
+    m_maxQueueBytes (0)
+{
+}
+
+void
+InbandTelemetryTag::Update (double utilization, uint32_t queueBytes)
+{
+  uint16_t u = static_cast<uint16_t> (std::min (std::max (utilization, 0.0), 1.0) * 65535 + 0.5);
+  m_maxUtilization = std::max (m_maxUtilization, u);
+  m_maxQueueBytes = std::max (m_maxQueueBytes, queueBytes);
+  if (m_hops < 255)
+    {
+      m_hops++;
+    }
+}
+
+uint8_t
+InbandTelemetryTag::GetHops (void) const
+{
+  return m_hops;
+}
+
+double
+InbandTelemetryTag::GetMaxUtilization (void) const
+{
+  return m_maxUtilization / 65535.0;
+}
+
+uint32_t
+InbandTelemetryTag::GetMaxQueueBytes (void) const
+{
+  return m_maxQueueBytes;
+}
+
+uint32_t
+InbandTelemetryTag::GetSerializedSize (void) const
+{
+  return 7;
+}
+
+void
+InbandTelemetryTag::Serialize (TagBuffer i) const
+{
+  i.WriteU8 (m_hops);
+  i.WriteU16 (m_maxUtilization);
+  i.WriteU32 (m_maxQueueBytes);
+}
+
+void
+InbandTelemetryTag::Deserialize (TagBuffer i)
+{
+  m_hops = i.ReadU8 ();
+  m_maxUtilization = i.ReadU16 ();
+  m_maxQueueBytes = i.ReadU32 ();
+}
+
+void
+InbandTelemetryTag::Print (std::ostream &os) const
+{
+  os << "hops=" << (uint32_t) m_hops << " util=" << GetMaxUtilization ()
+     << " queue=" << m_maxQueueBytes;
+}
+
+} // namespace ns3
@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef INBAND_TELEMETRY_TAG_H
+#define INBAND_TELEMETRY_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief In-band telemetry carried by a packet along its path.
+ *
+ * The tag has a fixed size: instead of appending one record per hop, every
+ * hop max-updates the path metrics, i.e., the utilization of the most
+ * utilized egress link and the longest egress queue seen so far, and
+ * increments the hop count. The utilization is stored with a 1/65535
+ * resolution.
+ */
+class InbandTelemetryTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  InbandTelemetryTag ();
+
+  /**
+   * Record the metrics of an egress port
+   * \param utilization the utilization of the link, between 0 and 1
+   * \param queueBytes the bytes queued on the port
+   */
+  void Update (double utilization, uint32_t queueBytes);
+
+  /**
+   * \return the number of hops which updated the tag
+   */
+  uint8_t GetHops (void) const;
+
+  /**
+   * \return the utilization of the most utilized link of the path
+   */
+  double GetMaxUtilization (void) const;
+
+  /**
+   * \return the longest queue of the path in bytes
+   */
+  uint32_t GetMaxQueueBytes (void) const;
+
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint8_t m_hops;             //!< Number of hops
+  uint16_t m_maxUtilization;  //!< Path utilization, 65535 is a fully utilized link
+  uint32_t m_maxQueueBytes;   //!< Path queue length
+};
+
+} // namespace ns3
+
+#endif /* INBAND_TELEMETRY_TAG_H */
@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "inband-telemetry.h"
+#include "inband-telemetry-tag.h"
+#include "port-occupancy.h"
+#include "traffic-control-layer.h"
+#include "queue-disc.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/data-rate.h"
+#include "ns3/simulator.h"
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("InbandTelemetry");
+
+NS_OBJECT_ENSURE_REGISTERED (InbandTelemetry);
+
+TypeId
+InbandTelemetry::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::InbandTelemetry")
+    .SetParent<Object> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<InbandTelemetry> ()
+    .AddAttribute ("TimeConstant",
+                   "The time constant of the link utilization estimator",
+                   TimeValue (MicroSeconds (200)),
+                   MakeTimeAccessor (&InbandTelemetry::m_timeConstant),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+InbandTelemetry::InbandTelemetry ()
+  : m_timeConstant (MicroSeconds (200))
+{
+  NS_LOG_FUNCTION (this);
+}
+
+InbandTelemetry::~InbandTelemetry ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+InbandTelemetry::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Connection>::iterator i = m_connections.begin (); i != m_connections.end (); ++i)
+    {
+      i->first->TraceDisconnectWithoutContext ("Dequeue", i->second);
+    }
+  m_connections.clear ();
+  m_ports.clear ();
+  m_occupancy = 0;
+  Object::DoDispose ();
+}
+
+Ptr<InbandTelemetry>
+InbandTelemetry::Install (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (node);
+  Ptr<InbandTelemetry> telemetry = node->GetObject<InbandTelemetry> ();
+  if (telemetry == 0)
+    {
+      telemetry = CreateObject<InbandTelemetry> ();
+      node->AggregateObject (telemetry);
+    }
+  telemetry->m_occupancy = PortOccupancy::Install (node);
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      telemetry->TrackDevice (node->GetDevice (i));
+    }
+  return telemetry;
+}
+
+void
+InbandTelemetry::TrackDevice (Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  uint32_t ifIndex = device->GetIfIndex ();
+  if (ifIndex >= m_ports.size ())
+    {
+      Port port = { false, 0.0, 0.0, 0 };
+      m_ports.resize (ifIndex + 1, port);
+    }
+  if (m_ports[ifIndex].tracked)
+    {
+      return;
+    }
+
+  Ptr<TrafficControlLayer> tc = device->GetNode ()->GetObject<TrafficControlLayer> ();
+  Ptr<QueueDisc> qd = tc != 0 ? tc->GetRootQueueDiscOnDevice (device) : 0;
+  if (qd == 0)
+    {
+      NS_LOG_LOGIC ("No root queue disc on device " << ifIndex << ", not stamped");
+      return;
+    }
+
+  m_ports[ifIndex].tracked = true;
+  DataRateValue rate;
+  if (device->GetAttributeFailSafe ("DataRate", rate))
+    {
+      m_ports[ifIndex].bytesPerSecond = rate.Get ().GetBitRate () / 8.0;
+    }
+
+  Callback<void, Ptr<const QueueItem> > cb = MakeBoundCallback (&InbandTelemetry::PacketOut, this, ifIndex);
+  qd->TraceConnectWithoutContext ("Dequeue", cb);
+  m_connections.push_back (std::make_pair (Ptr<Object> (qd), cb));
+}
+
+double
+InbandTelemetry::Decay (uint32_t ifIndex) const
+{
+  const Port &port = m_ports[ifIndex];
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  if (now != port.lastDecay)
+    {
+      port.bytes *= std::exp (-static_cast<double> (now - port.lastDecay) / m_timeConstant.GetTimeStep ());
+      port.lastDecay = now;
+    }
+  return port.bytes;
+}
+
+double
+InbandTelemetry::GetUtilization (uint32_t ifIndex) const
+{
+  if (ifIndex >= m_ports.size () || m_ports[ifIndex].bytesPerSecond == 0)
+    {
+      return 0;
+    }
+  // The counter converges to rate * time constant under a constant rate
+  return Decay (ifIndex) / (m_ports[ifIndex].bytesPerSecond * m_timeConstant.GetSeconds ());
+}
+
+void
+InbandTelemetry::Stamp (uint32_t ifIndex, Ptr<Packet> packet) const
+{
+  InbandTelemetryTag tag;
+  packet->PeekPacketTag (tag);
+  tag.Update (GetUtilization (ifIndex), m_occupancy != 0 ? m_occupancy->GetNBytes (ifIndex) : 0);
+  // Done in place unless the tag list is shared with a copy of the packet
+  packet->ReplacePacketTag (tag);
+}
+
+void
+InbandTelemetry::PacketOut (InbandTelemetry *self, uint32_t ifIndex, Ptr<const QueueItem> item)
+{
+  Ptr<Packet> packet = item->GetPacket ();
+  self->Decay (ifIndex);
+  self->m_ports[ifIndex].bytes += packet->GetSize ();
+  self->Stamp (ifIndex, packet);
+}
+
+} // namespace ns3
@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef INBAND_TELEMETRY_H
+#define INBAND_TELEMETRY_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/callback.h"
+#include <vector>
+
+namespace ns3 {
+
+class Node;
+class NetDevice;
+class Packet;
+class QueueItem;
+class PortOccupancy;
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief In-band network telemetry stamping at the egress ports of a switch.
+ *
+ * Every packet leaving the root queue disc of a tracked device is stamped
+ * with an InbandTelemetryTag holding the utilization of the egress link and
+ * the bytes queued on the port (from the PortOccupancy of the node). The
+ * tag is max-updated at every hop, so at the receiver it describes the
+ * bottleneck of the path. Load balancers only have to reflect the tag back
+ * to the sender; the stamping does not depend on how the path was chosen.
+ *
+ * The utilization is the output rate of the port, estimated with an
+ * exponentially decaying byte counter (a discounting rate estimator)
+ * decayed lazily when a packet leaves, divided by the DataRate of the
+ * device. A hop updates the tag in place, so only the first hop of a
+ * packet allocates a tag.
+ */
+class InbandTelemetry : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  InbandTelemetry ();
+  virtual ~InbandTelemetry ();
+
+  /**
+   * Get the InbandTelemetry aggregated to a node, creating it if needed,
+   * and track all the devices of the node. Call it after the queue discs
+   * have been installed.
+   *
+   * \param node the node
+   * \return the InbandTelemetry of the node
+   */
+  static Ptr<InbandTelemetry> Install (Ptr<Node> node);
+
+  /**
+   * Stamp the packets leaving a device of the node this object is
+   * aggregated to. Tracking a device twice has no effect.
+   *
+   * \param device the device
+   */
+  void TrackDevice (Ptr<NetDevice> device);
+
+  /**
+   * \param ifIndex the device index
+   * \return the current utilization of the link of the device
+   */
+  double GetUtilization (uint32_t ifIndex) const;
+
+  /**
+   * Max-update the telemetry of a packet with the metrics of a port
+   * \param ifIndex the egress device index
+   * \param packet the packet
+   */
+  void Stamp (uint32_t ifIndex, Ptr<Packet> packet) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * Trace sink for the packets leaving a root queue disc
+   * \param self the InbandTelemetry
+   * \param ifIndex the device index
+   * \param item the packet
+   */
+  static void PacketOut (InbandTelemetry *self, uint32_t ifIndex, Ptr<const QueueItem> item);
+
+  /**
+   * Decay the byte counter of a port to the current time
+   * \param ifIndex the device index
+   * \return the decayed counter
+   */
+  double Decay (uint32_t ifIndex) const;
+
+  /// Rate estimator of a port
+  struct Port
+  {
+    bool tracked;               //!< Whether the port is tracked
+    double bytesPerSecond;      //!< Link capacity, 0 if unknown
+    mutable double bytes;       //!< Decaying byte counter
+    mutable int64_t lastDecay;  //!< Time of the last decay, in time steps
+  };
+
+  /// A Dequeue trace source and the callback connected to it
+  typedef std::pair<Ptr<Object>, Callback<void, Ptr<const QueueItem> > > Connection;
+
+  Time m_timeConstant;                    //!< Time constant of the rate estimator
+  Ptr<PortOccupancy> m_occupancy;         //!< Queue lengths of the node
+  std::vector<Port> m_ports;              //!< Ports, indexed by device index
+  std::vector<Connection> m_connections;  //!< Connected trace sources
+};
+
+} // namespace ns3
+
+#endif /* INBAND_TELEMETRY_H */
@@ -0,0 +1,479 @@
+#include "ns3/log.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+#include "mq-ecn-sharp-queue-disc.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include <algorithm>
+#include <cmath>
+
+#define DEFAULT_MQ_ECN_SHARP_LIMIT 100
+#define MAX_MQ_ECN_SHARP_CLASSES 64
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MQECNSharpQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (MQECNSharpQueueDisc);
+
+namespace {
+
+/**
+ * Order of the classes: decreasing priority, then increasing class number
+ */
+struct ClassOrder
+{
+    template <typename C>
+    bool operator () (const C &a, const C &b) const
+    {
+        if (a.priority != b.priority)
+        {
+            return a.priority > b.priority;
+        }
+        return a.cl < b.cl;
+    }
+};
+
+/**
+ * @param bitmap a non-zero bitmap
+ * @return the index of its lowest set bit
+ */
+inline uint32_t
+LowestBit (uint64_t bitmap)
+{
+    return __builtin_ctzll (bitmap);
+}
+
+} // anonymous namespace
+
+TypeId
+MQECNSharpQueueDisc::GetTypeId (void)
+{
+    static TypeId tid = TypeId ("ns3::MQECNSharpQueueDisc")
+      .SetParent<QueueDisc> ()
+      .SetGroupName ("TrafficControl")
+      .AddConstructor<MQECNSharpQueueDisc> ()
+      .AddAttribute ("Scheduler", "The scheduler of the classes of the same priority.",
+              EnumValue (SCHEDULER_DWRR),
+              MakeEnumAccessor (&MQECNSharpQueueDisc::m_scheduler),
+              MakeEnumChecker (SCHEDULER_DWRR, "DWRR",
+                               SCHEDULER_WFQ, "WFQ",
+                               SCHEDULER_SP, "SP"))
+      .AddAttribute ("Mode", "Whether to use Bytes (see MaxBytes) or Packets (see MaxPackets) as the maximum queue size metric.",
+              EnumValue (Queue::QUEUE_MODE_BYTES),
+              MakeEnumAccessor (&MQECNSharpQueueDisc::m_mode),
+              MakeEnumChecker (Queue::QUEUE_MODE_BYTES, "QUEUE_MODE_BYTES",
+                               Queue::QUEUE_MODE_PACKETS, "QUEUE_MODE_PACKETS"))
+      .AddAttribute ("MaxPackets", "The maximum number of packets accepted by each class.",
+              UintegerValue (DEFAULT_MQ_ECN_SHARP_LIMIT),
+              MakeUintegerAccessor (&MQECNSharpQueueDisc::m_maxPackets),
+              MakeUintegerChecker<uint32_t> ())
+      .AddAttribute ("MaxBytes", "The maximum number of bytes accepted by each class.",
+              UintegerValue (1500 * DEFAULT_MQ_ECN_SHARP_LIMIT),
+              MakeUintegerAccessor (&MQECNSharpQueueDisc::m_maxBytes),
+              MakeUintegerChecker<uint32_t> ())
+      .AddAttribute ("InstantaneousMarkingThreshold", "The marking threshold for instantaneous queue length",
+              StringValue ("20us"),
+              MakeTimeAccessor (&MQECNSharpQueueDisc::m_instantMarkingThreshold),
+              MakeTimeChecker ())
+      .AddAttribute ("PersistentMarkingInterval", "The persistent marking interval",
+              StringValue ("100us"),
+              MakeTimeAccessor (&MQECNSharpQueueDisc::m_persistentMarkingInterval),
+              MakeTimeChecker ())
+      .AddAttribute ("PersistentMarkingTarget", "The persistent marking threshold to control queue delay",
+              StringValue ("10us"),
+              MakeTimeAccessor (&MQECNSharpQueueDisc::m_persistentMarkingTarget),
+              MakeTimeChecker ())
+    ;
+    return tid;
+}
+
+MQECNSharpQueueDisc::MQECNSharpQueueDisc ()
+    : m_active (0)
+{
+    NS_LOG_FUNCTION (this);
+}
+
+MQECNSharpQueueDisc::~MQECNSharpQueueDisc ()
+{
+    NS_LOG_FUNCTION (this);
+}
+
+void
+MQECNSharpQueueDisc::AddClass (int32_t cl, uint32_t weight)
+{
+    MQECNSharpQueueDisc::AddClass (cl, 0, weight);
+}
+
+void
+MQECNSharpQueueDisc::AddClass (int32_t cl, uint32_t priority, uint32_t weight)
+{
+    NS_LOG_FUNCTION (this << cl << priority << weight);
+    NS_ASSERT_MSG (cl >= 0, "Class numbers must not be negative");
+    NS_ASSERT_MSG (m_classes.size () < MAX_MQ_ECN_SHARP_CLASSES, "Too many classes");
+    NS_ASSERT_MSG (weight > 0, "The weight of a class must be positive");
+    NS_ASSERT_MSG (GetNPackets () == 0, "Classes must be added before packets are enqueued");
+
+    Class c;
+    c.cl = cl;
+    c.priority = priority;
+    c.weight = weight;
+    c.nBytes = 0;
+    c.deficit = 0;
+    c.headFinTime = 0;
+    c.firstAboveTime = Time (0);
+    c.marking = false;
+    c.markNext = Time (0);
+    c.markCount = 0;
+
+    // Replace the class if it exists
+    for (std::vector<Class>::iterator it = m_classes.begin (); it != m_classes.end (); ++it)
+    {
+        if (it->cl == cl)
+        {
+            m_classes.erase (it);
+            break;
+        }
+    }
+    m_classes.push_back (c);
+    std::sort (m_classes.begin (), m_classes.end (), ClassOrder ());
+
+    // Rebuild the class number index and the priority levels
+    int32_t maxClass = 0;
+    for (uint32_t i = 0; i < m_classes.size (); ++i)
+    {
+        maxClass = std::max (maxClass, m_classes[i].cl);
+    }
+    m_index.assign (maxClass + 1, -1);
+    for (uint32_t i = 0; i < m_classes.size (); ++i)
+    {
+        m_index[m_classes[i].cl] = i;
+        m_classes[i].levelFirst = (i > 0 && m_classes[i - 1].priority == m_classes[i].priority)
+            ? m_classes[i - 1].levelFirst : i;
+    }
+    for (uint32_t i = m_classes.size (); i-- > 0; )
+    {
+        m_classes[i].levelLast = (i + 1 < m_classes.size () && m_classes[i + 1].priority == m_classes[i].priority)
+            ? m_classes[i + 1].levelLast : i;
+    }
+    m_roundRobin.assign (m_classes.size (), 0);
+    for (uint32_t i = 0; i < m_classes.size (); ++i)
+    {
+        m_roundRobin[i] = m_classes[i].levelFirst;
+    }
+    m_virtualTime.assign (m_classes.size (), 0);
+}
+
+uint32_t
+MQECNSharpQueueDisc::GetClassNPackets (int32_t cl) const
+{
+    if (cl < 0 || cl >= static_cast<int32_t> (m_index.size ()) || m_index[cl] < 0)
+    {
+        return 0;
+    }
+    return m_classes[m_index[cl]].queue.size ();
+}
+
+uint64_t
+MQECNSharpQueueDisc::LevelMask (uint32_t index) const
+{
+    const Class &c = m_classes[index];
+    uint64_t upTo = (c.levelLast == 63) ? ~static_cast<uint64_t> (0)
+        : ((static_cast<uint64_t> (1) << (c.levelLast + 1)) - 1);
+    return upTo & ~((static_cast<uint64_t> (1) << c.levelFirst) - 1);
+}
+
+int32_t
+MQECNSharpQueueDisc::NextRoundRobin (void) const
+{
+    if (m_active == 0)
+    {
+        return -1;
+    }
+    // The lowest non-empty class belongs to the highest active priority
+    uint32_t first = m_classes[LowestBit (m_active)].levelFirst;
+    uint64_t level = m_active & LevelMask (first);
+    uint32_t position = m_roundRobin[first];
+    uint64_t after = (position > 63) ? 0 : level & ~((static_cast<uint64_t> (1) << position) - 1);
+    return LowestBit (after != 0 ? after : level);
+}
+
+int32_t
+MQECNSharpQueueDisc::SelectRoundRobin (uint32_t &rounds) const
+{
+    int32_t start = NextRoundRobin ();
+    if (start < 0)
+    {
+        return -1;
+    }
+
+    // Visit the classes at or after the position first, then wrap around
+    uint64_t level = m_active & LevelMask (start);
+    uint64_t after = level & ~((static_cast<uint64_t> (1) << start) - 1);
+    uint64_t order[2] = {after, level & ~after};
+
+    int32_t selected = -1;
+    rounds = 0;
+    for (uint32_t k = 0; k < 2; k++)
+    {
+        for (uint64_t set = order[k]; set != 0; set &= set - 1)
+        {
+            uint32_t i = LowestBit (set);
+            const Class &c = m_classes[i];
+            uint32_t length = c.queue.front ().first->GetPacketSize ();
+            uint32_t needed = (length <= c.deficit) ? 0 : (length - c.deficit + c.weight - 1) / c.weight;
+            // On a tie, the class visited first in the round sends
+            if (selected < 0 || needed < rounds)
+            {
+                selected = i;
+                rounds = needed;
+            }
+        }
+    }
+    return selected;
+}
+
+int32_t
+MQECNSharpQueueDisc::SelectClass (void) const
+{
+    if (m_active == 0)
+    {
+        return -1;
+    }
+
+    uint32_t lowest = LowestBit (m_active);
+    if (m_scheduler == SCHEDULER_SP)
+    {
+        return lowest;
+    }
+    if (m_scheduler == SCHEDULER_DWRR)
+    {
+        uint32_t rounds;
+        return SelectRoundRobin (rounds);
+    }
+
+    // Find the smallest head finish time
+    uint64_t level = m_active & LevelMask (lowest);
+    int32_t selected = -1;
+    for (; level != 0; level &= level - 1)
+    {
+        uint32_t i = LowestBit (level);
+        if (selected < 0 || m_classes[i].headFinTime < m_classes[selected].headFinTime)
+        {
+            selected = i;
+        }
+    }
+    return selected;
+}
+
+bool
+MQECNSharpQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+    NS_LOG_FUNCTION (this << item);
+
+    int32_t cl = Classify (item);
+    if (cl < 0 || cl >= static_cast<int32_t> (m_index.size ()) || m_index[cl] < 0)
+    {
+        NS_LOG_ERROR ("Cannot find class, dropping the packet");
+        Drop (item);
+        return false;
+    }
+
+    uint32_t index = m_index[cl];
+    Class &c = m_classes[index];
+    uint32_t length = item->GetPacketSize ();
+
+    if ((m_mode == Queue::QUEUE_MODE_PACKETS && c.queue.size () + 1 > m_maxPackets)
+        || (m_mode == Queue::QUEUE_MODE_BYTES && c.nBytes + length > m_maxBytes))
+    {
+        NS_LOG_LOGIC ("Class " << cl << " is full, dropping the packet");
+        Drop (item);
+        return false;
+    }
+
+    c.queue.push_back (std::make_pair (item, Simulator::Now ()));
+    c.nBytes += length;
+
+    if (c.queue.size () == 1)
+    {
+        m_active |= static_cast<uint64_t> (1) << index;
+        c.deficit = c.weight;
+        c.headFinTime = length / c.weight + m_virtualTime[c.levelFirst];
+        m_virtualTime[c.levelFirst] = c.headFinTime;
+    }
+
+    NS_LOG_LOGIC ("Enqueued to class " << cl << " with priority " << c.priority);
+    return true;
+}
+
+Ptr<QueueDiscItem>
+MQECNSharpQueueDisc::DoDequeue (void)
+{
+    NS_LOG_FUNCTION (this);
+
+    int32_t selected = SelectClass ();
+    if (selected < 0)
+    {
+        NS_LOG_LOGIC ("All the classes are empty");
+        return 0;
+    }
+
+    if (m_scheduler == SCHEDULER_DWRR)
+    {
+        // Give the quanta the round robin would give until the selected class
+        // can send: the classes visited before it in its round get one more
+        uint32_t rounds;
+        int32_t start = NextRoundRobin ();
+        selected = SelectRoundRobin (rounds);
+        for (uint64_t level = m_active & LevelMask (selected); level != 0; level &= level - 1)
+        {
+            int32_t i = LowestBit (level);
+            bool before = (selected >= start) ? (i >= start && i < selected) : (i >= start || i < selected);
+            m_classes[i].deficit += (rounds + (before ? 1 : 0)) * m_classes[i].weight;
+        }
+
+        Class &c = m_classes[selected];
+        c.deficit -= c.queue.front ().first->GetPacketSize ();
+        // Keep serving the class while it has packets and deficit
+        m_roundRobin[c.levelFirst] = (c.queue.size () > 1) ? selected : selected + 1;
+    }
+
+    Class &c = m_classes[selected];
+    Ptr<QueueDiscItem> item = c.queue.front ().first;
+    Time enqueueTime = c.queue.front ().second;
+    c.queue.pop_front ();
+    c.nBytes -= item->GetPacketSize ();
+
+    if (c.queue.empty ())
+    {
+        m_active &= ~(static_cast<uint64_t> (1) << selected);
+    }
+    else if (m_scheduler == SCHEDULER_WFQ)
+    {
+        c.headFinTime += c.queue.front ().first->GetPacketSize () / c.weight;
+        m_virtualTime[c.levelFirst] = std::max (m_virtualTime[c.levelFirst], c.headFinTime);
+    }
+
+    Time now = Simulator::Now ();
+    // Packets waited for the fluid backlog before being enqueued
+    Time sojournTime = now - enqueueTime + GetFluidDelay ();
+
+    bool instantaneousMarking = sojournTime > m_instantMarkingThreshold;
+    bool persistentMarking = false;
+
+    bool okToMark = OkToMark (c, sojournTime, now);
+    if (c.marking)
+    {
+        if (!okToMark)
+        {
+            c.marking = false;
+        }
+        else if (now >= c.markNext)
+        {
+            c.markCount++;
+            c.markNext = now + ControlLaw (c);
+            persistentMarking = true;
+        }
+    }
+    else if (okToMark)
+    {
+        c.marking = true;
+        c.markCount = 1;
+        c.markNext = now + m_persistentMarkingInterval;
+        persistentMarking = true;
+    }
+
+    if ((instantaneousMarking || persistentMarking) && !MarkingECN (item))
+    {
+        // The packet is not ECN capable, it is never dropped
+        NS_LOG_LOGIC ("Cannot mark ECN");
+    }
+
+    return item;
+}
+
+Ptr<const QueueDiscItem>
+MQECNSharpQueueDisc::DoPeek (void) const
+{
+    NS_LOG_FUNCTION (this);
+
+    int32_t selected = SelectClass ();
+    if (selected < 0)
+    {
+        return 0;
+    }
+    return m_classes[selected].queue.front ().first;
+}
+
+bool
+MQECNSharpQueueDisc::CheckConfig (void)
+{
+    NS_LOG_FUNCTION (this);
+    if (m_classes.empty ())
+    {
+        NS_LOG_ERROR ("MQECNSharpQueueDisc needs at least one class");
+        return false;
+    }
+    if (GetNInternalQueues () > 0 || GetNQueueDiscClasses () > 0)
+    {
+        NS_LOG_ERROR ("MQECNSharpQueueDisc cannot have internal queues or queue disc classes");
+        return false;
+    }
+    return true;
+}
+
+void
+MQECNSharpQueueDisc::InitializeParams (void)
+{
+    NS_LOG_FUNCTION (this);
+}
+
+bool
+MQECNSharpQueueDisc::OkToMark (Class &c, Time sojournTime, Time now)
+{
+    if (sojournTime < m_persistentMarkingTarget)
+    {
+        c.firstAboveTime = Time (0);
+        return false;
+    }
+    if (c.firstAboveTime == Time (0))
+    {
+        c.firstAboveTime = now + m_persistentMarkingInterval;
+    }
+    else if (now > c.firstAboveTime)
+    {
+        return true;
+    }
+    return false;
+}
+
+Time
+MQECNSharpQueueDisc::ControlLaw (const Class &c) const
+{
+    uint64_t timeStep = m_persistentMarkingInterval.GetTimeStep ();
+    timeStep = static_cast<uint64_t> (timeStep / sqrt (static_cast<double> (c.markCount)));
+    return TimeStep (timeStep);
+}
+
+bool
+MQECNSharpQueueDisc::MarkingECN (Ptr<QueueDiscItem> item)
+{
+    Ptr<Ipv4QueueDiscItem> ipv4Item = DynamicCast<Ipv4QueueDiscItem> (item);
+    if (ipv4Item == 0)
+    {
+        return false;
+    }
+
+    Ipv4Header header = ipv4Item->GetHeader ();
+    if (header.GetEcn () != Ipv4Header::ECN_ECT1)
+    {
+        return false;
+    }
+
+    header.SetEcn (Ipv4Header::ECN_CE);
+    ipv4Item->SetHeader (header);
+    return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,162 @@
+#ifndef MQ_ECN_SHARP_QUEUE_DISC_H
+#define MQ_ECN_SHARP_QUEUE_DISC_H
+
+#include "ns3/queue-disc.h"
+#include "ns3/queue.h"
+#include "ns3/nstime.h"
+#include <deque>
+#include <vector>
+#include <utility>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Multi-queue ECN# with a built-in scheduler.
+ *
+ * This queue disc behaves like a DWRRQueueDisc, WFQQueueDisc or
+ * SPQueueDisc whose classes are ECNSharpQueueDisc children, without the
+ * child queue disc objects: the classes live in one array, each with its
+ * FIFO of packets and enqueue times, its scheduler state and its ECN#
+ * persistent marking state. A bitmap of the non-empty classes selects the
+ * class to serve with a few bit operations.
+ *
+ * Classes are served by strict priority (a larger priority first); the
+ * classes of the same priority share the link according to the Scheduler:
+ * deficit round robin in class order with the weight as quantum in bytes,
+ * weighted fair queueing with the weight as the weight of the class, or
+ * strict order of the class numbers. The MaxPackets or MaxBytes limit
+ * applies to every class, like the limit of the ECN# children it replaces.
+ * At most 64 classes can be added.
+ */
+class MQECNSharpQueueDisc : public QueueDisc
+{
+public:
+
+    static TypeId GetTypeId (void);
+
+    /// Schedulers of the classes of the same priority
+    enum Scheduler
+    {
+        SCHEDULER_DWRR,     //!< Deficit weighted round robin
+        SCHEDULER_WFQ,      //!< Weighted fair queueing
+        SCHEDULER_SP        //!< Strict order of the class numbers
+    };
+
+    MQECNSharpQueueDisc ();
+
+    virtual ~MQECNSharpQueueDisc ();
+
+    /**
+     * Add a class with priority 0
+     * @param cl the class returned by the packet filters
+     * @param weight the DWRR quantum in bytes or the WFQ weight
+     */
+    void AddClass (int32_t cl, uint32_t weight);
+
+    /**
+     * Add a class
+     * @param cl the class returned by the packet filters
+     * @param priority the priority of the class, larger is served first
+     * @param weight the DWRR quantum in bytes or the WFQ weight
+     */
+    void AddClass (int32_t cl, uint32_t priority, uint32_t weight);
+
+    /**
+     * @param cl a class
+     * @return the number of packets queued in the class
+     */
+    uint32_t GetClassNPackets (int32_t cl) const;
+
+private:
+    /// A class of packets
+    struct Class
+    {
+        int32_t cl;                 //!< Class number
+        uint32_t priority;          //!< Strict priority
+        uint32_t weight;            //!< DWRR quantum or WFQ weight
+        uint32_t levelFirst;        //!< First class of the same priority
+        uint32_t levelLast;         //!< Last class of the same priority
+        std::deque<std::pair<Ptr<QueueDiscItem>, Time> > queue; //!< Packets and enqueue times
+        uint32_t nBytes;            //!< Bytes queued
+        uint32_t deficit;           //!< DWRR deficit
+        uint64_t headFinTime;       //!< WFQ finish time of the head packet
+        Time firstAboveTime;        //!< ECN# time to be above the target for the first time
+        bool marking;               //!< ECN# persistent marking state
+        Time markNext;              //!< ECN# next persistent marking time
+        uint32_t markCount;         //!< ECN# marks in the marking state
+    };
+
+    virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+    virtual Ptr<QueueDiscItem> DoDequeue (void);
+    virtual Ptr<const QueueDiscItem> DoPeek (void) const;
+    virtual bool CheckConfig (void);
+    virtual void InitializeParams (void);
+
+    /**
+     * @param index the index of a class
+     * @return the bitmap of the classes of its priority
+     */
+    uint64_t LevelMask (uint32_t index) const;
+
+    /**
+     * @return the index of the DWRR class at or after the round robin
+     * position of the highest active priority, -1 if all are empty
+     */
+    int32_t NextRoundRobin (void) const;
+
+    /**
+     * Find the DWRR class that can send first when the quanta are given
+     * in round robin from the current position
+     * @param rounds set to the number of quanta the selected class needs
+     * @return the index of the selected class, -1 if all are empty
+     */
+    int32_t SelectRoundRobin (uint32_t &rounds) const;
+
+    /**
+     * @return the index of the next class to serve, -1 if all are empty
+     */
+    int32_t SelectClass (void) const;
+
+    /**
+     * Whether the persistent marking should work
+     * @param c the class of the packet
+     * @param sojournTime the sojourn time of the packet
+     * @param now the current time
+     * @return true if it should be marked
+     */
+    bool OkToMark (Class &c, Time sojournTime, Time now);
+
+    /**
+     * @param c a class in the marking state
+     * @return the interval to the next persistent mark
+     */
+    Time ControlLaw (const Class &c) const;
+
+    /**
+     * Add ECN marking to the queue disc item
+     * @param item the item to mark
+     * @return true if it is successfully marked
+     */
+    bool MarkingECN (Ptr<QueueDiscItem> item);
+
+    Scheduler m_scheduler;                  //!< Scheduler of the classes of the same priority
+    uint32_t m_maxPackets;                  //!< Max # of packets accepted by a class
+    uint32_t m_maxBytes;                    //!< Max # of bytes accepted by a class
+    Queue::QueueMode m_mode;                //!< The operating mode (Bytes or packets)
+
+    Time m_instantMarkingThreshold;         //!< The instantaneous marking threshold
+    Time m_persistentMarkingInterval;       //!< The time interval used in persistent marking
+    Time m_persistentMarkingTarget;         //!< The time target used in persistent marking
+
+    std::vector<Class> m_classes;           //!< Classes by decreasing priority, then class number
+    std::vector<int32_t> m_index;           //!< Index of each class number, -1 if none
+    uint64_t m_active;                      //!< Bitmap of the non-empty classes
+    std::vector<uint32_t> m_roundRobin;     //!< DWRR position of each priority, by first class
+    std::vector<uint64_t> m_virtualTime;    //!< WFQ virtual time of each priority, by first class
+};
+
+} // namespace ns3
+
+#endif
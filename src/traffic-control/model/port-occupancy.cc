@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "port-occupancy.h"
+#include "traffic-control-layer.h"
+#include "queue-disc.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/queue.h"
+#include "ns3/pointer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PortOccupancy");
+
+NS_OBJECT_ENSURE_REGISTERED (PortOccupancy);
+
+TypeId
+PortOccupancy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PortOccupancy")
+    .SetParent<Object> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<PortOccupancy> ()
+  ;
+  return tid;
+}
+
+PortOccupancy::PortOccupancy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PortOccupancy::~PortOccupancy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PortOccupancy::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Connection>::iterator i = m_connections.begin (); i != m_connections.end (); ++i)
+    {
+      i->first->TraceDisconnectWithoutContext ("BytesInQueue", i->second);
+    }
+  m_connections.clear ();
+  m_bytes.clear ();
+  m_tracked.clear ();
+  Object::DoDispose ();
+}
+
+Ptr<PortOccupancy>
+PortOccupancy::Install (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (node);
+  Ptr<PortOccupancy> occupancy = node->GetObject<PortOccupancy> ();
+  if (occupancy == 0)
+    {
+      occupancy = CreateObject<PortOccupancy> ();
+      node->AggregateObject (occupancy);
+    }
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      occupancy->TrackDevice (node->GetDevice (i));
+    }
+  return occupancy;
+}
+
+void
+PortOccupancy::Reserve (uint32_t ifIndex)
+{
+  if (ifIndex >= m_bytes.size ())
+    {
+      m_bytes.resize (ifIndex + 1, 0);
+      m_tracked.resize (ifIndex + 1, false);
+    }
+}
+
+void
+PortOccupancy::TrackDevice (Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  uint32_t ifIndex = device->GetIfIndex ();
+  Reserve (ifIndex);
+  if (m_tracked[ifIndex])
+    {
+      return;
+    }
+  m_tracked[ifIndex] = true;
+
+  Callback<void, uint32_t, uint32_t> cb = MakeBoundCallback (&PortOccupancy::BytesInQueueChanged,
+                                                             this, ifIndex);
+
+  PointerValue txQueue;
+  if (device->GetAttributeFailSafe ("TxQueue", txQueue))
+    {
+      Ptr<Queue> queue = txQueue.Get<Queue> ();
+      if (queue != 0)
+        {
+          m_bytes[ifIndex] += queue->GetNBytes ();
+          queue->TraceConnectWithoutContext ("BytesInQueue", cb);
+          m_connections.push_back (std::make_pair (Ptr<Object> (queue), cb));
+        }
+    }
+
+  Ptr<TrafficControlLayer> tc = device->GetNode ()->GetObject<TrafficControlLayer> ();
+  if (tc != 0)
+    {
+      Ptr<QueueDisc> qd = tc->GetRootQueueDiscOnDevice (device);
+      if (qd != 0)
+        {
+          m_bytes[ifIndex] += qd->GetNBytes ();
+          qd->TraceConnectWithoutContext ("BytesInQueue", cb);
+          m_connections.push_back (std::make_pair (Ptr<Object> (qd), cb));
+        }
+    }
+}
+
+uint32_t
+PortOccupancy::GetNPorts (void) const
+{
+  return m_bytes.size ();
+}
+
+const uint32_t *
+PortOccupancy::GetNBytesArray (void) const
+{
+  return m_bytes.empty () ? 0 : &m_bytes[0];
+}
+
+void
+PortOccupancy::BytesInQueueChanged (PortOccupancy *self, uint32_t ifIndex,
+                                    uint32_t oldValue, uint32_t newValue)
+{
+  self->m_bytes[ifIndex] += newValue - oldValue;
+}
+
+} // namespace ns3
@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PORT_OCCUPANCY_H
+#define PORT_OCCUPANCY_H
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/callback.h"
+#include <vector>
+
+namespace ns3 {
+
+class Node;
+class NetDevice;
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Per-port byte occupancy of the transmission queues of a node.
+ *
+ * For every tracked device this object keeps the number of bytes stored in
+ * the root queue disc plus the number of bytes stored in the device
+ * transmission queue (the TxQueue attribute). The counters are updated by
+ * the BytesInQueue traced values of the queues, so they are always current
+ * and queue-aware load balancers can read them with a single array access
+ * instead of looking up the queues for every packet.
+ *
+ * The object is aggregated to the node by Install. The ports are the
+ * device indexes on the node.
+ */
+class PortOccupancy : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PortOccupancy ();
+  virtual ~PortOccupancy ();
+
+  /**
+   * Get the PortOccupancy aggregated to a node, creating it if needed, and
+   * track all the devices of the node. Call it after the queue discs have
+   * been installed: the root queue disc of a device is looked up when the
+   * device is tracked.
+   *
+   * \param node the node
+   * \return the PortOccupancy of the node
+   */
+  static Ptr<PortOccupancy> Install (Ptr<Node> node);
+
+  /**
+   * Track the queues of a device of the node this object is aggregated to.
+   * Tracking a device twice has no effect.
+   *
+   * \param device the device
+   */
+  void TrackDevice (Ptr<NetDevice> device);
+
+  /**
+   * \param ifIndex the device index on the node
+   * \return the number of bytes queued for transmission on the device
+   */
+  uint32_t GetNBytes (uint32_t ifIndex) const
+  {
+    return ifIndex < m_bytes.size () ? m_bytes[ifIndex] : 0;
+  }
+
+  /**
+   * \return the number of ports, i.e., the size of the array returned
+   * by GetNBytesArray
+   */
+  uint32_t GetNPorts (void) const;
+
+  /**
+   * \return the byte occupancy of all the ports, indexed by device index
+   */
+  const uint32_t * GetNBytesArray (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * Apply the change of a BytesInQueue traced value to a port counter.
+   * \param self the PortOccupancy
+   * \param ifIndex the device index
+   * \param oldValue the previous number of bytes in the queue
+   * \param newValue the current number of bytes in the queue
+   */
+  static void BytesInQueueChanged (PortOccupancy *self, uint32_t ifIndex,
+                                   uint32_t oldValue, uint32_t newValue);
+
+  /**
+   * Grow the counters to hold ifIndex
+   * \param ifIndex the device index
+   */
+  void Reserve (uint32_t ifIndex);
+
+  /// A BytesInQueue trace source and the callback connected to it
+  typedef std::pair<Ptr<Object>, Callback<void, uint32_t, uint32_t> > Connection;
+
+  std::vector<uint32_t> m_bytes;            //!< Bytes queued on each port
+  std::vector<bool> m_tracked;              //!< Whether each port is tracked
+  std::vector<Connection> m_connections;    //!< Connected trace sources
+};
+
+} // namespace ns3
+
+#endif /* PORT_OCCUPANCY_H */
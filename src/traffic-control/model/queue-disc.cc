@@ -24,6 +24,7 @@
 #include "ns3/object-vector.h"
 #include "ns3/packet.h"
 #include "ns3/unused.h"
+#include "ns3/pfc-ingress.h"
 #include "queue-disc.h"
 
 namespace ns3 {
@@ -179,6 +180,8 @@ QueueDisc::QueueDisc ()
      m_nTotalDroppedBytes (0),
      m_nTotalRequeuedPackets (0),
      m_nTotalRequeuedBytes (0),
+     m_fluidBytes (0),
+     m_fluidDelay (Seconds (0)),
      m_running (false)
 {
   NS_LOG_FUNCTION (this);
@@ -280,6 +283,26 @@ QueueDisc:: GetTotalRequeuedBytes (void) const
   return m_nTotalRequeuedBytes;
 }
 
+void
+QueueDisc::SetFluidBacklog (uint32_t bytes, Time delay)
+{
+  NS_LOG_FUNCTION (this << bytes << delay);
+  m_fluidBytes = bytes;
+  m_fluidDelay = delay;
+}
+
+uint32_t
+QueueDisc::GetFluidBytes (void) const
+{
+  return m_fluidBytes;
+}
+
+Time
+QueueDisc::GetFluidDelay (void) const
+{
+  return m_fluidDelay;
+}
+
 void
 QueueDisc::SetNetDevice (Ptr<NetDevice> device)
 {
@@ -405,6 +428,8 @@ QueueDisc::Drop (Ptr<QueueDiscItem> item)
 
   NS_LOG_LOGIC ("m_traceDrop (p)");
   m_traceDrop (item);
+  // a parent reports again the drops of its children, the tag is gone by then
+  PfcIngress::Release (item->GetPacket (), 0);
 }
 
 bool
@@ -22,6 +22,7 @@
 
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
+#include "ns3/nstime.h"
 #include <ns3/queue.h>
 #include "ns3/net-device.h"
 #include <vector>
@@ -274,6 +275,33 @@ public:
    */
   uint32_t GetTotalRequeuedBytes (void) const;
 
+  /**
+   * \brief Set the backlog of the fluid flows crossing this queue disc
+   *
+   * Flows simulated as fluid rates (see FluidFlowManager) send no packets,
+   * but they do occupy the queue of a congested port. Their backlog is not
+   * counted by GetNPackets and GetNBytes: it is added by the queue discs
+   * which support it to the queue length (RED) or to the sojourn time (TCN,
+   * ECNSharp) they mark on, and by the TrafficControlLayer, which holds the
+   * packets for the fluid delay before enqueuing them.
+   *
+   * \param bytes the fluid backlog in bytes
+   * \param delay the time needed to drain the fluid backlog
+   */
+  void SetFluidBacklog (uint32_t bytes, Time delay);
+
+  /**
+   * \brief Get the backlog of the fluid flows crossing this queue disc
+   * \return the fluid backlog in bytes.
+   */
+  uint32_t GetFluidBytes (void) const;
+
+  /**
+   * \brief Get the time needed to drain the backlog of the fluid flows
+   * \return the fluid queueing delay.
+   */
+  Time GetFluidDelay (void) const;
+
   /**
    * \brief Set the NetDevice on which this queue discipline is installed.
    * \param device the NetDevice on which this queue discipline is installed.
@@ -528,6 +556,8 @@ private:
   uint32_t m_nTotalDroppedBytes;    //!< Total dropped bytes
   uint32_t m_nTotalRequeuedPackets; //!< Total requeued packets
   uint32_t m_nTotalRequeuedBytes;   //!< Total requeued bytes
+  uint32_t m_fluidBytes;            //!< Backlog of the fluid flows in bytes
+  Time m_fluidDelay;                //!< Queueing delay of the fluid backlog
   uint32_t m_quota;                 //!< Maximum number of packets dequeued in a qdisc run
   Ptr<NetDevice> m_device;          //!< The NetDevice on which this queue discipline is installed
   Ptr<NetDeviceQueueInterface> m_devQueueIface;   //!< NetDevice queue interface
@@ -386,6 +386,15 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       nQueued = GetInternalQueue (0)->GetNPackets ();
     }
 
+  // The backlog of the fluid flows is part of the queue the marking decision
+  // is based on, but the packets are not stored here: the queue limit below
+  // keeps applying to the physical queue only
+  uint32_t nFluid = GetFluidBytes ();
+  if (nFluid > 0 && GetMode () == Queue::QUEUE_MODE_PACKETS)
+    {
+      nFluid = static_cast<uint32_t> (nFluid / m_meanPktSize);
+    }
+
   // simulate number of packets arrival during idle period
   //uint32_t m = 0;
 
@@ -410,7 +419,7 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   */
 
   //m_qAvg = Estimator (nQueued, m + 1, m_qAvg, m_qW);
-  m_qAvg = nQueued;
+  m_qAvg = nQueued + nFluid;
 
   NS_LOG_DEBUG ("\t bytesInQueue  " << GetInternalQueue (0)->GetNBytes () << "\tQavg " << m_qAvg);
   NS_LOG_DEBUG ("\t packetsInQueue  " << GetInternalQueue (0)->GetNPackets () << "\tQavg " << m_qAvg);
@@ -419,7 +428,7 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   m_countBytes += item->GetPacketSize ();
 
   uint32_t dropType = DTYPE_NONE;
-  if (m_qAvg >= m_minTh && nQueued > 1)
+  if (m_qAvg >= m_minTh && nQueued + nFluid > 1)
     {
       if ((!m_isGentle && m_qAvg >= m_maxTh) ||
           (m_isGentle && m_qAvg >= 2 * m_maxTh))
@@ -0,0 +1,283 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "shared-buffer-manager.h"
+#include "queue-disc.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/ipv4-queue-disc-item.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SharedBufferManager");
+
+NS_OBJECT_ENSURE_REGISTERED (SharedBufferManager);
+
+TypeId
+SharedBufferManager::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SharedBufferManager")
+    .SetParent<Object> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<SharedBufferManager> ()
+    .AddAttribute ("BufferSize",
+                   "The size of the shared buffer in bytes",
+                   UintegerValue (9 * 1024 * 1024),
+                   MakeUintegerAccessor (&SharedBufferManager::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Policy",
+                   "The admission policy",
+                   EnumValue (DYNAMIC_THRESHOLD),
+                   MakeEnumAccessor (&SharedBufferManager::m_policy),
+                   MakeEnumChecker (STATIC, "Static",
+                                    DYNAMIC_THRESHOLD, "DynamicThreshold",
+                                    PRIORITY_RESERVATION, "PriorityReservation"))
+    .AddAttribute ("Alpha",
+                   "The share of the free buffer a port (or a port and priority) may use",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&SharedBufferManager::m_alpha),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("StaticThreshold",
+                   "The per-port limit in bytes of the Static policy, 0 to split the buffer evenly",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&SharedBufferManager::m_staticThreshold),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ReservedBytes",
+                   "The bytes reserved to every port and priority by the PriorityReservation policy",
+                   UintegerValue (3000),
+                   MakeUintegerAccessor (&SharedBufferManager::m_reservedBytes),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("NPriorities",
+                   "The number of priorities",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&SharedBufferManager::m_nPriorities),
+                   MakeUintegerChecker<uint32_t> (1, 8))
+    .AddTraceSource ("Occupancy",
+                     "Number of bytes in the shared buffer",
+                     MakeTraceSourceAccessor (&SharedBufferManager::m_occupancy),
+                     "ns3::TracedValueCallback::Uint32")
+    .AddTraceSource ("Drop",
+                     "A packet rejected by the admission policy",
+                     MakeTraceSourceAccessor (&SharedBufferManager::m_traceDrop),
+                     "ns3::SharedBufferManager::DropTracedCallback")
+  ;
+  return tid;
+}
+
+SharedBufferManager::SharedBufferManager ()
+  : m_bufferSize (9 * 1024 * 1024),
+    m_policy (DYNAMIC_THRESHOLD),
+    m_alpha (1.0),
+    m_staticThreshold (0),
+    m_reservedBytes (3000),
+    m_nPriorities (8),
+    m_nPorts (0),
+    m_occupancy (0),
+    m_sharedOccupancy (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SharedBufferManager::~SharedBufferManager ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+SharedBufferManager::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t port = 0; port < m_queueDiscs.size (); port++)
+    {
+      if (m_queueDiscs[port] != 0)
+        {
+          Callback<void, Ptr<const QueueItem> > in = MakeBoundCallback (&SharedBufferManager::PacketIn, this, port);
+          Callback<void, Ptr<const QueueItem> > out = MakeBoundCallback (&SharedBufferManager::PacketOut, this, port);
+          m_queueDiscs[port]->TraceDisconnectWithoutContext ("Enqueue", in);
+          m_queueDiscs[port]->TraceDisconnectWithoutContext ("Requeue", in);
+          m_queueDiscs[port]->TraceDisconnectWithoutContext ("Dequeue", out);
+          m_queueDiscs[port]->TraceDisconnectWithoutContext ("Drop", out);
+        }
+    }
+  m_queueDiscs.clear ();
+  Object::DoDispose ();
+}
+
+void
+SharedBufferManager::Reserve (uint32_t port)
+{
+  if (port < m_nPorts)
+    {
+      return;
+    }
+  m_nPorts = port + 1;
+  m_portBytes.resize (m_nPorts, 0);
+  m_portPrioBytes.resize (m_nPorts * m_nPriorities, 0);
+  m_dropPackets.resize (m_nPorts, 0);
+  m_dropBytes.resize (m_nPorts, 0);
+  m_queueDiscs.resize (m_nPorts);
+}
+
+void
+SharedBufferManager::AttachQueueDisc (Ptr<QueueDisc> qd, uint32_t port)
+{
+  NS_LOG_FUNCTION (this << qd << port);
+  Reserve (port);
+  NS_ASSERT_MSG (m_queueDiscs[port] == 0, "A queue disc is already attached to port " << port);
+  NS_ASSERT_MSG (qd->GetNBytes () == 0, "Attach the queue disc before it stores packets");
+  m_queueDiscs[port] = qd;
+
+  // The traces of the queue disc hold the item as a QueueItem
+  Callback<void, Ptr<const QueueItem> > in = MakeBoundCallback (&SharedBufferManager::PacketIn, this, port);
+  Callback<void, Ptr<const QueueItem> > out = MakeBoundCallback (&SharedBufferManager::PacketOut, this, port);
+  qd->TraceConnectWithoutContext ("Enqueue", in);
+  qd->TraceConnectWithoutContext ("Requeue", in);
+  qd->TraceConnectWithoutContext ("Dequeue", out);
+  qd->TraceConnectWithoutContext ("Drop", out);
+}
+
+uint32_t
+SharedBufferManager::GetPriority (Ptr<const QueueDiscItem> item) const
+{
+  Ptr<const Ipv4QueueDiscItem> ipv4Item = DynamicCast<const Ipv4QueueDiscItem> (item);
+  if (ipv4Item == 0)
+    {
+      return 0;
+    }
+  uint32_t priority = ipv4Item->GetHeader ().GetTos () >> 5;
+  return priority < m_nPriorities ? priority : m_nPriorities - 1;
+}
+
+uint32_t
+SharedBufferManager::SharedUse (uint32_t port, uint32_t priority) const
+{
+  uint32_t bytes = m_portPrioBytes[port * m_nPriorities + priority];
+  if (m_policy != PRIORITY_RESERVATION)
+    {
+      return bytes;
+    }
+  return bytes > m_reservedBytes ? bytes - m_reservedBytes : 0;
+}
+
+void
+SharedBufferManager::Account (uint32_t port, uint32_t priority, int64_t bytes)
+{
+  Reserve (port);
+  uint32_t sharedBefore = SharedUse (port, priority);
+  m_portPrioBytes[port * m_nPriorities + priority] += bytes;
+  m_portBytes[port] += bytes;
+  m_occupancy += bytes;
+  m_sharedOccupancy += SharedUse (port, priority) - sharedBefore;
+}
+
+void
+SharedBufferManager::PacketIn (SharedBufferManager *self, uint32_t port, Ptr<const QueueItem> item)
+{
+  self->Account (port, self->GetPriority (StaticCast<const QueueDiscItem> (item)), item->GetPacketSize ());
+}
+
+void
+SharedBufferManager::PacketOut (SharedBufferManager *self, uint32_t port, Ptr<const QueueItem> item)
+{
+  self->Account (port, self->GetPriority (StaticCast<const QueueDiscItem> (item)),
+                 -static_cast<int64_t> (item->GetPacketSize ()));
+}
+
+bool
+SharedBufferManager::Admit (uint32_t port, Ptr<const QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << port << item);
+  Reserve (port);
+  uint32_t size = item->GetPacketSize ();
+  uint32_t priority = GetPriority (item);
+
+  bool admit = m_occupancy + size <= m_bufferSize;
+  if (admit)
+    {
+      switch (m_policy)
+        {
+        case STATIC:
+          {
+            uint32_t threshold = m_staticThreshold > 0 ? m_staticThreshold : m_bufferSize / m_nPorts;
+            admit = m_portBytes[port] + size <= threshold;
+            break;
+          }
+        case DYNAMIC_THRESHOLD:
+          admit = m_portBytes[port] + size <= m_alpha * (m_bufferSize - m_occupancy);
+          break;
+        case PRIORITY_RESERVATION:
+          {
+            uint32_t bytes = m_portPrioBytes[port * m_nPriorities + priority];
+            if (bytes + size > m_reservedBytes)
+              {
+                // Part of the packet goes to the shared pool
+                uint64_t reserved = static_cast<uint64_t> (m_reservedBytes) * m_nPriorities * m_nPorts;
+                uint64_t shared = m_bufferSize > reserved ? m_bufferSize - reserved : 0;
+                uint64_t freeShared = shared > m_sharedOccupancy ? shared - m_sharedOccupancy : 0;
+                uint32_t sharedUse = SharedUse (port, priority);
+                uint32_t sharedAfter = bytes + size - m_reservedBytes;
+                admit = sharedAfter - sharedUse <= freeShared
+                  && sharedAfter <= m_alpha * freeShared;
+              }
+            break;
+          }
+        }
+    }
+
+  if (!admit)
+    {
+      NS_LOG_LOGIC ("Port " << port << " priority " << priority << " rejects " << size
+                    << " bytes, port holds " << m_portBytes[port] << ", buffer holds " << m_occupancy);
+      m_dropPackets[port]++;
+      m_dropBytes[port] += size;
+      m_traceDrop (item, port);
+    }
+  return admit;
+}
+
+uint32_t
+SharedBufferManager::GetOccupancy (void) const
+{
+  return m_occupancy;
+}
+
+uint32_t
+SharedBufferManager::GetPortOccupancy (uint32_t port) const
+{
+  return port < m_nPorts ? m_portBytes[port] : 0;
+}
+
+uint32_t
+SharedBufferManager::GetPortOccupancy (uint32_t port, uint32_t priority) const
+{
+  return port < m_nPorts && priority < m_nPriorities ? m_portPrioBytes[port * m_nPriorities + priority] : 0;
+}
+
+uint64_t
+SharedBufferManager::GetNDroppedPackets (uint32_t port) const
+{
+  return port < m_nPorts ? m_dropPackets[port] : 0;
+}
+
+uint64_t
+SharedBufferManager::GetNDroppedBytes (uint32_t port) const
+{
+  return port < m_nPorts ? m_dropBytes[port] : 0;
+}
+
+} // namespace ns3
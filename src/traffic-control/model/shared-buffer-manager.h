@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SHARED_BUFFER_MANAGER_H
+#define SHARED_BUFFER_MANAGER_H
+
+#include "ns3/object.h"
+#include "ns3/traced-value.h"
+#include "ns3/traced-callback.h"
+#include <vector>
+
+namespace ns3 {
+
+class QueueDisc;
+class QueueItem;
+class QueueDiscItem;
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A packet buffer shared by all the ports of a switch.
+ *
+ * Switching chips do not give each port a private buffer: all the egress
+ * queues draw from one memory and an admission policy decides how much of
+ * it a single port may hold. Once set on a TrafficControlLayer, this object
+ * is consulted by TrafficControlLayer::Send before a packet is handed to the
+ * root queue disc of a port. A rejected packet is dropped before reaching
+ * the queue disc, so the AQMs work unchanged on the admitted packets.
+ *
+ * The occupancy of each port is accounted per priority through the
+ * Enqueue, Requeue, Dequeue and Drop traces of the root queue discs. The
+ * priority of a packet is the class selector of its IPv4 DSCP (the three
+ * most significant bits of the TOS), 0 for non IPv4 packets.
+ *
+ * Three admission policies are available:
+ *
+ * - STATIC: a port may hold up to StaticThreshold bytes (BufferSize divided
+ *   by the number of ports if 0).
+ * - DYNAMIC_THRESHOLD: a port may hold up to Alpha times the free buffer
+ *   (Choudhury and Hahne dynamic thresholds).
+ * - PRIORITY_RESERVATION: every (port, priority) pair has ReservedBytes of
+ *   guaranteed buffer; beyond it, the pair may hold up to Alpha times the
+ *   free shared buffer, i.e., the buffer which is not reserved.
+ *
+ * In all cases the total occupancy never exceeds BufferSize.
+ */
+class SharedBufferManager : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// Admission policies
+  enum Policy
+  {
+    STATIC,                 //!< Fixed per-port threshold
+    DYNAMIC_THRESHOLD,      //!< Per-port threshold proportional to the free buffer
+    PRIORITY_RESERVATION    //!< Per-port, per-priority reservation plus dynamic sharing
+  };
+
+  SharedBufferManager ();
+  virtual ~SharedBufferManager ();
+
+  /**
+   * Account for the packets of a root queue disc.
+   * \param qd the root queue disc
+   * \param port the index of the device the queue disc is installed on
+   */
+  void AttachQueueDisc (Ptr<QueueDisc> qd, uint32_t port);
+
+  /**
+   * Decide whether a packet may be enqueued on a port. If not, the drop is
+   * counted and reported by the Drop trace.
+   *
+   * \param port the device index
+   * \param item the packet
+   * \return true if the packet is admitted
+   */
+  bool Admit (uint32_t port, Ptr<const QueueDiscItem> item);
+
+  /**
+   * \param item a packet
+   * \return the priority used to account for the packet
+   */
+  uint32_t GetPriority (Ptr<const QueueDiscItem> item) const;
+
+  /**
+   * \return the number of bytes stored in the buffer
+   */
+  uint32_t GetOccupancy (void) const;
+
+  /**
+   * \param port the device index
+   * \return the number of bytes stored for the port
+   */
+  uint32_t GetPortOccupancy (uint32_t port) const;
+
+  /**
+   * \param port the device index
+   * \param priority the priority
+   * \return the number of bytes stored for the port with this priority
+   */
+  uint32_t GetPortOccupancy (uint32_t port, uint32_t priority) const;
+
+  /**
+   * \param port the device index
+   * \return the number of packets of the port rejected by the admission
+   */
+  uint64_t GetNDroppedPackets (uint32_t port) const;
+
+  /**
+   * \param port the device index
+   * \return the number of bytes of the port rejected by the admission
+   */
+  uint64_t GetNDroppedBytes (uint32_t port) const;
+
+  /**
+   * TracedCallback signature for admission drops.
+   * \param [in] item the dropped packet
+   * \param [in] port the device index
+   */
+  typedef void (* DropTracedCallback)(Ptr<const QueueDiscItem> item, uint32_t port);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * Add a signed number of bytes to the occupancy of a port
+   * \param port the device index
+   * \param priority the priority
+   * \param bytes the number of bytes, negative when packets leave
+   */
+  void Account (uint32_t port, uint32_t priority, int64_t bytes);
+
+  /**
+   * Trace sink for packets entering a queue disc
+   * \param self the SharedBufferManager
+   * \param port the device index
+   * \param item the packet
+   */
+  static void PacketIn (SharedBufferManager *self, uint32_t port, Ptr<const QueueItem> item);
+  /**
+   * Trace sink for packets leaving a queue disc
+   * \param self the SharedBufferManager
+   * \param port the device index
+   * \param item the packet
+   */
+  static void PacketOut (SharedBufferManager *self, uint32_t port, Ptr<const QueueItem> item);
+
+  /**
+   * Grow the per-port state to hold port
+   * \param port the device index
+   */
+  void Reserve (uint32_t port);
+
+  /**
+   * \param port the device index
+   * \param priority the priority
+   * \return the bytes of the pair above its reservation
+   */
+  uint32_t SharedUse (uint32_t port, uint32_t priority) const;
+
+  uint32_t m_bufferSize;                  //!< Size of the buffer in bytes
+  Policy m_policy;                        //!< Admission policy
+  double m_alpha;                         //!< Dynamic threshold factor
+  uint32_t m_staticThreshold;             //!< Per-port limit of the STATIC policy
+  uint32_t m_reservedBytes;               //!< Per-port, per-priority reservation
+  uint32_t m_nPriorities;                 //!< Number of priorities
+
+  uint32_t m_nPorts;                      //!< Number of ports
+  TracedValue<uint32_t> m_occupancy;      //!< Bytes in the buffer
+  uint32_t m_sharedOccupancy;             //!< Bytes beyond the reservations
+  std::vector<uint32_t> m_portBytes;      //!< Bytes per port
+  std::vector<uint32_t> m_portPrioBytes;  //!< Bytes per port and priority
+  std::vector<uint64_t> m_dropPackets;    //!< Rejected packets per port
+  std::vector<uint64_t> m_dropBytes;      //!< Rejected bytes per port
+  std::vector<Ptr<QueueDisc> > m_queueDiscs; //!< Attached root queue discs
+
+  TracedCallback<Ptr<const QueueDiscItem>, uint32_t> m_traceDrop; //!< Admission drops
+};
+
+} // namespace ns3
+
+#endif /* SHARED_BUFFER_MANAGER_H */
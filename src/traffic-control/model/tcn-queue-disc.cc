@@ -186,7 +186,8 @@ TCNQueueDisc::DoDequeue (void)
         return NULL;
     }
 
-    Time sojournTime = now - tag.GetTxTime ();
+    // Packets waited for the fluid backlog before being enqueued
+    Time sojournTime = now - tag.GetTxTime () + GetFluidDelay ();
 
     if (sojournTime > m_threshold)
     {
@@ -22,6 +22,11 @@
 #include "ns3/object-vector.h"
 #include "ns3/packet.h"
 #include "ns3/queue-disc.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/pfc-ingress.h"
+#include "shared-buffer-manager.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -40,6 +45,11 @@ TrafficControlLayer::GetTypeId (void)
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&TrafficControlLayer::m_rootQueueDiscs),
                    MakeObjectVectorChecker<QueueDisc> ())
+    .AddAttribute ("SharedBuffer", "The buffer shared by the root queue discs, if any.",
+                   PointerValue (),
+                   MakePointerAccessor (&TrafficControlLayer::SetSharedBuffer,
+                                        &TrafficControlLayer::GetSharedBuffer),
+                   MakePointerChecker<SharedBufferManager> ())
   ;
   return tid;
 }
@@ -64,6 +74,12 @@ TrafficControlLayer::DoDispose (void)
   m_rootQueueDiscs.clear ();
   m_handlers.clear ();
   m_netDeviceQueueToQueueDiscMap.clear ();
+  m_fluidRelease.clear ();
+  if (m_sharedBuffer != 0)
+    {
+      m_sharedBuffer->Dispose ();
+      m_sharedBuffer = 0;
+    }
   Object::DoDispose ();
 }
 
@@ -109,6 +125,11 @@ TrafficControlLayer::DoInitialize (void)
                 }
             }
 
+          if (m_sharedBuffer != 0)
+            {
+              m_sharedBuffer->AttachQueueDisc (m_rootQueueDiscs[j], j);
+            }
+
           // initialize the queue disc
           m_rootQueueDiscs[j]->Initialize ();
         }
@@ -116,6 +137,19 @@ TrafficControlLayer::DoInitialize (void)
   Object::DoInitialize ();
 }
 
+void
+TrafficControlLayer::SetSharedBuffer (Ptr<SharedBufferManager> sharedBuffer)
+{
+  NS_LOG_FUNCTION (this << sharedBuffer);
+  m_sharedBuffer = sharedBuffer;
+}
+
+Ptr<SharedBufferManager>
+TrafficControlLayer::GetSharedBuffer (void) const
+{
+  return m_sharedBuffer;
+}
+
 void
 TrafficControlLayer::SetupDevice (Ptr<NetDevice> device)
 {
@@ -298,7 +332,15 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
       if (!devQueueIface->GetTxQueue (txq)->IsStopped ())
         {
           item->AddHeader ();
-          device->Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ());
+          if (!device->Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ()))
+            {
+              // the packet is dropped, there is no queue disc to requeue it
+              PfcIngress::Release (item->GetPacket (), m_node);
+            }
+        }
+      else
+        {
+          PfcIngress::Release (item->GetPacket (), m_node);
         }
     }
   else
@@ -309,9 +351,47 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
 
       Ptr<QueueDisc> qDisc = qdMap->second.second[txq];
       NS_ASSERT (qDisc);
-      qDisc->Enqueue (item);
-      qDisc->Run ();
+
+      Time fluidDelay = qDisc->GetFluidDelay ();
+      if (fluidDelay.IsStrictlyPositive ())
+        {
+          // The packet queues behind the backlog of the fluid flows. Packets
+          // are released in order even if the fluid delay has decreased
+          Time release = Simulator::Now () + fluidDelay;
+          std::map<Ptr<QueueDisc>, Time>::iterator it = m_fluidRelease.find (qDisc);
+          if (it == m_fluidRelease.end ())
+            {
+              m_fluidRelease[qDisc] = release;
+            }
+          else
+            {
+              release = std::max (release, it->second);
+              it->second = release;
+            }
+          NS_LOG_LOGIC ("Holding the packet for the fluid backlog until " << release);
+          Simulator::Schedule (release - Simulator::Now (), &TrafficControlLayer::Enqueue,
+                               this, device, qDisc, item);
+          return;
+        }
+
+      Enqueue (device, qDisc, item);
+    }
+}
+
+void
+TrafficControlLayer::Enqueue (Ptr<NetDevice> device, Ptr<QueueDisc> qDisc, Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << device << qDisc << item);
+
+  if (m_sharedBuffer != 0 && !m_sharedBuffer->Admit (device->GetIfIndex (), item))
+    {
+      NS_LOG_LOGIC ("No room in the shared buffer, packet dropped");
+      PfcIngress::Release (item->GetPacket (), m_node);
+      return;
     }
+
+  qDisc->Enqueue (item);
+  qDisc->Run ();
 }
 
 } // namespace ns3
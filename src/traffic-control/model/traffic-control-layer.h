@@ -31,6 +31,7 @@ namespace ns3 {
 
 class Packet;
 class QueueDiscItem;
+class SharedBufferManager;
 
 /**
  * \ingroup traffic-control
@@ -157,6 +158,23 @@ public:
    */
   virtual void DeleteRootQueueDiscOnDevice (Ptr<NetDevice> device);
 
+  /**
+   * \brief Share a packet buffer among the root queue discs of this node
+   *
+   * The shared buffer manager decides whether each packet sent to a device
+   * may be enqueued in the root queue disc of the device. The root queue
+   * discs are attached to the manager when this layer is initialized.
+   *
+   * \param sharedBuffer the shared buffer manager, 0 to disable sharing
+   */
+  void SetSharedBuffer (Ptr<SharedBufferManager> sharedBuffer);
+
+  /**
+   * \brief Get the shared buffer manager of this node
+   * \return the shared buffer manager, 0 if the queue discs have private buffers
+   */
+  Ptr<SharedBufferManager> GetSharedBuffer (void) const;
+
   /**
    * \brief Set node associated with this stack.
    * \param node node to set
@@ -229,6 +247,14 @@ private:
    */
   uint32_t GetDeviceIndex (Ptr<NetDevice> device);
 
+  /**
+   * \brief Enqueue a packet in a root queue disc and run the queue disc
+   * \param device the device the packet must be sent to
+   * \param qDisc the queue disc
+   * \param item the packet
+   */
+  void Enqueue (Ptr<NetDevice> device, Ptr<QueueDisc> qDisc, Ptr<QueueDiscItem> item);
+
   /// The node this TrafficControlLayer object is aggregated to
   Ptr<Node> m_node;
   /// This vector stores the root queue discs installed on all the devices of the node.
@@ -237,6 +263,9 @@ private:
   /// This map plays the role of the qdisc field of the netdev_queue struct in Linux
   std::map<Ptr<NetDevice>, NetDeviceInfo> m_netDeviceQueueToQueueDiscMap;
   ProtocolHandlerList m_handlers;  //!< List of upper-layer handlers
+  Ptr<SharedBufferManager> m_sharedBuffer; //!< Buffer shared by the root queue discs
+  /// Time the last packet held for the fluid backlog is enqueued, per queue disc
+  std::map<Ptr<QueueDisc>, Time> m_fluidRelease;
 };
 
 } // namespace ns3
@@ -1,6 +1,9 @@
 #include "ns3/log.h"
 #include "wfq-queue-disc.h"
 #include "ns3/ipv4-queue-disc-item.h"
+#include <algorithm>
+
+#define MAX_WFQ_PRIORITIES 64
 
 namespace ns3 {
 
@@ -20,6 +23,8 @@ WFQClass::GetTypeId (void)
 }
 
 WFQClass::WFQClass ()
+    : cl (0),
+      level (0)
 {
     NS_LOG_FUNCTION (this);
 }
@@ -28,7 +33,7 @@ TypeId
 WFQQueueDisc::GetTypeId (void)
 {
     static TypeId tid = TypeId ("ns3::WFQQueueDisc")
-      .SetParent<Object> ()
+      .SetParent<QueueDisc> ()
       .SetGroupName ("TrafficControl")
       .AddConstructor<WFQQueueDisc> ()
     ;
@@ -36,6 +41,7 @@ WFQQueueDisc::GetTypeId (void)
 }
 
 WFQQueueDisc::WFQQueueDisc ()
+    : m_activeLevels (0)
 {
     NS_LOG_FUNCTION (this);
 }
@@ -60,7 +66,50 @@ WFQQueueDisc::AddWFQClass (Ptr<QueueDisc> qdisc, int32_t cl, uint32_t priority,
     wfqClass->headFinTime = 0;
     wfqClass->lengthBytes = 0;
     wfqClass->weight = weight;
+    wfqClass->cl = cl;
     m_WFQs[cl] = wfqClass;
+
+    NS_ASSERT_MSG (m_activeLevels == 0, "Classes must be added before packets are enqueued");
+    if (!std::binary_search (m_priorities.begin (), m_priorities.end (), priority))
+    {
+        NS_ASSERT_MSG (m_priorities.size () < MAX_WFQ_PRIORITIES, "Too many priorities");
+        m_priorities.insert (std::upper_bound (m_priorities.begin (), m_priorities.end (), priority), priority);
+        m_heaps.assign (m_priorities.size (), std::vector<HeapEntry> ());
+    }
+    std::map<int32_t, Ptr<WFQClass> >::iterator itr = m_WFQs.begin ();
+    for ( ; itr != m_WFQs.end (); ++itr)
+    {
+        itr->second->level = std::lower_bound (m_priorities.begin (), m_priorities.end (),
+                                               itr->second->priority) - m_priorities.begin ();
+    }
+}
+
+void
+WFQQueueDisc::Push (WFQClass *wfqClass)
+{
+    std::vector<HeapEntry> &heap = m_heaps[wfqClass->level];
+    HeapEntry entry = { wfqClass->headFinTime, wfqClass->cl, wfqClass };
+    heap.push_back (entry);
+    std::push_heap (heap.begin (), heap.end (), HeapOrder ());
+    m_activeLevels |= static_cast<uint64_t> (1) << wfqClass->level;
+}
+
+void
+WFQQueueDisc::Pop (uint32_t level)
+{
+    std::vector<HeapEntry> &heap = m_heaps[level];
+    std::pop_heap (heap.begin (), heap.end (), HeapOrder ());
+    heap.pop_back ();
+    if (heap.empty ())
+    {
+        m_activeLevels &= ~(static_cast<uint64_t> (1) << level);
+    }
+}
+
+uint32_t
+WFQQueueDisc::GetHighestLevel (void) const
+{
+    return 63 - __builtin_clzll (m_activeLevels);
 }
 
 bool
@@ -114,6 +163,10 @@ WFQQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
         m_virtualTime[wfqClass->priority] = wfqClass->headFinTime;
     }
 
+    if (wfqClass->lengthBytes == 0)
+    {
+        Push (PeekPointer (wfqClass));
+    }
     wfqClass->lengthBytes += length;
 
     return true;
@@ -124,45 +177,16 @@ WFQQueueDisc::DoDequeue (void)
 {
     NS_LOG_FUNCTION (this);
 
-    int32_t highestPriority = -1;
-    std::map<int32_t, Ptr<WFQClass> >::const_iterator itr = m_WFQs.begin ();
-
     // Strict priority scheduling
-    for (; itr != m_WFQs.end (); ++itr)
-    {
-        Ptr<WFQClass> wfqClass = itr->second;
-        if (static_cast<int32_t> (wfqClass->priority) > highestPriority
-                && wfqClass->lengthBytes > 0)
-        {
-            highestPriority = static_cast<int32_t> (wfqClass->priority);
-        }
-    }
-
-    if (highestPriority == -1)
+    if (m_activeLevels == 0)
     {
         NS_LOG_LOGIC ("Cannot find active queue");
         return 0;
     }
 
-    // Find the smallest head finish time
-    uint64_t smallestHeadFinTime = 0;
-    Ptr<WFQClass> wfqClassToDequeue = 0;
-
-    itr = m_WFQs.begin ();
-    for (; itr != m_WFQs.end (); ++itr)
-    {
-        Ptr<WFQClass> wfqClass = itr->second;
-        if (static_cast<int32_t> (wfqClass->priority) != highestPriority
-                || wfqClass->lengthBytes == 0)
-        {
-            continue;
-        }
-        if (wfqClassToDequeue == 0 || wfqClass->headFinTime < smallestHeadFinTime)
-        {
-            wfqClassToDequeue = wfqClass;
-            smallestHeadFinTime = wfqClass->headFinTime;
-        }
-    }
+    // The smallest head finish time is on top of the heap
+    uint32_t level = GetHighestLevel ();
+    WFQClass *wfqClassToDequeue = m_heaps[level].front ().wfqClass;
 
     Ptr<const QueueDiscItem> item = wfqClassToDequeue->qdisc->Peek ();
 
@@ -188,6 +212,7 @@ WFQQueueDisc::DoDequeue (void)
     }
 
     wfqClassToDequeue->lengthBytes -= ipv4Item->GetPacketSize ();
+    Pop (level);
 
     if (wfqClassToDequeue->lengthBytes > 0)
     {
@@ -207,6 +232,8 @@ WFQQueueDisc::DoDequeue (void)
         {
             m_virtualTime[wfqClassToDequeue->priority] = wfqClassToDequeue->headFinTime;
         }
+
+        Push (wfqClassToDequeue);
     }
 
     return retItem;
@@ -217,47 +244,15 @@ WFQQueueDisc::DoPeek (void) const
 {
     NS_LOG_FUNCTION (this);
 
-    int32_t highestPriority = -1;
-    std::map<int32_t, Ptr<WFQClass> >::const_iterator itr = m_WFQs.begin ();
-
     // Strict priority scheduling
-    for (; itr != m_WFQs.end (); ++itr)
-    {
-        Ptr<WFQClass> wfqClass = itr->second;
-        if (static_cast<int32_t> (wfqClass->priority) > highestPriority
-                && wfqClass->lengthBytes > 0)
-        {
-            highestPriority = static_cast<int32_t> (wfqClass->priority);
-        }
-    }
-
-    if (highestPriority == -1)
+    if (m_activeLevels == 0)
     {
         NS_LOG_LOGIC ("Cannot find active queue");
         return 0;
     }
 
-    // Find the smallest head finish time
-    uint64_t smallestHeadFinTime = 0;
-    Ptr<WFQClass> wfqClassToDequeue = 0;
-
-    itr = m_WFQs.begin ();
-    for (; itr != m_WFQs.end (); ++itr)
-    {
-        Ptr<WFQClass> wfqClass = itr->second;
-        if (static_cast<int32_t> (wfqClass->priority) != highestPriority
-                || wfqClass->lengthBytes == 0)
-        {
-            continue;
-        }
-        if (wfqClassToDequeue == 0 || wfqClass->headFinTime < smallestHeadFinTime)
-        {
-            wfqClassToDequeue = wfqClass;
-            smallestHeadFinTime = wfqClass->headFinTime;
-        }
-    }
-
-    return wfqClassToDequeue->qdisc->Peek ();
+    // The smallest head finish time is on top of the heap
+    return m_heaps[GetHighestLevel ()].front ().wfqClass->qdisc->Peek ();
 }
 
 bool
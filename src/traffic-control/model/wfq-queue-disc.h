@@ -2,7 +2,8 @@
 #define WFQ_QUEUE_DISC_H
 
 #include "ns3/queue-disc.h"
-#include <list>
+#include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -21,6 +22,9 @@ public:
     uint64_t headFinTime;
     uint32_t lengthBytes;
     uint32_t weight;
+
+    int32_t cl;                 //!< Class number, breaks the ties of finish times
+    uint32_t level;             //!< Index of the priority in the sorted priorities
 };
 
 class WFQQueueDisc : public QueueDisc
@@ -44,9 +48,55 @@ private:
     virtual bool CheckConfig (void);
     virtual void InitializeParams (void);
 
+    /// Entry of the heap of the active classes of a priority
+    struct HeapEntry
+    {
+        uint64_t headFinTime;   //!< Finish time of the head packet of the class
+        int32_t cl;             //!< Class number
+        WFQClass *wfqClass;     //!< The class
+    };
+
+    /// Order of the heaps: smallest finish time, then smallest class number, on top
+    struct HeapOrder
+    {
+        bool operator () (const HeapEntry &a, const HeapEntry &b) const
+        {
+            if (a.headFinTime != b.headFinTime)
+            {
+                return a.headFinTime > b.headFinTime;
+            }
+            return a.cl > b.cl;
+        }
+    };
+
+    /**
+     * Add an active class to the heap of its priority
+     * @param wfqClass the class
+     */
+    void Push (WFQClass *wfqClass);
+
+    /**
+     * Remove the class on top of the heap of a priority
+     * @param level the index of the priority
+     */
+    void Pop (uint32_t level);
+
+    /**
+     * @return the index of the highest priority with active classes, the
+     * bitmap of active priorities must not be empty
+     */
+    uint32_t GetHighestLevel (void) const;
+
     std::map<int32_t, Ptr<WFQClass> > m_WFQs;
     std::map<uint32_t, uint64_t> m_virtualTime;
 
+    // The classes with bytes are kept in a min-heap of finish times per
+    // priority; a bitmap tells which priorities have any, the priorities
+    // being sorted so that the highest set bit is served first
+    std::vector<uint32_t> m_priorities;
+    std::vector<std::vector<HeapEntry> > m_heaps;
+    uint64_t m_activeLevels;
+
 };
 
 } // namespace ns3
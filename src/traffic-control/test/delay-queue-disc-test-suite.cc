@@ -0,0 +1,278 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/delay-queue-disc.h"
+#include "ns3/packet-filter.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Packet filter returning the DSCP bits of the IPv4 TOS as the class
+ */
+class DelayTosFilter : public PacketFilter
+{
+public:
+  virtual bool CheckProtocol (Ptr<QueueDiscItem> item) const
+  {
+    return DynamicCast<Ipv4QueueDiscItem> (item) != 0;
+  }
+  virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const
+  {
+    return DynamicCast<Ipv4QueueDiscItem> (item)->GetHeader ().GetTos () >> 2;
+  }
+};
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Enqueue packets in a DelayQueueDisc and record when each one can
+ * be dequeued, polling the queue disc every microsecond.
+ */
+class DelayQueueDiscTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param name the name of the test case
+   */
+  DelayQueueDiscTestCase (std::string name);
+
+  /**
+   * Enqueue a packet
+   * \param cl the class of the packet
+   */
+  void Enqueue (int32_t cl);
+  /**
+   * Dequeue all the released packets, then poll again in 1us until the end
+   * \param end the last poll time
+   */
+  void Poll (Time end);
+
+protected:
+  /// A dequeued packet
+  struct Dequeued
+  {
+    int32_t cl;           //!< Class of the packet
+    uint64_t uid;         //!< Uid of the packet, increasing with the enqueue order
+    Time time;            //!< Dequeue time
+  };
+
+  /**
+   * Create the queue disc with the default granularity
+   * \return the queue disc
+   */
+  Ptr<DelayQueueDisc> Setup (void);
+
+  Ptr<DelayQueueDisc> m_queue;                  //!< The queue disc
+  std::vector<Dequeued> m_dequeued;             //!< The dequeued packets
+  std::vector<Time> m_enqueueTimes;             //!< Enqueue time of each packet
+};
+
+DelayQueueDiscTestCase::DelayQueueDiscTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+Ptr<DelayQueueDisc>
+DelayQueueDiscTestCase::Setup (void)
+{
+  m_queue = CreateObject<DelayQueueDisc> ();
+  m_queue->AddPacketFilter (CreateObject<DelayTosFilter> ());
+  m_dequeued.clear ();
+  m_enqueueTimes.clear ();
+  return m_queue;
+}
+
+void
+DelayQueueDiscTestCase::Enqueue (int32_t cl)
+{
+  Ipv4Header header;
+  header.SetTos (cl << 2);
+  header.SetPayloadSize (1000);
+  m_enqueueTimes.push_back (Simulator::Now ());
+  m_queue->Enqueue (Create<Ipv4QueueDiscItem> (Create<Packet> (1000), Address (), 0, header));
+}
+
+void
+DelayQueueDiscTestCase::Poll (Time end)
+{
+  Ptr<QueueDiscItem> item;
+  while ((item = m_queue->Dequeue ()) != 0)
+    {
+      Dequeued dequeued;
+      dequeued.cl = DynamicCast<Ipv4QueueDiscItem> (item)->GetHeader ().GetTos () >> 2;
+      dequeued.uid = item->GetPacket ()->GetUid ();
+      dequeued.time = Simulator::Now ();
+      m_dequeued.push_back (dequeued);
+    }
+  if (Simulator::Now () < end)
+    {
+      Simulator::Schedule (MicroSeconds (1), &DelayQueueDiscTestCase::Poll, this, end);
+    }
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check the release times of fixed delay classes, including a delay
+ * beyond the initial span of the timing wheel.
+ */
+class DelayQueueDiscFixedTestCase : public DelayQueueDiscTestCase
+{
+public:
+  DelayQueueDiscFixedTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DelayQueueDiscFixedTestCase::DelayQueueDiscFixedTestCase ()
+  : DelayQueueDiscTestCase ("Check the release times of fixed delays")
+{
+}
+
+void
+DelayQueueDiscFixedTestCase::DoRun (void)
+{
+  Ptr<DelayQueueDisc> queue = Setup ();
+  queue->AddDelayClass (0, MicroSeconds (10));
+  queue->AddDelayClass (1, MicroSeconds (200));
+  queue->AddDelayClass (2, MicroSeconds (0));
+  queue->Initialize ();
+
+  // Polls happen half way between two releases
+  Simulator::Schedule (NanoSeconds (500), &DelayQueueDiscTestCase::Poll, this, MicroSeconds (300));
+  Simulator::Schedule (MicroSeconds (0), &DelayQueueDiscTestCase::Enqueue, this, 1);
+  Simulator::Schedule (MicroSeconds (0), &DelayQueueDiscTestCase::Enqueue, this, 0);
+  Simulator::Schedule (MicroSeconds (0), &DelayQueueDiscTestCase::Enqueue, this, 2);
+  Simulator::Schedule (MicroSeconds (5), &DelayQueueDiscTestCase::Enqueue, this, 0);
+  Simulator::Schedule (MicroSeconds (150), &DelayQueueDiscTestCase::Enqueue, this, 0);
+  // Unknown class
+  Simulator::Schedule (MicroSeconds (150), &DelayQueueDiscTestCase::Enqueue, this, 3);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  int32_t classes[] = { 2, 0, 0, 0, 1 };
+  int64_t times[] = { 0, 10, 15, 160, 200 };
+  NS_TEST_ASSERT_MSG_EQ (m_dequeued.size (), 5, "Five packets should have been dequeued");
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_dequeued[i].cl, classes[i], "Wrong release order");
+      NS_TEST_EXPECT_MSG_EQ (m_dequeued[i].time, MicroSeconds (times[i]) + NanoSeconds (500),
+                             "Packet " << i << " released at the wrong time");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNDelayedPackets (), 0, "No packet should be left in the wheel");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 0, "No packet should be left in the queue disc");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 1, "The unknown class should be dropped");
+  queue->Dispose ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that the packets of a jittered class are delayed within
+ * the range of the random variable and leave in their enqueue order.
+ */
+class DelayQueueDiscJitterTestCase : public DelayQueueDiscTestCase
+{
+public:
+  DelayQueueDiscJitterTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DelayQueueDiscJitterTestCase::DelayQueueDiscJitterTestCase ()
+  : DelayQueueDiscTestCase ("Check the order and the delays of jittered classes")
+{
+}
+
+void
+DelayQueueDiscJitterTestCase::DoRun (void)
+{
+  Ptr<DelayQueueDisc> queue = Setup ();
+  Ptr<UniformRandomVariable> jitter = CreateObject<UniformRandomVariable> ();
+  // Negative draws count as no delay
+  jitter->SetAttribute ("Min", DoubleValue (-20));
+  jitter->SetAttribute ("Max", DoubleValue (100));
+  queue->AddDelayClass (0, jitter);
+  queue->AddDelayClass (1, MicroSeconds (30));
+  queue->Initialize ();
+
+  Simulator::Schedule (NanoSeconds (500), &DelayQueueDiscTestCase::Poll, this, MicroSeconds (400));
+  for (uint32_t i = 0; i < 200; ++i)
+    {
+      Simulator::Schedule (MicroSeconds (i), &DelayQueueDiscTestCase::Enqueue, this, i % 2);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_dequeued.size (), 200, "All the packets should have been dequeued");
+  uint64_t firstUid = m_dequeued[0].uid;
+  for (uint32_t i = 0; i < 200; ++i)
+    {
+      if (m_dequeued[i].uid < firstUid)
+        {
+          firstUid = m_dequeued[i].uid;
+        }
+    }
+  uint64_t lastUid[2] = { 0, 0 };
+  bool first[2] = { true, true };
+  for (uint32_t i = 0; i < 200; ++i)
+    {
+      const Dequeued &dequeued = m_dequeued[i];
+      Time enqueued = m_enqueueTimes[dequeued.uid - firstUid];
+      NS_TEST_EXPECT_MSG_EQ ((first[dequeued.cl] || dequeued.uid > lastUid[dequeued.cl]), true,
+                             "Packets of class " << dequeued.cl << " out of order");
+      first[dequeued.cl] = false;
+      lastUid[dequeued.cl] = dequeued.uid;
+      NS_TEST_EXPECT_MSG_GT (dequeued.time, enqueued, "Packet released before its enqueue");
+      if (dequeued.cl == 1)
+        {
+          NS_TEST_EXPECT_MSG_EQ (dequeued.time, enqueued + MicroSeconds (30) + NanoSeconds (500),
+                                 "Fixed delay class released at the wrong time");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNDelayedPackets (), 0, "No packet should be left in the wheel");
+  queue->Dispose ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief DelayQueueDisc test suite
+ */
+static class DelayQueueDiscTestSuite : public TestSuite
+{
+public:
+  DelayQueueDiscTestSuite ()
+    : TestSuite ("delay-queue-disc", UNIT)
+  {
+    AddTestCase (new DelayQueueDiscFixedTestCase (), TestCase::QUICK);
+    AddTestCase (new DelayQueueDiscJitterTestCase (), TestCase::QUICK);
+  }
+} g_delayQueueDiscTestSuite;
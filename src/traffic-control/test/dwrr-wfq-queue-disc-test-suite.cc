@@ -0,0 +1,482 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/dwrr-queue-disc.h"
+#include "ns3/wfq-queue-disc.h"
+#include "ns3/packet-filter.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/random-variable-stream.h"
+#include <deque>
+#include <list>
+#include <map>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Packet filter returning the DSCP bits of the IPv4 TOS as the class
+ */
+class SchedulerTestTosFilter : public PacketFilter
+{
+public:
+  virtual bool CheckProtocol (Ptr<QueueDiscItem> item) const
+  {
+    return DynamicCast<Ipv4QueueDiscItem> (item) != 0;
+  }
+  virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const
+  {
+    return DynamicCast<Ipv4QueueDiscItem> (item)->GetHeader ().GetTos () >> 2;
+  }
+};
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief FIFO queue disc used as the class of the schedulers
+ */
+class SchedulerTestFifoQueueDisc : public QueueDisc
+{
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item)
+  {
+    m_items.push_back (item);
+    return true;
+  }
+  virtual Ptr<QueueDiscItem> DoDequeue (void)
+  {
+    if (m_items.empty ())
+      {
+        return 0;
+      }
+    Ptr<QueueDiscItem> item = m_items.front ();
+    m_items.pop_front ();
+    return item;
+  }
+  virtual Ptr<const QueueDiscItem> DoPeek (void) const
+  {
+    return m_items.empty () ? 0 : m_items.front ();
+  }
+  virtual bool CheckConfig (void)
+  {
+    return true;
+  }
+  virtual void InitializeParams (void)
+  {
+  }
+
+  std::deque<Ptr<QueueDiscItem> > m_items; //!< The packets
+};
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief The DWRR algorithm as implemented by DWRRQueueDisc before the
+ * active classes were kept in a bitmap of priorities: a map of lists of
+ * classes by priority, scanned on every dequeue.
+ */
+class ReferenceDWRRQueueDisc : public QueueDisc
+{
+public:
+  /**
+   * Add a class
+   * \param qdisc the queue disc of the class
+   * \param cl the class number
+   * \param priority the priority, larger is served first
+   * \param quantum the quantum in bytes
+   */
+  void AddClass (Ptr<QueueDisc> qdisc, int32_t cl, uint32_t priority, uint32_t quantum)
+  {
+    Class c;
+    c.priority = priority;
+    c.qdisc = qdisc;
+    c.quantum = quantum;
+    c.deficit = 0;
+    m_classes[cl] = c;
+  }
+
+private:
+  /// A DWRR class
+  struct Class
+  {
+    uint32_t priority;          //!< Priority
+    Ptr<QueueDisc> qdisc;       //!< Queue disc of the class
+    uint32_t quantum;           //!< Quantum
+    uint32_t deficit;           //!< Deficit
+  };
+
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item)
+  {
+    std::map<int32_t, Class>::iterator itr = m_classes.find (Classify (item));
+    if (itr == m_classes.end ())
+      {
+        Drop (item);
+        return false;
+      }
+    Class *c = &itr->second;
+    if (!c->qdisc->Enqueue (item))
+      {
+        Drop (item);
+        return false;
+      }
+    if (c->qdisc->GetNPackets () == 1)
+      {
+        m_active[c->priority].push_back (c);
+        c->deficit = c->quantum;
+      }
+    return true;
+  }
+
+  virtual Ptr<QueueDiscItem> DoDequeue (void)
+  {
+    int32_t highestPriority = -1;
+    std::map<uint32_t, std::list<Class *> >::const_iterator itr = m_active.begin ();
+    for (; itr != m_active.end (); ++itr)
+      {
+        if (static_cast<int32_t> (itr->first) > highestPriority && !(itr->second).empty ())
+          {
+            highestPriority = static_cast<int32_t> (itr->first);
+          }
+      }
+    if (highestPriority == -1)
+      {
+        return 0;
+      }
+    while (true)
+      {
+        Class *c = m_active[highestPriority].front ();
+        Ptr<const QueueDiscItem> item = c->qdisc->Peek ();
+        uint32_t length = item->GetPacketSize ();
+        if (length <= c->deficit)
+          {
+            c->deficit -= length;
+            Ptr<QueueDiscItem> retItem = c->qdisc->Dequeue ();
+            if (c->qdisc->GetNPackets () == 0)
+              {
+                m_active[highestPriority].pop_front ();
+              }
+            return retItem;
+          }
+        c->deficit += c->quantum;
+        m_active[highestPriority].pop_front ();
+        m_active[highestPriority].push_back (c);
+      }
+  }
+
+  virtual Ptr<const QueueDiscItem> DoPeek (void) const
+  {
+    int32_t highestPriority = -1;
+    std::map<uint32_t, std::list<Class *> >::const_iterator itr = m_active.begin ();
+    for (; itr != m_active.end (); ++itr)
+      {
+        if (static_cast<int32_t> (itr->first) >= highestPriority && !(itr->second).empty ())
+          {
+            highestPriority = static_cast<int32_t> (itr->first);
+          }
+      }
+    if (highestPriority == -1)
+      {
+        return 0;
+      }
+    return m_active.at (highestPriority).front ()->qdisc->Peek ();
+  }
+
+  virtual bool CheckConfig (void)
+  {
+    return true;
+  }
+
+  virtual void InitializeParams (void)
+  {
+  }
+
+  std::map<uint32_t, std::list<Class *> > m_active;     //!< Active classes by priority
+  std::map<int32_t, Class> m_classes;                   //!< Classes
+};
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief The WFQ algorithm as implemented by WFQQueueDisc before the
+ * active classes were kept in heaps: every class is scanned on every
+ * dequeue for the smallest head finish time.
+ */
+class ReferenceWFQQueueDisc : public QueueDisc
+{
+public:
+  /**
+   * Add a class
+   * \param qdisc the queue disc of the class
+   * \param cl the class number
+   * \param priority the priority, larger is served first
+   * \param weight the weight
+   */
+  void AddClass (Ptr<QueueDisc> qdisc, int32_t cl, uint32_t priority, uint32_t weight)
+  {
+    Class c;
+    c.priority = priority;
+    c.qdisc = qdisc;
+    c.headFinTime = 0;
+    c.lengthBytes = 0;
+    c.weight = weight;
+    m_classes[cl] = c;
+  }
+
+private:
+  /// A WFQ class
+  struct Class
+  {
+    uint32_t priority;          //!< Priority
+    Ptr<QueueDisc> qdisc;       //!< Queue disc of the class
+    uint64_t headFinTime;       //!< Finish time of the head packet
+    uint32_t lengthBytes;       //!< Bytes queued
+    uint32_t weight;            //!< Weight
+  };
+
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item)
+  {
+    std::map<int32_t, Class>::iterator itr = m_classes.find (Classify (item));
+    if (itr == m_classes.end ())
+      {
+        Drop (item);
+        return false;
+      }
+    Class *c = &itr->second;
+    if (!c->qdisc->Enqueue (item))
+      {
+        Drop (item);
+        return false;
+      }
+    uint32_t length = item->GetPacketSize ();
+    uint64_t virtualTime = m_virtualTime[c->priority];
+    if (c->qdisc->GetNPackets () == 1)
+      {
+        c->headFinTime = length / c->weight + virtualTime;
+        m_virtualTime[c->priority] = c->headFinTime;
+      }
+    c->lengthBytes += length;
+    return true;
+  }
+
+  /**
+   * \return the class with the smallest head finish time in the highest
+   * priority with bytes, 0 if all the classes are empty
+   */
+  const Class *Select (void) const
+  {
+    int32_t highestPriority = -1;
+    std::map<int32_t, Class>::const_iterator itr = m_classes.begin ();
+    for (; itr != m_classes.end (); ++itr)
+      {
+        if (static_cast<int32_t> (itr->second.priority) > highestPriority && itr->second.lengthBytes > 0)
+          {
+            highestPriority = static_cast<int32_t> (itr->second.priority);
+          }
+      }
+    const Class *selected = 0;
+    for (itr = m_classes.begin (); itr != m_classes.end (); ++itr)
+      {
+        if (static_cast<int32_t> (itr->second.priority) != highestPriority || itr->second.lengthBytes == 0)
+          {
+            continue;
+          }
+        if (selected == 0 || itr->second.headFinTime < selected->headFinTime)
+          {
+            selected = &itr->second;
+          }
+      }
+    return selected;
+  }
+
+  virtual Ptr<QueueDiscItem> DoDequeue (void)
+  {
+    Class *c = const_cast<Class *> (Select ());
+    if (c == 0)
+      {
+        return 0;
+      }
+    Ptr<QueueDiscItem> retItem = c->qdisc->Dequeue ();
+    c->lengthBytes -= retItem->GetPacketSize ();
+    if (c->lengthBytes > 0)
+      {
+        c->headFinTime += c->qdisc->Peek ()->GetPacketSize () / c->weight;
+        if (m_virtualTime[c->priority] < c->headFinTime)
+          {
+            m_virtualTime[c->priority] = c->headFinTime;
+          }
+      }
+    return retItem;
+  }
+
+  virtual Ptr<const QueueDiscItem> DoPeek (void) const
+  {
+    const Class *c = Select ();
+    return c == 0 ? 0 : c->qdisc->Peek ();
+  }
+
+  virtual bool CheckConfig (void)
+  {
+    return true;
+  }
+
+  virtual void InitializeParams (void)
+  {
+  }
+
+  std::map<int32_t, Class> m_classes;           //!< Classes
+  std::map<uint32_t, uint64_t> m_virtualTime;   //!< Virtual time by priority
+};
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Feed the same random sequence of enqueues and dequeues to a
+ * scheduler and to its reference implementation, and check that they
+ * dequeue the same packets in the same order.
+ */
+class SchedulerEquivalenceTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param wfq whether to test WFQQueueDisc rather than DWRRQueueDisc
+   * \param stream the random stream of the test
+   */
+  SchedulerEquivalenceTestCase (bool wfq, int64_t stream);
+
+private:
+  virtual void DoRun (void);
+
+  bool m_wfq;           //!< Test WFQQueueDisc
+  int64_t m_stream;     //!< Random stream
+};
+
+SchedulerEquivalenceTestCase::SchedulerEquivalenceTestCase (bool wfq, int64_t stream)
+  : TestCase (std::string ("Check that ") + (wfq ? "WFQQueueDisc" : "DWRRQueueDisc")
+              + " dequeues the packets of the reference implementation"),
+    m_wfq (wfq),
+    m_stream (stream)
+{
+}
+
+void
+SchedulerEquivalenceTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (m_stream);
+
+  const uint32_t nClasses = 24;
+  Ptr<QueueDisc> queue;
+  Ptr<QueueDisc> reference;
+  Ptr<DWRRQueueDisc> dwrr;
+  Ptr<WFQQueueDisc> wfq;
+  Ptr<ReferenceDWRRQueueDisc> referenceDwrr;
+  Ptr<ReferenceWFQQueueDisc> referenceWfq;
+  if (m_wfq)
+    {
+      queue = wfq = CreateObject<WFQQueueDisc> ();
+      reference = referenceWfq = CreateObject<ReferenceWFQQueueDisc> ();
+    }
+  else
+    {
+      queue = dwrr = CreateObject<DWRRQueueDisc> ();
+      reference = referenceDwrr = CreateObject<ReferenceDWRRQueueDisc> ();
+    }
+  queue->AddPacketFilter (CreateObject<SchedulerTestTosFilter> ());
+  reference->AddPacketFilter (CreateObject<SchedulerTestTosFilter> ());
+
+  for (uint32_t cl = 0; cl < nClasses; ++cl)
+    {
+      // 8 priorities, some classes sharing one, with distinct weights
+      uint32_t priority = random->GetInteger (0, 7);
+      uint32_t weight = m_wfq ? random->GetInteger (1, 16) : random->GetInteger (64, 6000);
+      if (m_wfq)
+        {
+          wfq->AddWFQClass (CreateObject<SchedulerTestFifoQueueDisc> (), cl, priority, weight);
+          referenceWfq->AddClass (CreateObject<SchedulerTestFifoQueueDisc> (), cl, priority, weight);
+        }
+      else
+        {
+          dwrr->AddDWRRClass (CreateObject<SchedulerTestFifoQueueDisc> (), cl, priority, weight);
+          referenceDwrr->AddClass (CreateObject<SchedulerTestFifoQueueDisc> (), cl, priority, weight);
+        }
+    }
+  queue->Initialize ();
+  reference->Initialize ();
+
+  uint32_t nDequeued = 0;
+  for (uint32_t i = 0; i < 20000; ++i)
+    {
+      // Alternate phases where the queues grow and shrink
+      double enqueueProbability = ((i / 2000) % 2 == 0) ? 0.6 : 0.4;
+      if (random->GetValue () < enqueueProbability)
+        {
+          Ipv4Header header;
+          header.SetTos (random->GetInteger (0, nClasses - 1) << 2);
+          uint32_t size = random->GetInteger (40, 1480);
+          header.SetPayloadSize (size);
+          Ptr<QueueDiscItem> item = Create<Ipv4QueueDiscItem> (Create<Packet> (size), Address (), 0, header);
+          queue->Enqueue (item);
+          reference->Enqueue (item);
+        }
+      else
+        {
+          NS_TEST_ASSERT_MSG_EQ (queue->Peek (), reference->Peek (), "Different head packets at step " << i);
+          Ptr<QueueDiscItem> item = queue->Dequeue ();
+          NS_TEST_ASSERT_MSG_EQ (item, reference->Dequeue (), "Different dequeued packets at step " << i);
+          if (item != 0)
+            {
+              nDequeued++;
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (queue->GetNPackets (), reference->GetNPackets (), "Different backlogs at step " << i);
+    }
+  NS_TEST_ASSERT_MSG_GT (nDequeued, 5000, "Too few packets dequeued to compare the schedulers");
+
+  while (reference->GetNPackets () > 0)
+    {
+      NS_TEST_ASSERT_MSG_EQ (queue->Dequeue (), reference->Dequeue (), "Different dequeued packets while draining");
+    }
+  NS_TEST_ASSERT_MSG_EQ (queue->Dequeue (), 0, "The queue disc should be empty");
+  queue->Dispose ();
+  reference->Dispose ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief DWRR and WFQ scheduler equivalence test suite
+ */
+static class SchedulerEquivalenceTestSuite : public TestSuite
+{
+public:
+  SchedulerEquivalenceTestSuite ()
+    : TestSuite ("dwrr-wfq-queue-disc", UNIT)
+  {
+    for (int64_t stream = 1; stream <= 3; ++stream)
+      {
+        AddTestCase (new SchedulerEquivalenceTestCase (false, stream), TestCase::QUICK);
+        AddTestCase (new SchedulerEquivalenceTestCase (true, stream), TestCase::QUICK);
+      }
+  }
+} g_schedulerEquivalenceTestSuite;
@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/inband-telemetry.h"
+#include "ns3/inband-telemetry-tag.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/codel-queue-disc.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/data-rate.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Queue disc item used by the in-band telemetry tests
+ */
+class InbandTelemetryTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   * \param p the packet
+   */
+  InbandTelemetryTestItem (Ptr<Packet> p)
+    : QueueDiscItem (p, Address (), 0)
+  {
+  }
+  virtual void AddHeader (void)
+  {
+  }
+};
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Send 1000 bytes packets every 2 us on an 8 Gbps port, i.e., at
+ * half the link rate, and check the telemetry stamped on them.
+ */
+class InbandTelemetryTestCase : public TestCase
+{
+public:
+  InbandTelemetryTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Pass one packet through the queue disc
+  void Forward (void);
+
+  Ptr<QueueDisc> m_qd;              //!< The root queue disc
+  InbandTelemetryTag m_lastTag;     //!< Telemetry of the last packet
+};
+
+InbandTelemetryTestCase::InbandTelemetryTestCase ()
+  : TestCase ("Check the in-band telemetry stamped at an egress port")
+{
+}
+
+void
+InbandTelemetryTestCase::Forward (void)
+{
+  m_qd->Enqueue (Create<InbandTelemetryTestItem> (Create<Packet> (1000)));
+  Ptr<QueueDiscItem> item = m_qd->Dequeue ();
+  item->GetPacket ()->PeekPacketTag (m_lastTag);
+}
+
+void
+InbandTelemetryTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<TrafficControlLayer> tc = CreateObject<TrafficControlLayer> ();
+  node->AggregateObject (tc);
+
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAttribute ("DataRate", DataRateValue (DataRate ("8Gbps")));
+  device->SetQueue (CreateObject<DropTailQueue> ());
+  node->AddDevice (device);
+  tc->SetupDevice (device);
+
+  m_qd = CreateObject<CoDelQueueDisc> ();
+  m_qd->SetNetDevice (device);
+  tc->SetRootQueueDiscOnDevice (device, m_qd);
+  m_qd->Initialize ();
+
+  Ptr<InbandTelemetry> telemetry = InbandTelemetry::Install (node);
+  NS_TEST_ASSERT_MSG_EQ (telemetry, node->GetObject<InbandTelemetry> (), "Not aggregated to the node");
+
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      Simulator::Schedule (MicroSeconds (2 * i), &InbandTelemetryTestCase::Forward, this);
+    }
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_lastTag.GetHops (), 1, "The packet crossed one hop");
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_lastTag.GetMaxUtilization (), 0.5, 0.01, "Wrong link utilization");
+  NS_TEST_ASSERT_MSG_EQ (m_lastTag.GetMaxQueueBytes (), 0, "Nothing was queued");
+
+  // The tag is max-updated: a congested upstream hop is kept
+  Ptr<Packet> p = Create<Packet> (1000);
+  InbandTelemetryTag upstream;
+  upstream.Update (0.9, 500);
+  p->AddPacketTag (upstream);
+  m_qd->Enqueue (Create<InbandTelemetryTestItem> (p));
+  m_qd->Enqueue (Create<InbandTelemetryTestItem> (Create<Packet> (1000)));
+  m_qd->Enqueue (Create<InbandTelemetryTestItem> (Create<Packet> (1000)));
+  Ptr<QueueDiscItem> item = m_qd->Dequeue ();
+  InbandTelemetryTag tag;
+  NS_TEST_ASSERT_MSG_EQ (item->GetPacket ()->PeekPacketTag (tag), true, "Packet not stamped");
+  NS_TEST_ASSERT_MSG_EQ (tag.GetHops (), 2, "The packet crossed two hops");
+  NS_TEST_ASSERT_MSG_EQ_TOL (tag.GetMaxUtilization (), 0.9, 0.001, "The upstream utilization is larger");
+  NS_TEST_ASSERT_MSG_EQ (tag.GetMaxQueueBytes (), 2000, "The local queue is longer");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief In-band telemetry TestSuite
+ */
+static class InbandTelemetryTestSuite : public TestSuite
+{
+public:
+  InbandTelemetryTestSuite ()
+    : TestSuite ("inband-telemetry", UNIT)
+  {
+    AddTestCase (new InbandTelemetryTestCase (), TestCase::QUICK);
+  }
+} g_inbandTelemetryTestSuite; ///< the test suite
@@ -0,0 +1,285 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/mq-ecn-sharp-queue-disc.h"
+#include "ns3/packet-filter.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Packet filter returning the DSCP bits of the IPv4 TOS as the class
+ */
+class MQECNSharpTosFilter : public PacketFilter
+{
+public:
+  virtual bool CheckProtocol (Ptr<QueueDiscItem> item) const
+  {
+    return DynamicCast<Ipv4QueueDiscItem> (item) != 0;
+  }
+  virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const
+  {
+    return DynamicCast<Ipv4QueueDiscItem> (item)->GetHeader ().GetTos () >> 2;
+  }
+};
+
+/**
+ * \param cl the class of the packet
+ * \return an ECN capable packet of 1500 bytes with its IPv4 header
+ */
+static Ptr<QueueDiscItem>
+CreateMQECNSharpItem (int32_t cl)
+{
+  Ipv4Header header;
+  header.SetTos (cl << 2);
+  header.SetEcn (Ipv4Header::ECN_ECT1);
+  header.SetPayloadSize (1480);
+  return Create<Ipv4QueueDiscItem> (Create<Packet> (1480), Address (), 0, header);
+}
+
+/**
+ * \param scheduler the scheduler
+ * \param nClasses the number of classes, numbered from 0
+ * \param priorities the priorities of the classes
+ * \param weights the weights of the classes
+ * \return the queue disc, configured and initialized
+ */
+static Ptr<MQECNSharpQueueDisc>
+CreateMQECNSharp (std::string scheduler, uint32_t nClasses, const uint32_t *priorities, const uint32_t *weights)
+{
+  Ptr<MQECNSharpQueueDisc> queue = CreateObject<MQECNSharpQueueDisc> ();
+  queue->SetAttribute ("Scheduler", StringValue (scheduler));
+  queue->SetAttribute ("Mode", EnumValue (Queue::QUEUE_MODE_PACKETS));
+  queue->AddPacketFilter (CreateObject<MQECNSharpTosFilter> ());
+  for (uint32_t i = 0; i < nClasses; ++i)
+    {
+      queue->AddClass (i, priorities[i], weights[i]);
+    }
+  queue->Initialize ();
+  return queue;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check the share of the link each scheduler gives to backlogged
+ * classes and the strict priority between classes.
+ */
+class MQECNSharpSchedulerTestCase : public TestCase
+{
+public:
+  MQECNSharpSchedulerTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Fill the classes and count the classes of the first dequeued packets
+   * \param scheduler the scheduler
+   * \param weights the weights of classes 0 and 1, class 2 has the highest priority
+   * \param nDequeued the number of packets to dequeue
+   * \param counts the number of packets dequeued from each class
+   */
+  void Run (std::string scheduler, const uint32_t *weights, uint32_t nDequeued, uint32_t *counts);
+};
+
+MQECNSharpSchedulerTestCase::MQECNSharpSchedulerTestCase ()
+  : TestCase ("Check the DWRR, WFQ and SP schedulers of MQECNSharpQueueDisc")
+{
+}
+
+void
+MQECNSharpSchedulerTestCase::Run (std::string scheduler, const uint32_t *weights, uint32_t nDequeued, uint32_t *counts)
+{
+  uint32_t priorities[] = { 0, 0, 1 };
+  uint32_t allWeights[] = { weights[0], weights[1], 1500 };
+  Ptr<MQECNSharpQueueDisc> queue = CreateMQECNSharp (scheduler, 3, priorities, allWeights);
+
+  for (uint32_t i = 0; i < 50; ++i)
+    {
+      queue->Enqueue (CreateMQECNSharpItem (0));
+      queue->Enqueue (CreateMQECNSharpItem (1));
+    }
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      queue->Enqueue (CreateMQECNSharpItem (2));
+    }
+
+  counts[0] = counts[1] = counts[2] = 0;
+  for (uint32_t i = 0; i < nDequeued; ++i)
+    {
+      Ptr<const QueueDiscItem> peeked = queue->Peek ();
+      Ptr<QueueDiscItem> item = queue->Dequeue ();
+      NS_TEST_ASSERT_MSG_NE (item, 0, "The queue disc should not be empty");
+      NS_TEST_ASSERT_MSG_EQ (PeekPointer (peeked), PeekPointer (item), "Peek should return the packet dequeued next");
+      uint8_t cl = DynamicCast<Ipv4QueueDiscItem> (item)->GetHeader ().GetTos () >> 2;
+      // The high priority class goes first
+      NS_TEST_ASSERT_MSG_EQ ((i < 5), (cl == 2), "Class 2 should be served first");
+      counts[cl]++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (queue->GetNPackets (), 105 - nDequeued, "Wrong number of packets left");
+  queue->Dispose ();
+}
+
+void
+MQECNSharpSchedulerTestCase::DoRun (void)
+{
+  uint32_t weights[] = { 3000, 1500 };
+  uint32_t counts[3];
+
+  Run ("DWRR", weights, 35, counts);
+  NS_TEST_EXPECT_MSG_EQ (counts[0], 20, "DWRR should give class 0 twice the share of class 1");
+  NS_TEST_EXPECT_MSG_EQ (counts[1], 10, "DWRR should give class 1 half the share of class 0");
+
+  // Quanta smaller than a packet need several rounds before a class can send
+  uint32_t smallWeights[] = { 1000, 500 };
+  Run ("DWRR", smallWeights, 35, counts);
+  NS_TEST_EXPECT_MSG_EQ_TOL (counts[0], 20, 1, "DWRR should give class 0 twice the share of class 1");
+  NS_TEST_EXPECT_MSG_EQ_TOL (counts[1], 10, 1, "DWRR should give class 1 half the share of class 0");
+
+  uint32_t wfqWeights[] = { 2, 1 };
+  Run ("WFQ", wfqWeights, 35, counts);
+  NS_TEST_EXPECT_MSG_EQ_TOL (counts[0], 20, 1, "WFQ should give class 0 twice the share of class 1");
+  NS_TEST_EXPECT_MSG_EQ_TOL (counts[1], 10, 1, "WFQ should give class 1 half the share of class 0");
+
+  Run ("SP", weights, 35, counts);
+  NS_TEST_EXPECT_MSG_EQ (counts[0], 30, "SP should serve the lowest class number first");
+  NS_TEST_EXPECT_MSG_EQ (counts[1], 0, "SP should not serve class 1 while class 0 has packets");
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that the sojourn times and the marking states of the
+ * classes are tracked separately.
+ */
+class MQECNSharpMarkingTestCase : public TestCase
+{
+public:
+  MQECNSharpMarkingTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Enqueue a packet
+   * \param queue the queue disc
+   * \param cl the class of the packet
+   */
+  void Enqueue (Ptr<MQECNSharpQueueDisc> queue, int32_t cl);
+  /**
+   * Dequeue a packet and record whether it was marked
+   * \param queue the queue disc
+   */
+  void Dequeue (Ptr<MQECNSharpQueueDisc> queue);
+
+  std::vector<std::pair<uint8_t, bool> > m_dequeued; //!< Class and mark of the dequeued packets
+};
+
+MQECNSharpMarkingTestCase::MQECNSharpMarkingTestCase ()
+  : TestCase ("Check the per-class ECN# marking of MQECNSharpQueueDisc")
+{
+}
+
+void
+MQECNSharpMarkingTestCase::Enqueue (Ptr<MQECNSharpQueueDisc> queue, int32_t cl)
+{
+  queue->Enqueue (CreateMQECNSharpItem (cl));
+}
+
+void
+MQECNSharpMarkingTestCase::Dequeue (Ptr<MQECNSharpQueueDisc> queue)
+{
+  Ptr<Ipv4QueueDiscItem> item = DynamicCast<Ipv4QueueDiscItem> (queue->Dequeue ());
+  NS_TEST_ASSERT_MSG_NE (item, 0, "The queue disc should not be empty");
+  m_dequeued.push_back (std::make_pair (item->GetHeader ().GetTos () >> 2,
+                                        item->GetHeader ().GetEcn () == Ipv4Header::ECN_CE));
+}
+
+void
+MQECNSharpMarkingTestCase::DoRun (void)
+{
+  // Class 1 has the highest priority and is served at once, class 0
+  // waits 50us, above the 20us instantaneous marking threshold
+  uint32_t priorities[] = { 0, 1 };
+  uint32_t weights[] = { 1500, 1500 };
+  Ptr<MQECNSharpQueueDisc> queue = CreateMQECNSharp ("SP", 2, priorities, weights);
+  queue->SetAttribute ("InstantaneousMarkingThreshold", StringValue ("20us"));
+  queue->SetAttribute ("PersistentMarkingTarget", StringValue ("10us"));
+  queue->SetAttribute ("PersistentMarkingInterval", StringValue ("100us"));
+
+  Simulator::Schedule (MicroSeconds (0), &MQECNSharpMarkingTestCase::Enqueue, this, queue, 0);
+  Simulator::Schedule (MicroSeconds (0), &MQECNSharpMarkingTestCase::Enqueue, this, queue, 0);
+  Simulator::Schedule (MicroSeconds (50), &MQECNSharpMarkingTestCase::Enqueue, this, queue, 1);
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      Simulator::Schedule (MicroSeconds (50), &MQECNSharpMarkingTestCase::Dequeue, this, queue);
+    }
+  // 15us is below the instantaneous threshold but above the persistent
+  // target, where class 0 has been since 50us and class 1 has not been
+  Simulator::Schedule (MicroSeconds (200), &MQECNSharpMarkingTestCase::Enqueue, this, queue, 0);
+  Simulator::Schedule (MicroSeconds (200), &MQECNSharpMarkingTestCase::Enqueue, this, queue, 0);
+  Simulator::Schedule (MicroSeconds (200), &MQECNSharpMarkingTestCase::Enqueue, this, queue, 1);
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      Simulator::Schedule (MicroSeconds (215), &MQECNSharpMarkingTestCase::Dequeue, this, queue);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  uint32_t classes[] = { 1, 0, 0, 1, 0, 0 };
+  bool marks[] = { false, true, true, false, true, false };
+  const char *reasons[] = {
+    "Class 1 did not wait",
+    "Class 0 waited above the instantaneous threshold",
+    "Class 0 waited above the instantaneous threshold",
+    "Class 1 was not above the persistent target for an interval",
+    "Class 0 was above the persistent target for an interval",
+    "Class 0 is in the marking state until the next persistent mark"
+  };
+  NS_TEST_ASSERT_MSG_EQ (m_dequeued.size (), 6, "Six packets should have been dequeued");
+  for (uint32_t i = 0; i < 6; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (m_dequeued[i].first), classes[i], "Class 1 should be served first");
+      NS_TEST_EXPECT_MSG_EQ (m_dequeued[i].second, marks[i], reasons[i]);
+    }
+  queue->Dispose ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief MQECNSharpQueueDisc test suite
+ */
+static class MQECNSharpQueueDiscTestSuite : public TestSuite
+{
+public:
+  MQECNSharpQueueDiscTestSuite ()
+    : TestSuite ("mq-ecn-sharp-queue-disc", UNIT)
+  {
+    AddTestCase (new MQECNSharpSchedulerTestCase (), TestCase::QUICK);
+    AddTestCase (new MQECNSharpMarkingTestCase (), TestCase::QUICK);
+  }
+} g_mqEcnSharpQueueDiscTestSuite;
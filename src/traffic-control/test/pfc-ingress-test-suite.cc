@@ -0,0 +1,152 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/pfc-ingress.h"
+#include "ns3/codel-queue-disc.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/queue.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Queue disc item used by the PFC ingress tests
+ */
+class PfcIngressTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   * \param p the packet
+   */
+  PfcIngressTestItem (Ptr<Packet> p)
+    : QueueDiscItem (p, Address (), 0)
+  {
+  }
+  virtual void AddHeader (void)
+  {
+  }
+};
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that the bytes counted by an ingress device are released
+ * once when a queue disc drops the packet, and once for the segments of a
+ * packet which was cut.
+ */
+class PfcIngressReleaseTestCase : public TestCase
+{
+public:
+  PfcIngressReleaseTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Release callback of the ingress device
+   * \param priority the priority
+   * \param size the bytes released
+   */
+  void Release (uint8_t priority, uint32_t size);
+
+  uint32_t m_released[2];       //!< Bytes released per priority
+  uint32_t m_nReleases;         //!< Number of releases
+};
+
+PfcIngressReleaseTestCase::PfcIngressReleaseTestCase ()
+  : TestCase ("Check the release of the PFC ingress counters"),
+    m_nReleases (0)
+{
+  m_released[0] = 0;
+  m_released[1] = 0;
+}
+
+void
+PfcIngressReleaseTestCase::Release (uint8_t priority, uint32_t size)
+{
+  m_released[priority] += size;
+  m_nReleases++;
+}
+
+void
+PfcIngressReleaseTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  node->AddDevice (device);
+  Ptr<PfcIngress> ingress = CreateObject<PfcIngress> ();
+  ingress->SetReleaseCallback (MakeCallback (&PfcIngressReleaseTestCase::Release, this));
+  device->AggregateObject (ingress);
+
+  Ptr<QueueDisc> queueDisc = CreateObject<CoDelQueueDisc> ();
+  queueDisc->SetAttribute ("Mode", EnumValue (Queue::QUEUE_MODE_PACKETS));
+  queueDisc->SetAttribute ("MaxPackets", UintegerValue (2));
+  queueDisc->Initialize ();
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      PfcIngress::Count (p, device, 1, 1000);
+      queueDisc->Enqueue (Create<PfcIngressTestItem> (p));
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_released[1], 1000, "The packet dropped by the queue disc should be released");
+
+  // the packets which leave the node are released by their egress device
+  Ptr<QueueDiscItem> item = queueDisc->Dequeue ();
+  PfcIngress::Release (item->GetPacket (), node);
+  PfcIngress::Release (item->GetPacket (), node);
+  NS_TEST_EXPECT_MSG_EQ (m_released[1], 2000, "A packet should be released once");
+
+  // the count follows the first segment of a packet which is cut
+  Ptr<Packet> p = Create<Packet> (3000);
+  PfcIngress::Count (p, device, 0, 3000);
+  Ptr<Packet> first = p->CreateFragment (0, 1500);
+  PfcIngress::Move (p, first);
+  Ptr<Packet> second = p->CreateFragment (1500, 1500);
+  PfcIngress::Release (second, 0);
+  NS_TEST_EXPECT_MSG_EQ (m_released[0], 0, "The second segment does not carry the count");
+  PfcIngress::Release (first, 0);
+  NS_TEST_EXPECT_MSG_EQ (m_released[0], 3000, "The first segment carries the count");
+  NS_TEST_EXPECT_MSG_EQ (m_nReleases, 3, "Wrong number of releases");
+
+  queueDisc->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief PFC ingress TestSuite
+ */
+static class PfcIngressTestSuite : public TestSuite
+{
+public:
+  PfcIngressTestSuite ()
+    : TestSuite ("pfc-ingress", UNIT)
+  {
+    AddTestCase (new PfcIngressReleaseTestCase (), TestCase::QUICK);
+  }
+} g_pfcIngressTestSuite; ///< the test suite
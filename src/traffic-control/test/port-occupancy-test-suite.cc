@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/port-occupancy.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/codel-queue-disc.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Queue disc item used by the port occupancy tests
+ */
+class PortOccupancyTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   * \param p the packet
+   */
+  PortOccupancyTestItem (Ptr<Packet> p)
+    : QueueDiscItem (p, Address (), 0)
+  {
+  }
+  virtual void AddHeader (void)
+  {
+  }
+};
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that the port occupancy follows the root queue disc and the
+ * device queue of every port.
+ */
+class PortOccupancyTestCase : public TestCase
+{
+public:
+  PortOccupancyTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PortOccupancyTestCase::PortOccupancyTestCase ()
+  : TestCase ("Check the per-port byte occupancy")
+{
+}
+
+void
+PortOccupancyTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<TrafficControlLayer> tc = CreateObject<TrafficControlLayer> ();
+  node->AggregateObject (tc);
+
+  Ptr<SimpleNetDevice> devices[2];
+  Ptr<Queue> queues[2];
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      devices[i] = CreateObject<SimpleNetDevice> ();
+      queues[i] = CreateObject<DropTailQueue> ();
+      devices[i]->SetQueue (queues[i]);
+      node->AddDevice (devices[i]);
+    }
+
+  // Only the second device has a queue disc
+  Ptr<QueueDisc> qd = CreateObject<CoDelQueueDisc> ();
+  qd->SetNetDevice (devices[1]);
+  tc->SetRootQueueDiscOnDevice (devices[1], qd);
+  qd->Initialize ();
+
+  // Bytes queued before the installation are accounted for
+  queues[0]->Enqueue (Create<QueueItem> (Create<Packet> (100)));
+
+  Ptr<PortOccupancy> occupancy = PortOccupancy::Install (node);
+  NS_TEST_ASSERT_MSG_EQ (occupancy, node->GetObject<PortOccupancy> (), "Not aggregated to the node");
+  NS_TEST_ASSERT_MSG_EQ (occupancy->GetNPorts (), 2, "Wrong number of ports");
+  NS_TEST_ASSERT_MSG_EQ (occupancy->GetNBytes (0), 100, "Initial occupancy not accounted for");
+  NS_TEST_ASSERT_MSG_EQ (occupancy->GetNBytes (1), 0, "Wrong initial occupancy");
+
+  // Installing twice does not count the queues twice
+  PortOccupancy::Install (node);
+  NS_TEST_ASSERT_MSG_EQ (occupancy->GetNBytes (0), 100, "Queue tracked twice");
+
+  qd->Enqueue (Create<PortOccupancyTestItem> (Create<Packet> (500)));
+  qd->Enqueue (Create<PortOccupancyTestItem> (Create<Packet> (300)));
+  queues[1]->Enqueue (Create<QueueItem> (Create<Packet> (200)));
+  NS_TEST_ASSERT_MSG_EQ (occupancy->GetNBytes (1), 1000, "Queue disc and device queue not summed");
+
+  Ptr<QueueDiscItem> item = qd->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ (occupancy->GetNBytes (1), 1000 - item->GetPacketSize (), "Dequeue not accounted for");
+  queues[0]->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ (occupancy->GetNBytesArray ()[0], 0, "Dequeue not accounted for");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Port occupancy TestSuite
+ */
+static class PortOccupancyTestSuite : public TestSuite
+{
+public:
+  PortOccupancyTestSuite ()
+    : TestSuite ("port-occupancy", UNIT)
+  {
+    AddTestCase (new PortOccupancyTestCase (), TestCase::QUICK);
+  }
+} g_portOccupancyTestSuite; ///< the test suite
@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/shared-buffer-manager.h"
+#include "ns3/codel-queue-disc.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Queue disc item used by the shared buffer tests
+ */
+class SharedBufferTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   * \param p the packet
+   */
+  SharedBufferTestItem (Ptr<Packet> p)
+    : QueueDiscItem (p, Address (), 0)
+  {
+  }
+  virtual void AddHeader (void)
+  {
+  }
+};
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Fill two ports of a shared buffer with 1000 bytes packets and check
+ * how many packets each admission policy accepts.
+ */
+class SharedBufferAdmissionTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param policy the admission policy
+   * \param port0 the bytes expected to be admitted on the first port
+   * \param port1 the bytes expected to be admitted on the second port
+   */
+  SharedBufferAdmissionTestCase (SharedBufferManager::Policy policy, uint32_t port0, uint32_t port1);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Offer packets to a port until the first rejection
+   * \param port the port
+   */
+  void Fill (uint32_t port);
+
+  SharedBufferManager::Policy m_policy;     //!< The admission policy
+  uint32_t m_port0;                         //!< Expected bytes on port 0
+  uint32_t m_port1;                         //!< Expected bytes on port 1
+  Ptr<SharedBufferManager> m_buffer;        //!< The shared buffer
+  Ptr<QueueDisc> m_queueDiscs[2];           //!< The root queue discs
+};
+
+SharedBufferAdmissionTestCase::SharedBufferAdmissionTestCase (SharedBufferManager::Policy policy,
+                                                              uint32_t port0, uint32_t port1)
+  : TestCase ("Check the admission of a shared buffer policy"),
+    m_policy (policy),
+    m_port0 (port0),
+    m_port1 (port1)
+{
+}
+
+void
+SharedBufferAdmissionTestCase::Fill (uint32_t port)
+{
+  while (true)
+    {
+      Ptr<QueueDiscItem> item = Create<SharedBufferTestItem> (Create<Packet> (1000));
+      if (!m_buffer->Admit (port, item))
+        {
+          return;
+        }
+      m_queueDiscs[port]->Enqueue (item);
+    }
+}
+
+void
+SharedBufferAdmissionTestCase::DoRun (void)
+{
+  m_buffer = CreateObject<SharedBufferManager> ();
+  m_buffer->SetAttribute ("BufferSize", UintegerValue (10000));
+  m_buffer->SetAttribute ("Policy", EnumValue (m_policy));
+  m_buffer->SetAttribute ("Alpha", DoubleValue (1.0));
+  m_buffer->SetAttribute ("ReservedBytes", UintegerValue (1000));
+  m_buffer->SetAttribute ("NPriorities", UintegerValue (2));
+
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      m_queueDiscs[i] = CreateObject<CoDelQueueDisc> ();
+      m_queueDiscs[i]->Initialize ();
+      m_buffer->AttachQueueDisc (m_queueDiscs[i], i);
+    }
+
+  Fill (0);
+  Fill (1);
+  NS_TEST_ASSERT_MSG_EQ (m_buffer->GetPortOccupancy (0), m_port0, "Wrong admission on port 0");
+  NS_TEST_ASSERT_MSG_EQ (m_buffer->GetPortOccupancy (1), m_port1, "Wrong admission on port 1");
+  NS_TEST_ASSERT_MSG_EQ (m_buffer->GetOccupancy (), m_port0 + m_port1, "Wrong total occupancy");
+  NS_TEST_ASSERT_MSG_EQ (m_buffer->GetNDroppedPackets (0), 1, "Rejection not counted");
+  NS_TEST_ASSERT_MSG_EQ (m_buffer->GetNDroppedBytes (1), 1000, "Rejection not counted");
+
+  // Dequeued packets free the buffer
+  m_queueDiscs[0]->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ (m_buffer->GetPortOccupancy (0), m_port0 - 1000, "Dequeue not accounted for");
+  NS_TEST_ASSERT_MSG_EQ (m_buffer->GetPortOccupancy (0, 0), m_port0 - 1000, "Dequeue not accounted for");
+  NS_TEST_ASSERT_MSG_EQ (m_buffer->GetOccupancy (), m_port0 + m_port1 - 1000, "Dequeue not accounted for");
+
+  m_buffer->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Shared buffer manager TestSuite
+ */
+static class SharedBufferManagerTestSuite : public TestSuite
+{
+public:
+  SharedBufferManagerTestSuite ()
+    : TestSuite ("shared-buffer-manager", UNIT)
+  {
+    // Half of the buffer for each port
+    AddTestCase (new SharedBufferAdmissionTestCase (SharedBufferManager::STATIC, 5000, 5000), TestCase::QUICK);
+    // Port 0 stops at its share of the free buffer, port 1 at the share of what is left
+    AddTestCase (new SharedBufferAdmissionTestCase (SharedBufferManager::DYNAMIC_THRESHOLD, 5000, 3000), TestCase::QUICK);
+    // 4000 bytes are reserved, the dynamic threshold applies to the other 6000
+    AddTestCase (new SharedBufferAdmissionTestCase (SharedBufferManager::PRIORITY_RESERVATION, 4000, 3000), TestCase::QUICK);
+  }
+} g_sharedBufferManagerTestSuite; ///< the test suite
@@ -136,7 +136,9 @@ InterferenceHelper::NiChange::operator < (const InterferenceHelper::NiChange& o)
 InterferenceHelper::InterferenceHelper ()
   : m_errorRateModel (0),
     m_firstPower (0.0),
-    m_rxing (false)
+    m_rxing (false),
+    m_cursor (m_niChanges.end ()),
+    m_cursorPower (0.0)
 {
 }
 
@@ -191,17 +193,17 @@ Time
 InterferenceHelper::GetEnergyDuration (double energyW)
 {
   Time now = Simulator::Now ();
-  double noiseInterferenceW = 0.0;
+  Advance (now);
+  if (!m_rxing)
+    {
+      Prune ();
+    }
+  double noiseInterferenceW = m_cursorPower;
   Time end = now;
-  noiseInterferenceW = m_firstPower;
-  for (NiChanges::const_iterator i = m_niChanges.begin (); i != m_niChanges.end (); i++)
+  for (NiTimeline::const_iterator i = m_cursor; i != m_niChanges.end (); i++)
     {
-      noiseInterferenceW += i->GetDelta ();
-      end = i->GetTime ();
-      if (end < now)
-        {
-          continue;
-        }
+      noiseInterferenceW += i->second;
+      end = i->first;
       if (noiseInterferenceW < energyW)
         {
           break;
@@ -216,18 +218,11 @@ InterferenceHelper::AppendEvent (Ptr<InterferenceHelper::Event> event)
   Time now = Simulator::Now ();
   if (!m_rxing)
     {
-      NiChanges::iterator nowIterator = GetPosition (now);
-      for (NiChanges::iterator i = m_niChanges.begin (); i != nowIterator; i++)
-        {
-          m_firstPower += i->GetDelta ();
-        }
-      m_niChanges.erase (m_niChanges.begin (), nowIterator);
-      m_niChanges.insert (m_niChanges.begin (), NiChange (event->GetStartTime (), event->GetRxPowerW ()));
-    }
-  else
-    {
-      AddNiChangeEvent (NiChange (event->GetStartTime (), event->GetRxPowerW ()));
+      // the changes until now included only matter through their sum
+      Advance (now + TimeStep (1));
+      Prune ();
     }
+  AddNiChangeEvent (NiChange (event->GetStartTime (), event->GetRxPowerW ()));
   AddNiChangeEvent (NiChange (event->GetEndTime (), -event->GetRxPowerW ()));
 
 }
@@ -253,15 +248,17 @@ InterferenceHelper::CalculateNoiseInterferenceW (Ptr<InterferenceHelper::Event>
 {
   double noiseInterference = m_firstPower;
   NS_ASSERT (m_rxing);
-  for (NiChanges::const_iterator i = m_niChanges.begin () + 1; i != m_niChanges.end (); i++)
+  NS_ASSERT (!m_niChanges.empty ());
+  ni->push_back (NiChange (event->GetStartTime (), noiseInterference));
+  NiTimeline::const_iterator i = m_niChanges.begin ();
+  for (i++; i != m_niChanges.end (); i++)
     {
-      if ((event->GetEndTime () == i->GetTime ()) && event->GetRxPowerW () == -i->GetDelta ())
+      if ((event->GetEndTime () == i->first) && event->GetRxPowerW () == -i->second)
         {
           break;
         }
-      ni->push_back (*i);
+      ni->push_back (NiChange (i->first, i->second));
     }
-  ni->insert (ni->begin (), NiChange (event->GetStartTime (), noiseInterference));
   ni->push_back (NiChange (event->GetEndTime (), 0));
   return noiseInterference;
 }
@@ -831,18 +828,38 @@ InterferenceHelper::EraseEvents (void)
   m_niChanges.clear ();
   m_rxing = false;
   m_firstPower = 0.0;
+  m_cursor = m_niChanges.end ();
+  m_cursorPower = 0.0;
+}
+
+void
+InterferenceHelper::AddNiChangeEvent (NiChange change)
+{
+  // the changes happen now or later, hence after the changes already
+  // accumulated by the cursor
+  NiTimeline::iterator i = m_niChanges.insert (std::make_pair (change.GetTime (), change.GetDelta ()));
+  if (m_cursor == m_niChanges.end () || change.GetTime () < m_cursor->first)
+    {
+      m_cursor = i;
+    }
 }
 
-InterferenceHelper::NiChanges::iterator
-InterferenceHelper::GetPosition (Time moment)
+void
+InterferenceHelper::Advance (Time moment)
 {
-  return std::upper_bound (m_niChanges.begin (), m_niChanges.end (), NiChange (moment, 0));
+  while (m_cursor != m_niChanges.end () && m_cursor->first < moment)
+    {
+      m_cursorPower += m_cursor->second;
+      m_cursor++;
+    }
 }
 
 void
-InterferenceHelper::AddNiChangeEvent (NiChange change)
+InterferenceHelper::Prune (void)
 {
-  m_niChanges.insert (GetPosition (change.GetTime ()), change);
+  NS_ASSERT (!m_rxing);
+  m_niChanges.erase (m_niChanges.begin (), m_cursor);
+  m_firstPower = m_cursorPower;
 }
 
 void
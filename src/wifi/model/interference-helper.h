@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <vector>
 #include <list>
+#include <map>
 #include "wifi-mode.h"
 #include "wifi-preamble.h"
 #include "wifi-phy-standard.h"
@@ -38,6 +39,12 @@ class ErrorRateModel;
 /**
  * \ingroup wifi
  * \brief handles interference calculations
+ *
+ * The changes of the power on the medium are kept in a balanced tree
+ * ordered by time, so adding a signal costs O(log n). The changes which
+ * happened before now are folded into a single power as soon as no
+ * reception needs them, and a cursor remembers the power at the last
+ * query, so the energy queries do not walk the past changes again.
  */
 class InterferenceHelper
 {
@@ -263,6 +270,25 @@ private:
    * typedef for a list of Events
    */
   typedef std::list<Ptr<Event> > Events;
+  /**
+   * typedef for the power changes of the medium by time, the changes
+   * at the same time are kept in insertion order
+   */
+  typedef std::multimap<Time, double> NiTimeline;
+
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   */
+  InterferenceHelper (const InterferenceHelper &);
+  /**
+   * \brief Copy assignment
+   *
+   * Defined and unimplemented to avoid misuse
+   * \returns
+   */
+  InterferenceHelper &operator = (const InterferenceHelper &);
 
   /**
    * Append the given Event.
@@ -326,17 +352,28 @@ private:
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel;
   /// Experimental: needed for energy duration calculation
-  NiChanges m_niChanges;
-  double m_firstPower;
+  NiTimeline m_niChanges;
+  double m_firstPower;                  //!< Power before the first change
   bool m_rxing;
-  /// Returns an iterator to the first nichange, which is later than moment
-  NiChanges::iterator GetPosition (Time moment);
+  NiTimeline::iterator m_cursor;        //!< First change not in m_cursorPower
+  double m_cursorPower;                 //!< Power before m_cursor
   /**
-   * Add NiChange to the list at the appropriate position.
+   * Add NiChange to the timeline at the appropriate position.
    *
    * \param change
    */
   void AddNiChangeEvent (NiChange change);
+  /**
+   * Move the cursor past the changes before the given time.
+   *
+   * \param moment the time, no earlier than the previous one
+   */
+  void Advance (Time moment);
+  /**
+   * Fold the changes before the cursor into the first power and erase
+   * them. Only allowed when not receiving.
+   */
+  void Prune (void);
 };
 
 } //namespace ns3
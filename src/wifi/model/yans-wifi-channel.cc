@@ -25,10 +25,14 @@
 #include "ns3/node.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/object-factory.h"
 #include "yans-wifi-channel.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
+#include <algorithm>
+#include <limits>
 
 namespace ns3 {
 
@@ -51,11 +55,27 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("ReceiverCulling",
+                   "Deliver the packets only to the PHYs within the range of the transmission.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_culling),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxRange",
+                   "The range of the transmissions (m) when the PHYs are culled, "
+                   "0 to derive it from the propagation loss model and the thresholds of the PHYs.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0.0))
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_culling (false),
+    m_maxRange (0.0),
+    m_gridDirty (true),
+    m_thresholdsDirty (true),
+    m_rxThresholdDbm (0.0)
 {
 }
 
@@ -83,18 +103,30 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
 {
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
-  uint32_t j = 0;
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
+  double range = GetCullingRange (txPowerDbm);
+  std::vector<uint32_t> candidates;
+  if (range >= 0)
     {
-      if (sender != (*i))
+      m_grid.GetNeighbors (senderMobility->GetPosition (), range, candidates);
+    }
+  uint32_t n = range >= 0 ? candidates.size () : m_phyList.size ();
+  for (uint32_t k = 0; k < n; k++)
+    {
+      uint32_t j = range >= 0 ? candidates[k] : k;
+      Ptr<YansWifiPhy> phy = m_phyList[j];
+      if (sender != phy)
         {
           //For now don't account for inter channel interference
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          if (phy->GetChannelNumber () != sender->GetChannelNumber ())
             {
               continue;
             }
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
+          Ptr<MobilityModel> receiverMobility = phy->GetMobility ()->GetObject<MobilityModel> ();
+          if (range >= 0 && senderMobility->GetDistanceFrom (receiverMobility) > range)
+            {
+              continue;
+            }
           Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
           double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
           NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
@@ -125,6 +157,50 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
     }
 }
 
+double
+YansWifiChannel::GetCullingRange (double txPowerDbm) const
+{
+  if (!m_culling)
+    {
+      return -1;
+    }
+  if (m_thresholdsDirty)
+    {
+      // A signal below the ED threshold still makes the CCA busy above CCA mode 1
+      m_rxThresholdDbm = std::numeric_limits<double>::infinity ();
+      for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+        {
+          double threshold = std::min ((*i)->GetEdThreshold (), (*i)->GetCcaMode1Threshold ());
+          m_rxThresholdDbm = std::min (m_rxThresholdDbm, threshold - (*i)->GetRxGain ());
+        }
+      m_thresholdsDirty = false;
+    }
+  double range = m_maxRange > 0 ? m_maxRange : m_loss->GetMaxRange (txPowerDbm, m_rxThresholdDbm);
+  if (range < 0 || range == std::numeric_limits<double>::infinity ())
+    {
+      return -1;
+    }
+  UpdateGrid (range);
+  return range;
+}
+
+void
+YansWifiChannel::UpdateGrid (double range) const
+{
+  if (!m_gridDirty)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << range);
+  m_grid.Clear ();
+  m_grid.SetCellSize (std::max (range, 1.0));
+  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+    {
+      m_grid.Add ((*i)->GetMobility ()->GetObject<MobilityModel> ());
+    }
+  m_gridDirty = false;
+}
+
 void
 YansWifiChannel::Receive (uint32_t i, Ptr<Packet> packet, struct Parameters parameters) const
 {
@@ -147,6 +223,14 @@ void
 YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
 {
   m_phyList.push_back (phy);
+  m_gridDirty = true;
+  m_thresholdsDirty = true;
+}
+
+void
+YansWifiChannel::NotifyThresholdsChanged (void)
+{
+  m_thresholdsDirty = true;
 }
 
 int64_t
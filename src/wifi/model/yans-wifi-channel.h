@@ -30,6 +30,7 @@
 #include "wifi-tx-vector.h"
 #include "yans-wifi-phy.h"
 #include "ns3/nstime.h"
+#include "ns3/mobility-grid.h"
 
 namespace ns3 {
 
@@ -57,6 +58,19 @@ struct Parameters
  * class and contains a ns3::PropagationLossModel and a ns3::PropagationDelayModel.
  * By default, no propagation models are set so, it is the caller's responsability
  * to set them before using the channel.
+ *
+ * With the ReceiverCulling attribute, the channel keeps the PHYs in a
+ * ns3::MobilityGrid and only delivers a packet to the PHYs within the
+ * range of the transmission: the MaxRange attribute if set, else the
+ * distance beyond which the propagation loss model brings the signal
+ * below the lowest energy detection or CCA mode 1 threshold of the PHYs
+ * (net of their rx gain). The thresholds are read again when the first
+ * packet is sent after a PHY is added or changes one of them. When the
+ * range of the loss model is unknown, like with fading models, and
+ * MaxRange is not set, all the PHYs receive the packet.
+ * The culled signals are not added to the interference of the PHYs out
+ * of range and the propagation delay model is not invoked for them,
+ * which changes the draws of a random delay model.
  */
 class YansWifiChannel : public WifiChannel
 {
@@ -77,6 +91,12 @@ public:
    */
   void Add (Ptr<YansWifiPhy> phy);
 
+  /**
+   * Notify the channel that the thresholds or the rx gain of an attached
+   * PHY changed, so that the culling range is derived again
+   */
+  void NotifyThresholdsChanged (void);
+
   /**
    * \param loss the new propagation loss model.
    */
@@ -134,9 +154,28 @@ private:
    */
   void Receive (uint32_t i, Ptr<Packet> packet, struct Parameters parameters) const;
 
+  /**
+   * \param txPowerDbm the tx power of a packet
+   * \return the distance beyond which no PHY receives the packet, or a
+   * negative value if the PHYs are not culled
+   */
+  double GetCullingRange (double txPowerDbm) const;
+
+  /**
+   * Put the PHYs in the grid if PHYs were added
+   * \param range the range of the packet being sent
+   */
+  void UpdateGrid (double range) const;
+
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  bool m_culling;                      //!< Whether the PHYs out of range are culled
+  double m_maxRange;                   //!< Range of the transmissions, or 0 to derive it from the loss model
+  mutable MobilityGrid m_grid;         //!< Positions of the PHYs, by PHY index
+  mutable bool m_gridDirty;            //!< Whether PHYs were added since the grid was filled
+  mutable bool m_thresholdsDirty;      //!< Whether the thresholds of the PHYs changed since they were read
+  mutable double m_rxThresholdDbm;     //!< Lowest reception threshold of the PHYs before rx gain
 };
 
 } //namespace ns3
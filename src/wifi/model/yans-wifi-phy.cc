@@ -308,6 +308,10 @@ YansWifiPhy::SetRxGain (double gain)
 {
   NS_LOG_FUNCTION (this << gain);
   m_rxGainDb = gain;
+  if (m_channel != 0)
+    {
+      m_channel->NotifyThresholdsChanged ();
+    }
 }
 
 void
@@ -315,6 +319,10 @@ YansWifiPhy::SetEdThreshold (double threshold)
 {
   NS_LOG_FUNCTION (this << threshold);
   m_edThresholdW = DbmToW (threshold);
+  if (m_channel != 0)
+    {
+      m_channel->NotifyThresholdsChanged ();
+    }
 }
 
 void
@@ -322,6 +330,10 @@ YansWifiPhy::SetCcaMode1Threshold (double threshold)
 {
   NS_LOG_FUNCTION (this << threshold);
   m_ccaMode1ThresholdW = DbmToW (threshold);
+  if (m_channel != 0)
+    {
+      m_channel->NotifyThresholdsChanged ();
+    }
 }
 
 void
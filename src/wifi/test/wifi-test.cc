@@ -25,15 +25,18 @@
 #include "ns3/mobility-helper.h"
 #include "ns3/wifi-net-device.h"
 #include "ns3/adhoc-wifi-mac.h"
+#include "ns3/constant-rate-wifi-manager.h"
 #include "ns3/propagation-delay-model.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/yans-error-rate-model.h"
+#include "ns3/interference-helper.h"
 #include "ns3/constant-position-mobility-model.h"
 #include "ns3/test.h"
 #include "ns3/pointer.h"
 #include "ns3/rng-seed-manager.h"
 #include "ns3/config.h"
 #include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/string.h"
 #include "ns3/packet-socket-address.h"
 #include "ns3/packet-socket-server.h"
@@ -618,6 +621,284 @@ Bug730TestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (result, true, "packet reception unexpectedly stopped after adapting fragmentation threshold!");
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * Propagation delay model counting the receivers the channel considers
+ */
+class CountingPropagationDelayModel : public PropagationDelayModel
+{
+public:
+  CountingPropagationDelayModel ()
+    : m_count (0)
+  {
+  }
+  virtual Time GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+  {
+    m_count++;
+    return Seconds (0);
+  }
+  mutable uint32_t m_count; //!< Number of delays computed
+private:
+  virtual int64_t DoAssignStreams (int64_t stream)
+  {
+    return 0;
+  }
+};
+
+/**
+ * Make sure that the culling of the receivers out of range does not
+ * change the packets received, and that it skips the receivers out of
+ * range.
+ */
+class YansWifiChannelCullingTest : public TestCase
+{
+public:
+  YansWifiChannelCullingTest ();
+
+  virtual void DoRun (void);
+
+
+private:
+  /**
+   * Run the scenario
+   * \param culling whether the receivers are culled
+   * \param maxRange the MaxRange attribute of the channel
+   * \param threshold if not 0, the ED and CCA mode 1 thresholds (dBm) set
+   * after the first packet is sent
+   */
+  void RunOne (bool culling, double maxRange, double threshold = 0);
+  void CreateOne (Vector pos, Ptr<YansWifiChannel> channel);
+  void SendOnePacket (Ptr<WifiNetDevice> dev);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+  /**
+   * \param threshold the ED and CCA mode 1 thresholds (dBm) of all the PHYs
+   */
+  void SetThresholds (double threshold);
+
+  uint32_t m_received; //!< Number of packets received
+  uint32_t m_considered; //!< Number of receivers considered by the channel
+  std::vector<Ptr<YansWifiPhy> > m_phys; //!< The PHYs of the scenario
+};
+
+YansWifiChannelCullingTest::YansWifiChannelCullingTest ()
+  : TestCase ("Culling of the receivers out of range of YansWifiChannel")
+{
+}
+
+void
+YansWifiChannelCullingTest::SendOnePacket (Ptr<WifiNetDevice> dev)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  dev->Send (p, dev->GetBroadcast (), 1);
+}
+
+bool
+YansWifiChannelCullingTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  m_received++;
+  return true;
+}
+
+void
+YansWifiChannelCullingTest::SetThresholds (double threshold)
+{
+  for (uint32_t i = 0; i < m_phys.size (); i++)
+    {
+      m_phys[i]->SetEdThreshold (threshold);
+      m_phys[i]->SetCcaMode1Threshold (threshold);
+    }
+}
+
+void
+YansWifiChannelCullingTest::CreateOne (Vector pos, Ptr<YansWifiChannel> channel)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> dev = CreateObject<WifiNetDevice> ();
+
+  Ptr<WifiMac> mac = CreateObject<AdhocWifiMac> ();
+  mac->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  Ptr<ErrorRateModel> error = CreateObject<YansErrorRateModel> ();
+  phy->SetErrorRateModel (error);
+  phy->SetChannel (channel);
+  phy->SetDevice (dev);
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  m_phys.push_back (phy);
+  Ptr<WifiRemoteStationManager> manager = CreateObject<ConstantRateWifiManager> ();
+
+  mobility->SetPosition (pos);
+  node->AggregateObject (mobility);
+  mac->SetAddress (Mac48Address::Allocate ());
+  dev->SetMac (mac);
+  dev->SetPhy (phy);
+  dev->SetRemoteStationManager (manager);
+  node->AddDevice (dev);
+  dev->SetReceiveCallback (MakeCallback (&YansWifiChannelCullingTest::Receive, this));
+
+  Simulator::Schedule (Seconds (1.0 + 0.1 * node->GetId ()), &YansWifiChannelCullingTest::SendOnePacket, this, dev);
+}
+
+void
+YansWifiChannelCullingTest::RunOne (bool culling, double maxRange, double threshold)
+{
+  m_received = 0;
+  m_phys.clear ();
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetAttribute ("ReceiverCulling", BooleanValue (culling));
+  channel->SetAttribute ("MaxRange", DoubleValue (maxRange));
+  Ptr<CountingPropagationDelayModel> propDelay = CreateObject<CountingPropagationDelayModel> ();
+  channel->SetPropagationDelayModel (propDelay);
+  channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+
+  // the range of the log distance model is about 150m
+  CreateOne (Vector (0.0, 0.0, 0.0), channel);
+  CreateOne (Vector (20.0, 0.0, 0.0), channel);
+  CreateOne (Vector (0.0, 60.0, 0.0), channel);
+  CreateOne (Vector (1000.0, 0.0, 0.0), channel);
+  CreateOne (Vector (1000.0, 1000.0, 0.0), channel);
+  if (threshold != 0)
+    {
+      // Between the packets of the first and the second node
+      Simulator::Schedule (Seconds (1.05), &YansWifiChannelCullingTest::SetThresholds, this, threshold);
+    }
+
+  Simulator::Stop (Seconds (10.0));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_considered = propDelay->m_count;
+  m_phys.clear ();
+}
+
+void
+YansWifiChannelCullingTest::DoRun (void)
+{
+  RunOne (false, 0);
+  NS_TEST_EXPECT_MSG_EQ (m_received, 6, "The three nodes close to the origin should hear each other");
+  NS_TEST_EXPECT_MSG_EQ (m_considered, 20, "All the receivers should be considered");
+
+  RunOne (true, 0);
+  NS_TEST_EXPECT_MSG_EQ (m_received, 6, "The culling should not change the packets received");
+  NS_TEST_EXPECT_MSG_EQ (m_considered, 6, "Only the receivers in range should be considered");
+
+  RunOne (true, 40);
+  NS_TEST_EXPECT_MSG_EQ (m_received, 2, "Only the two nodes within MaxRange should hear each other");
+  NS_TEST_EXPECT_MSG_EQ (m_considered, 2, "Only the receivers within MaxRange should be considered");
+
+  // The range shrinks to about 2m once the thresholds are raised
+  RunOne (true, 0, -40);
+  NS_TEST_EXPECT_MSG_EQ (m_received, 2, "Only the packet sent before the change should be heard");
+  NS_TEST_EXPECT_MSG_EQ (m_considered, 2, "The range should follow the thresholds of the PHYs");
+}
+
+/**
+ * Check the energy durations and the SNR computed by InterferenceHelper
+ * when signals overlap, with and without a reception in progress.
+ */
+class InterferenceHelperTimelineTest : public TestCase
+{
+public:
+  InterferenceHelperTimelineTest ();
+
+  virtual void DoRun (void);
+
+
+private:
+  /**
+   * Add a signal to the helper
+   * \param duration the duration of the signal in microseconds
+   * \param powerW the power of the signal
+   * \param rx whether the reception of the signal starts
+   */
+  void Add (uint32_t duration, double powerW, bool rx);
+  /**
+   * Record the energy duration for a threshold
+   * \param energyW the threshold
+   */
+  void Query (double energyW);
+  /// End the reception and record its SNR
+  void EndRx (void);
+
+  InterferenceHelper m_interference;            //!< The helper under test
+  WifiTxVector m_txVector;                      //!< TXVECTOR of the signals
+  Ptr<InterferenceHelper::Event> m_rxEvent;     //!< The signal received
+  std::vector<Time> m_durations;                //!< Energy durations recorded
+  double m_snr;                                 //!< SNR of the signal received
+};
+
+InterferenceHelperTimelineTest::InterferenceHelperTimelineTest ()
+  : TestCase ("InterferenceHelper energy durations of overlapping signals")
+{
+}
+
+void
+InterferenceHelperTimelineTest::Add (uint32_t duration, double powerW, bool rx)
+{
+  Ptr<InterferenceHelper::Event> event = m_interference.Add (1000, m_txVector, WIFI_PREAMBLE_LONG,
+                                                             MicroSeconds (duration), powerW);
+  if (rx)
+    {
+      m_rxEvent = event;
+      m_interference.NotifyRxStart ();
+    }
+}
+
+void
+InterferenceHelperTimelineTest::Query (double energyW)
+{
+  m_durations.push_back (m_interference.GetEnergyDuration (energyW));
+}
+
+void
+InterferenceHelperTimelineTest::EndRx (void)
+{
+  m_snr = m_interference.CalculatePlcpPayloadSnrPer (m_rxEvent).snr;
+  m_interference.NotifyRxEnd ();
+}
+
+void
+InterferenceHelperTimelineTest::DoRun (void)
+{
+  m_interference.SetNoiseFigure (1.0);
+  m_interference.SetErrorRateModel (CreateObject<YansErrorRateModel> ());
+  m_txVector.SetMode (WifiPhy::GetOfdmRate6Mbps ());
+  m_txVector.SetChannelWidth (20);
+  m_txVector.SetNss (1);
+
+  // A: 1 nW from 0 to 100us, B: 2 nW from 10 to 60us
+  Simulator::Schedule (MicroSeconds (0), &InterferenceHelperTimelineTest::Add, this, 100, 1e-9, false);
+  Simulator::Schedule (MicroSeconds (0), &InterferenceHelperTimelineTest::Query, this, 0.5e-9);
+  Simulator::Schedule (MicroSeconds (10), &InterferenceHelperTimelineTest::Add, this, 50, 2e-9, false);
+  Simulator::Schedule (MicroSeconds (10), &InterferenceHelperTimelineTest::Query, this, 2.5e-9);
+  Simulator::Schedule (MicroSeconds (10), &InterferenceHelperTimelineTest::Query, this, 0.5e-9);
+  Simulator::Schedule (MicroSeconds (60), &InterferenceHelperTimelineTest::Query, this, 0.5e-9);
+  Simulator::Schedule (MicroSeconds (60), &InterferenceHelperTimelineTest::Query, this, 1.5e-9);
+  // C: 1 nW from 70 to 170us, received, D: 4 nW from 80 to 90us
+  Simulator::Schedule (MicroSeconds (70), &InterferenceHelperTimelineTest::Add, this, 100, 1e-9, true);
+  Simulator::Schedule (MicroSeconds (80), &InterferenceHelperTimelineTest::Add, this, 10, 4e-9, false);
+  Simulator::Schedule (MicroSeconds (85), &InterferenceHelperTimelineTest::Query, this, 4.5e-9);
+  Simulator::Schedule (MicroSeconds (120), &InterferenceHelperTimelineTest::Query, this, 0.5e-9);
+  Simulator::Schedule (MicroSeconds (170), &InterferenceHelperTimelineTest::EndRx, this);
+  Simulator::Schedule (MicroSeconds (170), &InterferenceHelperTimelineTest::Query, this, 0.5e-9);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_durations.size (), 8, "All the queries should be recorded");
+  NS_TEST_EXPECT_MSG_EQ (m_durations[0], MicroSeconds (100), "A alone lasts 100us");
+  NS_TEST_EXPECT_MSG_EQ (m_durations[1], MicroSeconds (50), "A and B overlap until 60us");
+  NS_TEST_EXPECT_MSG_EQ (m_durations[2], MicroSeconds (90), "A lasts until 100us");
+  NS_TEST_EXPECT_MSG_EQ (m_durations[3], MicroSeconds (40), "A lasts until 100us after B ends");
+  NS_TEST_EXPECT_MSG_EQ (m_durations[4], MicroSeconds (0), "The power drops below 1.5 nW when B ends");
+  NS_TEST_EXPECT_MSG_EQ (m_durations[5], MicroSeconds (5), "A, C and D overlap until 90us");
+  NS_TEST_EXPECT_MSG_EQ (m_durations[6], MicroSeconds (50), "C lasts until 170us");
+  NS_TEST_EXPECT_MSG_EQ (m_durations[7], MicroSeconds (0), "The medium is idle after C");
+
+  // A interferes with the start of C
+  double noiseFloor = 1.3803e-23 * 290.0 * 20e6;
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_snr, 1e-9 / (noiseFloor + 1e-9), 1e-9, "C is received with A as interference");
+}
+
 //-----------------------------------------------------------------------------
 class WifiTestSuite : public TestSuite
 {
@@ -633,6 +914,8 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new InterferenceHelperSequenceTest, TestCase::QUICK); //Bug 991
   AddTestCase (new Bug555TestCase, TestCase::QUICK); //Bug 555
   AddTestCase (new Bug730TestCase, TestCase::QUICK); //Bug 730
+  AddTestCase (new YansWifiChannelCullingTest, TestCase::QUICK);
+  AddTestCase (new InterferenceHelperTimelineTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite;
@@ -0,0 +1,293 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Replay a local pcap file from helper threads into the simulator, the
+ * way an emulated device feeds the packets it reads from a socket: each
+ * packet is handed to the simulation thread with
+ * Simulator::ScheduleWithContext.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/mpsc-event-ring.h"
+#include "ns3/packet.h"
+#include "ns3/pcap-file.h"
+#include "ns3/pcap-mmap-reader.h"
+#include "ns3/trace-helper.h"
+#include <iostream>
+#include <list>
+#include <vector>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+static std::string g_file = "bench-pcap-replay.pcap";
+static uint32_t g_expected = 0;
+static uint32_t g_received = 0;
+static uint64_t g_bytes = 0;
+
+static void
+writeFile (uint32_t n)
+{
+  PcapFile file;
+  file.Open (g_file, std::ios::out);
+  file.Init (PcapHelper::DLT_RAW);
+  uint8_t data[1500] = { 0 };
+  for (uint32_t i = 0; i < n; i++)
+    {
+      file.Write (i / 1000000, i % 1000000, data, 64 + (i * 7919) % 1400);
+    }
+  file.Close ();
+}
+
+static void
+receive (Ptr<Packet> packet)
+{
+  g_received++;
+  g_bytes += packet->GetSize ();
+}
+
+static void
+replayThread (void)
+{
+  PcapFile file;
+  file.Open (g_file, std::ios::in);
+  uint8_t data[65536];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  for (;;)
+    {
+      file.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+      if (file.Eof () || file.Fail ())
+        {
+          break;
+        }
+      Ptr<Packet> packet = Create<Packet> (data, readLen);
+      Simulator::ScheduleWithContext (0, Seconds (0), &receive, packet);
+    }
+  file.Close ();
+}
+
+static void
+poll (void)
+{
+  if (g_received == g_expected)
+    {
+      Simulator::Stop ();
+      return;
+    }
+  Simulator::Schedule (MicroSeconds (10), &poll);
+}
+
+static void
+benchReplay (uint32_t n, uint32_t nThreads, bool realtime)
+{
+  if (realtime)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::RealtimeSimulatorImpl"));
+    }
+  g_expected = n * nThreads;
+  g_received = 0;
+  g_bytes = 0;
+  std::list<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < nThreads; i++)
+    {
+      threads.push_back (Create<SystemThread> (MakeCallback (&replayThread)));
+    }
+  Simulator::Schedule (MicroSeconds (10), &poll);
+
+  SystemWallClockMs time;
+  time.Start ();
+  for (std::list<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Start ();
+    }
+  Simulator::Run ();
+  uint64_t deltaMs = time.End ();
+  for (std::list<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+  Simulator::Destroy ();
+
+  std::cout << g_received * 1000.0 / std::max (deltaMs, (uint64_t)1) << " packets/s"
+            << " (" << deltaMs << " ms elapsed, " << g_bytes << " bytes)\t"
+            << "Replay with " << nThreads << " threads"
+            << (realtime ? " in real time" : "")
+            << std::endl;
+}
+
+/*
+ * The cross-thread queue alone: the lock-free ring against a list
+ * protected by a mutex, which DefaultSimulatorImpl used to swap.
+ */
+static MpscEventRing *g_ring;
+static std::list<MpscEventRing::Event> g_list;
+static SystemMutex g_listMutex;
+static uint32_t g_nEvents;
+
+static void
+pushRing (void)
+{
+  MpscEventRing::Event ev;
+  ev.context = 0;
+  ev.event = 0;
+  for (uint32_t i = 0; i < g_nEvents; i++)
+    {
+      ev.timestamp = i;
+      g_ring->Push (ev);
+    }
+}
+
+static void
+pushList (void)
+{
+  MpscEventRing::Event ev;
+  ev.context = 0;
+  ev.event = 0;
+  for (uint32_t i = 0; i < g_nEvents; i++)
+    {
+      ev.timestamp = i;
+      CriticalSection cs (g_listMutex);
+      g_list.push_back (ev);
+    }
+}
+
+static void
+benchQueue (uint32_t n, uint32_t nThreads, bool ring)
+{
+  g_nEvents = n;
+  MpscEventRing eventRing;
+  g_ring = &eventRing;
+  std::list<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < nThreads; i++)
+    {
+      threads.push_back (Create<SystemThread> (MakeCallback (ring ? &pushRing : &pushList)));
+    }
+
+  SystemWallClockMs time;
+  time.Start ();
+  for (std::list<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Start ();
+    }
+  uint64_t total = uint64_t (n) * nThreads;
+  uint64_t drained = 0;
+  std::vector<MpscEventRing::Event> events;
+  while (drained < total)
+    {
+      if (ring)
+        {
+          events.clear ();
+          eventRing.Drain (events);
+          drained += events.size ();
+        }
+      else
+        {
+          std::list<MpscEventRing::Event> batch;
+          {
+            CriticalSection cs (g_listMutex);
+            g_list.swap (batch);
+          }
+          drained += batch.size ();
+        }
+    }
+  uint64_t deltaMs = time.End ();
+  for (std::list<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+  g_ring = 0;
+
+  std::cout << total * 1000.0 / std::max (deltaMs, (uint64_t)1) << " events/s"
+            << " (" << deltaMs << " ms elapsed)\t"
+            << (ring ? "MpscEventRing" : "Mutex and list") << " with " << nThreads << " threads"
+            << std::endl;
+}
+
+static void
+benchRead (bool mmap)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  uint64_t packets = 0;
+  uint64_t bytes = 0;
+  if (mmap)
+    {
+      PcapMmapReader reader;
+      reader.Open (g_file);
+      PcapMmapReader::Record record;
+      while (reader.Next (record))
+        {
+          packets++;
+          bytes += record.inclLen + record.data[0];
+        }
+    }
+  else
+    {
+      PcapFile file;
+      file.Open (g_file, std::ios::in);
+      uint8_t data[65536];
+      uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+      for (;;)
+        {
+          file.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+          if (file.Eof () || file.Fail ())
+            {
+              break;
+            }
+          packets++;
+          bytes += readLen + data[0];
+        }
+    }
+  uint64_t deltaMs = time.End ();
+  std::cout << packets * 1000.0 / std::max (deltaMs, (uint64_t)1) << " records/s"
+            << " (" << deltaMs << " ms elapsed, " << bytes << " bytes)\t"
+            << (mmap ? "PcapMmapReader" : "PcapFile") << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t nThreads = 2;
+  bool realtime = false;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the events scheduled from other threads, replaying a pcap file");
+  cmd.AddValue ("n", "number of packets in the pcap file", n);
+  cmd.AddValue ("threads", "number of threads replaying the file", nThreads);
+  cmd.AddValue ("realtime", "use the real time simulator", realtime);
+  cmd.AddValue ("file", "pcap file to write and replay", g_file);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of packets must be specified " <<
+        "by command-line argument --n=(number of packets)" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-pcap-replay with n=" << n << std::endl;
+
+  benchQueue (n, nThreads, false);
+  benchQueue (n, nThreads, true);
+  writeFile (n);
+  benchRead (false);
+  benchRead (true);
+  benchReplay (n, nThreads, realtime);
+
+  return 0;
+}
@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/data-rate.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/point-to-point-helper.h"
+#include <iostream>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+static volatile int64_t g_sink = 0; // keeps the results alive
+static uint32_t g_received = 0;
+
+/*
+ * The transmission time as DataRate used to compute it, through a double
+ * and int64x64_t.
+ */
+static void
+benchTxTimeDouble (uint32_t n)
+{
+  DataRate rate ("10Gbps");
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint32_t bytes = 64 + i % 1437;
+      g_sink += Seconds (static_cast<double> (bytes) * 8 / rate.GetBitRate ()).GetTimeStep ();
+    }
+}
+
+static void
+benchTxTime (uint32_t n)
+{
+  DataRate rate ("10Gbps");
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint32_t bytes = 64 + i % 1437;
+      g_sink += rate.CalculateBytesTxTime (bytes).GetTimeStep ();
+    }
+}
+
+/*
+ * Time::GetSeconds as it used to be computed, through int64x64_t.
+ */
+static void
+benchGetSecondsInt64x64 (uint32_t n)
+{
+  double sum = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      sum += NanoSeconds (i).To (Time::S).GetDouble ();
+    }
+  g_sink += static_cast<int64_t> (sum);
+}
+
+static void
+benchGetSeconds (uint32_t n)
+{
+  double sum = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      sum += NanoSeconds (i).GetSeconds ();
+    }
+  g_sink += static_cast<int64_t> (sum);
+}
+
+static bool
+receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  g_received++;
+  return true;
+}
+
+/*
+ * Send packets back to back on a point-to-point link, each of them goes
+ * through PointToPointNetDevice::TransmitStart.
+ */
+static void
+benchPointToPoint (uint32_t n)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1us"));
+  p2p.SetQueue ("ns3::DropTailQueue", "MaxPackets", UintegerValue (n));
+  NetDeviceContainer devices = p2p.Install (nodes);
+  devices.Get (1)->SetReceiveCallback (MakeCallback (&receive));
+
+  g_received = 0;
+  Ptr<Packet> packet = Create<Packet> (1400);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      devices.Get (0)->Send (packet->Copy (), devices.Get (1)->GetAddress (), 0x0800);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  g_sink += g_received;
+}
+
+static uint64_t
+runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  (*bench) (n);
+  uint64_t deltaMs = time.End ();
+  return deltaMs;
+}
+
+
+static void
+runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      uint64_t delay = runBenchOneIteration (bench, n);
+      minDelay = std::min (minDelay, delay);
+    }
+  double ps = n;
+  ps *= 1000;
+  ps /= std::max (minDelay, (uint64_t)1);
+  std::cout << ps << " operations/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark Time, DataRate and the point-to-point transmissions");
+  cmd.AddValue ("n", "number of iterations", n);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of iterations must be specified " <<
+        "by command-line argument --n=(number of iterations)" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-point-to-point with n=" << n << std::endl;
+
+  runBench (&benchTxTimeDouble, n, minIterations, "Tx time through double");
+  runBench (&benchTxTime, n, minIterations, "DataRate::CalculateBytesTxTime");
+  runBench (&benchGetSecondsInt64x64, n, minIterations, "GetSeconds through int64x64_t");
+  runBench (&benchGetSeconds, n, minIterations, "Time::GetSeconds");
+  runBench (&benchPointToPoint, n, minIterations, "Point-to-point packets");
+
+  return 0;
+}
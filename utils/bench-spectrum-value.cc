@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/spectrum-value.h"
+#include <iostream>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+using namespace ns3;
+
+static uint32_t g_nBands = 100;
+static Ptr<SpectrumValue> g_signal;
+static Ptr<SpectrumValue> g_allSignals;
+static Ptr<SpectrumValue> g_noise;
+static volatile double g_sink = 0; // keeps the results alive
+
+static void
+setup (void)
+{
+  // resource blocks of 180 kHz around 2.1 GHz
+  std::vector<double> freqs;
+  for (uint32_t i = 0; i < g_nBands; ++i)
+    {
+      freqs.push_back (2.1e9 + (i - g_nBands / 2.0) * 180e3);
+    }
+  Ptr<SpectrumModel> model = Create<SpectrumModel> (freqs);
+  g_signal = Create<SpectrumValue> (model);
+  g_allSignals = Create<SpectrumValue> (model);
+  g_noise = Create<SpectrumValue> (model);
+  for (uint32_t i = 0; i < g_nBands; ++i)
+    {
+      (*g_signal)[i] = 1e-15 * (1 + std::sin (i));
+      (*g_allSignals)[i] = 3e-15 * (2 + std::cos (i));
+      (*g_noise)[i] = 1e-17;
+    }
+}
+
+static void
+benchSinrOperators (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      SpectrumValue sinr = (*g_signal) / ((*g_allSignals) - (*g_signal) + (*g_noise));
+      g_sink += sinr[0];
+    }
+}
+
+static void
+benchSinrInPlace (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      SpectrumValue interf = *g_allSignals;
+      interf -= *g_signal;
+      interf += *g_noise;
+      SpectrumValue sinr = *g_signal;
+      sinr /= interf;
+      g_sink += sinr[0];
+    }
+}
+
+static void
+benchAccumulateOperators (uint32_t n)
+{
+  SpectrumValue sum (g_signal->GetSpectrumModel ());
+  for (uint32_t i = 0; i < n; i++)
+    {
+      sum += (*g_signal) * 1e-3;
+    }
+  g_sink += sum[0];
+}
+
+static void
+benchAccumulateInPlace (uint32_t n)
+{
+  SpectrumValue sum (g_signal->GetSpectrumModel ());
+  for (uint32_t i = 0; i < n; i++)
+    {
+      sum.AddScaled (*g_signal, 1e-3);
+    }
+  g_sink += sum[0];
+}
+
+static void
+benchSum (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_sink += Sum (*g_allSignals);
+    }
+}
+
+static void
+benchIntegral (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_sink += Integral (*g_allSignals);
+    }
+}
+
+static uint64_t
+runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  (*bench) (n);
+  uint64_t deltaMs = time.End ();
+  return deltaMs;
+}
+
+
+static void
+runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      uint64_t delay = runBenchOneIteration (bench, n);
+      minDelay = std::min (minDelay, delay);
+    }
+  double ps = n;
+  ps *= 1000;
+  ps /= std::max (minDelay, (uint64_t)1);
+  std::cout << ps << " operations/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark SpectrumValue arithmetic");
+  cmd.AddValue ("n", "number of iterations", n);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.AddValue ("bands", "number of bands of the spectrum model", g_nBands);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of iterations must be specified " <<
+        "by command-line argument --n=(number of iterations)" << std::endl;
+      exit (1);
+    }
+  setup ();
+  std::cout << "Running bench-spectrum-value with n=" << n
+            << " and " << g_nBands << " bands" << std::endl;
+
+  runBench (&benchSinrOperators, n, minIterations, "SINR with operators");
+  runBench (&benchSinrInPlace, n, minIterations, "SINR in place");
+  runBench (&benchAccumulateOperators, n, minIterations, "Accumulate with operators");
+  runBench (&benchAccumulateInPlace, n, minIterations, "Accumulate with AddScaled");
+  runBench (&benchSum, n, minIterations, "Sum");
+  runBench (&benchIntegral, n, minIterations, "Integral");
+
+  return 0;
+}